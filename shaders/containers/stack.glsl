@@ -6,6 +6,7 @@
   #error "Please define a default return type for the stack!"
 #endif
 
+// NOTE(WSWhitehouse): The SdfRenderer checks the BVH depth against this, keep SHADER_STACK_MAX_SIZE in sync...
 #define STACK_MAX_SIZE 50
 
 struct Stack
@@ -13,56 +13,42 @@ layout(set = 1, binding = 0) uniform SdfDataUBO
   mat4x4 worldMat;
   mat4x4 invWorldMat;
 
-  vec3 boundingBoxExtents;
-
-  uint indexCount;
+  uint triangleCount;
 } SdfData;
 
-struct Plane
-{
-  vec3 position;
-  vec3 normal;
-};
-
-#define MAX_TRIANGLES 75U
-#define MAX_INDICES (MAX_TRIANGLES * 3U)
 #define EPSILON 0.00001
 
 struct NodeStack
 {
   int index;
-  float tNear;
-  float tFar;
+  float dist;
 };
 
 #define STACK_TYPE NodeStack
-#define STACK_DEFAULT_RETURN NodeStack(0, 0.0, 0.0)
+#define STACK_DEFAULT_RETURN NodeStack(0, 0.0)
 #include "containers/stack.glsl"
 
-struct BSPNode
+// NOTE(WSWhitehouse): Matches BVH::Node, the left child of an interior node is
+// the next node in the array and the offset is the right child. For leaves the
+// offset is the first triangle...
+struct BVHNode
 {
-  Plane plane;
-
-  uint isLeaf;
-
-  uint nodePos;
-  uint nodeNeg;
-
-  uint indexStart;
-  uint indexCount;
+  vec3 minimum;
+  uint offset;
+  vec3 maximum;
+  uint triangleCount;
 };
 
-struct Vertex
+struct Triangle
 {
-  vec3 position;
+  vec3 a;
+  vec3 b;
+  vec3 c;
   vec3 normal;
-  vec3 colour;
-  vec2 texcoord;
 };
 
-layout(set = 1, binding = 1, std430) readonly buffer BSPTree     { BSPNode bspNodes[]; };
-layout(set = 1, binding = 2, std430) readonly buffer IndexArray  { uint indices[];     };
-layout(set = 1, binding = 3, std430) readonly buffer VertexArray { Vertex vertices[];  };
+layout(set = 1, binding = 1, std430) readonly buffer BVH           { BVHNode bvhNodes[];   };
+layout(set = 1, binding = 2, std430) readonly buffer TriangleArray { Triangle triangles[]; };
 
 struct Ray
 {
@@ -99,7 +85,7 @@ Ray CreateCameraRay()
 #define AO_INTENSITY 0.25
 #define AO_ITERATIONS 3
 
-bool RayIntersectBox(Ray ray, vec3 boxPos, vec3 boxSize, out float tMin, out float tMax)
+bool RayIntersectBox(Ray ray, vec3 minExtent, vec3 maxExtent, out float tMin, out float tMax)
 {
   tMin = EPSILON;
   tMax = RAYMARCH_DISTANCE;
@@ -107,10 +93,6 @@ bool RayIntersectBox(Ray ray, vec3 boxPos, vec3 boxSize, out float tMin, out flo
   vec3 origin = ray.Origin;
   vec3 dir    = ray.Direction;
 
-  // Calculate min and max extents
-  const vec3 minExtent = -boxSize;
-  const vec3 maxExtent = +boxSize;
-
   for (int i = 0; i < 3; ++i)
   {
     if (abs(dir[i]) < EPSILON)
@@ -145,93 +127,28 @@ bool RayIntersectBox(Ray ray, vec3 boxPos, vec3 boxSize, out float tMin, out flo
   return true;
 }
 
+// NOTE(WSWhitehouse): Returns the root node if the ray hits the bounds of the BVH, otherwise
+// -1 so the raymarch is skipped. The ray is moved into mesh space as that's where the BVH is...
 int GetNode(Ray ray)
 {
-  float tNear = EPSILON;
-  float tFar  = RAYMARCH_DISTANCE;
+  Ray localRay;
+  localRay.Origin    = (SdfData.invWorldMat * vec4(ray.Origin, 1.0)).xyz;
+  localRay.Direction = (SdfData.invWorldMat * vec4(ray.Direction, 0.0)).xyz;
+  localRay.Length    = ray.Length;
 
-  vec4 boxPos = SdfData.worldMat * vec4(0.0, 0.0, 0.0, 1.0);
-  if (!RayIntersectBox(ray, boxPos.xyz, SdfData.boundingBoxExtents, tNear, tFar))
+  float tNear, tFar;
+  if (!RayIntersectBox(localRay, bvhNodes[0].minimum, bvhNodes[0].maximum, tNear, tFar))
   {
     return -1;
   }
 
-  Stack stack = StackCreate();
-  int nodeIndex = 0;
-
-  float minimumHitDist = RAYMARCH_DISTANCE;
-
-  while(true)
-  {
-    BSPNode node = bspNodes[nodeIndex];
-
-    while(node.isLeaf == 0)
-    {
-      const Plane plane = node.plane;
-      const float denom = dot(ray.Direction, plane.normal);
-
-      // If the denominator is zero, the ray is parallel to the plane
-      //      if (abs(denom) < EPSILON)
-      //      {
-      //        node = bspNodes[node.nodeNeg];
-      //        continue;
-      //      }
-
-      const float numer = dot(plane.position - ray.Origin, plane.normal);
-      const float d = numer / denom;
-
-      if (d <= tNear)
-      {
-        nodeIndex = int(node.nodeNeg);
-      }
-      else if(d >= tFar)
-      {
-        nodeIndex = int(node.nodePos);
-      }
-      else
-      {
-        NodeStack nodeStack = NodeStack(int(node.nodeNeg), d, tFar);
-        StackPush(stack, nodeStack);
-        nodeIndex = int(node.nodePos);
-        tFar = d;
-      }
-
-      node = bspNodes[nodeIndex];
-    }
-
-
-
-    const uint pointCount = node.indexCount;
-    if (pointCount > 0)
-    {
-      return nodeIndex;
-    }
-//      const uint startIndex = node.pointIndex;
-//      const uint endIndex   = startIndex + pointCount;
-//      for (uint i = startIndex; i < endIndex; i++)
-//      {
-//        float tMin, tMax;
-//        if (RayIntersectSphere(ray, points[i].xyz, 0.01, tMin, tMax))
-//        {
-//          minimumHitDist = min(minimumHitDist, tMin);
-//
-//          if (tFar <= minimumHitDist) return nodeIndex;
-//        }
-//      }
-//    }
-
-    if (StackIsEmpty(stack))
-    {
-      if (tFar <= minimumHitDist) return -1;
-
-      return nodeIndex;
-    }
+  return 0;
+}
 
-    const NodeStack nodeStack = StackPop(stack);
-    nodeIndex = nodeStack.index;
-    tNear     = nodeStack.tNear;
-    tFar      = nodeStack.tFar;
-  }
+float BoxDistance(vec3 pos, BVHNode node)
+{
+  const vec3 delta = max(max(node.minimum - pos, pos - node.maximum), 0.0);
+  return length(delta);
 }
 
 float sdfTriangle2(vec3 point, vec3 a, vec3 b, vec3 c, vec3 normal)
@@ -274,73 +191,57 @@ float RaymarchMap(Ray ray, vec3 pos, inout vec3 colour, float minDist, int nodeI
   // NOTE(WSWhitehouse): Apply matrix transformation to the current position...
   pos = (SdfData.invWorldMat * vec4(pos.xyz, 1.0)).xyz;
 
-  const float bounds = sdfBox(pos, vec3(0.0, 0.0, 0.0), SdfData.boundingBoxExtents);
-  if (bounds > minDist) return bounds;
+  float nodeDist = BoxDistance(pos, bvhNodes[0]);
+  if (nodeDist > minDist) return nodeDist;
 
   Stack stack = StackCreate();
   float dist = RAYMARCH_DISTANCE;
   nodeIndex = 0;
 
+  // NOTE(WSWhitehouse): Closest child first, a node is only visited if its bounding
+  // box is closer than the closest triangle found so far...
   while(true)
   {
-    BSPNode node = bspNodes[nodeIndex];
-
-    while(node.isLeaf == 0)
+    if (nodeDist < abs(dist))
     {
-      const vec3 planeDiff  = pos - node.plane.position;
-      const float planeDist = dot(normalize(node.plane.normal), planeDiff);
+      const BVHNode node = bvhNodes[nodeIndex];
 
-      if (abs(planeDist) < dist)
+      if (node.triangleCount == 0)
       {
-        if (planeDist > 0.0)
-        {
-          const NodeStack nodeStack = NodeStack(int(node.nodeNeg), 0, 0);
-          StackPush(stack, nodeStack);
-          nodeIndex = int(node.nodePos);
-        }
-        else
+        int nearChild = nodeIndex + 1;
+        int farChild  = int(node.offset);
+        float nearDist = BoxDistance(pos, bvhNodes[nearChild]);
+        float farDist  = BoxDistance(pos, bvhNodes[farChild]);
+
+        if (farDist < nearDist)
         {
-          const NodeStack nodeStack = NodeStack(int(node.nodePos), 0, 0);
-          StackPush(stack, nodeStack);
-          nodeIndex = int(node.nodeNeg);
+          const int tempChild = nearChild; nearChild = farChild; farChild = tempChild;
+          const float tempDist = nearDist; nearDist  = farDist;  farDist  = tempDist;
         }
-      }
-      else
-      {
-        if (StackIsEmpty(stack))
+
+        // NOTE(WSWhitehouse): The far child is only pushed if it could still hold a closer
+        // triangle, it's checked again when popped as the closest triangle may have changed...
+        if (farDist < abs(dist))
         {
-          return dist;
+          StackPush(stack, NodeStack(farChild, farDist));
         }
 
-        const NodeStack nodeStack = StackPop(stack);
-        nodeIndex = nodeStack.index;
+        nodeIndex = nearChild;
+        nodeDist  = nearDist;
+        continue;
       }
 
-      node = bspNodes[nodeIndex];
-    }
-
-    const uint indexCount = node.indexCount;
-    if (indexCount != 0)
-    {
-      const uint startIndex = node.indexStart;
-      const uint endIndex   = startIndex + indexCount;
-      for (uint i = startIndex; i < endIndex; i+=3)
+      const uint startIndex = node.offset;
+      const uint endIndex   = startIndex + node.triangleCount;
+      for (uint i = startIndex; i < endIndex; ++i)
       {
-        const uint index0 = indices[i + 0];
-        const uint index1 = indices[i + 1];
-        const uint index2 = indices[i + 2];
+        const Triangle tri = triangles[i];
 
-        const vec3 vert0  = vertices[index0].position;
-        const vec3 vert1  = vertices[index1].position;
-        const vec3 vert2  = vertices[index2].position;
-        const vec3 normal = normalize(cross((vert1 - vert0), (vert0 - vert2)));
-
-        const float thisTriDist = sdfTriangle2(pos, vert0, vert1, vert2, normal);
+        const float thisTriDist = sdfTriangle2(pos, tri.a, tri.b, tri.c, tri.normal);
         if (abs(thisTriDist) < abs(dist))
         {
           dist = thisTriDist;
         }
-
       }
     }
 
@@ -351,178 +252,8 @@ float RaymarchMap(Ray ray, vec3 pos, inout vec3 colour, float minDist, int nodeI
 
     const NodeStack nodeStack = StackPop(stack);
     nodeIndex = nodeStack.index;
+    nodeDist  = nodeStack.dist;
   }
-
-
-
-//  const uint startIndex = bspNodes[nodeIndex].indexStart;
-//  const uint endIndex   = startIndex + bspNodes[nodeIndex].indexCount;
-//  const uint indexCount = endIndex - startIndex;
-//
-//  float minTriDist = RAYMARCH_DISTANCE;
-//
-//  if (indexCount <= 0) return minTriDist;
-//
-//  for (uint i = startIndex; i < endIndex; i+=3)
-//  {
-//    const uint index0 = indices[i + 0];
-//    const uint index1 = indices[i + 1];
-//    const uint index2 = indices[i + 2];
-//
-//    const vec3 vert0 = vertices[index0].position;
-//    const vec3 vert1 = vertices[index1].position;
-//    const vec3 vert2 = vertices[index2].position;
-//
-//    const float thisTriDist = sdfTriangle(pos, vert0, vert1, vert2);
-//
-//    if (abs(thisTriDist) < abs(minTriDist))
-//    {
-//      minTriDist = thisTriDist;
-//    }
-//
-//    // NOTE(WSWhitehouse): No need to check other triangles if this point
-//    // has already hit the minimum distance to a triangle!
-//    if (thisTriDist < minDist) return minTriDist;
-//  }
-//
-//  return minTriDist;
-
-//  float tNear = EPSILON;
-//  float tFar  = RAYMARCH_DISTANCE;
-//
-//  vec4 boxPos = SdfData.worldMat * vec4(0.0, 0.0, 0.0, 1.0);
-//  if (!RayIntersectBox(ray, boxPos.xyz, SdfData.boundingBoxExtents, tNear, tFar))
-//  {
-//    return RAYMARCH_DISTANCE;
-//  }
-//
-//  Stack stack = StackCreate();
-//  nodeIndex = 0;
-//
-//  float minimumHitDist = RAYMARCH_DISTANCE;
-//
-//  while(true)
-//  {
-//    BSPNode node = bspNodes[nodeIndex];
-//
-//    while(node.isLeaf == 0)
-//    {
-//      const Plane plane = node.plane;
-//      const float denom = dot(ray.Direction, plane.normal);
-//      const float numer = dot(plane.position - ray.Origin, plane.normal);
-//      const float d = numer / denom;
-//
-//      if (d <= tNear)
-//      {
-//        nodeIndex = int(node.nodeNeg);
-//      }
-//      else if(d >= tFar)
-//      {
-//        nodeIndex = int(node.nodePos);
-//      }
-//      else
-//      {
-//        NodeStack nodeStack = NodeStack(int(node.nodeNeg), d, tFar);
-//        StackPush(stack, nodeStack);
-//        nodeIndex = int(node.nodePos);
-//        tFar = d;
-//      }
-//
-//      node = bspNodes[nodeIndex];
-//    }
-//
-////    const vec3 planeDiff  = pos - bspNodes[nodeIndex].plane.position;
-////    const float planeDist = dot(bspNodes[nodeIndex].plane.normal, planeDiff);
-//
-//    const uint indexCount = node.indexCount;
-//    if (indexCount != 0)
-//    {
-//      const uint startIndex = node.indexStart;
-//      const uint endIndex   = startIndex + indexCount;
-//      for (uint i = startIndex; i < endIndex; i+=3)
-//      {
-//        const uint index0 = indices[i + 0];
-//        const uint index1 = indices[i + 1];
-//        const uint index2 = indices[i + 2];
-//
-//        const vec3 vert0 = vertices[index0].position;
-//        const vec3 vert1 = vertices[index1].position;
-//        const vec3 vert2 = vertices[index2].position;
-//
-//        const float thisTriDist = sdfTriangle(pos, vert0, vert1, vert2);
-//        minimumHitDist = min(minimumHitDist, thisTriDist);
-//
-//        // NOTE(WSWhitehouse): No need to check other triangles if this point
-//        // has already hit the minimum distance to a triangle!
-//        if (minimumHitDist < minDist) return minimumHitDist;
-//      }
-//    }
-//
-//    if (StackIsEmpty(stack))
-//    {
-//      return minimumHitDist;
-//    }
-//
-//    const NodeStack nodeStack = StackPop(stack);
-//    nodeIndex = nodeStack.index;
-//    tNear     = nodeStack.tNear;
-//    tFar      = nodeStack.tFar;
-//  }
-
-//  nodeIndex = 0;
-//  while(true)
-//  {
-//    if (bspNodes[nodeIndex].isLeaf == 1)
-//    {
-//      const uint startIndex = bspNodes[nodeIndex].indexStart;
-//      const uint endIndex   = startIndex + bspNodes[nodeIndex].indexCount;
-//      const uint indexCount = endIndex - startIndex;
-//
-//      if (indexCount <= 0)
-//      {
-//        const vec3 planeDiff = pos - bspNodes[nodeIndex].plane.position;
-//        return dot(bspNodes[nodeIndex].plane.normal, planeDiff);
-//      }
-//
-//      float minTriDist = RAYMARCH_DISTANCE;
-//
-//      for (uint i = startIndex; i < endIndex; i+=3)
-//      {
-//        const uint index0 = indices[i + 0];
-//        const uint index1 = indices[i + 1];
-//        const uint index2 = indices[i + 2];
-//
-//        const vec3 vert0 = vertices[index0].position;
-//        const vec3 vert1 = vertices[index1].position;
-//        const vec3 vert2 = vertices[index2].position;
-//
-//        const float thisTriDist = sdfTriangle(pos, vert0, vert1, vert2);
-//
-//        if (thisTriDist < minTriDist)
-//        {
-//          minTriDist = thisTriDist;
-//        }
-//
-//        // NOTE(WSWhitehouse): No need to check other triangles if this point
-//        // has already hit the minimum distance to a triangle!
-//        if (thisTriDist < minDist) return minTriDist;
-//      }
-//
-//      return minTriDist;
-//    }
-//
-//    const vec3 planeDiff  = pos - bspNodes[nodeIndex].plane.position;
-//    const float planeDist = dot(bspNodes[nodeIndex].plane.normal, planeDiff);
-//
-//    if (planeDist >= 0.0f)
-//    {
-//      nodeIndex = int(bspNodes[nodeIndex].nodePos);
-//    }
-//    else
-//    {
-//      nodeIndex = int(bspNodes[nodeIndex].nodeNeg);
-//    }
-//  }
 }
 
 // NOTE(WSWhitehouse): A simple overload for the RaymarchMap func,
@@ -16,3 +16,15 @@
 #define INDEX_FORMAT_16 0
 #define INDEX_FORMAT_32 1
 
+// NOTE(WSWhitehouse): The value of cells the compute shaders haven't written (F32_MAX)
+#define SDF_MAX_DIST 3.402823466e+38
+
+// Jump flooding passes, must match JumpFloodPass in SdfVoxelGrid.cpp
+#define JUMP_FLOOD_PASS_INIT    0
+#define JUMP_FLOOD_PASS_JUMP    1
+#define JUMP_FLOOD_PASS_RESOLVE 2
+
+// Jump flooding seeds are packed into a uint with 10 bits per axis
+#define NO_SEED 0xFFFFFFFFu
+#define PACK_SEED(cell) (uint((cell).x) | (uint((cell).y) << 10) | (uint((cell).z) << 20))
+#define UNPACK_SEED(seed) ivec3((seed) & 0x3FFu, ((seed) >> 10) & 0x3FFu, ((seed) >> 20) & 0x3FFu)
@@ -19,10 +19,31 @@ layout(set = 1, binding = 0) uniform UBVoxelData
   float voxelGridScale;
   float blend;
   bool showBounds;
+
+// Sparse Bricks (brickCount is 0 when the grid is dense)
+  uvec3 brickCount;
+  uvec3 brickAtlasCount;
+
+// Distance Encoding (see SdfEncoding)
+  float distanceScale;
+  float distanceBias;
 } VoxelData;
 
+// NOTE(WSWhitehouse): When using sparse bricks this is the brick atlas...
 layout(set = 1, binding = 1) uniform sampler3D voxelGrid;
 
+// NOTE(WSWhitehouse): Matches SdfBrickVolume::TopLevelCell
+struct TopLevelCell
+{
+  uint brickIndex;
+  float distance;
+};
+
+layout(set = 1, binding = 2) readonly buffer BrickGrid
+{
+  TopLevelCell cells[];
+} BrickGrid;
+
 // Fragment Output
 layout(location = 0) out vec4 outColor;
 
@@ -64,6 +85,46 @@ Ray CreateCameraRay()
 #define AO_INTENSITY 0.25
 #define AO_ITERATIONS 3
 
+// NOTE(WSWhitehouse): The normalised formats are sampled in the range [0,1], every
+// format is decoded the same way as the float formats have a scale of 1 and no bias...
+float SampleVoxelGrid(vec3 texPos)
+{
+  return (texture(voxelGrid, texPos).r * VoxelData.distanceScale) + VoxelData.distanceBias;
+}
+
+// Sparse Brick Settings (see SdfBrickVolume)
+#define BRICK_SIZE 8u
+#define BRICK_STRIDE 7u
+#define EMPTY_BRICK 0xFFFFFFFFu
+
+float SampleBricks(vec3 texPos)
+{
+  // NOTE(WSWhitehouse): Convert to grid space where the cells are at whole numbers,
+  // clamping to the edge of the grid like the dense image sampler...
+  const vec3 cellCount = vec3(VoxelData.cellCount);
+  const vec3 cell      = clamp(texPos * cellCount - 0.5, vec3(0.0), cellCount - 1.0);
+
+  const uvec3 brickCount = VoxelData.brickCount;
+  const uvec3 brick      = min(uvec3(cell / float(BRICK_STRIDE)), brickCount - 1u);
+  const uint index       = brick.x + (brick.y * brickCount.x) + (brick.z * brickCount.x * brickCount.y);
+
+  // NOTE(WSWhitehouse): Bricks that aren't stored are far from the surface, the
+  // distance is a lower bound for the whole brick so it is safe to step by...
+  const TopLevelCell topLevel = BrickGrid.cells[index];
+  if (topLevel.brickIndex == EMPTY_BRICK) return topLevel.distance;
+
+  const uvec3 atlasCount = VoxelData.brickAtlasCount;
+  const uvec3 atlasBrick = uvec3(topLevel.brickIndex % atlasCount.x,
+                                 (topLevel.brickIndex / atlasCount.x) % atlasCount.y,
+                                 topLevel.brickIndex / (atlasCount.x * atlasCount.y));
+
+  // NOTE(WSWhitehouse): Neighbouring bricks share a face of samples, so the
+  // hardware filtering never needs a sample from outside of the brick...
+  const vec3 local    = cell - vec3(brick * BRICK_STRIDE);
+  const vec3 atlasPos = (vec3(atlasBrick * BRICK_SIZE) + local + 0.5) / vec3(atlasCount * BRICK_SIZE);
+  return SampleVoxelGrid(atlasPos);
+}
+
 float VoxelDistance(vec3 pos, float minDist)
 {
   // NOTE(WSWhitehouse): Apply matrix transformation to the current position...
@@ -81,7 +142,7 @@ float VoxelDistance(vec3 pos, float minDist)
 
   // NOTE(WSWhitehouse): Scales the position to be between [0,1] so its a valid tex coord.
   const vec3 texPos     = (center / gridSize);
-  const float voxel     = texture(voxelGrid, texPos).r;
+  const float voxel     = VoxelData.brickCount.x > 0 ? SampleBricks(texPos) : SampleVoxelGrid(texPos);
   const float voxelDist = voxel / VoxelData.voxelGridScale;
 
 //  if (bounds <= minDist)
@@ -0,0 +1,657 @@
+#include "containers/AABBTree.hpp"
+
+// geometry
+#include "geometry/Frustum.hpp"
+
+// math
+#include "math/internal/Simd.hpp"
+
+using namespace ECS;
+using namespace Math;
+
+/** @brief The bounds of 8 nodes, stored as SoA so they can be tested using F32x8. */
+struct alignas(32) NodeBatch
+{
+  f32 minX[F32X8_LANE_COUNT];
+  f32 minY[F32X8_LANE_COUNT];
+  f32 minZ[F32X8_LANE_COUNT];
+  f32 maxX[F32X8_LANE_COUNT];
+  f32 maxY[F32X8_LANE_COUNT];
+  f32 maxZ[F32X8_LANE_COUNT];
+};
+
+static constexpr const u32 ALL_LANES_MASK = (1U << F32X8_LANE_COUNT) - 1U;
+
+static INLINE BoundingBox3D ExpandBounds(const BoundingBox3D& bounds, f32 margin)
+{
+  const glm::vec3 expand = glm::vec3(margin);
+  return { bounds.minimum - expand, bounds.maximum + expand };
+}
+
+void AABBTree::Create(u32 initialCapacity)
+{
+  nodes        = nullptr;
+  nodeCapacity = 0;
+  freeList     = NULL_NODE;
+  root         = NULL_NODE;
+  leafCount    = 0;
+
+  entityLeaves       = nullptr;
+  entityLeafCapacity = 0;
+
+  // NOTE(WSWhitehouse): Allocate the initial nodes and link them into the free list...
+  nodes = (Node*)mem_alloc(sizeof(Node) * MAX(initialCapacity, 1U));
+  nodeCapacity = MAX(initialCapacity, 1U);
+  Clear();
+}
+
+void AABBTree::Destroy()
+{
+  mem_free(nodes);
+  mem_free(entityLeaves);
+
+  nodes              = nullptr;
+  nodeCapacity       = 0;
+  freeList           = NULL_NODE;
+  root               = NULL_NODE;
+  leafCount          = 0;
+  entityLeaves       = nullptr;
+  entityLeafCapacity = 0;
+}
+
+void AABBTree::Clear()
+{
+  for (u32 i = 0; i < nodeCapacity; ++i)
+  {
+    nodes[i].parent = i + 1 < nodeCapacity ? i + 1 : NULL_NODE;
+    nodes[i].child1 = NULL_NODE;
+    nodes[i].child2 = NULL_NODE;
+  }
+
+  for (u32 i = 0; i < entityLeafCapacity; ++i)
+  {
+    entityLeaves[i] = NULL_NODE;
+  }
+
+  freeList  = 0;
+  root      = NULL_NODE;
+  leafCount = 0;
+}
+
+void AABBTree::Insert(Entity entity, const BoundingBox3D& bounds)
+{
+  const u32 entityIndex = EntityIndex(entity);
+
+  if (entityIndex >= entityLeafCapacity)
+  {
+    const u32 newCapacity = MAX(entityIndex + 1, entityLeafCapacity * 2);
+    entityLeaves = (u32*)mem_realloc(entityLeaves, sizeof(u32) * newCapacity);
+
+    for (u32 i = entityLeafCapacity; i < newCapacity; ++i)
+    {
+      entityLeaves[i] = NULL_NODE;
+    }
+
+    entityLeafCapacity = newCapacity;
+  }
+
+  // NOTE(WSWhitehouse): The index may still be in use by a stale handle...
+  if (entityLeaves[entityIndex] != NULL_NODE)
+  {
+    RemoveLeaf(entityLeaves[entityIndex]);
+    FreeNode(entityLeaves[entityIndex]);
+    leafCount--;
+  }
+
+  const u32 leaf = AllocateNode();
+  Node& node      = nodes[leaf];
+  node.bounds     = ExpandBounds(bounds, LEAF_MARGIN);
+  node.leafBounds = bounds;
+  node.entity     = entity;
+
+  InsertLeaf(leaf);
+  entityLeaves[entityIndex] = leaf;
+  leafCount++;
+}
+
+void AABBTree::Remove(Entity entity)
+{
+  if (!Contains(entity)) return;
+
+  const u32 entityIndex = EntityIndex(entity);
+  const u32 leaf        = entityLeaves[entityIndex];
+
+  RemoveLeaf(leaf);
+  FreeNode(leaf);
+  entityLeaves[entityIndex] = NULL_NODE;
+  leafCount--;
+}
+
+b8 AABBTree::Update(Entity entity, const BoundingBox3D& bounds)
+{
+  if (!Contains(entity))
+  {
+    Insert(entity, bounds);
+    return true;
+  }
+
+  const u32 leaf = entityLeaves[EntityIndex(entity)];
+  nodes[leaf].leafBounds = bounds;
+
+  if (nodes[leaf].bounds.ContainsAABB(bounds)) return false;
+
+  RemoveLeaf(leaf);
+  nodes[leaf].bounds = ExpandBounds(bounds, LEAF_MARGIN);
+  InsertLeaf(leaf);
+  return true;
+}
+
+b8 AABBTree::Contains(Entity entity) const
+{
+  const u32 entityIndex = EntityIndex(entity);
+  if (entityIndex >= entityLeafCapacity || entityLeaves[entityIndex] == NULL_NODE) return false;
+
+  return nodes[entityLeaves[entityIndex]].entity == entity;
+}
+
+u32 AABBTree::AllocateNode()
+{
+  if (freeList == NULL_NODE)
+  {
+    const u32 oldCapacity = nodeCapacity;
+    nodeCapacity = oldCapacity * 2;
+    nodes        = (Node*)mem_realloc(nodes, sizeof(Node) * nodeCapacity);
+
+    for (u32 i = oldCapacity; i < nodeCapacity; ++i)
+    {
+      nodes[i].parent = i + 1 < nodeCapacity ? i + 1 : NULL_NODE;
+      nodes[i].child1 = NULL_NODE;
+      nodes[i].child2 = NULL_NODE;
+    }
+
+    freeList = oldCapacity;
+  }
+
+  const u32 nodeIndex = freeList;
+  freeList = nodes[nodeIndex].parent;
+
+  nodes[nodeIndex].parent = NULL_NODE;
+  nodes[nodeIndex].child1 = NULL_NODE;
+  nodes[nodeIndex].child2 = NULL_NODE;
+  nodes[nodeIndex].entity = NULL_ENTITY;
+  return nodeIndex;
+}
+
+void AABBTree::FreeNode(u32 nodeIndex)
+{
+  nodes[nodeIndex].parent = freeList;
+  nodes[nodeIndex].child1 = NULL_NODE;
+  nodes[nodeIndex].child2 = NULL_NODE;
+  freeList = nodeIndex;
+}
+
+void AABBTree::InsertLeaf(u32 leaf)
+{
+  if (root == NULL_NODE)
+  {
+    root = leaf;
+    nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // NOTE(WSWhitehouse): Find the best sibling by walking down from the root. The cost of
+  // a sibling is the area of the new parent plus the area every ancestor grows by, the
+  // walk stops when making the current node the sibling is cheaper than either child.
+  const BoundingBox3D& leafBounds = nodes[leaf].bounds;
+
+  u32 sibling = root;
+  while (!nodes[sibling].IsLeaf())
+  {
+    const Node& node = nodes[sibling];
+
+    const f32 area         = node.bounds.GetSurfaceArea();
+    const f32 combinedArea = BoundingBox3D::Combine(node.bounds, leafBounds).GetSurfaceArea();
+
+    const f32 cost            = 2.0f * combinedArea;
+    const f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto childCost = [&](u32 child)
+    {
+      const f32 newArea = BoundingBox3D::Combine(nodes[child].bounds, leafBounds).GetSurfaceArea();
+      if (nodes[child].IsLeaf()) return newArea + inheritanceCost;
+
+      return (newArea - nodes[child].bounds.GetSurfaceArea()) + inheritanceCost;
+    };
+
+    const f32 cost1 = childCost(node.child1);
+    const f32 cost2 = childCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) break;
+
+    sibling = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  // Create a new parent for the sibling and leaf...
+  const u32 oldParent = nodes[sibling].parent;
+  const u32 newParent = AllocateNode();
+
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].bounds = BoundingBox3D::Combine(nodes[sibling].bounds, nodes[leaf].bounds);
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+  nodes[sibling].parent   = newParent;
+  nodes[leaf].parent      = newParent;
+
+  if (oldParent == NULL_NODE)
+  {
+    root = newParent;
+  }
+  else if (nodes[oldParent].child1 == sibling)
+  {
+    nodes[oldParent].child1 = newParent;
+  }
+  else
+  {
+    nodes[oldParent].child2 = newParent;
+  }
+
+  RefitAncestors(oldParent);
+}
+
+void AABBTree::RemoveLeaf(u32 leaf)
+{
+  if (leaf == root)
+  {
+    root = NULL_NODE;
+    return;
+  }
+
+  const u32 parent      = nodes[leaf].parent;
+  const u32 grandParent = nodes[parent].parent;
+  const u32 sibling     = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+  // NOTE(WSWhitehouse): The sibling takes the place of the parent...
+  nodes[sibling].parent = grandParent;
+  nodes[leaf].parent    = NULL_NODE;
+  FreeNode(parent);
+
+  if (grandParent == NULL_NODE)
+  {
+    root = sibling;
+    return;
+  }
+
+  if (nodes[grandParent].child1 == parent) { nodes[grandParent].child1 = sibling; }
+  else                                     { nodes[grandParent].child2 = sibling; }
+
+  RefitAncestors(grandParent);
+}
+
+void AABBTree::RefitAncestors(u32 nodeIndex)
+{
+  while (nodeIndex != NULL_NODE)
+  {
+    Node& node  = nodes[nodeIndex];
+    node.bounds = BoundingBox3D::Combine(nodes[node.child1].bounds, nodes[node.child2].bounds);
+
+    Rotate(nodeIndex);
+    nodeIndex = node.parent;
+  }
+}
+
+void AABBTree::Rotate(u32 nodeIndex)
+{
+  // NOTE(WSWhitehouse): Consider swapping a child with one of the other child's children
+  // (4 possible rotations). A rotation doesn't change the bounds of this node, only the
+  // bounds of the child that receives the swapped node, so the best rotation is the one
+  // that shrinks that child the most...
+  const Node& node = nodes[nodeIndex];
+  const u32 b = node.child1;
+  const u32 c = node.child2;
+
+  f32 bestGain   = 0.0f;
+  u32 swapChild  = NULL_NODE; // Child of this node being swapped
+  u32 swapTarget = NULL_NODE; // Grandchild being swapped with it
+  u32 swapParent = NULL_NODE; // Parent of the grandchild
+
+  auto consider = [&](u32 child, u32 parent, u32 grandChild, u32 otherGrandChild)
+  {
+    const f32 gain = nodes[parent].bounds.GetSurfaceArea() -
+                     BoundingBox3D::Combine(nodes[child].bounds, nodes[otherGrandChild].bounds).GetSurfaceArea();
+
+    if (gain > bestGain)
+    {
+      bestGain   = gain;
+      swapChild  = child;
+      swapTarget = grandChild;
+      swapParent = parent;
+    }
+  };
+
+  if (!nodes[c].IsLeaf())
+  {
+    consider(b, c, nodes[c].child1, nodes[c].child2);
+    consider(b, c, nodes[c].child2, nodes[c].child1);
+  }
+
+  if (!nodes[b].IsLeaf())
+  {
+    consider(c, b, nodes[b].child1, nodes[b].child2);
+    consider(c, b, nodes[b].child2, nodes[b].child1);
+  }
+
+  if (swapChild == NULL_NODE) return;
+
+  Node& parentNode = nodes[swapParent];
+  if (nodes[nodeIndex].child1 == swapChild) { nodes[nodeIndex].child1 = swapTarget; }
+  else                                      { nodes[nodeIndex].child2 = swapTarget; }
+
+  if (parentNode.child1 == swapTarget) { parentNode.child1 = swapChild; }
+  else                                 { parentNode.child2 = swapChild; }
+
+  nodes[swapTarget].parent = nodeIndex;
+  nodes[swapChild].parent  = swapParent;
+  parentNode.bounds        = BoundingBox3D::Combine(nodes[parentNode.child1].bounds, nodes[parentNode.child2].bounds);
+}
+
+template<typename BatchTestFunc>
+void AABBTree::QueryBatched(BatchTestFunc test, DArray<Entity>& out_entities) const
+{
+  if (root == NULL_NODE) return;
+
+  // NOTE(WSWhitehouse): Every node is pushed at most once, so the stack can't be
+  // larger than the node capacity...
+  u32* stack    = (u32*)mem_alloc(sizeof(u32) * nodeCapacity);
+  u32 stackSize = 0;
+
+  stack[stackSize] = root;
+  stackSize++;
+
+  NodeBatch batch;
+  u32 batchNodes[F32X8_LANE_COUNT];
+
+  while (stackSize > 0)
+  {
+    // NOTE(WSWhitehouse): Pop up to 8 nodes and test them all at once. Unused lanes are
+    // filled with the last node so they hold valid values, their results are ignored...
+    const u32 batchCount = MIN(stackSize, F32X8_LANE_COUNT);
+    stackSize -= batchCount;
+
+    for (u32 lane = 0; lane < F32X8_LANE_COUNT; ++lane)
+    {
+      batchNodes[lane] = stack[stackSize + MIN(lane, batchCount - 1)];
+
+      const BoundingBox3D& bounds = GetQueryBounds(batchNodes[lane]);
+      batch.minX[lane] = bounds.minimum.x;
+      batch.minY[lane] = bounds.minimum.y;
+      batch.minZ[lane] = bounds.minimum.z;
+      batch.maxX[lane] = bounds.maximum.x;
+      batch.maxY[lane] = bounds.maximum.y;
+      batch.maxZ[lane] = bounds.maximum.z;
+    }
+
+    u32 insideMask = 0;
+    const u32 hitMask = test(batch, insideMask);
+
+    for (u32 lane = 0; lane < batchCount; ++lane)
+    {
+      if ((hitMask & (1U << lane)) == 0) continue;
+
+      const Node& node = nodes[batchNodes[lane]];
+      if (node.IsLeaf())
+      {
+        out_entities.Add(node.entity);
+        continue;
+      }
+
+      if ((insideMask & (1U << lane)) == 0)
+      {
+        stack[stackSize]     = node.child1;
+        stack[stackSize + 1] = node.child2;
+        stackSize += 2;
+        continue;
+      }
+
+      // NOTE(WSWhitehouse): The node is entirely inside the query, add every leaf below it
+      // without testing. The subtree is walked above the current top of the stack...
+      const u32 subtreeBase = stackSize;
+      stack[stackSize] = batchNodes[lane];
+      stackSize++;
+
+      while (stackSize > subtreeBase)
+      {
+        stackSize--;
+        const Node& subtreeNode = nodes[stack[stackSize]];
+
+        if (subtreeNode.IsLeaf())
+        {
+          out_entities.Add(subtreeNode.entity);
+          continue;
+        }
+
+        stack[stackSize]     = subtreeNode.child1;
+        stack[stackSize + 1] = subtreeNode.child2;
+        stackSize += 2;
+      }
+    }
+  }
+
+  mem_free(stack);
+}
+
+void AABBTree::QueryFrustum(const Frustum& frustum, DArray<Entity>& out_entities) const
+{
+  QueryBatched([&frustum](const NodeBatch& batch, u32& out_insideMask) -> u32
+  {
+    const F32x8 half    = F32x8Set(0.5f);
+    const F32x8 zero    = F32x8Set(0.0f);
+    const F32x8 minX    = F32x8Load(batch.minX);
+    const F32x8 minY    = F32x8Load(batch.minY);
+    const F32x8 minZ    = F32x8Load(batch.minZ);
+    const F32x8 maxX    = F32x8Load(batch.maxX);
+    const F32x8 maxY    = F32x8Load(batch.maxY);
+    const F32x8 maxZ    = F32x8Load(batch.maxZ);
+    const F32x8 centerX = (minX + maxX) * half;
+    const F32x8 centerY = (minY + maxY) * half;
+    const F32x8 centerZ = (minZ + maxZ) * half;
+    const F32x8 extentX = (maxX - minX) * half;
+    const F32x8 extentY = (maxY - minY) * half;
+    const F32x8 extentZ = (maxZ - minZ) * half;
+
+    // NOTE(WSWhitehouse): A box is outside when it's entirely behind any plane, and
+    // entirely inside when it's in front of every plane...
+    u32 outsideMask      = 0;
+    u32 intersectingMask = 0;
+
+    for (u32 i = 0; i < Frustum::PLANE_COUNT; ++i)
+    {
+      const glm::vec4& plane = frustum.planes[i];
+
+      const F32x8 distance = centerX * F32x8Set(plane.x) + centerY * F32x8Set(plane.y) +
+                             centerZ * F32x8Set(plane.z) + F32x8Set(plane.w);
+      const F32x8 radius   = extentX * F32x8Set(fabsf(plane.x)) + extentY * F32x8Set(fabsf(plane.y)) +
+                             extentZ * F32x8Set(fabsf(plane.z));
+
+      outsideMask      |= F32x8LessThanMask(distance + radius, zero);
+      intersectingMask |= F32x8LessThanMask(distance - radius, zero);
+    }
+
+    out_insideMask = ~intersectingMask & ALL_LANES_MASK;
+    return ~outsideMask & ALL_LANES_MASK;
+  }, out_entities);
+}
+
+void AABBTree::QueryAABB(const BoundingBox3D& aabb, DArray<Entity>& out_entities) const
+{
+  QueryBatched([&aabb](const NodeBatch& batch, u32& out_insideMask) -> u32
+  {
+    const F32x8 queryMinX = F32x8Set(aabb.minimum.x);
+    const F32x8 queryMinY = F32x8Set(aabb.minimum.y);
+    const F32x8 queryMinZ = F32x8Set(aabb.minimum.z);
+    const F32x8 queryMaxX = F32x8Set(aabb.maximum.x);
+    const F32x8 queryMaxY = F32x8Set(aabb.maximum.y);
+    const F32x8 queryMaxZ = F32x8Set(aabb.maximum.z);
+
+    const F32x8 minX = F32x8Load(batch.minX);
+    const F32x8 minY = F32x8Load(batch.minY);
+    const F32x8 minZ = F32x8Load(batch.minZ);
+    const F32x8 maxX = F32x8Load(batch.maxX);
+    const F32x8 maxY = F32x8Load(batch.maxY);
+    const F32x8 maxZ = F32x8Load(batch.maxZ);
+
+    const u32 separatedMask =
+      F32x8LessThanMask(queryMaxX, minX) | F32x8LessThanMask(maxX, queryMinX) |
+      F32x8LessThanMask(queryMaxY, minY) | F32x8LessThanMask(maxY, queryMinY) |
+      F32x8LessThanMask(queryMaxZ, minZ) | F32x8LessThanMask(maxZ, queryMinZ);
+
+    const u32 outsideQueryMask =
+      F32x8LessThanMask(minX, queryMinX) | F32x8LessThanMask(queryMaxX, maxX) |
+      F32x8LessThanMask(minY, queryMinY) | F32x8LessThanMask(queryMaxY, maxY) |
+      F32x8LessThanMask(minZ, queryMinZ) | F32x8LessThanMask(queryMaxZ, maxZ);
+
+    out_insideMask = ~outsideQueryMask & ALL_LANES_MASK;
+    return ~separatedMask & ALL_LANES_MASK;
+  }, out_entities);
+}
+
+void AABBTree::QueryRay(const glm::vec3& origin, const glm::vec3& direction, f32 maxDistance,
+                        DArray<Entity>& out_entities) const
+{
+  // NOTE(WSWhitehouse): Slab test, a zero direction component gives an infinite inverse
+  // so the ray is only inside that slab if the origin is...
+  // https://tavianator.com/2011/ray_box.html
+  const glm::vec3 invDirection = 1.0f / direction;
+
+  QueryBatched([&origin, &invDirection, maxDistance](const NodeBatch& batch, u32& out_insideMask) -> u32
+  {
+    const F32x8 originX = F32x8Set(origin.x);
+    const F32x8 originY = F32x8Set(origin.y);
+    const F32x8 originZ = F32x8Set(origin.z);
+    const F32x8 invDirX = F32x8Set(invDirection.x);
+    const F32x8 invDirY = F32x8Set(invDirection.y);
+    const F32x8 invDirZ = F32x8Set(invDirection.z);
+
+    const F32x8 t1X = (F32x8Load(batch.minX) - originX) * invDirX;
+    const F32x8 t2X = (F32x8Load(batch.maxX) - originX) * invDirX;
+    const F32x8 t1Y = (F32x8Load(batch.minY) - originY) * invDirY;
+    const F32x8 t2Y = (F32x8Load(batch.maxY) - originY) * invDirY;
+    const F32x8 t1Z = (F32x8Load(batch.minZ) - originZ) * invDirZ;
+    const F32x8 t2Z = (F32x8Load(batch.maxZ) - originZ) * invDirZ;
+
+    const F32x8 tNear = F32x8Max(F32x8Max(F32x8Min(t1X, t2X), F32x8Min(t1Y, t2Y)),
+                                 F32x8Max(F32x8Min(t1Z, t2Z), F32x8Set(0.0f)));
+    const F32x8 tFar  = F32x8Min(F32x8Min(F32x8Max(t1X, t2X), F32x8Max(t1Y, t2Y)),
+                                 F32x8Min(F32x8Max(t1Z, t2Z), F32x8Set(maxDistance)));
+
+    out_insideMask = 0;
+    return ~F32x8LessThanMask(tFar, tNear) & ALL_LANES_MASK;
+  }, out_entities);
+}
+
+static INLINE f32 DistanceSqToBounds(const glm::vec3& point, const BoundingBox3D& bounds)
+{
+  const glm::vec3 delta = glm::max(glm::max(bounds.minimum - point, point - bounds.maximum), glm::vec3(0.0f));
+  return glm::dot(delta, delta);
+}
+
+u32 AABBTree::QueryNearest(const glm::vec3& point, u32 k, Entity* out_entities, f32* out_distances) const
+{
+  if (root == NULL_NODE || k == 0) return 0;
+
+  struct HeapEntry
+  {
+    f32 distanceSq;
+    u32 node;
+  };
+
+  // NOTE(WSWhitehouse): Best first search, the nodes are visited closest first using a
+  // binary min heap. The found entities are kept sorted, once k have been found any node
+  // further away than the furthest of them can't contain a closer entity...
+  HeapEntry* heap = (HeapEntry*)mem_alloc(sizeof(HeapEntry) * nodeCapacity);
+  u32 heapSize    = 0;
+
+  f32* foundDistancesSq = (f32*)mem_alloc(sizeof(f32) * k);
+  u32 foundCount        = 0;
+
+  auto heapPush = [&](HeapEntry entry)
+  {
+    u32 index = heapSize;
+    heapSize++;
+
+    while (index > 0)
+    {
+      const u32 parent = (index - 1) / 2;
+      if (heap[parent].distanceSq <= entry.distanceSq) break;
+
+      heap[index] = heap[parent];
+      index       = parent;
+    }
+
+    heap[index] = entry;
+  };
+
+  auto heapPop = [&]() -> HeapEntry
+  {
+    const HeapEntry top  = heap[0];
+    heapSize--;
+    const HeapEntry last = heap[heapSize];
+
+    u32 index = 0;
+    while (true)
+    {
+      u32 child = (index * 2) + 1;
+      if (child >= heapSize) break;
+      if (child + 1 < heapSize && heap[child + 1].distanceSq < heap[child].distanceSq) { child++; }
+      if (last.distanceSq <= heap[child].distanceSq) break;
+
+      heap[index] = heap[child];
+      index       = child;
+    }
+
+    if (heapSize > 0) { heap[index] = last; }
+    return top;
+  };
+
+  heapPush({ DistanceSqToBounds(point, GetQueryBounds(root)), root });
+
+  while (heapSize > 0)
+  {
+    const HeapEntry entry = heapPop();
+    if (foundCount == k && entry.distanceSq >= foundDistancesSq[k - 1]) break;
+
+    const Node& node = nodes[entry.node];
+    if (!node.IsLeaf())
+    {
+      heapPush({ DistanceSqToBounds(point, GetQueryBounds(node.child1)), node.child1 });
+      heapPush({ DistanceSqToBounds(point, GetQueryBounds(node.child2)), node.child2 });
+      continue;
+    }
+
+    // Insert the leaf into the sorted results, dropping the furthest if full...
+    u32 index = foundCount < k ? foundCount : k - 1;
+    if (foundCount < k) { foundCount++; }
+
+    while (index > 0 && foundDistancesSq[index - 1] > entry.distanceSq)
+    {
+      foundDistancesSq[index] = foundDistancesSq[index - 1];
+      out_entities[index]     = out_entities[index - 1];
+      index--;
+    }
+
+    foundDistancesSq[index] = entry.distanceSq;
+    out_entities[index]     = node.entity;
+  }
+
+  if (out_distances != nullptr)
+  {
+    for (u32 i = 0; i < foundCount; ++i)
+    {
+      out_distances[i] = sqrtf(foundDistancesSq[i]);
+    }
+  }
+
+  mem_free(foundDistancesSq);
+  mem_free(heap);
+
+  return foundCount;
+}
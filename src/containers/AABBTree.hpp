@@ -0,0 +1,161 @@
+#ifndef SNOWFLAKE_AABB_TREE_HPP
+#define SNOWFLAKE_AABB_TREE_HPP
+
+#include "pch.hpp"
+
+// containers
+#include "containers/DArray.hpp"
+
+// geometry
+#include "geometry/BoundingBox3D.hpp"
+
+// ECS includes
+#include "ecs/Entity.hpp"
+
+// Forward Declarations
+struct Frustum;
+
+/**
+* @brief A dynamic bounding volume hierarchy of entity bounding boxes, used as a spatial
+* index for culling and spatial queries. Every leaf holds the bounding box of a single
+* entity and the tree is updated incrementally as entities move, rather than being
+* rebuilt.
+*
+* Leaves are stored with a "fat" bounding box (grown by LEAF_MARGIN) so entities
+* that only move a small amount don't change the tree. When an entity leaves its fat box
+* it is removed and reinserted, picking the sibling that least increases the surface area
+* of the tree. Every node on the path back to the root is refit and tree rotations are
+* applied where they reduce the surface area, which keeps the tree close to the quality
+* of a full rebuild.
+*
+* The queries test 8 nodes at a time using SIMD (see Math::F32x8). Like the DArray it
+* isn't set up during its ctor, call the Create/Destroy functions.
+*
+* USEFUL LINKS & RESOURCES:
+*  - https://box2d.org/files/ErinCatto_DynamicBVH_GDC2019.pdf
+*  - Kensler, A. (2008). Tree Rotations for Improving Bounding Volume Hierarchies.
+*/
+struct AABBTree
+{
+  static inline constexpr const u32 NULL_NODE = U32_MAX;
+
+  /** @brief The amount the leaf bounding boxes are grown by on every side. */
+  static inline constexpr const f32 LEAF_MARGIN = 0.1f;
+
+  struct Node
+  {
+    BoundingBox3D bounds;     // Fat bounds for leaves
+    BoundingBox3D leafBounds; // Exact bounds, only valid for leaves
+    u32 parent;               // Next free node when in the free list
+    u32 child1;               // NULL_NODE for leaves
+    u32 child2;
+    ECS::Entity entity;       // Only valid for leaves
+
+    [[nodiscard]] INLINE b8 IsLeaf() const noexcept { return child1 == NULL_NODE; }
+  };
+
+  void Create(u32 initialCapacity = 64);
+  void Destroy();
+
+  /** @brief Remove every entity from the tree, doesn't free any memory. */
+  void Clear();
+
+  /**
+  * @brief Insert the entity into the tree, replacing any existing leaf for the
+  * same entity index (i.e. a destroyed entity whose index has been reused).
+  * @param entity Entity to insert.
+  * @param bounds World space bounding box of the entity.
+  */
+  void Insert(ECS::Entity entity, const BoundingBox3D& bounds);
+
+  /** @brief Remove the entity from the tree, does nothing if it isn't in the tree. */
+  void Remove(ECS::Entity entity);
+
+  /**
+  * @brief Update the bounding box of an entity, inserting it if it isn't in the tree.
+  * @param entity Entity to update.
+  * @param bounds World space bounding box of the entity.
+  * @return True if the structure of the tree changed; false if the entity stayed inside its fat bounds.
+  */
+  b8 Update(ECS::Entity entity, const BoundingBox3D& bounds);
+
+  /** @brief Returns true if the entity is in the tree. */
+  [[nodiscard]] b8 Contains(ECS::Entity entity) const;
+
+  /** @brief Get the number of entities in the tree. */
+  [[nodiscard]] INLINE u32 GetLeafCount() const noexcept { return leafCount; }
+
+  /** @brief Get the bounding box of the entire tree, only valid when the tree isn't empty. */
+  [[nodiscard]] INLINE const BoundingBox3D& GetBounds() const { return nodes[root].bounds; }
+
+  /**
+  * @brief Find every entity whose bounding box is inside or intersecting the frustum.
+  * @param frustum Frustum to test against.
+  * @param out_entities Array the entities are added to, it isn't cleared first.
+  */
+  void QueryFrustum(const Frustum& frustum, DArray<ECS::Entity>& out_entities) const;
+
+  /**
+  * @brief Find every entity whose bounding box overlaps the requested bounding box.
+  * @param aabb Bounding box to test against.
+  * @param out_entities Array the entities are added to, it isn't cleared first.
+  */
+  void QueryAABB(const BoundingBox3D& aabb, DArray<ECS::Entity>& out_entities) const;
+
+  /**
+  * @brief Find every entity whose bounding box is hit by the ray.
+  * @param origin Origin of the ray.
+  * @param direction Direction of the ray, doesn't need to be normalised.
+  * @param maxDistance Length of the ray, as a multiple of the direction.
+  * @param out_entities Array the entities are added to, it isn't cleared first.
+  */
+  void QueryRay(const glm::vec3& origin, const glm::vec3& direction, f32 maxDistance,
+                DArray<ECS::Entity>& out_entities) const;
+
+  /**
+  * @brief Find the k entities whose bounding boxes are closest to the point. Entities
+  * whose bounding box contains the point have a distance of 0.
+  * @param point Point to search from.
+  * @param k Max number of entities to find.
+  * @param out_entities Array of at least k entities, sorted by distance (closest first).
+  * @param out_distances Optional array of at least k distances, may be nullptr.
+  * @return The number of entities found, at most k.
+  */
+  u32 QueryNearest(const glm::vec3& point, u32 k, ECS::Entity* out_entities, f32* out_distances = nullptr) const;
+
+private:
+  Node* nodes      = nullptr;
+  u32 nodeCapacity = 0;
+  u32 freeList     = NULL_NODE;
+  u32 root         = NULL_NODE;
+  u32 leafCount    = 0;
+
+  // NOTE(WSWhitehouse): Indexed by entity index, the leaf node of the entity...
+  u32* entityLeaves      = nullptr;
+  u32 entityLeafCapacity = 0;
+
+  [[nodiscard]] u32 AllocateNode();
+  void FreeNode(u32 nodeIndex);
+
+  void InsertLeaf(u32 leaf);
+  void RemoveLeaf(u32 leaf);
+  void RefitAncestors(u32 nodeIndex);
+  void Rotate(u32 nodeIndex);
+
+  /**
+  * @brief Walk the tree testing 8 nodes at a time, see AABBTree.cpp.
+  * @param test Called with each batch of nodes, returns a bit per overlapping node.
+  * It also outputs a bit per node that is entirely inside the query, whose
+  * leaves are then added without testing.
+  */
+  template<typename BatchTestFunc>
+  void QueryBatched(BatchTestFunc test, DArray<ECS::Entity>& out_entities) const;
+
+  /** @brief Get the bounds tested by the queries, the exact bounds for leaves. */
+  [[nodiscard]] INLINE const BoundingBox3D& GetQueryBounds(u32 nodeIndex) const
+  {
+    return nodes[nodeIndex].IsLeaf() ? nodes[nodeIndex].leafBounds : nodes[nodeIndex].bounds;
+  }
+};
+
+#endif //SNOWFLAKE_AABB_TREE_HPP
@@ -3,11 +3,9 @@
 // core
 #include "core/Abort.hpp"
 #include "core/Logging.hpp"
-#include "core/Random.hpp"
 
 // containers
 #include "containers/FArray.hpp"
-#include <queue>
 
 // geometry
 #include "geometry/BoundingBox3D.hpp"
@@ -19,12 +17,67 @@
 // math
 #include "math/Math.hpp"
 
+// threading
+#include "threading/JobSystem.hpp"
+
 // https://stackoverflow.com/a/21220521/13195883
 
+// NOTE(WSWhitehouse): Child geometry with at least this many indices is built as a separate
+// job, smaller geometry is built by the job that split it. This is a fixed size rather than
+// depending on the number of threads so the same subtrees are always built as jobs...
+#define PARALLEL_BUILD_INDEX_COUNT (MAX_TRIANGLES * 3 * 64)
+
+/**
+* @brief A per thread bump allocator for the index arrays made while splitting the mesh.
+* Nothing is freed until the tree is built, then all the blocks are freed at once.
+*/
+struct IndexArena
+{
+  static inline constexpr const u64 BLOCK_SIZE = 1024 * 1024; // Indices per block
+
+  DArray<u32*> blocks = {};
+  u32* block          = nullptr;
+  u64 blockUsed       = 0;
+  u64 blockCapacity   = 0;
+
+  INLINE void Create()
+  {
+    blocks.Create(4);
+    block         = nullptr;
+    blockUsed     = 0;
+    blockCapacity = 0;
+  }
+
+  INLINE void Destroy()
+  {
+    for (u64 i = 0; i < blocks.Size(); ++i)
+    {
+      mem_free(blocks[i]);
+    }
+
+    blocks.Destroy();
+  }
+
+  [[nodiscard]] INLINE u32* Allocate(u64 count)
+  {
+    if (count > blockCapacity - blockUsed)
+    {
+      blockCapacity = MAX(count, BLOCK_SIZE);
+      blockUsed     = 0;
+      block         = (u32*)mem_alloc(sizeof(u32) * blockCapacity);
+      blocks.Add(block);
+    }
+
+    u32* indices = block + blockUsed;
+    blockUsed   += count;
+    return indices;
+  }
+};
+
 // Forward Declarations
 static INLINE Plane ChooseAutoPartitioningSplitPlane(const MeshGeometry& meshGeometry);
 static INLINE Plane ChooseMaxVarianceSplitPlane(const MeshGeometry& meshGeometry);
-static FArray<MeshGeometry, 2> SplitMesh(const MeshGeometry& meshGeometry, const Plane& plane);
+static FArray<MeshGeometry, 2> SplitMesh(const MeshGeometry& meshGeometry, const Plane& plane, IndexArena& arena);
 
 static INLINE void SortVerts(const Plane& plane,
                              FArray<Vertex, 4>& frontVerts, u32& frontVertsCount,
@@ -80,6 +133,167 @@ static INLINE void SortVerts(const Plane& plane,
   }
 }
 
+// NOTE(WSWhitehouse): Child links of nodes with this bit set refer to a subtree built by
+// another task (the index of the subtree in the task), otherwise they are the index of the
+// node in the task...
+static inline constexpr const u32 SUBTREE_LINK_BIT = 1U << 31;
+static inline constexpr const u32 NO_PARENT        = U32_MAX;
+
+struct BuildContext
+{
+  // NOTE(WSWhitehouse): Only depends on the vertex array, which is shared by every node...
+  Plane maxVariancePlane;
+
+  // Indexed by JobSystem::GetThreadIndex()
+  IndexArena* indexArenas;
+
+  b8 spawnJobs;
+};
+
+/**
+* @brief A subtree of the BSP tree that is built depth-first by a single thread.
+*/
+struct BuildTask
+{
+  MeshGeometry geometry;
+  u32 prevIndexCount;
+
+  // NOTE(WSWhitehouse): Written by the thread running the task. Every task owns its nodes,
+  // a thread can run another task while the merge is reading a finished one, so the nodes
+  // can't be shared between the tasks run by a thread...
+  DArray<BSPTree::Node> nodes;
+  DArray<BuildTask*> subtrees;
+
+  JobSystem::JobHandle job; // Not used by the root task, it runs on the calling thread
+};
+
+static void RunBuildTask(const BuildContext& ctx, BuildTask* task);
+
+static INLINE BuildTask* SpawnBuildTask(const BuildContext& ctx, const MeshGeometry& geometry, u32 prevIndexCount)
+{
+  // NOTE(WSWhitehouse): Zeroing the task leaves the job handle and array in their default state...
+  BuildTask* task = (BuildTask*)mem_alloc(sizeof(BuildTask));
+  mem_zero(task, sizeof(BuildTask));
+
+  task->geometry       = geometry;
+  task->prevIndexCount = prevIndexCount;
+  task->job            = JobSystem::SubmitJob([&ctx, task] { RunBuildTask(ctx, task); });
+
+  return task;
+}
+
+static void RunBuildTask(const BuildContext& ctx, BuildTask* task)
+{
+  IndexArena& indexArena       = ctx.indexArenas[JobSystem::GetThreadIndex()];
+  DArray<BSPTree::Node>& nodes = task->nodes;
+  nodes.Create(64);
+
+  struct StackEntry
+  {
+    MeshGeometry geometry;
+    u32 prevIndexCount;
+    u32 parentNode;
+    b8 isPositive;
+  };
+
+  DArray<StackEntry> stack = {};
+  stack.Create(32);
+  stack.Add({ task->geometry, task->prevIndexCount, NO_PARENT, false });
+
+  while (stack.Size() > 0)
+  {
+    const StackEntry entry = stack[stack.Size() - 1];
+    stack.Remove(stack.Size() - 1);
+
+    const u32 nodeIndex = (u32)nodes.Size();
+    if (entry.parentNode != NO_PARENT)
+    {
+      BSPTree::Node& parent = nodes[entry.parentNode];
+      if (entry.isPositive) { parent.nodePositive = nodeIndex; }
+      else                  { parent.nodeNegative = nodeIndex; }
+    }
+
+    BSPTree::Node node = {};
+    const u32 currentIndexCount = (u32)entry.geometry.indexCount;
+
+    if (currentIndexCount <= 0)
+    {
+      node.isLeaf     = true;
+      node.indexCount = 0;
+      nodes.Add(node);
+      continue;
+    }
+
+    const u32 triangleCount = currentIndexCount / 3;
+    if (currentIndexCount >= entry.prevIndexCount + 20 || triangleCount <= MAX_TRIANGLES)
+    {
+      node.isLeaf     = true;
+      node.indexCount = currentIndexCount;
+      node.indices    = entry.geometry.indexArrayU32;
+      nodes.Add(node);
+      continue;
+    }
+
+    b8 useAutoPartitioning = currentIndexCount >= entry.prevIndexCount;
+    node.plane = useAutoPartitioning ? ChooseAutoPartitioningSplitPlane(entry.geometry) : ctx.maxVariancePlane;
+
+    FArray<MeshGeometry, 2> halfGeom = SplitMesh(entry.geometry, node.plane, indexArena);
+
+    // NOTE(WSWhitehouse): A child that keeps every triangle hasn't been split at all. The max variance
+    // plane is the same for every node, so a child made of triangles straddling it would be copied into
+    // both sides every time it's used, the auto-partitioning plane is used for this node instead...
+    b8 noProgress = halfGeom[0].indexCount == currentIndexCount ||
+                    halfGeom[1].indexCount == currentIndexCount;
+
+    if (noProgress && !useAutoPartitioning)
+    {
+      useAutoPartitioning = true;
+      node.plane          = ChooseAutoPartitioningSplitPlane(entry.geometry);
+      halfGeom            = SplitMesh(entry.geometry, node.plane, indexArena);
+      noProgress          = halfGeom[0].indexCount == currentIndexCount ||
+                            halfGeom[1].indexCount == currentIndexCount;
+    }
+
+    // NOTE(WSWhitehouse): If the auto-partitioning plane puts every triangle on one side, that
+    // child would pick the same plane again and be split forever. So it becomes a leaf instead...
+    if (noProgress)
+    {
+      node.isLeaf     = true;
+      node.indexCount = currentIndexCount;
+      node.indices    = entry.geometry.indexArrayU32;
+      nodes.Add(node);
+      continue;
+    }
+
+    nodes.Add(node);
+
+    // NOTE(WSWhitehouse): The negative child is pushed first so the positive child is built
+    // next. Large children are built by another job, the link is set straight away...
+    for (i32 side = 1; side >= 0; --side)
+    {
+      const MeshGeometry& childGeometry = halfGeom[side];
+      const b8 isPositive               = side == 0;
+
+      if (ctx.spawnJobs && childGeometry.indexCount >= PARALLEL_BUILD_INDEX_COUNT)
+      {
+        if (!task->subtrees.IsValid()) { task->subtrees.Create(2); }
+
+        const u32 link = SUBTREE_LINK_BIT | (u32)task->subtrees.Size();
+        task->subtrees.Add(SpawnBuildTask(ctx, childGeometry, currentIndexCount));
+
+        BSPTree::Node& thisNode = nodes[nodeIndex];
+        if (isPositive) { thisNode.nodePositive = link; }
+        else            { thisNode.nodeNegative = link; }
+        continue;
+      }
+
+      stack.Add({ childGeometry, currentIndexCount, nodeIndex, isPositive });
+    }
+  }
+
+  stack.Destroy();
+}
+
 void BSPTree::BuildTree(const Mesh* mesh)
 {
   // NOTE(WSWhitehouse): Working with the first mesh node only for now...
@@ -154,110 +368,148 @@ void BSPTree::BuildTree(const Mesh* mesh)
 //    }
 //  }
 
-  nodes.Create(3);
-  nodes.Add({}); // create first node
+  const u64 threadCount = JobSystem::GetWorkerThreadCount() + 1;
 
-  struct QueueEntry
+  BuildContext ctx      = {};
+  ctx.maxVariancePlane  = ChooseMaxVarianceSplitPlane(meshGeometry);
+  ctx.indexArenas       = (IndexArena*)mem_alloc(sizeof(IndexArena) * threadCount);
+  ctx.spawnJobs         = threadCount > 1;
+
+  for (u64 i = 0; i < threadCount; ++i)
   {
-    MeshGeometry geometry;
-    u32 nodeIndex;
-    u32 prevIndexCount;
-    u32 depth;
+    ctx.indexArenas[i] = {};
+    ctx.indexArenas[i].Create();
+  }
+
+  BuildTask rootTask = {};
+  rootTask.geometry       = meshGeometry;
+  rootTask.prevIndexCount = (u32)meshGeometry.indexCount + 1;
+  RunBuildTask(ctx, &rootTask);
+
+  // NOTE(WSWhitehouse): Merge the tasks into the final array by walking the whole tree
+  // depth-first (positive child first). The order only depends on the shape of the tree,
+  // not on which task built each node, so the tree is the same no matter how many threads
+  // built it. Each subtree job is waited on the first time the walk reaches it...
+  struct MergeEntry
+  {
+    BuildTask* task;
+    u32 taskNode;
+    u32 parentNode;
+    b8 isPositive;
   };
 
-  std::queue<QueueEntry> queue = {};
+  DArray<MergeEntry> stack = {};
+  stack.Create(32);
+  stack.Add({ &rootTask, 0, NO_PARENT, false });
 
-  // Insert first queue entry
-  queue.push(QueueEntry{
-    .geometry        = meshGeometry,
-    .nodeIndex       = 0,
-    .prevIndexCount  = (u32)meshGeometry.indexCount + 1,
-    .depth           = 0
-  });
+  DArray<BuildTask*> spawnedTasks = {};
+  spawnedTasks.Create(8);
 
-  while(!queue.empty())
-  {
-    // Get & pop the first element from the queue
-    QueueEntry queueEntry = queue.front();
-    queue.pop();
+  nodes.Create(64);
+  u64 leafIndexCount = 0;
 
-    Node& thisNode = nodes[queueEntry.nodeIndex];
-    const u32 currentIndexCount = queueEntry.geometry.indexCount;
-//    LOG_DEBUG("index count: %u", currentIndexCount);
+  while (stack.Size() > 0)
+  {
+    const MergeEntry entry = stack[stack.Size() - 1];
+    stack.Remove(stack.Size() - 1);
 
-//    if (queueEntry.depth >= 1)
-//    {
-////      LOG_DEBUG("Hit depth limit!");
-//      thisNode.isLeaf   = true;
-//
-//      thisNode.indexCount = queueEntry.geometry.indexCount;
-//      thisNode.indices    = queueEntry.geometry.indexArrayU32;
-//      continue;
-//    }
+    // NOTE(WSWhitehouse): The task has finished, so its nodes can't move...
+    const Node& node = entry.task->nodes[entry.taskNode];
 
-    if (currentIndexCount <= 0)
+    const u32 nodeIndex = (u32)nodes.Add(node);
+    if (entry.parentNode != NO_PARENT)
     {
-//      LOG_DEBUG("Hit empty leaf!");
-      thisNode.isLeaf     = true;
-      thisNode.indexCount = 0;
-      continue;
+      if (entry.isPositive) { nodes[entry.parentNode].nodePositive = nodeIndex; }
+      else                  { nodes[entry.parentNode].nodeNegative = nodeIndex; }
     }
 
-    if (currentIndexCount >= queueEntry.prevIndexCount + 20/* && currentIndexCount <= MAX_INDICES*/)
+    if (node.isLeaf)
     {
-//      LOG_DEBUG("Hit index/vertex count larger or equal!");
-      thisNode.isLeaf = true;
-
-      thisNode.indexCount = queueEntry.geometry.indexCount;
-      thisNode.indices    = queueEntry.geometry.indexArrayU32;
+      leafIndexCount += node.indexCount;
       continue;
     }
 
-    const u32 triangleCount = queueEntry.geometry.indexCount / 3;
-    if (triangleCount <= MAX_TRIANGLES)
+    const u32 links[2] = { node.nodeNegative, node.nodePositive };
+    for (u32 side = 0; side < 2; ++side)
     {
-//      LOG_DEBUG("Hit max triangle count!");
-      thisNode.isLeaf = true;
+      const u32 link        = links[side];
+      const b8 isPositive   = side == 1;
 
-      thisNode.indexCount = queueEntry.geometry.indexCount;
-      thisNode.indices    = queueEntry.geometry.indexArrayU32;
-      continue;
-    }
+      if ((link & SUBTREE_LINK_BIT) == 0)
+      {
+        stack.Add({ entry.task, link, nodeIndex, isPositive });
+        continue;
+      }
 
-    if (currentIndexCount >= queueEntry.prevIndexCount)
-    {
-      thisNode.plane = ChooseAutoPartitioningSplitPlane(queueEntry.geometry);
-    }
-    else
-    {
-      thisNode.plane = ChooseMaxVarianceSplitPlane(queueEntry.geometry);
+      BuildTask* subtree = entry.task->subtrees[link & ~SUBTREE_LINK_BIT];
+      subtree->job.WaitUntilComplete();
+      spawnedTasks.Add(subtree);
+
+      stack.Add({ subtree, 0, nodeIndex, isPositive });
     }
+  }
 
-    const FArray<MeshGeometry, 2> halfGeom = SplitMesh(queueEntry.geometry, thisNode.plane);
-
-    // NOTE(WSWhitehouse): MUST NOT USE `thisNode` REFERENCE BEYOND THIS POINT!
-
-    nodes[queueEntry.nodeIndex].nodePositive = nodes.Add({});
-    queue.push(QueueEntry{
-      .geometry       = halfGeom[0],
-      .nodeIndex      = nodes[queueEntry.nodeIndex].nodePositive,
-      .prevIndexCount = currentIndexCount,
-      .depth          = queueEntry.depth + 1
-    });
-
-    nodes[queueEntry.nodeIndex].nodeNegative = nodes.Add({});
-    queue.push(QueueEntry{
-      .geometry       = halfGeom[1],
-      .nodeIndex      = nodes[queueEntry.nodeIndex].nodeNegative,
-      .prevIndexCount = currentIndexCount,
-      .depth          = queueEntry.depth + 1
-    });
+  // NOTE(WSWhitehouse): Copy the leaf indices out of the arenas into a single array...
+  indexArray = (u32*)mem_alloc(sizeof(u32) * MAX(leafIndexCount, 1));
+  u64 indexOffset = 0;
+
+  for (u64 i = 0; i < nodes.Size(); ++i)
+  {
+    Node& node = nodes[i];
+    if (!node.isLeaf || node.indexCount == 0) continue;
+
+    mem_copy(indexArray + indexOffset, node.indices, sizeof(u32) * node.indexCount);
+    node.indices = indexArray + indexOffset;
+    indexOffset += node.indexCount;
+  }
+
+  for (u64 i = 0; i < spawnedTasks.Size(); ++i)
+  {
+    spawnedTasks[i]->nodes.Destroy();
+    spawnedTasks[i]->subtrees.Destroy();
+    mem_free(spawnedTasks[i]);
+  }
+
+  for (u64 i = 0; i < threadCount; ++i)
+  {
+    ctx.indexArenas[i].Destroy();
   }
+
+  rootTask.nodes.Destroy();
+  rootTask.subtrees.Destroy();
+  spawnedTasks.Destroy();
+  stack.Destroy();
+  mem_free(ctx.indexArenas);
+  mem_free(meshGeometry.indexArray);
+}
+
+void BSPTree::Destroy()
+{
+  nodes.Destroy();
+  mem_free(indexArray);
+  mem_free(vertices);
+
+  indexArray  = nullptr;
+  vertices    = nullptr;
+  vertexCount = 0;
 }
 
 static INLINE Plane ChooseAutoPartitioningSplitPlane(const MeshGeometry& meshGeometry)
 {
-  const BoundingBox3D boundingBox = meshGeometry.CalculateBoundingBox();
+  // NOTE(WSWhitehouse): Calculated here rather than with MeshGeometry::CalculateBoundingBox
+  // as that submits jobs, and this is already running as part of a job...
+  BoundingBox3D boundingBox =
+    {
+      .minimum = glm::vec3(F32_MAX, F32_MAX, F32_MAX),
+      .maximum = glm::vec3(-F32_MAX, -F32_MAX, -F32_MAX)
+    };
+
+  for (u64 i = 0; i < meshGeometry.indexCount; ++i)
+  {
+    const glm::vec3& position = meshGeometry.vertexArray[meshGeometry.indexArrayU32[i]].position;
+    boundingBox.minimum = glm::min(boundingBox.minimum, position);
+    boundingBox.maximum = glm::max(boundingBox.maximum, position);
+  }
 
   const glm::vec3 diff = boundingBox.maximum - boundingBox.minimum;
 
@@ -267,10 +519,10 @@ static INLINE Plane ChooseAutoPartitioningSplitPlane(const MeshGeometry& meshGeo
   i8 largestAxis = 0;
   for (i8 i = 1; i < 3; ++i)
   {
-    // NOTE(WSWhitehouse): These axis are considered the same length, randomly select one...
+    // NOTE(WSWhitehouse): These axis are considered the same length, keep the first one so
+    // the tree is always built the same way...
     if (glm::abs(diff[i] - diff[largestAxis]) <= F32_EPSILON)
     {
-      largestAxis = Random::Bool() ? i : largestAxis;
       continue;
     }
 
@@ -373,90 +625,89 @@ static INLINE Plane ChooseMaxVarianceSplitPlane(const MeshGeometry& meshGeometry
     };
 }
 
-static FArray<MeshGeometry, 2> SplitMesh(const MeshGeometry& meshGeometry, const Plane& plane)
+enum SplitSide : u8
 {
-  std::vector<u32> frontIndices = {};
-  std::vector<u32> backIndices  = {};
+  SPLIT_SIDE_FRONT = 1 << 0,
+  SPLIT_SIDE_BACK  = 1 << 1,
+};
 
-  frontIndices.reserve(meshGeometry.indexCount);
-  backIndices.reserve(meshGeometry.indexCount);
+/** @brief Find which sides of the plane the triangle is on, triangles crossing the plane are on both. */
+static INLINE u8 ClassifyTriangle(const MeshGeometry& meshGeometry, const Plane& plane, u64 triangle)
+{
+  const u32* indices = meshGeometry.indexArrayU32 + (triangle * 3);
 
-  for (u64 i = 0; i < meshGeometry.indexCount; i+=3)
-  {
-    // Get triangle indices...
-    const u32 index0 = meshGeometry.GetUniversalIndex(i + 0);
-    const u32 index1 = meshGeometry.GetUniversalIndex(i + 1);
-    const u32 index2 = meshGeometry.GetUniversalIndex(i + 2);
+  // Get triangle positions...
+  const glm::vec3& pos0 = meshGeometry.vertexArray[indices[0]].position;
+  const glm::vec3& pos1 = meshGeometry.vertexArray[indices[1]].position;
+  const glm::vec3& pos2 = meshGeometry.vertexArray[indices[2]].position;
 
-    // Get triangle positions...
-    const glm::vec3& pos0 = meshGeometry.vertexArray[index0].position;
-    const glm::vec3& pos1 = meshGeometry.vertexArray[index1].position;
-    const glm::vec3& pos2 = meshGeometry.vertexArray[index2].position;
-
-    // Compute the distance to the plane...
-    const f32 dist0 = plane.SignedDistanceFromPoint(pos0);
-    const f32 dist1 = plane.SignedDistanceFromPoint(pos1);
-    const f32 dist2 = plane.SignedDistanceFromPoint(pos2);
-
-    // Compute the distance sign...
-    const b8 isFront0 = dist0 > F32_EPSILON;
-    const b8 isFront1 = dist1 > F32_EPSILON;
-    const b8 isFront2 = dist2 > F32_EPSILON;
-
-    // Check that all verts are in front of the plane...
-    if (isFront0 && isFront1 && isFront2)
-    {
-      frontIndices.push_back(index0);
-      frontIndices.push_back(index1);
-      frontIndices.push_back(index2);
-      continue;
-    }
+  // Compute the distance sign...
+  const b8 isFront0 = plane.SignedDistanceFromPoint(pos0) > F32_EPSILON;
+  const b8 isFront1 = plane.SignedDistanceFromPoint(pos1) > F32_EPSILON;
+  const b8 isFront2 = plane.SignedDistanceFromPoint(pos2) > F32_EPSILON;
 
-    // Check that all verts are behind the plane...
-    if (!isFront0 && !isFront1 && !isFront2)
-    {
-      backIndices.push_back(index0);
-      backIndices.push_back(index1);
-      backIndices.push_back(index2);
-      continue;
-    }
+  u8 side = 0;
+  if (isFront0 || isFront1 || isFront2)    { side |= SPLIT_SIDE_FRONT; }
+  if (!isFront0 || !isFront1 || !isFront2) { side |= SPLIT_SIDE_BACK;  }
+
+  return side;
+}
+
+static FArray<MeshGeometry, 2> SplitMesh(const MeshGeometry& meshGeometry, const Plane& plane, IndexArena& arena)
+{
+  // NOTE(WSWhitehouse): The triangles are classified twice, once to count the size of each
+  // side so the index arrays can be allocated from the arena at their exact size, then
+  // again to fill them. This is cheaper than allocating temporary arrays for every node...
+  const u64 triangleCount = meshGeometry.indexCount / 3;
 
-    frontIndices.push_back(index0);
-    frontIndices.push_back(index1);
-    frontIndices.push_back(index2);
+  u64 frontIndexCount = 0;
+  u64 backIndexCount  = 0;
 
-    backIndices.push_back(index0);
-    backIndices.push_back(index1);
-    backIndices.push_back(index2);
+  for (u64 tri = 0; tri < triangleCount; ++tri)
+  {
+    const u8 side = ClassifyTriangle(meshGeometry, plane, tri);
+    if (side & SPLIT_SIDE_FRONT) { frontIndexCount += 3; }
+    if (side & SPLIT_SIDE_BACK)  { backIndexCount  += 3; }
   }
 
   FArray<MeshGeometry, 2> outMeshes = {};
   mem_zero(&outMeshes, sizeof(FArray<MeshGeometry, 2>));
 
   // Front Mesh
-  {
-    MeshGeometry& frontGeometry = outMeshes[0];
+  MeshGeometry& frontGeometry = outMeshes[0];
+  frontGeometry.vertexCount   = meshGeometry.vertexCount;
+  frontGeometry.vertexArray   = meshGeometry.vertexArray;
+  frontGeometry.indexType     = IndexType::U32_TYPE;
+  frontGeometry.indexCount    = frontIndexCount;
+  frontGeometry.indexArray    = frontIndexCount > 0 ? arena.Allocate(frontIndexCount) : nullptr;
 
-    frontGeometry.vertexCount = meshGeometry.vertexCount;
-    frontGeometry.vertexArray = meshGeometry.vertexArray;
+  // Back Mesh
+  MeshGeometry& backGeometry = outMeshes[1];
+  backGeometry.vertexCount   = meshGeometry.vertexCount;
+  backGeometry.vertexArray   = meshGeometry.vertexArray;
+  backGeometry.indexType     = IndexType::U32_TYPE;
+  backGeometry.indexCount    = backIndexCount;
+  backGeometry.indexArray    = backIndexCount > 0 ? arena.Allocate(backIndexCount) : nullptr;
 
-    frontGeometry.indexType  = IndexType::U32_TYPE;
-    frontGeometry.indexCount = frontIndices.size();
-    frontGeometry.indexArray = mem_alloc(sizeof(u32) * frontGeometry.indexCount);
-    mem_copy(frontGeometry.indexArray, frontIndices.data(), sizeof(u32) * frontGeometry.indexCount);
-  }
+  u64 frontIndex = 0;
+  u64 backIndex  = 0;
 
-  // Back Mesh
+  for (u64 tri = 0; tri < triangleCount; ++tri)
   {
-    MeshGeometry& backGeometry = outMeshes[1];
+    const u8 side              = ClassifyTriangle(meshGeometry, plane, tri);
+    const u32* triangleIndices = meshGeometry.indexArrayU32 + (tri * 3);
 
-    backGeometry.vertexCount = meshGeometry.vertexCount;
-    backGeometry.vertexArray = meshGeometry.vertexArray;
+    if (side & SPLIT_SIDE_FRONT)
+    {
+      mem_copy(frontGeometry.indexArrayU32 + frontIndex, triangleIndices, sizeof(u32) * 3);
+      frontIndex += 3;
+    }
 
-    backGeometry.indexType  = IndexType::U32_TYPE;
-    backGeometry.indexCount = backIndices.size();
-    backGeometry.indexArray = mem_alloc(sizeof(u32) * backGeometry.indexCount);
-    mem_copy(backGeometry.indexArray, backIndices.data(), sizeof(u32) * backGeometry.indexCount);
+    if (side & SPLIT_SIDE_BACK)
+    {
+      mem_copy(backGeometry.indexArrayU32 + backIndex, triangleIndices, sizeof(u32) * 3);
+      backIndex += 3;
+    }
   }
 
   return outMeshes;
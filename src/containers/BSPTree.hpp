@@ -18,10 +18,16 @@ struct Vertex;
 
 #define MAX_TRIANGLES 50U
 
+/**
+* @brief A BSP tree over the triangles of the first node of a mesh. The tree is built
+* depth-first, large subtrees are built in parallel on the JobSystem and merged at the
+* end, the result is the same no matter how many threads are used.
+*/
 class BSPTree
 {
 public:
   void BuildTree(const Mesh* mesh);
+  void Destroy();
 
   struct Node
   {
@@ -39,6 +45,9 @@ public:
 
   DArray<Node> nodes = {};
 
+  // NOTE(WSWhitehouse): The indices of every leaf, the leaf nodes point into this array...
+  u32* indexArray = nullptr;
+
   Vertex* vertices = nullptr;
   u64 vertexCount  = 0;
 };
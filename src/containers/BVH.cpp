@@ -0,0 +1,696 @@
+#include "containers/BVH.hpp"
+
+// core
+#include "core/Logging.hpp"
+
+// containers
+#include "containers/DArray.hpp"
+
+// geometry
+#include "geometry/Mesh.hpp"
+#include "geometry/MeshGeometry.hpp"
+#include "geometry/Vertex.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+// NOTE(WSWhitehouse): The SAH cost of visiting a node, relative to the cost of
+// intersecting a single triangle...
+static inline constexpr const f32 TRAVERSAL_COST = 1.0f;
+
+// NOTE(WSWhitehouse): Meshes with fewer triangles than this are built on the calling
+// thread, otherwise the top of the tree is split until the remaining subtrees are small
+// enough to be spread across the worker threads...
+static inline constexpr const u32 PARALLEL_BUILD_THRESHOLD = 4096;
+static inline constexpr const u32 MIN_SUBTREE_SIZE         = 1024;
+static inline constexpr const u32 SUBTREES_PER_THREAD      = 4;
+
+// NOTE(WSWhitehouse): Marks a node built by the top of the tree as the root of a
+// subtree that is built separately, the offset is the index of the subtree...
+static inline constexpr const u32 SUBTREE_NODE = U32_MAX;
+
+static inline constexpr const u32 NO_PARENT = U32_MAX;
+
+// NOTE(WSWhitehouse): Queries use a stack on the stack when the tree is shallow enough...
+static inline constexpr const u32 LOCAL_STACK_SIZE = 64;
+
+// NOTE(WSWhitehouse): The primitives are partitioned in place as the tree is built, so every
+// range is read sequentially rather than through an index array...
+struct BuildPrimitive
+{
+  BoundingBox3D bounds;
+  glm::vec3 centroid;
+  u32 triangleIndex;
+};
+
+struct BuildRange
+{
+  u32 first;
+  u32 count;
+  u32 parent; // Node whose right child is this range, NO_PARENT for left children
+  u32 depth;
+};
+
+struct Bin
+{
+  BoundingBox3D bounds;
+  u32 count;
+};
+
+static INLINE BoundingBox3D EmptyBounds()
+{
+  return { glm::vec3(F32_MAX, F32_MAX, F32_MAX), glm::vec3(-F32_MAX, -F32_MAX, -F32_MAX) };
+}
+
+static INLINE void GrowBounds(BoundingBox3D& bounds, const BoundingBox3D& other)
+{
+  bounds.minimum = glm::min(bounds.minimum, other.minimum);
+  bounds.maximum = glm::max(bounds.maximum, other.maximum);
+}
+
+static INLINE u32 CalculateBin(f32 centroid, f32 minimum, f32 scale)
+{
+  return MIN((u32)((centroid - minimum) * scale), BVH::BIN_COUNT - 1);
+}
+
+/**
+* @brief Choose how to split the range of triangles using the binned SAH, then partition
+* the triangle indices so the left child is first.
+* @return Number of triangles in the left child; 0 if the range should be a leaf.
+*/
+static u32 PartitionRange(BuildPrimitive* primitives, u32 first, u32 count,
+                          const BoundingBox3D& bounds, const BoundingBox3D& centroidBounds)
+{
+  const u32 last = first + count;
+
+  // NOTE(WSWhitehouse): Every axis is binned in a single pass over the primitives. An axis
+  // with no centroid extent has a scale of 0, so everything lands in the first bin and it
+  // never produces a valid split...
+  const glm::vec3 extent = centroidBounds.maximum - centroidBounds.minimum;
+  const glm::vec3 scale  = glm::vec3(extent.x > 0.0f ? (f32)BVH::BIN_COUNT / extent.x : 0.0f,
+                                     extent.y > 0.0f ? (f32)BVH::BIN_COUNT / extent.y : 0.0f,
+                                     extent.z > 0.0f ? (f32)BVH::BIN_COUNT / extent.z : 0.0f);
+
+  Bin bins[3][BVH::BIN_COUNT];
+  for (u32 axis = 0; axis < 3; ++axis)
+  {
+    for (Bin& bin : bins[axis]) { bin = { EmptyBounds(), 0 }; }
+  }
+
+  for (u32 i = first; i < last; ++i)
+  {
+    const BuildPrimitive& primitive = primitives[i];
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+      Bin& bin = bins[axis][CalculateBin(primitive.centroid[axis], centroidBounds.minimum[axis], scale[axis])];
+
+      GrowBounds(bin.bounds, primitive.bounds);
+      bin.count++;
+    }
+  }
+
+  f32 bestCost = F32_MAX;
+  u32 bestAxis = 0;
+  u32 bestBin  = 0;
+
+  for (u32 axis = 0; axis < 3; ++axis)
+  {
+    if (scale[axis] == 0.0f) continue;
+
+    // NOTE(WSWhitehouse): Sweep from the left to get the area and count on the left of each
+    // split, then sweep back from the right to evaluate the cost of each split...
+    f32 leftArea[BVH::BIN_COUNT - 1];
+    u32 leftCount[BVH::BIN_COUNT - 1];
+
+    BoundingBox3D sweepBounds = EmptyBounds();
+    u32 sweepCount = 0;
+    for (u32 i = 0; i < BVH::BIN_COUNT - 1; ++i)
+    {
+      GrowBounds(sweepBounds, bins[axis][i].bounds);
+      sweepCount  += bins[axis][i].count;
+      leftArea[i]  = sweepCount > 0 ? sweepBounds.GetSurfaceArea() : 0.0f;
+      leftCount[i] = sweepCount;
+    }
+
+    sweepBounds = EmptyBounds();
+    sweepCount  = 0;
+    for (u32 i = BVH::BIN_COUNT - 1; i > 0; --i)
+    {
+      GrowBounds(sweepBounds, bins[axis][i].bounds);
+      sweepCount += bins[axis][i].count;
+
+      if (sweepCount == 0 || leftCount[i - 1] == 0) continue;
+
+      const f32 cost = (leftArea[i - 1] * (f32)leftCount[i - 1]) + (sweepBounds.GetSurfaceArea() * (f32)sweepCount);
+      if (cost < bestCost)
+      {
+        bestCost = cost;
+        bestAxis = axis;
+        bestBin  = i - 1;
+      }
+    }
+  }
+
+  // NOTE(WSWhitehouse): Every centroid is in the same place, so there isn't a split that
+  // separates them. Large ranges are split in half so the leaves stay small...
+  if (bestCost == F32_MAX)
+  {
+    return count > BVH::MAX_LEAF_SIZE ? count / 2 : 0;
+  }
+
+  if (count <= BVH::MAX_LEAF_SIZE)
+  {
+    const f32 parentArea = bounds.GetSurfaceArea();
+    const f32 splitCost  = TRAVERSAL_COST + (parentArea > 0.0f ? bestCost / parentArea : 0.0f);
+    if ((f32)count <= splitCost) return 0;
+  }
+
+  u32 left  = first;
+  u32 right = last;
+  while (left < right)
+  {
+    if (CalculateBin(primitives[left].centroid[bestAxis], centroidBounds.minimum[bestAxis], scale[bestAxis]) <= bestBin)
+    {
+      left++;
+    }
+    else
+    {
+      right--;
+      const BuildPrimitive temp = primitives[left];
+      primitives[left]          = primitives[right];
+      primitives[right]         = temp;
+    }
+  }
+
+  return left - first;
+}
+
+/**
+* @brief Build the nodes of a range of triangles in depth-first order. When a subtree size is
+* given, ranges with at most that many triangles aren't built. Instead a SUBTREE_NODE is added
+* in their place and the range is added to the subtree array, so they can be built separately.
+* @return The depth of the nodes that were built.
+*/
+static u32 BuildNodes(BuildPrimitive* primitives, u32 first, u32 count, u32 subtreeSize,
+                      DArray<BVH::Node>& out_nodes, DArray<BuildRange>* out_subtrees)
+{
+  DArray<BuildRange> stack = {};
+  stack.Create(64);
+  stack.Add({ first, count, NO_PARENT, 1 });
+
+  u32 maxDepth = 0;
+
+  while (stack.Size() > 0)
+  {
+    const BuildRange range = stack[stack.Size() - 1];
+    stack.Remove(stack.Size() - 1);
+
+    const u32 nodeIndex = (u32)out_nodes.Size();
+    if (range.parent != NO_PARENT) { out_nodes[range.parent].offset = nodeIndex; }
+
+    if (range.count <= subtreeSize)
+    {
+      out_nodes.Add({ {}, (u32)out_subtrees->Size(), {}, SUBTREE_NODE });
+      out_subtrees->Add(range);
+      continue;
+    }
+
+    BoundingBox3D bounds         = EmptyBounds();
+    BoundingBox3D centroidBounds = EmptyBounds();
+    for (u32 i = range.first; i < range.first + range.count; ++i)
+    {
+      GrowBounds(bounds, primitives[i].bounds);
+      centroidBounds.minimum = glm::min(centroidBounds.minimum, primitives[i].centroid);
+      centroidBounds.maximum = glm::max(centroidBounds.maximum, primitives[i].centroid);
+    }
+
+    maxDepth = MAX(maxDepth, range.depth);
+
+    const u32 leftCount = PartitionRange(primitives, range.first, range.count, bounds, centroidBounds);
+    if (leftCount == 0)
+    {
+      out_nodes.Add({ bounds.minimum, range.first, bounds.maximum, range.count });
+      continue;
+    }
+
+    out_nodes.Add({ bounds.minimum, 0, bounds.maximum, 0 });
+
+    // NOTE(WSWhitehouse): The left child is pushed last so it's built next, placing it
+    // directly after its parent. The right child sets its parent's offset when built...
+    stack.Add({ range.first + leftCount, range.count - leftCount, nodeIndex, range.depth + 1 });
+    stack.Add({ range.first, leftCount, NO_PARENT, range.depth + 1 });
+  }
+
+  stack.Destroy();
+  return maxDepth;
+}
+
+void BVH::Create(const Mesh* mesh)
+{
+  triangleCount = 0;
+  for (u32 i = 0; i < mesh->nodeCount; ++i)
+  {
+    const MeshNode& node = mesh->nodeArray[i];
+    if (node.geometryIndex < 0) continue;
+
+    triangleCount += (u32)(mesh->geometryArray[node.geometryIndex].indexCount / 3);
+  }
+
+  triangles = (Triangle*)mem_alloc(sizeof(Triangle) * MAX(triangleCount, 1));
+
+  u32 triangleIndex = 0;
+  for (u32 i = 0; i < mesh->nodeCount; ++i)
+  {
+    const MeshNode& node = mesh->nodeArray[i];
+    if (node.geometryIndex < 0) continue;
+
+    const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
+    const u64 indexCount = (geometry.indexCount / 3) * 3;
+
+    for (u64 index = 0; index < indexCount; index += 3)
+    {
+      Triangle& triangle = triangles[triangleIndex++];
+      for (u32 vert = 0; vert < 3; ++vert)
+      {
+        const glm::vec3& position = geometry.vertexArray[geometry.GetUniversalIndex(index + vert)].position;
+        triangle.vertices[vert]   = glm::vec3(node.transformMatrix * glm::vec4(position, 1.0f));
+      }
+    }
+  }
+
+  Build();
+}
+
+void BVH::Create(const MeshGeometry& geometry, const glm::mat4& transform)
+{
+  triangleCount = (u32)(geometry.indexCount / 3);
+  triangles     = (Triangle*)mem_alloc(sizeof(Triangle) * MAX(triangleCount, 1));
+
+  for (u32 i = 0; i < triangleCount; ++i)
+  {
+    for (u32 vert = 0; vert < 3; ++vert)
+    {
+      const glm::vec3& position    = geometry.vertexArray[geometry.GetUniversalIndex(((u64)i * 3) + vert)].position;
+      triangles[i].vertices[vert]  = glm::vec3(transform * glm::vec4(position, 1.0f));
+    }
+  }
+
+  Build();
+}
+
+void BVH::Destroy()
+{
+  mem_free(nodes);
+  mem_free(triangles);
+  mem_free(triangleIndices);
+  mem_free(trianglePacketBlock);
+
+  nodes               = nullptr;
+  nodeCount           = 0;
+  triangles           = nullptr;
+  triangleIndices     = nullptr;
+  triangleCount       = 0;
+  trianglePackets     = nullptr;
+  trianglePacketCount = 0;
+  trianglePacketBlock = nullptr;
+  depth               = 0;
+}
+
+void BVH::Build()
+{
+  triangleIndices = (u32*)mem_alloc(sizeof(u32) * MAX(triangleCount, 1));
+
+  if (triangleCount == 0)
+  {
+    LOG_WARN("BVH: Building a BVH with no triangles!");
+    nodes     = nullptr;
+    nodeCount = 0;
+    depth     = 0;
+    return;
+  }
+
+  BuildPrimitive* primitives = (BuildPrimitive*)mem_alloc(sizeof(BuildPrimitive) * triangleCount);
+
+  for (u32 i = 0; i < triangleCount; ++i)
+  {
+    const Triangle& triangle = triangles[i];
+
+    BuildPrimitive& primitive = primitives[i];
+    primitive.bounds.minimum  = glm::min(glm::min(triangle.vertices[0], triangle.vertices[1]), triangle.vertices[2]);
+    primitive.bounds.maximum  = glm::max(glm::max(triangle.vertices[0], triangle.vertices[1]), triangle.vertices[2]);
+    primitive.centroid        = primitive.bounds.GetCenter();
+    primitive.triangleIndex   = i;
+  }
+
+  // NOTE(WSWhitehouse): The subtree size depends on the number of threads, but the splits
+  // don't. Every range is split the same way whether it's built as part of the top of the
+  // tree or as a subtree, so the tree is identical no matter how many threads built it...
+  const u64 workerCount = JobSystem::GetWorkerThreadCount();
+
+  u32 subtreeSize = triangleCount;
+  if (workerCount > 0 && triangleCount >= PARALLEL_BUILD_THRESHOLD)
+  {
+    subtreeSize = MAX((u32)(triangleCount / ((workerCount + 1) * SUBTREES_PER_THREAD)), MIN_SUBTREE_SIZE);
+  }
+
+  DArray<Node> topNodes = {};
+  topNodes.Create(64);
+
+  DArray<BuildRange> subtrees = {};
+  subtrees.Create(64);
+
+  const u32 topDepth = BuildNodes(primitives, 0, triangleCount, subtreeSize, topNodes, &subtrees);
+
+  // Build subtrees
+  const u32 subtreeCount = (u32)subtrees.Size();
+  DArray<Node>* subtreeNodes = (DArray<Node>*)mem_alloc(sizeof(DArray<Node>) * subtreeCount);
+  u32* subtreeDepths         = (u32*)mem_alloc(sizeof(u32) * subtreeCount);
+
+  const auto buildSubtree = [primitives, &subtrees, subtreeNodes, subtreeDepths](u32 subtree)
+  {
+    const BuildRange& range = subtrees[subtree];
+
+    subtreeNodes[subtree] = {};
+    subtreeNodes[subtree].Create(range.count * 2);
+    subtreeDepths[subtree] = range.depth - 1 + BuildNodes(primitives, range.first, range.count, 0, subtreeNodes[subtree], nullptr);
+  };
+
+  // NOTE(WSWhitehouse): Subtrees own disjoint ranges of the primitives, so they
+  // can be built at the same time without any synchronisation...
+  JobSystem::ParallelFor(subtreeCount, buildSubtree);
+
+  // NOTE(WSWhitehouse): Stitch the subtrees into the top of the tree. Every node is given
+  // its final index first, then the nodes are copied with their right child indices moved
+  // to match...
+  u32* nodeRemap = (u32*)mem_alloc(sizeof(u32) * topNodes.Size());
+
+  nodeCount = 0;
+  depth     = topDepth;
+  for (u32 i = 0; i < topNodes.Size(); ++i)
+  {
+    nodeRemap[i] = nodeCount;
+
+    if (topNodes[i].triangleCount == SUBTREE_NODE)
+    {
+      nodeCount += (u32)subtreeNodes[topNodes[i].offset].Size();
+      depth      = MAX(depth, subtreeDepths[topNodes[i].offset]);
+    }
+    else
+    {
+      nodeCount++;
+    }
+  }
+
+  nodes = (Node*)mem_alloc(sizeof(Node) * nodeCount);
+
+  for (u32 i = 0; i < topNodes.Size(); ++i)
+  {
+    const Node& topNode = topNodes[i];
+    const u32 nodeIndex = nodeRemap[i];
+
+    if (topNode.triangleCount != SUBTREE_NODE)
+    {
+      nodes[nodeIndex] = topNode;
+      if (!topNode.IsLeaf()) { nodes[nodeIndex].offset = nodeRemap[topNode.offset]; }
+      continue;
+    }
+
+    DArray<Node>& subtree = subtreeNodes[topNode.offset];
+    for (u32 node = 0; node < subtree.Size(); ++node)
+    {
+      nodes[nodeIndex + node] = subtree[node];
+      if (!subtree[node].IsLeaf()) { nodes[nodeIndex + node].offset += nodeIndex; }
+    }
+
+    subtree.Destroy();
+  }
+
+  // Reorder the triangles to match the tree
+  Triangle* sortedTriangles = (Triangle*)mem_alloc(sizeof(Triangle) * triangleCount);
+  for (u32 i = 0; i < triangleCount; ++i)
+  {
+    triangleIndices[i] = primitives[i].triangleIndex;
+    sortedTriangles[i] = triangles[triangleIndices[i]];
+  }
+
+  mem_free(triangles);
+  triangles = sortedTriangles;
+
+  // NOTE(WSWhitehouse): The packets must be aligned for the SIMD registers, mem_alloc only
+  // guarantees the alignment of the largest scalar type so the block is over allocated...
+  trianglePacketCount = (triangleCount + TriangleX8::LANE_COUNT - 1) / TriangleX8::LANE_COUNT;
+  trianglePacketBlock = mem_alloc((sizeof(TriangleX8) * trianglePacketCount) + alignof(TriangleX8));
+  trianglePackets     = (TriangleX8*)(((u64)trianglePacketBlock + alignof(TriangleX8) - 1) & ~(alignof(TriangleX8) - 1));
+
+  for (u32 i = 0; i < trianglePacketCount; ++i)
+  {
+    const u32 first = i * TriangleX8::LANE_COUNT;
+    trianglePackets[i].Set(triangles + first, MIN(triangleCount - first, TriangleX8::LANE_COUNT));
+  }
+
+  mem_free(nodeRemap);
+  mem_free(subtreeDepths);
+  mem_free(subtreeNodes);
+  subtrees.Destroy();
+  topNodes.Destroy();
+  mem_free(primitives);
+}
+
+/**
+* @brief Slab test, a zero direction component gives an infinite inverse so the
+* ray is only inside that slab if the origin is.
+* @return Distance to the box along the ray; F32_MAX if it misses.
+*/
+static INLINE f32 RayIntersectNode(const BVH::Node& node, const glm::vec3& origin,
+                                   const glm::vec3& invDirection, f32 maxDistance)
+{
+  // https://tavianator.com/2011/ray_box.html
+  const glm::vec3 t1 = (node.minimum - origin) * invDirection;
+  const glm::vec3 t2 = (node.maximum - origin) * invDirection;
+
+  const glm::vec3 tMin = glm::min(t1, t2);
+  const glm::vec3 tMax = glm::max(t1, t2);
+
+  const f32 tNear = MAX(MAX(tMin.x, tMin.y), MAX(tMin.z, 0.0f));
+  const f32 tFar  = MIN(MIN(tMax.x, tMax.y), MIN(tMax.z, maxDistance));
+
+  return tNear <= tFar ? tNear : F32_MAX;
+}
+
+/**
+* @brief Moller-Trumbore ray triangle intersection.
+* @return True when the ray hits the triangle closer than the current hit distance.
+*/
+static INLINE b8 RayIntersectTriangle(const Triangle& triangle, const glm::vec3& origin,
+                                      const glm::vec3& direction, BVH::RayHit& hit)
+{
+  // https://www.scratchapixel.com/lessons/3d-basic-rendering/ray-tracing-rendering-a-triangle/moller-trumbore-ray-triangle-intersection.html
+  const glm::vec3 edge1 = triangle.vertices[1] - triangle.vertices[0];
+  const glm::vec3 edge2 = triangle.vertices[2] - triangle.vertices[0];
+
+  const glm::vec3 p   = glm::cross(direction, edge2);
+  const f32 determinant = glm::dot(edge1, p);
+  if (glm::abs(determinant) < 1e-12f) return false;
+
+  const f32 invDeterminant = 1.0f / determinant;
+
+  const glm::vec3 s = origin - triangle.vertices[0];
+  const f32 u = glm::dot(s, p) * invDeterminant;
+  if (u < 0.0f || u > 1.0f) return false;
+
+  const glm::vec3 q = glm::cross(s, edge1);
+  const f32 v = glm::dot(direction, q) * invDeterminant;
+  if (v < 0.0f || u + v > 1.0f) return false;
+
+  const f32 t = glm::dot(edge2, q) * invDeterminant;
+  if (t < 0.0f || t >= hit.distance) return false;
+
+  hit.distance = t;
+  hit.u        = u;
+  hit.v        = v;
+  return true;
+}
+
+b8 BVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, f32 maxDistance, RayHit* out_hit) const
+{
+  if (nodeCount == 0) return false;
+
+  const glm::vec3 invDirection = 1.0f / direction;
+  if (RayIntersectNode(nodes[0], origin, invDirection, maxDistance) == F32_MAX) return false;
+
+  u32 localStack[LOCAL_STACK_SIZE];
+  u32* stack    = depth <= LOCAL_STACK_SIZE ? localStack : (u32*)mem_alloc(sizeof(u32) * depth);
+  u32 stackSize = 0;
+
+  RayHit hit = { maxDistance, U32_MAX, 0.0f, 0.0f };
+  u32 nodeIndex = 0;
+
+  while (true)
+  {
+    const Node& node = nodes[nodeIndex];
+
+    if (node.IsLeaf())
+    {
+      for (u32 i = node.offset; i < node.offset + node.triangleCount; ++i)
+      {
+        if (RayIntersectTriangle(triangles[i], origin, direction, hit)) { hit.triangle = i; }
+      }
+    }
+    else
+    {
+      // NOTE(WSWhitehouse): Visit the closest child first, the other child is only visited
+      // if it's still closer than the closest hit once it's popped...
+      u32 nearChild = nodeIndex + 1;
+      u32 farChild  = node.offset;
+      f32 nearDist  = RayIntersectNode(nodes[nearChild], origin, invDirection, hit.distance);
+      f32 farDist   = RayIntersectNode(nodes[farChild],  origin, invDirection, hit.distance);
+
+      if (farDist < nearDist)
+      {
+        const u32 tempChild = nearChild; nearChild = farChild; farChild = tempChild;
+        const f32 tempDist  = nearDist;  nearDist  = farDist;  farDist  = tempDist;
+      }
+
+      if (nearDist != F32_MAX)
+      {
+        if (farDist != F32_MAX) { stack[stackSize++] = farChild; }
+
+        nodeIndex = nearChild;
+        continue;
+      }
+    }
+
+    // Pop the next node that could still contain a closer hit
+    nodeIndex = U32_MAX;
+    while (stackSize > 0)
+    {
+      const u32 next = stack[--stackSize];
+      if (RayIntersectNode(nodes[next], origin, invDirection, hit.distance) != F32_MAX)
+      {
+        nodeIndex = next;
+        break;
+      }
+    }
+
+    if (nodeIndex == U32_MAX) break;
+  }
+
+  if (stack != localStack) mem_free(stack);
+
+  if (hit.triangle == U32_MAX) return false;
+
+  *out_hit = hit;
+  return true;
+}
+
+static INLINE f32 DistanceSqToNode(const BVH::Node& node, const glm::vec3& point)
+{
+  const glm::vec3 delta = glm::max(glm::max(node.minimum - point, point - node.maximum), glm::vec3(0.0f));
+  return glm::dot(delta, delta);
+}
+
+f32 BVH::ClosestTriangle(const glm::vec3& point, f32 maxDistance, u32* out_triangle) const
+{
+  if (nodeCount == 0) return maxDistance;
+
+  f32 bestDistSq  = maxDistance * maxDistance;
+  u32 bestTriangle = U32_MAX;
+
+  if (DistanceSqToNode(nodes[0], point) >= bestDistSq) return maxDistance;
+
+  struct StackEntry
+  {
+    u32 nodeIndex;
+    f32 distSq;
+  };
+
+  StackEntry localStack[LOCAL_STACK_SIZE];
+  StackEntry* stack = depth <= LOCAL_STACK_SIZE ? localStack : (StackEntry*)mem_alloc(sizeof(StackEntry) * depth);
+  u32 stackSize     = 0;
+
+  const Math::F32x8 pointX = Math::F32x8Set(point.x);
+  const Math::F32x8 pointY = Math::F32x8Set(point.y);
+  const Math::F32x8 pointZ = Math::F32x8Set(point.z);
+  u32 lastTestedPacket     = U32_MAX;
+
+  u32 nodeIndex = 0;
+
+  while (true)
+  {
+    const Node& node = nodes[nodeIndex];
+
+    if (node.IsLeaf())
+    {
+      // NOTE(WSWhitehouse): Every triangle in the packets is tested, including the ones
+      // that belong to neighbouring leaves. They are still triangles of the mesh so can
+      // only lower the distance. Neighbouring leaves often share a packet, so the last
+      // packet isn't tested twice in a row...
+      const u32 firstPacket = node.offset / TriangleX8::LANE_COUNT;
+      const u32 lastPacket  = (node.offset + node.triangleCount - 1) / TriangleX8::LANE_COUNT;
+
+      for (u32 packet = firstPacket; packet <= lastPacket; ++packet)
+      {
+        if (packet == lastTestedPacket) continue;
+        lastTestedPacket = packet;
+
+        const Math::F32x8 packetDistSq = trianglePackets[packet].DistanceSq(pointX, pointY, pointZ);
+        if (Math::F32x8LessThanMask(packetDistSq, Math::F32x8Set(bestDistSq)) == 0) continue;
+
+        f32 distSq[TriangleX8::LANE_COUNT];
+        Math::F32x8Store(distSq, packetDistSq);
+
+        for (u32 lane = 0; lane < TriangleX8::LANE_COUNT; ++lane)
+        {
+          if (distSq[lane] < bestDistSq)
+          {
+            bestDistSq   = distSq[lane];
+            bestTriangle = (packet * TriangleX8::LANE_COUNT) + lane;
+          }
+        }
+      }
+    }
+    else
+    {
+      u32 nearChild = nodeIndex + 1;
+      u32 farChild  = node.offset;
+      f32 nearDist  = DistanceSqToNode(nodes[nearChild], point);
+      f32 farDist   = DistanceSqToNode(nodes[farChild],  point);
+
+      if (farDist < nearDist)
+      {
+        const u32 tempChild = nearChild; nearChild = farChild; farChild = tempChild;
+        const f32 tempDist  = nearDist;  nearDist  = farDist;  farDist  = tempDist;
+      }
+
+      if (nearDist < bestDistSq)
+      {
+        if (farDist < bestDistSq) { stack[stackSize++] = { farChild, farDist }; }
+
+        nodeIndex = nearChild;
+        continue;
+      }
+    }
+
+    // NOTE(WSWhitehouse): The distance is stored with each entry so nodes that are further
+    // than a triangle found since they were pushed are skipped without being loaded...
+    nodeIndex = U32_MAX;
+    while (stackSize > 0)
+    {
+      const StackEntry entry = stack[--stackSize];
+      if (entry.distSq < bestDistSq)
+      {
+        nodeIndex = entry.nodeIndex;
+        break;
+      }
+    }
+
+    if (nodeIndex == U32_MAX) break;
+  }
+
+  if (stack != localStack) mem_free(stack);
+
+  if (bestTriangle == U32_MAX) return maxDistance;
+
+  if (out_triangle != nullptr) *out_triangle = bestTriangle;
+  return glm::sqrt(bestDistSq);
+}
@@ -0,0 +1,129 @@
+#ifndef SNOWFLAKE_BVH_HPP
+#define SNOWFLAKE_BVH_HPP
+
+#include "pch.hpp"
+
+// core
+#include "core/Assert.hpp"
+
+// geometry
+#include "geometry/BoundingBox3D.hpp"
+#include "geometry/Triangle.hpp"
+#include "geometry/TriangleX8.hpp"
+
+// Forward Declarations
+struct Mesh;
+struct MeshGeometry;
+
+/**
+* @brief A static bounding volume hierarchy over the triangles of a mesh, used as the
+* acceleration structure for ray and distance queries (i.e. SDF baking and rendering).
+*
+* The tree is built top-down using a binned surface area heuristic (SAH), triangles are
+* never split or duplicated. Large subtrees are built in parallel on the JobSystem, the
+* result doesn't depend on the number of threads. Nodes are stored in a flat depth-first
+* array: the left child of an interior node is always the next node, so only the right
+* child index is stored. Each leaf references a contiguous range of the triangle array,
+* which is reordered to match the tree.
+*
+* Like the DArray it isn't set up during its ctor, call the Create/Destroy functions.
+*
+* USEFUL LINKS & RESOURCES:
+*  - Wald, I. (2007). On fast Construction of SAH-based Bounding Volume Hierarchies.
+*  - https://jacco.ompf2.com/2022/04/18/how-to-build-a-bvh-part-2-faster-rays/
+*  - https://pbr-book.org/3ed-2018/Primitives_and_Intersection_Acceleration/Bounding_Volume_Hierarchies
+*/
+struct BVH
+{
+  /** @brief The number of bins the centroids are sorted into when evaluating the SAH. */
+  static inline constexpr const u32 BIN_COUNT = 16;
+
+  /** @brief Nodes with more triangles than this are always split. */
+  static inline constexpr const u32 MAX_LEAF_SIZE = 8;
+
+  /**
+  * @brief A 32 byte node, the layout matches the `BVHNode` std430 struct used by
+  * the shaders so the node array can be uploaded directly.
+  */
+  struct Node
+  {
+    glm::vec3 minimum;
+    u32 offset;        // Right child for interior nodes, first triangle for leaves
+    glm::vec3 maximum;
+    u32 triangleCount; // 0 for interior nodes
+
+    [[nodiscard]] INLINE b8 IsLeaf() const noexcept { return triangleCount > 0; }
+    [[nodiscard]] INLINE BoundingBox3D GetBounds() const noexcept { return { minimum, maximum }; }
+  };
+
+  struct RayHit
+  {
+    f32 distance; // As a multiple of the ray direction
+    u32 triangle; // Index into the triangle array
+    f32 u, v;     // Barycentric coordinates of the hit on the triangle
+  };
+
+  /**
+  * @brief Build the BVH over every triangle of the mesh, each node's geometry
+  * is transformed by its matrix so the BVH is in mesh space.
+  * @param mesh Mesh to build from.
+  */
+  void Create(const Mesh* mesh);
+
+  /**
+  * @brief Build the BVH over the triangles of a single geometry.
+  * @param geometry Geometry to build from.
+  * @param transform Matrix applied to every vertex position.
+  */
+  void Create(const MeshGeometry& geometry, const glm::mat4& transform = glm::identity<glm::mat4>());
+
+  void Destroy();
+
+  /** @brief Get the bounding box of every triangle in the BVH, only valid when it isn't empty. */
+  [[nodiscard]] INLINE BoundingBox3D GetBounds() const { return nodes[0].GetBounds(); }
+
+  /**
+  * @brief Find the closest triangle hit by the ray, triangles are double sided.
+  * @param origin Origin of the ray.
+  * @param direction Direction of the ray, doesn't need to be normalised.
+  * @param maxDistance Length of the ray, as a multiple of the direction.
+  * @param out_hit Closest hit, only written when a triangle is hit.
+  * @return True when a triangle is hit; false otherwise.
+  */
+  b8 Raycast(const glm::vec3& origin, const glm::vec3& direction, f32 maxDistance, RayHit* out_hit) const;
+
+  /**
+  * @brief Find the unsigned distance from the point to the closest triangle.
+  * @param point Point to search from.
+  * @param maxDistance Triangles further than this are ignored.
+  * @param out_triangle Optional index of the closest triangle, only written when one is found.
+  * @return Distance to the closest triangle; maxDistance if there isn't one within range.
+  */
+  f32 ClosestTriangle(const glm::vec3& point, f32 maxDistance, u32* out_triangle = nullptr) const;
+
+  // --- MEMBER DATA --- //
+  Node* nodes   = nullptr;
+  u32 nodeCount = 0;
+
+  // NOTE(WSWhitehouse): Triangles are in tree order, the index array maps each one
+  // back to its position in the mesh (counting through the nodes in order)...
+  Triangle* triangles  = nullptr;
+  u32* triangleIndices = nullptr;
+  u32 triangleCount    = 0;
+
+  // NOTE(WSWhitehouse): The triangles in groups of 8 for the distance queries, packet
+  // `i` holds triangles [i * 8, i * 8 + 8) so a leaf overlaps at most two packets...
+  TriangleX8* trianglePackets = nullptr;
+  u32 trianglePacketCount     = 0;
+  void* trianglePacketBlock   = nullptr; // The packets are aligned inside this allocation
+
+  /** @brief The number of nodes on the longest path from the root to a leaf. */
+  u32 depth = 0;
+
+private:
+  void Build();
+};
+
+STATIC_ASSERT(sizeof(BVH::Node) == 32);
+
+#endif //SNOWFLAKE_BVH_HPP
@@ -0,0 +1,371 @@
+#ifndef SNOWFLAKE_BIT_SET_HPP
+#define SNOWFLAKE_BIT_SET_HPP
+
+#include "pch.hpp"
+#include "core/Assert.hpp"
+#include "core/Bits.hpp"
+#include "core/Logging.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+  #include <immintrin.h>
+#endif
+
+/**
+* @file BitSet.hpp
+* @brief Fixed (FBitSet) and dynamic (DBitSet) sized bit sets. Bits are stored in 64-bit
+* words, and the word arrays are padded to BITSET_WORD_ALIGNMENT words (256 bits) and
+* aligned to 32 bytes, so the bulk operations (AND, OR, AND NOT, popcount) can process
+* whole AVX2 registers without a scalar tail. When compiling without AVX2 (see the
+* USE_AVX2 CMake option) the bulk operations fall back to SSE2, then to plain u64 ops.
+* Bits past the bit count in the final word are always kept as 0.
+*/
+
+#define BITSET_BITS_PER_WORD  64ULL
+#define BITSET_WORD_ALIGNMENT 4ULL  // Words per AVX2 register
+#define BITSET_BYTE_ALIGNMENT 32ULL
+
+namespace BitSetOps
+{
+
+  /** @brief Number of words required to store the bit count, padded to BITSET_WORD_ALIGNMENT. */
+  [[nodiscard]] INLINE constexpr u64 WordCount(u64 bitCount)
+  {
+    const u64 words = (bitCount + BITSET_BITS_PER_WORD - 1) / BITSET_BITS_PER_WORD;
+    return (words + BITSET_WORD_ALIGNMENT - 1) & ~(BITSET_WORD_ALIGNMENT - 1);
+  }
+
+  /** @brief dst = lhs & rhs. The word count must be a multiple of BITSET_WORD_ALIGNMENT. */
+  INLINE void And(u64* dst, const u64* lhs, const u64* rhs, u64 wordCount)
+  {
+#if defined(__AVX2__)
+    for (u64 i = 0; i < wordCount; i += 4)
+    {
+      const __m256i a = _mm256_load_si256((const __m256i*)&lhs[i]);
+      const __m256i b = _mm256_load_si256((const __m256i*)&rhs[i]);
+      _mm256_store_si256((__m256i*)&dst[i], _mm256_and_si256(a, b));
+    }
+#elif defined(__SSE2__)
+    for (u64 i = 0; i < wordCount; i += 2)
+    {
+      const __m128i a = _mm_load_si128((const __m128i*)&lhs[i]);
+      const __m128i b = _mm_load_si128((const __m128i*)&rhs[i]);
+      _mm_store_si128((__m128i*)&dst[i], _mm_and_si128(a, b));
+    }
+#else
+    for (u64 i = 0; i < wordCount; ++i) { dst[i] = lhs[i] & rhs[i]; }
+#endif
+  }
+
+  /** @brief dst = lhs | rhs. The word count must be a multiple of BITSET_WORD_ALIGNMENT. */
+  INLINE void Or(u64* dst, const u64* lhs, const u64* rhs, u64 wordCount)
+  {
+#if defined(__AVX2__)
+    for (u64 i = 0; i < wordCount; i += 4)
+    {
+      const __m256i a = _mm256_load_si256((const __m256i*)&lhs[i]);
+      const __m256i b = _mm256_load_si256((const __m256i*)&rhs[i]);
+      _mm256_store_si256((__m256i*)&dst[i], _mm256_or_si256(a, b));
+    }
+#elif defined(__SSE2__)
+    for (u64 i = 0; i < wordCount; i += 2)
+    {
+      const __m128i a = _mm_load_si128((const __m128i*)&lhs[i]);
+      const __m128i b = _mm_load_si128((const __m128i*)&rhs[i]);
+      _mm_store_si128((__m128i*)&dst[i], _mm_or_si128(a, b));
+    }
+#else
+    for (u64 i = 0; i < wordCount; ++i) { dst[i] = lhs[i] | rhs[i]; }
+#endif
+  }
+
+  /** @brief dst = lhs & ~rhs. The word count must be a multiple of BITSET_WORD_ALIGNMENT. */
+  INLINE void AndNot(u64* dst, const u64* lhs, const u64* rhs, u64 wordCount)
+  {
+#if defined(__AVX2__)
+    for (u64 i = 0; i < wordCount; i += 4)
+    {
+      const __m256i a = _mm256_load_si256((const __m256i*)&lhs[i]);
+      const __m256i b = _mm256_load_si256((const __m256i*)&rhs[i]);
+      _mm256_store_si256((__m256i*)&dst[i], _mm256_andnot_si256(b, a));
+    }
+#elif defined(__SSE2__)
+    for (u64 i = 0; i < wordCount; i += 2)
+    {
+      const __m128i a = _mm_load_si128((const __m128i*)&lhs[i]);
+      const __m128i b = _mm_load_si128((const __m128i*)&rhs[i]);
+      _mm_store_si128((__m128i*)&dst[i], _mm_andnot_si128(b, a));
+    }
+#else
+    for (u64 i = 0; i < wordCount; ++i) { dst[i] = lhs[i] & ~rhs[i]; }
+#endif
+  }
+
+  /** @brief Count the set bits across all words. */
+  [[nodiscard]] INLINE u64 PopCount(const u64* words, u64 wordCount)
+  {
+    // NOTE(WSWhitehouse): Four independent accumulators break the dependency
+    // chain on the adds, so the popcnt instructions can be pipelined.
+    u64 count0 = 0, count1 = 0, count2 = 0, count3 = 0;
+    for (u64 i = 0; i < wordCount; i += 4)
+    {
+      count0 += Bits::PopCount64(words[i + 0]);
+      count1 += Bits::PopCount64(words[i + 1]);
+      count2 += Bits::PopCount64(words[i + 2]);
+      count3 += Bits::PopCount64(words[i + 3]);
+    }
+
+    return count0 + count1 + count2 + count3;
+  }
+
+  /** @brief Returns true if any bit is set. */
+  [[nodiscard]] INLINE b8 Any(const u64* words, u64 wordCount)
+  {
+#if defined(__AVX2__)
+    for (u64 i = 0; i < wordCount; i += 4)
+    {
+      const __m256i a = _mm256_load_si256((const __m256i*)&words[i]);
+      if (!_mm256_testz_si256(a, a)) return true;
+    }
+    return false;
+#else
+    for (u64 i = 0; i < wordCount; ++i)
+    {
+      if (words[i] != 0) return true;
+    }
+    return false;
+#endif
+  }
+
+  /**
+  * @brief Call the function with the index of every set bit, in ascending order.
+  * @param func Function with the signature `void(u64 bitIndex)`.
+  */
+  template<typename Func>
+  INLINE void ForEachSetBit(const u64* words, u64 wordCount, Func&& func)
+  {
+    for (u64 i = 0; i < wordCount; ++i)
+    {
+      u64 word = words[i];
+      while (word != 0)
+      {
+        const u64 bitIndex = (i * BITSET_BITS_PER_WORD) + Bits::CountTrailingZeros64(word);
+        word &= word - 1; // Clear lowest set bit...
+
+        func(bitIndex);
+      }
+    }
+  }
+
+  /**
+  * @brief Call the function with the index of every bit that is set in *all* the
+  * word arrays, in ascending order. The intersection is computed word by word on
+  * the fly, so no temporary bit set is required.
+  * @param wordArrays Array of word arrays to intersect, must be at least 1.
+  * @param arrayCount Number of word arrays.
+  * @param wordCount Number of words to process in each array.
+  * @param func Function with the signature `void(u64 bitIndex)`.
+  */
+  template<typename Func>
+  INLINE void ForEachSetBitInAll(const u64* const* wordArrays, u64 arrayCount, u64 wordCount, Func&& func)
+  {
+    for (u64 i = 0; i < wordCount; ++i)
+    {
+      u64 word = wordArrays[0][i];
+      for (u64 array = 1; array < arrayCount && word != 0; ++array)
+      {
+        word &= wordArrays[array][i];
+      }
+
+      while (word != 0)
+      {
+        const u64 bitIndex = (i * BITSET_BITS_PER_WORD) + Bits::CountTrailingZeros64(word);
+        word &= word - 1; // Clear lowest set bit...
+
+        func(bitIndex);
+      }
+    }
+  }
+
+} // namespace BitSetOps
+
+/**
+* @brief A fixed-size bit set. See BitSet.hpp for more info.
+* @tparam BitCount Number of bits in the set.
+*/
+template<u64 BitCount>
+struct FBitSet
+{
+  static constexpr const u64 WORD_COUNT = BitSetOps::WordCount(BitCount);
+
+  alignas(BITSET_BYTE_ALIGNMENT) u64 words[WORD_COUNT] = {};
+
+  /** @brief Get the number of bits in the set. */
+  [[nodiscard]] INLINE constexpr u64 Size() const noexcept { return BitCount; }
+
+  [[nodiscard]] INLINE b8 Test(u64 bit) const { return (words[bit / BITSET_BITS_PER_WORD] >> (bit % BITSET_BITS_PER_WORD)) & 1ULL; }
+  INLINE void Set(u64 bit)   { words[bit / BITSET_BITS_PER_WORD] |=  (1ULL << (bit % BITSET_BITS_PER_WORD)); }
+  INLINE void Reset(u64 bit) { words[bit / BITSET_BITS_PER_WORD] &= ~(1ULL << (bit % BITSET_BITS_PER_WORD)); }
+
+  /** @brief Clear every bit in the set. */
+  INLINE void ClearAll() { mem_zero(words, sizeof(words)); }
+
+  [[nodiscard]] INLINE u64 Count() const { return BitSetOps::PopCount(words, WORD_COUNT); }
+  [[nodiscard]] INLINE b8 Any()     const { return BitSetOps::Any(words, WORD_COUNT); }
+  [[nodiscard]] INLINE b8 None()    const { return !Any(); }
+
+  /** @brief Returns true if every bit set in `other` is also set in this set. */
+  [[nodiscard]] INLINE b8 ContainsAll(const FBitSet& other) const
+  {
+    for (u64 i = 0; i < WORD_COUNT; ++i)
+    {
+      if ((words[i] & other.words[i]) != other.words[i]) return false;
+    }
+    return true;
+  }
+
+  INLINE void And(const FBitSet& other)    { BitSetOps::And(words, words, other.words, WORD_COUNT);    }
+  INLINE void Or(const FBitSet& other)     { BitSetOps::Or(words, words, other.words, WORD_COUNT);     }
+  INLINE void AndNot(const FBitSet& other) { BitSetOps::AndNot(words, words, other.words, WORD_COUNT); }
+
+  [[nodiscard]] INLINE b8 operator==(const FBitSet& other) const
+  {
+    for (u64 i = 0; i < WORD_COUNT; ++i)
+    {
+      if (words[i] != other.words[i]) return false;
+    }
+    return true;
+  }
+
+  /** @brief Call the function with the index of every set bit. Signature: `void(u64 bitIndex)`. */
+  template<typename Func>
+  INLINE void ForEachSetBit(Func&& func) const { BitSetOps::ForEachSetBit(words, WORD_COUNT, func); }
+};
+
+/**
+* @brief A dynamic sized bit set. Like the DArray it isn't set up during its ctor, call
+* the Create/Destroy functions appropriately. See BitSet.hpp for more info.
+*/
+struct DBitSet
+{
+  /** @brief The underlying word array, aligned to BITSET_BYTE_ALIGNMENT bytes. */
+  u64* words = nullptr;
+
+  /** @brief Get the number of bits in the set. */
+  [[nodiscard]] INLINE u64 Size() const noexcept { return bitCount; }
+
+  /** @brief Get the number of (padded) words in the set. */
+  [[nodiscard]] INLINE u64 WordCount() const noexcept { return wordCount; }
+
+  /** @brief Returns if the DBitSet is valid. True when valid; false otherwise. */
+  [[nodiscard]] INLINE b8 IsValid() const noexcept { return words != nullptr; }
+
+  /**
+  * @brief Create the bit set with all bits cleared.
+  * @param _bitCount Number of bits in the set.
+  */
+  INLINE void Create(u64 _bitCount)
+  {
+    if (IsValid()) { Destroy(); }
+
+    bitCount    = _bitCount;
+    wordCount   = BitSetOps::WordCount(MAX(1, bitCount));
+    memoryBlock = mem_alloc(sizeof(u64) * wordCount + BITSET_BYTE_ALIGNMENT);
+    words       = AlignWords(memoryBlock);
+    ClearAll();
+  }
+
+  /** @brief Destroy the bit set and free its memory. */
+  INLINE void Destroy()
+  {
+    if (!IsValid()) return;
+
+    mem_free(memoryBlock);
+    memoryBlock = nullptr;
+    words       = nullptr;
+    bitCount    = 0;
+    wordCount   = 0;
+  }
+
+  /**
+  * @brief Resize the bit set, keeping the existing bits. New bits are cleared.
+  * @param newBitCount New number of bits.
+  */
+  INLINE void Resize(u64 newBitCount)
+  {
+    if (!IsValid()) { Create(newBitCount); return; }
+
+    const u64 newWordCount = BitSetOps::WordCount(MAX(1, newBitCount));
+
+    void* newMemoryBlock = mem_alloc(sizeof(u64) * newWordCount + BITSET_BYTE_ALIGNMENT);
+    u64* newWords        = AlignWords(newMemoryBlock);
+    mem_zero(newWords, sizeof(u64) * newWordCount);
+    mem_copy(newWords, words, sizeof(u64) * MIN(wordCount, newWordCount));
+
+    mem_free(memoryBlock);
+    memoryBlock = newMemoryBlock;
+    words       = newWords;
+    wordCount   = newWordCount;
+    bitCount    = newBitCount;
+
+    // NOTE(WSWhitehouse): Ensure the bits past the bit count stay cleared when shrinking...
+    const u64 usedBitsInLastWord = bitCount % BITSET_BITS_PER_WORD;
+    const u64 lastWord           = bitCount / BITSET_BITS_PER_WORD;
+    if (usedBitsInLastWord != 0) { words[lastWord] &= (1ULL << usedBitsInLastWord) - 1ULL; }
+    for (u64 i = lastWord + (usedBitsInLastWord != 0 ? 1 : 0); i < wordCount; ++i) { words[i] = 0; }
+  }
+
+  [[nodiscard]] INLINE b8 Test(u64 bit) const { return (words[bit / BITSET_BITS_PER_WORD] >> (bit % BITSET_BITS_PER_WORD)) & 1ULL; }
+  INLINE void Set(u64 bit)   { words[bit / BITSET_BITS_PER_WORD] |=  (1ULL << (bit % BITSET_BITS_PER_WORD)); }
+  INLINE void Reset(u64 bit) { words[bit / BITSET_BITS_PER_WORD] &= ~(1ULL << (bit % BITSET_BITS_PER_WORD)); }
+
+  /** @brief Clear every bit in the set. */
+  INLINE void ClearAll() { mem_zero(words, sizeof(u64) * wordCount); }
+
+  [[nodiscard]] INLINE u64 Count() const { return BitSetOps::PopCount(words, wordCount); }
+  [[nodiscard]] INLINE b8 Any()     const { return BitSetOps::Any(words, wordCount); }
+  [[nodiscard]] INLINE b8 None()    const { return !Any(); }
+
+  /** @brief this = this & other. Both sets must be the same size. */
+  INLINE void And(const DBitSet& other)
+  {
+    ASSERT(wordCount == other.wordCount);
+    BitSetOps::And(words, words, other.words, wordCount);
+  }
+
+  /** @brief this = this | other. Both sets must be the same size. */
+  INLINE void Or(const DBitSet& other)
+  {
+    ASSERT(wordCount == other.wordCount);
+    BitSetOps::Or(words, words, other.words, wordCount);
+  }
+
+  /** @brief this = this & ~other. Both sets must be the same size. */
+  INLINE void AndNot(const DBitSet& other)
+  {
+    ASSERT(wordCount == other.wordCount);
+    BitSetOps::AndNot(words, words, other.words, wordCount);
+  }
+
+  /** @brief Copy the bits from another set of the same size. */
+  INLINE void CopyFrom(const DBitSet& other)
+  {
+    ASSERT(wordCount == other.wordCount);
+    mem_copy(words, other.words, sizeof(u64) * wordCount);
+  }
+
+  /** @brief Call the function with the index of every set bit. Signature: `void(u64 bitIndex)`. */
+  template<typename Func>
+  INLINE void ForEachSetBit(Func&& func) const { BitSetOps::ForEachSetBit(words, wordCount, func); }
+
+private:
+  void* memoryBlock = nullptr;
+  u64 bitCount      = 0;
+  u64 wordCount     = 0;
+
+  [[nodiscard]] static INLINE u64* AlignWords(void* block)
+  {
+    return (u64*)(((u64)block + BITSET_BYTE_ALIGNMENT - 1) & ~(BITSET_BYTE_ALIGNMENT - 1));
+  }
+};
+
+#endif //SNOWFLAKE_BIT_SET_HPP
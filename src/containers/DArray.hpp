@@ -169,6 +169,28 @@ struct DArray
     numElements--;
   }
 
+  /**
+  * @brief Remove an element at the specified index, shifting all the following
+  * elements down by one. Slower than Remove() but preserves the element order.
+  * @param index Element at index to remove.
+  */
+  INLINE void RemoveOrdered(u64 index)
+  {
+    DARRAY_VALID_CHECK();
+
+    if (index >= numElements)
+    {
+      LOG_ERROR("Trying to remove an element at an invalid index in a DArray!");
+      return;
+    }
+
+    mem_move(&data[index], &data[index + 1], sizeof(Type) * (numElements - index - 1));
+    numElements--;
+  }
+
+  /** @brief Clear the array, doesn't free any memory. */
+  INLINE void Clear() { numElements = 0; }
+
 private:
   u64 numElements  = 0;
   u64 capacity     = 0;
@@ -0,0 +1,243 @@
+#include "containers/RadixSort.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+#define RADIX_DIGIT_BITS    8
+#define RADIX_BUCKET_COUNT  (1U << RADIX_DIGIT_BITS)
+#define RADIX_DIGIT_MASK    (RADIX_BUCKET_COUNT - 1U)
+
+// NOTE(WSWhitehouse): Below this key count the parallel sort falls back to the serial sort, the
+// cost of submitting jobs outweighs the benefit. Blocks are never smaller than the min block size.
+#define PARALLEL_SORT_MIN_COUNT      65536
+#define PARALLEL_SORT_MIN_BLOCK_SIZE 16384
+
+template<typename KeyType>
+[[nodiscard]] static INLINE u32 GetDigit(KeyType key, u32 pass)
+{
+  return (u32)((key >> (pass * RADIX_DIGIT_BITS)) & RADIX_DIGIT_MASK);
+}
+
+/**
+* @brief Helper struct to manage the ping-pong between the input arrays and the scratch
+* buffers. Allocates scratch buffers if the user hasn't provided them.
+*/
+template<typename KeyType>
+struct SortBuffers
+{
+  KeyType* srcKeys;
+  KeyType* dstKeys;
+  u32* srcValues;
+  u32* dstValues;
+
+  KeyType* allocatedKeys;
+  u32* allocatedValues;
+
+  INLINE void Init(KeyType* keys, u32* values, u64 count, KeyType* keysScratch, u32* valuesScratch)
+  {
+    allocatedKeys   = nullptr;
+    allocatedValues = nullptr;
+
+    if (keysScratch == nullptr)
+    {
+      allocatedKeys = (KeyType*)mem_alloc(sizeof(KeyType) * count);
+      keysScratch   = allocatedKeys;
+    }
+
+    if (values != nullptr && valuesScratch == nullptr)
+    {
+      allocatedValues = (u32*)mem_alloc(sizeof(u32) * count);
+      valuesScratch   = allocatedValues;
+    }
+
+    srcKeys   = keys;
+    dstKeys   = keysScratch;
+    srcValues = values;
+    dstValues = values != nullptr ? valuesScratch : nullptr;
+  }
+
+  INLINE void Swap()
+  {
+    KeyType* tempKeys = srcKeys;
+    srcKeys = dstKeys;
+    dstKeys = tempKeys;
+
+    u32* tempValues = srcValues;
+    srcValues = dstValues;
+    dstValues = tempValues;
+  }
+
+  /** @brief Ensures the sorted result ends up in the user arrays and frees any scratch buffers. */
+  INLINE void Finish(KeyType* keys, u32* values, u64 count)
+  {
+    // NOTE(WSWhitehouse): After an odd number of passes the sorted data is in the scratch buffers...
+    if (srcKeys != keys)
+    {
+      mem_copy(keys, srcKeys, sizeof(KeyType) * count);
+      if (values != nullptr) { mem_copy(values, srcValues, sizeof(u32) * count); }
+    }
+
+    if (allocatedKeys   != nullptr) { mem_free(allocatedKeys);   }
+    if (allocatedValues != nullptr) { mem_free(allocatedValues); }
+  }
+};
+
+template<typename KeyType>
+static void SortImpl(KeyType* keys, u32* values, u64 count, KeyType* keysScratch, u32* valuesScratch)
+{
+  constexpr const u32 passCount = sizeof(KeyType);
+
+  if (count <= 1) return;
+
+  // NOTE(WSWhitehouse): Build the histograms for every pass in a single read of the keys...
+  u64 histograms[passCount][RADIX_BUCKET_COUNT];
+  mem_zero(histograms, sizeof(histograms));
+
+  for (u64 i = 0; i < count; ++i)
+  {
+    const KeyType key = keys[i];
+    for (u32 pass = 0; pass < passCount; ++pass)
+    {
+      histograms[pass][GetDigit(key, pass)]++;
+    }
+  }
+
+  SortBuffers<KeyType> buffers;
+  buffers.Init(keys, values, count, keysScratch, valuesScratch);
+
+  for (u32 pass = 0; pass < passCount; ++pass)
+  {
+    u64* histogram = histograms[pass];
+
+    // NOTE(WSWhitehouse): Every key shares the same digit, this pass wouldn't change the order...
+    if (histogram[GetDigit(buffers.srcKeys[0], pass)] == count) continue;
+
+    // Exclusive prefix sum to find the starting offset of each bucket...
+    u64 offset = 0;
+    for (u32 bucket = 0; bucket < RADIX_BUCKET_COUNT; ++bucket)
+    {
+      const u64 bucketCount = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucketCount;
+    }
+
+    // Scatter...
+    for (u64 i = 0; i < count; ++i)
+    {
+      const KeyType key = buffers.srcKeys[i];
+      const u64 dstIndex = histogram[GetDigit(key, pass)]++;
+
+      buffers.dstKeys[dstIndex] = key;
+      if (buffers.srcValues != nullptr) { buffers.dstValues[dstIndex] = buffers.srcValues[i]; }
+    }
+
+    buffers.Swap();
+  }
+
+  buffers.Finish(keys, values, count);
+}
+
+template<typename KeyType>
+static void ParallelSortImpl(KeyType* keys, u32* values, u64 count, KeyType* keysScratch, u32* valuesScratch)
+{
+  constexpr const u32 passCount = sizeof(KeyType);
+
+  const u64 workerCount = JobSystem::GetWorkerThreadCount();
+  if (count < PARALLEL_SORT_MIN_COUNT || workerCount == 0)
+  {
+    SortImpl(keys, values, count, keysScratch, valuesScratch);
+    return;
+  }
+
+  // NOTE(WSWhitehouse): The calling thread also takes a block...
+  const u64 maxBlockCount = (count + PARALLEL_SORT_MIN_BLOCK_SIZE - 1) / PARALLEL_SORT_MIN_BLOCK_SIZE;
+  const u64 blockCount    = MIN(workerCount + 1, maxBlockCount);
+  const u64 blockSize     = (count + blockCount - 1) / blockCount;
+
+  // NOTE(WSWhitehouse): Laid out as [block][bucket], each block only touches its own histogram.
+  u64* blockHistograms = (u64*)mem_alloc(sizeof(u64) * RADIX_BUCKET_COUNT * blockCount);
+
+  SortBuffers<KeyType> buffers;
+  buffers.Init(keys, values, count, keysScratch, valuesScratch);
+
+  for (u32 pass = 0; pass < passCount; ++pass)
+  {
+    // Per block histograms...
+    JobSystem::ParallelFor((u32)blockCount, [&](u32 block)
+    {
+      u64* histogram = &blockHistograms[block * RADIX_BUCKET_COUNT];
+      mem_zero(histogram, sizeof(u64) * RADIX_BUCKET_COUNT);
+
+      const u64 start = block * blockSize;
+      const u64 end   = MIN(start + blockSize, count);
+      for (u64 i = start; i < end; ++i)
+      {
+        histogram[GetDigit(buffers.srcKeys[i], pass)]++;
+      }
+    });
+
+    // NOTE(WSWhitehouse): Prefix sum across the blocks in bucket-major order. Block N scatters
+    // its keys for a bucket directly after block N-1, which keeps the sort stable...
+    b8 skipPass = false;
+    u64 offset  = 0;
+    for (u32 bucket = 0; bucket < RADIX_BUCKET_COUNT && !skipPass; ++bucket)
+    {
+      const u64 bucketStart = offset;
+      for (u64 block = 0; block < blockCount; ++block)
+      {
+        u64& bucketCount = blockHistograms[block * RADIX_BUCKET_COUNT + bucket];
+        const u64 blockBucketCount = bucketCount;
+
+        bucketCount = offset;
+        offset += blockBucketCount;
+      }
+
+      // Every key shares the same digit, this pass wouldn't change the order...
+      skipPass = (offset - bucketStart) == count;
+    }
+
+    if (skipPass) continue;
+
+    // Scatter...
+    JobSystem::ParallelFor((u32)blockCount, [&](u32 block)
+    {
+      u64* histogram = &blockHistograms[block * RADIX_BUCKET_COUNT];
+
+      const u64 start = block * blockSize;
+      const u64 end   = MIN(start + blockSize, count);
+      for (u64 i = start; i < end; ++i)
+      {
+        const KeyType key  = buffers.srcKeys[i];
+        const u64 dstIndex = histogram[GetDigit(key, pass)]++;
+
+        buffers.dstKeys[dstIndex] = key;
+        if (buffers.srcValues != nullptr) { buffers.dstValues[dstIndex] = buffers.srcValues[i]; }
+      }
+    });
+
+    buffers.Swap();
+  }
+
+  buffers.Finish(keys, values, count);
+  mem_free(blockHistograms);
+}
+
+void RadixSort::Sort(u32* keys, u32* values, u64 count, u32* keysScratch, u32* valuesScratch)
+{
+  SortImpl<u32>(keys, values, count, keysScratch, valuesScratch);
+}
+
+void RadixSort::Sort(u64* keys, u32* values, u64 count, u64* keysScratch, u32* valuesScratch)
+{
+  SortImpl<u64>(keys, values, count, keysScratch, valuesScratch);
+}
+
+void RadixSort::ParallelSort(u32* keys, u32* values, u64 count, u32* keysScratch, u32* valuesScratch)
+{
+  ParallelSortImpl<u32>(keys, values, count, keysScratch, valuesScratch);
+}
+
+void RadixSort::ParallelSort(u64* keys, u32* values, u64 count, u64* keysScratch, u32* valuesScratch)
+{
+  ParallelSortImpl<u64>(keys, values, count, keysScratch, valuesScratch);
+}
@@ -0,0 +1,52 @@
+#ifndef SNOWFLAKE_RADIX_SORT_HPP
+#define SNOWFLAKE_RADIX_SORT_HPP
+
+#include "pch.hpp"
+
+/**
+* @file RadixSort.hpp
+* @brief A least significant digit (LSD) radix sort for key/value pairs. Keys are sorted
+* in ascending order using 8-bit digits, so a u32 key takes at most 4 passes and a u64
+* key at most 8 passes over the data. Passes where every key shares the same digit are
+* skipped. The sort is stable, values with equal keys keep their relative order.
+*
+* The parallel variants split the arrays into blocks across the JobSystem, each pass
+* builds a histogram per block, prefix sums them on the calling thread, then each block
+* scatters its keys into its own region of the output. The parallel variants fall back
+* to the serial sort for small arrays where the job overhead isn't worth it.
+*
+* USEFUL LINKS & RESOURCES:
+*  - http://stereopsis.com/radix.html
+*  - https://travisdowns.github.io/blog/2019/05/22/sorting.html
+*  - https://gpuopen.com/download/publications/Introduction_to_GPU_Radix_Sort.pdf
+*/
+
+namespace RadixSort
+{
+
+  /**
+  * @brief Sort the keys (and values) in ascending order on the calling thread.
+  * @param keys Keys to sort, sorted in place.
+  * @param values Values associated with each key, reordered alongside the keys. Can be nullptr.
+  * @param count Number of keys (and values).
+  * @param keysScratch Scratch buffer of at least `count` keys. If nullptr, it is allocated internally.
+  * @param valuesScratch Scratch buffer of at least `count` values. If nullptr, it is allocated internally.
+  */
+  void Sort(u32* keys, u32* values, u64 count, u32* keysScratch = nullptr, u32* valuesScratch = nullptr);
+  void Sort(u64* keys, u32* values, u64 count, u64* keysScratch = nullptr, u32* valuesScratch = nullptr);
+
+  /**
+  * @brief Sort the keys (and values) in ascending order using the JobSystem. Blocks the
+  * calling thread until the sort is complete, the calling thread takes part in the sort.
+  * @param keys Keys to sort, sorted in place.
+  * @param values Values associated with each key, reordered alongside the keys. Can be nullptr.
+  * @param count Number of keys (and values).
+  * @param keysScratch Scratch buffer of at least `count` keys. If nullptr, it is allocated internally.
+  * @param valuesScratch Scratch buffer of at least `count` values. If nullptr, it is allocated internally.
+  */
+  void ParallelSort(u32* keys, u32* values, u64 count, u32* keysScratch = nullptr, u32* valuesScratch = nullptr);
+  void ParallelSort(u64* keys, u32* values, u64 count, u64* keysScratch = nullptr, u32* valuesScratch = nullptr);
+
+} // namespace RadixSort
+
+#endif //SNOWFLAKE_RADIX_SORT_HPP
@@ -0,0 +1,218 @@
+#ifndef SNOWFLAKE_SMALL_VECTOR_HPP
+#define SNOWFLAKE_SMALL_VECTOR_HPP
+
+#include "pch.hpp"
+#include "core/Assert.hpp"
+#include "core/Logging.hpp"
+
+#define SMALL_VECTOR_RESIZE_FACTOR 2
+
+/**
+* @brief A templated dynamic sized contiguous array with inline storage. The first
+* `InlineCapacity` elements are stored inside the SmallVector itself, the array only
+* spills over to the heap when it grows past that. This avoids heap allocations for
+* the (very common) small temporary lists, i.e. per-node lists when building trees.
+* The API matches the DArray, but unlike the DArray a zero-initialised SmallVector is
+* ready to use without calling Create - the Create/Destroy functions are still provided
+* to reserve capacity upfront and to free any spilled heap memory. Destroy *must* be
+* called if the array could have spilled to the heap. Elements are moved using mem_copy,
+* so don't keep a pointer or reference to an element as it may be moved.
+* @tparam Type Type of array to create.
+* @tparam InlineCapacity Number of elements stored inline before spilling to the heap.
+*/
+template<typename Type, u64 InlineCapacity>
+struct SmallVector
+{
+  STATIC_ASSERT(InlineCapacity > 0, "SmallVector requires an inline capacity of at least 1!");
+
+  [[nodiscard]] INLINE const Type& operator[] (u64 index) const noexcept { return Data()[index]; }
+  [[nodiscard]] INLINE       Type& operator[] (u64 index)       noexcept { return Data()[index]; }
+
+  /** @brief Get the underlying array data. Points to the inline storage until the array spills to the heap. */
+  [[nodiscard]] INLINE const Type* Data() const noexcept { return heapData != nullptr ? heapData : (const Type*)inlineData; }
+  [[nodiscard]] INLINE       Type* Data()       noexcept { return heapData != nullptr ? heapData : (Type*)inlineData; }
+
+  /** @brief Get the number of elements in the array. */
+  [[nodiscard]] INLINE u64 Size() const noexcept { return numElements; }
+
+  /** @brief Get the capacity of the array, may not match Size(). Never less than InlineCapacity. */
+  [[nodiscard]] INLINE u64 Capacity() const noexcept { return heapData != nullptr ? heapCapacity : InlineCapacity; }
+
+  /** @brief Returns if the array has spilled over to the heap. */
+  [[nodiscard]] INLINE b8 IsOnHeap() const noexcept { return heapData != nullptr; }
+
+  /** @brief A SmallVector is always valid as it falls back to its inline storage. Kept for parity with the DArray. */
+  [[nodiscard]] INLINE b8 IsValid() const noexcept { return true; }
+
+  /**
+  * @brief Create the array. Only allocates when the initial capacity
+  * is larger than the inline capacity. Clears any existing elements.
+  * @param initialCapacity The initial capacity of the array. Default = 1.
+  */
+  INLINE void Create(u64 initialCapacity = 1)
+  {
+    Destroy();
+
+    if (initialCapacity > InlineCapacity)
+    {
+      heapData     = AllocDataArray(initialCapacity);
+      heapCapacity = initialCapacity;
+    }
+  }
+
+  /**
+  * @brief Destroy the array and free any heap memory. The array
+  * falls back to the inline storage and can be used again.
+  */
+  INLINE void Destroy()
+  {
+    if (heapData != nullptr)
+    {
+      mem_free(heapData);
+    }
+
+    heapData     = nullptr;
+    heapCapacity = 0;
+    numElements  = 0;
+  }
+
+  /**
+  * @brief Resizes the array to the desired capacity. Will truncate and remove
+  * elements already in the array if requested. Moves the elements back into
+  * the inline storage if the new capacity fits.
+  * @param newCapacity Desired new capacity of array.
+  * @param truncateArray Should elements be removed when resizing. Default = true.
+  */
+  INLINE void Resize(u64 newCapacity, b8 truncateArray = true)
+  {
+    if (!truncateArray)
+    {
+      newCapacity = MAX(newCapacity, numElements);
+    }
+
+    if (newCapacity <= 0)
+    {
+      LOG_ERROR("Can't resize SmallVector to 0 capacity!");
+      return;
+    }
+
+    const u64 newElementCount = MIN(numElements, newCapacity);
+
+    if (newCapacity <= InlineCapacity)
+    {
+      // NOTE(WSWhitehouse): Already using the inline storage, nothing to move...
+      if (heapData == nullptr)
+      {
+        numElements = newElementCount;
+        return;
+      }
+
+      mem_copy(inlineData, heapData, sizeof(Type) * newElementCount);
+      mem_free(heapData);
+
+      heapData     = nullptr;
+      heapCapacity = 0;
+      numElements  = newElementCount;
+      return;
+    }
+
+    Type* newData = AllocDataArray(newCapacity);
+    mem_copy(newData, Data(), sizeof(Type) * newElementCount);
+
+    // Free old heap array
+    if (heapData != nullptr) { mem_free(heapData); }
+
+    // Set new array values
+    heapData     = newData;
+    heapCapacity = newCapacity;
+    numElements  = newElementCount;
+  }
+
+  /** @brief Resizes the array to match the number of elements. */
+  INLINE void ShrinkToNumElements()
+  {
+    Resize(1, false);
+  }
+
+  /**
+  * @brief Add a new element to the array. May spill to the heap if there is not enough capacity.
+  * @param element Element to add.
+  * @return The index into the array where the element was added.
+  */
+  INLINE u64 Add(const Type& element)
+  {
+    // NOTE(WSWhitehouse): Resize the array if we've hit capacity!
+    if (numElements == Capacity())
+    {
+      Resize(Capacity() * SMALL_VECTOR_RESIZE_FACTOR, false);
+    }
+
+    const u64 elementIndex = numElements;
+    numElements++;
+
+    Data()[elementIndex] = element;
+    return elementIndex;
+  }
+
+  /**
+  * @brief Remove an element at the specified index. The final element
+  * is moved into the gap, so the order of elements is not preserved.
+  * @param index Element at index to remove.
+  */
+  INLINE void Remove(u64 index)
+  {
+    if (index >= numElements)
+    {
+      LOG_ERROR("Trying to remove an element at an invalid index in a SmallVector!");
+      return;
+    }
+
+    const u64 lastElementIndex = numElements - 1;
+    numElements--;
+
+    if (index == lastElementIndex) return;
+
+    Type* data = Data();
+    mem_copy(&data[index], &data[lastElementIndex], sizeof(Type));
+  }
+
+  /**
+  * @brief Remove an element at the specified index, shifting all the following
+  * elements down by one. Slower than Remove() but preserves the element order.
+  * @param index Element at index to remove.
+  */
+  INLINE void RemoveOrdered(u64 index)
+  {
+    if (index >= numElements)
+    {
+      LOG_ERROR("Trying to remove an element at an invalid index in a SmallVector!");
+      return;
+    }
+
+    Type* data = Data();
+    mem_move(&data[index], &data[index + 1], sizeof(Type) * (numElements - index - 1));
+    numElements--;
+  }
+
+  /** @brief Clear the array, doesn't free any heap memory. */
+  INLINE void Clear() { numElements = 0; }
+
+private:
+  alignas(Type) byte inlineData[sizeof(Type) * InlineCapacity];
+
+  Type* heapData   = nullptr;
+  u64 heapCapacity = 0;
+  u64 numElements  = 0;
+
+  /**
+  * @brief Helper function to allocate memory for the heap array at the specified capacity.
+  * @param capacity Capacity to allocate.
+  * @return Pointer to allocated memory.
+  */
+  static INLINE Type* AllocDataArray(u64 capacity)
+  {
+    return (Type*)mem_alloc(sizeof(Type) * capacity);
+  }
+};
+
+#endif //SNOWFLAKE_SMALL_VECTOR_HPP
@@ -0,0 +1,54 @@
+#ifndef SNOWFLAKE_BITS_HPP
+#define SNOWFLAKE_BITS_HPP
+
+#include "pch.hpp"
+
+#if defined(COMPILER_MSC)
+  #include <intrin.h>
+#endif
+
+/**
+* @brief Portable wrappers around the bit manipulation intrinsics. These compile
+* down to single instructions (popcnt, tzcnt/bsf, lzcnt/bsr) when the target
+* supports them.
+*/
+namespace Bits
+{
+
+  /** @brief Count the number of set bits in the value. */
+  [[nodiscard]] INLINE u32 PopCount64(u64 value)
+  {
+#if defined(COMPILER_MSC)
+    return (u32)__popcnt64(value);
+#else
+    return (u32)__builtin_popcountll(value);
+#endif
+  }
+
+  /** @brief Index of the lowest set bit. The value must not be 0. */
+  [[nodiscard]] INLINE u32 CountTrailingZeros64(u64 value)
+  {
+#if defined(COMPILER_MSC)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctzll(value);
+#endif
+  }
+
+  /** @brief Number of leading zero bits. The value must not be 0. */
+  [[nodiscard]] INLINE u32 CountLeadingZeros64(u64 value)
+  {
+#if defined(COMPILER_MSC)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63U - (u32)index;
+#else
+    return (u32)__builtin_clzll(value);
+#endif
+  }
+
+} // namespace Bits
+
+#endif //SNOWFLAKE_BITS_HPP
@@ -17,11 +17,11 @@ namespace Hash
   constexpr const u64 FNV1a64_HASH_VALUE  = 0xcbf29ce484222325;
   constexpr const u64 FNV1a64_PRIME_VALUE = 0x100000001b3;
 
-  INLINE constexpr u32 FNV1a32(const void* data, const u32 length) noexcept
+  INLINE constexpr u32 FNV1a32(const void* data, const u32 length, const u32 value = FNV1a32_HASH_VALUE) noexcept
   {
     const byte* dataPtr = (byte*)data;
 
-    u32 hash  = FNV1a32_HASH_VALUE;
+    u32 hash  = value;
     u32 prime = FNV1a32_PRIME_VALUE;
 
     for(u32 i = 0; i < length; ++i)
@@ -35,11 +35,11 @@ namespace Hash
     return hash;
   }
 
-  INLINE constexpr u64 FNV1a64(const void* data, const u64 length) noexcept
+  INLINE constexpr u64 FNV1a64(const void* data, const u64 length, const u64 value = FNV1a64_HASH_VALUE) noexcept
   {
     const byte* dataPtr = (byte*)data;
 
-    u64 hash  = FNV1a64_HASH_VALUE;
+    u64 hash  = value;
     u64 prime = FNV1a64_PRIME_VALUE;
 
     for(u64 i = 0; i < length; ++i)
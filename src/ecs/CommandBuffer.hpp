@@ -0,0 +1,242 @@
+#ifndef SNOWFLAKE_ECS_COMMAND_BUFFER_HPP
+#define SNOWFLAKE_ECS_COMMAND_BUFFER_HPP
+
+#include "pch.hpp"
+
+#include <new> // placement new
+
+// containers
+#include "containers/DArray.hpp"
+
+// ECS includes
+#include "ecs/ECS.hpp"
+
+namespace ECS
+{
+
+  /**
+  * @brief An entity created in a CommandBuffer, it doesn't exist until the buffer is
+  * played back. Can be used with the other commands recorded in the same buffer.
+  */
+  struct PendingEntity
+  {
+    u32 index;
+  };
+
+  /**
+  * @brief Records structural changes (create/destroy entities, add/remove components)
+  * so they can be made while iterating in parallel, where changing the sparse sets
+  * directly is unsafe. Every thread has its own buffer, get it with
+  * `ecs.GetCommandBuffer()`. The buffers are played back by the ECS::Manager at the
+  * sync point at the end of SystemsUpdate, see Manager::PlaybackCommandBuffers.
+  *
+  * Component values are copied into the buffer when the command is recorded. Like the
+  * DArray it isn't set up during its ctor, call the Create/Destroy functions.
+  */
+  struct CommandBuffer
+  {
+    enum class CommandType : u8
+    {
+      ADD_COMPONENT,
+      REMOVE_COMPONENT,
+      DESTROY_ENTITY,
+    };
+
+    typedef void (*ApplyFuncPtr)(Manager& ecs, Entity entity, void* data);
+    typedef void (*DestroyDataFuncPtr)(void* data);
+
+    struct Command
+    {
+      CommandType type;
+      b8 isPending;        // If true, `target` is a PendingEntity index rather than an Entity
+      u32 target;
+      u32 componentIndex;
+      u64 dataOffset;
+      ApplyFuncPtr apply;
+      DestroyDataFuncPtr destroyData; // nullptr if the command has no data
+    };
+
+    /** @brief Create the command buffer with no commands. */
+    INLINE void Create()
+    {
+      commands.Create(64);
+      data               = nullptr;
+      dataSize           = 0;
+      dataCapacity       = 0;
+      pendingEntityCount = 0;
+    }
+
+    /** @brief Destroy the command buffer, any commands that haven't been played back are discarded. */
+    INLINE void Destroy()
+    {
+      Clear();
+      commands.Destroy();
+      mem_free(data);
+      data         = nullptr;
+      dataCapacity = 0;
+    }
+
+    /** @brief Discard every recorded command. */
+    INLINE void Clear()
+    {
+      for (u64 i = 0; i < commands.Size(); ++i)
+      {
+        if (commands[i].destroyData != nullptr) { commands[i].destroyData(data + commands[i].dataOffset); }
+      }
+
+      commands.Clear();
+      dataSize           = 0;
+      pendingEntityCount = 0;
+    }
+
+    /**
+    * @brief Record creating an entity. The entity is created when the buffer is
+    * played back, before any component is added.
+    * @return The pending entity, only valid for commands recorded in this buffer.
+    */
+    [[nodiscard]] INLINE PendingEntity CreateEntity()
+    {
+      PendingEntity pending = { pendingEntityCount };
+      pendingEntityCount++;
+      return pending;
+    }
+
+    /** @brief Record destroying the entity. Entities are destroyed after every component command. */
+    INLINE void DestroyEntity(Entity entity)
+    {
+      Command command        = {};
+      command.type           = CommandType::DESTROY_ENTITY;
+      command.isPending      = false;
+      command.target         = entity;
+      command.componentIndex = U32_MAX;
+      command.apply          = nullptr;
+      command.destroyData    = nullptr;
+      commands.Add(command);
+    }
+
+    /** @brief Record adding the component to the entity, the component is copied into the buffer. */
+    template<typename T>
+    INLINE void AddComponent(Entity entity, const T& component = {})
+    {
+      RecordAddComponent<T>(entity, false, component);
+    }
+
+    /** @brief Record adding the component to the pending entity, the component is copied into the buffer. */
+    template<typename T>
+    INLINE void AddComponent(PendingEntity entity, const T& component = {})
+    {
+      RecordAddComponent<T>(entity.index, true, component);
+    }
+
+    /** @brief Record removing the component from the entity. */
+    template<typename T>
+    INLINE void RemoveComponent(Entity entity)
+    {
+      RecordRemoveComponent<T>(entity, false);
+    }
+
+    /** @brief Record removing the component from the pending entity. */
+    template<typename T>
+    INLINE void RemoveComponent(PendingEntity entity)
+    {
+      RecordRemoveComponent<T>(entity.index, true);
+    }
+
+    /** @brief Get the number of recorded commands, not including entity creation. */
+    [[nodiscard]] INLINE u64 GetCommandCount() const noexcept { return commands.Size(); }
+
+    /** @brief Get the number of entities created in the buffer. */
+    [[nodiscard]] INLINE u32 GetPendingEntityCount() const noexcept { return pendingEntityCount; }
+
+    /** @brief Get the recorded command at the index. Used by ECS::Manager::PlaybackCommandBuffers. */
+    [[nodiscard]] INLINE const Command& GetCommand(u64 index) const { return commands[index]; }
+
+    /** @brief Get the data recorded for the command. Used by ECS::Manager::PlaybackCommandBuffers. */
+    [[nodiscard]] INLINE void* GetCommandData(const Command& command) const { return data + command.dataOffset; }
+
+  private:
+    DArray<Command> commands = {};
+
+    // NOTE(WSWhitehouse): Component values are placement new'd into a single byte
+    // arena so recording a command doesn't allocate per component...
+    byte* data       = nullptr;
+    u64 dataSize     = 0;
+    u64 dataCapacity = 0;
+
+    u32 pendingEntityCount = 0;
+
+    static inline constexpr const u64 DATA_ALIGNMENT = 16;
+
+    template<typename T>
+    INLINE void RecordAddComponent(u32 target, b8 isPending, const T& component)
+    {
+      STATIC_ASSERT(alignof(T) <= DATA_ALIGNMENT, "Component alignment is too large for the ECS CommandBuffer!");
+
+      const u64 offset = AllocateData(sizeof(T), alignof(T));
+      new (data + offset) T(component);
+
+      Command command        = {};
+      command.type           = CommandType::ADD_COMPONENT;
+      command.isPending      = isPending;
+      command.target         = target;
+      command.componentIndex = (u32)Component<T>::INDEX;
+      command.dataOffset     = offset;
+      command.apply          = ApplyAddComponent<T>;
+      command.destroyData    = DestroyData<T>;
+      commands.Add(command);
+    }
+
+    template<typename T>
+    INLINE void RecordRemoveComponent(u32 target, b8 isPending)
+    {
+      Command command        = {};
+      command.type           = CommandType::REMOVE_COMPONENT;
+      command.isPending      = isPending;
+      command.target         = target;
+      command.componentIndex = (u32)Component<T>::INDEX;
+      command.apply          = ApplyRemoveComponent<T>;
+      command.destroyData    = nullptr;
+      commands.Add(command);
+    }
+
+    INLINE u64 AllocateData(u64 size, u64 alignment)
+    {
+      const u64 offset  = (dataSize + (alignment - 1)) & ~(alignment - 1);
+      const u64 newSize = offset + size;
+
+      if (newSize > dataCapacity)
+      {
+        // NOTE(WSWhitehouse): The arena is allocated with mem_alloc's alignment,
+        // which is at least DATA_ALIGNMENT, so aligned offsets stay aligned.
+        const u64 newCapacity = MAX(newSize, MAX(dataCapacity * 2, (u64)1024));
+        data         = (byte*)mem_realloc(data, newCapacity);
+        dataCapacity = newCapacity;
+      }
+
+      dataSize = newSize;
+      return offset;
+    }
+
+    template<typename T>
+    static void ApplyAddComponent(Manager& ecs, Entity entity, void* data)
+    {
+      T* component = ecs.AddComponent<T>(entity);
+      if (component != nullptr) { *component = *(T*)data; }
+    }
+
+    template<typename T>
+    static void ApplyRemoveComponent(Manager& ecs, Entity entity, void* /* data */)
+    {
+      ecs.RemoveComponent<T>(entity);
+    }
+
+    template<typename T>
+    static void DestroyData(void* data)
+    {
+      ((T*)data)->~T();
+    }
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_COMMAND_BUFFER_HPP
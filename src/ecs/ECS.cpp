@@ -7,8 +7,21 @@
 // preprocessor
 #include "preprocessor/HasFunction.hpp"
 
+// containers
+#include "containers/FArray.hpp"
+#include "containers/RadixSort.hpp"
+
+// filesystem
+#include "filesystem/FileSystem.hpp"
+
 // ecs
 #include "ecs/ComponentRegistry.inl"
+#include "ecs/Prefab.hpp"
+#include "ecs/CommandBuffer.hpp"
+#include "ecs/Snapshot.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
 
 // systems
 #include "ecs/systems/TransformSystem.hpp"
@@ -18,22 +31,85 @@
 
 using namespace ECS;
 
+typedef void (*RemoveComponentFuncPtr)(Manager& ecs, Entity entity);
+typedef u32  (*RemoveEntitiesFuncPtr)(ComponentSparseSet& sparseSet, const DBitSet& entityIndices, u32 firstIndex);
+typedef void (*LoadSnapshotFuncPtr)(ComponentSparseSet& sparseSet, const byte* data, u32 count);
+
 struct InitComponentData
 {
   u64 size; // Must be sizeof(ComponentData<T>)
   u32 count;
+  u64 uuid;
+
+  // NOTE(WSWhitehouse): Type-erased removal, used when destroying entities...
+  RemoveComponentFuncPtr removeComponent;
+  RemoveEntitiesFuncPtr removeEntities;
+
+  // NOTE(WSWhitehouse): The snapshot version is 0 if the component hasn't opted into snapshots.
+  u32 snapshotVersion;
+  LoadSnapshotFuncPtr loadSnapshot;
 };
 
+template<typename T>
+static void RemoveComponentFromEntity(Manager& ecs, Entity entity)
+{
+  ecs.RemoveComponent<T>(entity);
+}
+
+template<typename T>
+static u32 RemoveComponentFromEntities(ComponentSparseSet& sparseSet, const DBitSet& entityIndices, u32 firstIndex)
+{
+  return sparseSet.RemoveEntities<T>(entityIndices, firstIndex);
+}
+
+template<typename T>
+static void LoadSnapshotComponents(ComponentSparseSet& sparseSet, const byte* data, u32 count)
+{
+  if constexpr (HAS_SNAPSHOT_SUPPORT<T>)
+  {
+    STATIC_ASSERT(std::is_trivially_copyable_v<T>, "Only trivially copyable components can opt into snapshots!");
+
+    sparseSet.EnsureComponentCapacity(count, Component<T>::MAX_COUNT);
+
+    ComponentData<T>* compArray = (ComponentData<T>*)sparseSet.componentArray;
+    mem_copy(compArray, data, sizeof(ComponentData<T>) * count);
+
+    for (u32 i = 0; i < count; ++i)
+    {
+      const u32 entityIndex = EntityIndex(compArray[i].entity);
+      sparseSet.EnsureSparseCapacity(entityIndex);
+      sparseSet.entitySparseArray[entityIndex] = i;
+      sparseSet.entityMask.Set(entityIndex);
+      sparseSet.changeVersions[i] = sparseSet.changeVersion;
+
+      ComponentSnapshot<T>::FixUp(compArray[i].component);
+    }
+
+    sparseSet.componentCount = count;
+  }
+}
+
+template<typename T>
+static consteval InitComponentData GetInitComponentDataForType()
+{
+  return InitComponentData
+    {
+      .size            = sizeof(ComponentData<T>),
+      .count           = ECS::Component<T>::MAX_COUNT,
+      .uuid            = ECS::Component<T>::UUID,
+      .removeComponent = RemoveComponentFromEntity<T>,
+      .removeEntities  = RemoveComponentFromEntities<T>,
+      .snapshotVersion = ComponentSnapshot<T>::SCHEMA_VERSION,
+      .loadSnapshot    = LoadSnapshotComponents<T>,
+    };
+}
+
 template <std::size_t... Is>
 static consteval auto GetInitComponentDataImpl(std::index_sequence<Is...>)
 {
   return FArray<InitComponentData, sizeof...(Is)>
     {
-      InitComponentData
-      {
-        .size  = sizeof(ComponentData<typename IndexToComponent<Is>::Type>),
-        .count = ECS::Component<typename IndexToComponent<Is>::Type>::MAX_COUNT,
-      }
+      GetInitComponentDataForType<typename IndexToComponent<Is>::Type>()
       ...
     };
 }
@@ -43,102 +119,1029 @@ static consteval FArray<InitComponentData, COMPONENT_COUNT> GetInitComponentData
   return GetInitComponentDataImpl(std::make_index_sequence<COMPONENT_COUNT>());
 }
 
+static constexpr FArray<InitComponentData, COMPONENT_COUNT> componentInitData = GetInitComponentData();
+
+STATIC_ASSERT(COMPONENT_COUNT <= ECS_MAX_SYSTEM_COMPONENT_COUNT, "Too many components for the SystemManager access masks!");
+STATIC_ASSERT(COMPONENT_COUNT <= 64, "Too many components for the entity component signatures!");
+
+template <std::size_t... Is>
+static const char* const* GetComponentNamesImpl(std::index_sequence<Is...>)
+{
+  static const char* const names[] = { ECS::Component<typename IndexToComponent<Is>::Type>::NAME... };
+  return names;
+}
+
+const char* Manager::GetComponentName(u64 componentIndex)
+{
+  if (componentIndex >= COMPONENT_COUNT) return "Unknown";
+  return GetComponentNamesImpl(std::make_index_sequence<COMPONENT_COUNT>())[componentIndex];
+}
+
+static void RegisterSystems(SystemManager& systemManager)
+{
+  // NOTE(WSWhitehouse): Systems that conflict are run in the order they are registered here...
+  systemManager.RegisterSystem("FlyCamSystem", FlyCamSystem::Update)
+    .Writes<FlyCam, Transform>()
+    .MainThreadOnly(); // Input & Window
+
+  systemManager.RegisterSystem("CameraSystem", CameraSystem::Update)
+    .Reads<Transform>()
+    .Writes<Camera>();
+
+  systemManager.RegisterSystem("TransformSystem", TransformSystem::Update)
+    .Writes<Transform>();
+
+  systemManager.RegisterSystem("SpriteSystem", SpriteSystem::Update)
+    .Reads<Sprite>()
+    .Writes<Transform>();
+}
+
+static void DeclareGroups(Manager& ecs)
+{
+  // NOTE(WSWhitehouse): Declaring a group reorders the sets it owns, so groups used while
+  // other sets are being iterated (i.e. by the renderer inside the camera view) are
+  // declared here, before anything can be iterating them...
+  (void)ecs.Group<Transform, MeshRenderer>();
+}
+
 void Manager::CreateECS()
 {
   // Components...
   components = (ComponentSparseSet*)mem_alloc(sizeof(ComponentSparseSet) * COMPONENT_COUNT);
-  static constexpr FArray<InitComponentData, COMPONENT_COUNT> componentInitData = GetInitComponentData();
 
   for (u32 i = 0; i < COMPONENT_COUNT; ++i)
   {
     ComponentSparseSet& sparseSet     = components[i];
     const InitComponentData& initData = componentInitData[i];
 
-    sparseSet.entitySparseArray = (u32*)mem_alloc(sizeof(u32) * MAX_ENTITY_COUNT);
-    sparseSet.componentArray    = mem_alloc(initData.size * initData.count);
+    // NOTE(WSWhitehouse): Start with a single chunk, the sets grow as components are added...
+    const u32 initialComponentCapacity = MIN(initData.count, ENTITY_CHUNK_SIZE);
+
+    sparseSet.entitySparseArray = (u32*)mem_alloc(sizeof(u32) * ENTITY_CHUNK_SIZE);
+    sparseSet.sparseCapacity    = ENTITY_CHUNK_SIZE;
+    sparseSet.componentArray    = mem_alloc(initData.size * initialComponentCapacity);
     sparseSet.componentCount    = 0;
+    sparseSet.componentCapacity = initialComponentCapacity;
     sparseSet.componentStride   = initData.size;
+    sparseSet.groupIndex        = NO_GROUP_INDEX;
+    sparseSet.changeVersions    = (u32*)mem_alloc(sizeof(u32) * initialComponentCapacity);
+    sparseSet.changeVersion     = FIRST_CHANGE_VERSION;
+
+    // NOTE(WSWhitehouse): The components array isn't constructed, reset the mask before creating it.
+    sparseSet.entityMask = {};
+    sparseSet.entityMask.Create(ENTITY_CHUNK_SIZE);
   }
 
+  changeVersion = FIRST_CHANGE_VERSION;
+
   // Entities...
-  availableEntities    = (Entity*)mem_alloc(sizeof(Entity) * MAX_ENTITY_COUNT);
-  availableEntityCount = MAX_ENTITY_COUNT;
+  entities            = nullptr;
+  componentSignatures = nullptr;
+  freeEntityIndices   = nullptr;
+  freeEntityCount     = 0;
+  entityHighWaterMark = 0;
+  entityCapacity      = 0;
+  aliveEntities       = {};
+  hierarchy.Create(0);
+  GrowEntityStorage();
 
-  for (u32 i = 0; i < MAX_ENTITY_COUNT; ++i)
+  // Command Buffers...
+  commandBufferCount = (u32)JobSystem::GetWorkerThreadCount() + 1;
+  commandBuffers     = (CommandBuffer*)mem_alloc(sizeof(CommandBuffer) * commandBufferCount);
+  for (u32 i = 0; i < commandBufferCount; ++i)
   {
-    availableEntities[i] = i;
+    new (&commandBuffers[i]) CommandBuffer();
+    commandBuffers[i].Create();
   }
+
+  // Groups...
+  DeclareGroups(*this);
+
+  // Systems...
+  systemManager.Create();
+  RegisterSystems(systemManager);
 }
 
 void Manager::DestroyECS()
 {
+  systemManager.Destroy();
+
+  for (u32 i = 0; i < commandBufferCount; ++i)
+  {
+    commandBuffers[i].Destroy();
+  }
+
+  mem_free(commandBuffers);
+  commandBuffers     = nullptr;
+  commandBufferCount = 0;
+
   for (u32 i = 0; i < COMPONENT_COUNT; ++i)
   {
     ComponentSparseSet& sparseSet = components[i];
 
     mem_free(sparseSet.entitySparseArray);
     mem_free(sparseSet.componentArray);
+    mem_free(sparseSet.changeVersions);
+    sparseSet.entityMask.Destroy();
 
     sparseSet.entitySparseArray = nullptr;
+    sparseSet.sparseCapacity    = 0;
     sparseSet.componentArray    = nullptr;
+    sparseSet.changeVersions    = nullptr;
     sparseSet.componentCount    = 0;
+    sparseSet.componentCapacity = 0;
   }
 
   mem_free(components);
   components = nullptr;
 
-  mem_free(availableEntities);
-  availableEntities    = nullptr;
-  availableEntityCount = 0;
+  for (u32 i = 0; i < groupCount; ++i)
+  {
+    groups[i].removedEntities.Destroy();
+  }
+  groupCount = 0;
+
+  mem_free(entities);
+  mem_free(componentSignatures);
+  mem_free(freeEntityIndices);
+  aliveEntities.Destroy();
+  hierarchy.Destroy();
+  entities            = nullptr;
+  componentSignatures = nullptr;
+  freeEntityIndices   = nullptr;
+  freeEntityCount     = 0;
+  entityHighWaterMark = 0;
+  entityCapacity      = 0;
 }
 
 void Manager::ResetECS()
 {
+  // NOTE(WSWhitehouse): Any recorded commands refer to entities from before the reset...
+  for (u32 i = 0; i < commandBufferCount; ++i)
+  {
+    commandBuffers[i].Clear();
+  }
+
+  // NOTE(WSWhitehouse): Every entity leaves its groups, recorded before the sets are cleared...
+  for (u32 i = 0; i < groupCount; ++i)
+  {
+    const ComponentSparseSet& firstSet = components[groups[i].ownedIndices[0]];
+    for (u32 denseIndex = 0; denseIndex < groups[i].size; ++denseIndex)
+    {
+      RecordGroupRemoval(i, *(const Entity*)((const byte*)firstSet.componentArray + ((u64)denseIndex * firstSet.componentStride)));
+    }
+
+    groups[i].size = 0;
+  }
+
   for (u32 i = 0; i < COMPONENT_COUNT; ++i)
   {
     ComponentSparseSet& sparseSet = components[i];
     sparseSet.componentCount      = 0;
+    sparseSet.entityMask.ClearAll();
   }
 
-  availableEntityCount = MAX_ENTITY_COUNT;
-  for (u32 i = 0; i < MAX_ENTITY_COUNT; ++i)
+  // NOTE(WSWhitehouse): Bump the generation of every used index so any handles
+  // from before the reset are stale, rather than aliasing the new entities...
+  for (u32 i = 0; i < entityHighWaterMark; ++i)
   {
-    availableEntities[i] = i;
+    entities[i]            = MakeEntity(i, EntityGeneration(entities[i]) + 1);
+    componentSignatures[i] = 0;
   }
+
+  aliveEntities.ClearAll();
+  hierarchy.Clear();
+  freeEntityCount     = 0;
+  entityHighWaterMark = 0;
+}
+
+void Manager::GrowEntityStorage()
+{
+  if (entityCapacity >= MAX_ENTITY_COUNT)
+  {
+    LOG_FATAL("No more available entities! Max entity count (%u) hit!", MAX_ENTITY_COUNT);
+    ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
+  }
+
+  // NOTE(WSWhitehouse): Grow by whole chunks, doubling the capacity so spawning
+  // millions of entities doesn't copy the storage once per chunk...
+  const u32 newCapacity = (u32)MIN(MAX((u64)entityCapacity * 2, (u64)entityCapacity + ENTITY_CHUNK_SIZE), (u64)MAX_ENTITY_COUNT);
+
+  entities            = (Entity*)mem_realloc(entities, sizeof(Entity) * newCapacity);
+  componentSignatures = (u64*)mem_realloc(componentSignatures, sizeof(u64) * newCapacity);
+  freeEntityIndices   = (u32*)mem_realloc(freeEntityIndices, sizeof(u32) * newCapacity);
+  aliveEntities.Resize(newCapacity);
+  hierarchy.Resize(newCapacity);
+
+  // NOTE(WSWhitehouse): New indices start at generation 0...
+  for (u32 i = entityCapacity; i < newCapacity; ++i)
+  {
+    entities[i]            = MakeEntity(i, 0);
+    componentSignatures[i] = 0;
+  }
+
+  entityCapacity = newCapacity;
 }
 
 Entity Manager::CreateEntity()
 {
-  if (availableEntityCount <= 0)
+  // Reuse a destroyed index first, its generation was bumped when it was destroyed...
+  if (freeEntityCount > 0)
+  {
+    freeEntityCount--;
+
+    const u32 entityIndex = freeEntityIndices[freeEntityCount];
+    aliveEntities.Set(entityIndex);
+    return entities[entityIndex];
+  }
+
+  if (entityHighWaterMark >= entityCapacity) { GrowEntityStorage(); }
+
+  const u32 entityIndex = entityHighWaterMark;
+  entityHighWaterMark++;
+
+  aliveEntities.Set(entityIndex);
+  return entities[entityIndex];
+}
+
+void Manager::CreateEntities(u32 count, Entity* outEntities)
+{
+  // Reuse destroyed indices first...
+  const u32 reuseCount = MIN(count, freeEntityCount);
+  for (u32 i = 0; i < reuseCount; ++i)
+  {
+    freeEntityCount--;
+
+    const u32 entityIndex = freeEntityIndices[freeEntityCount];
+    aliveEntities.Set(entityIndex);
+    outEntities[i] = entities[entityIndex];
+  }
+
+  const u32 newCount = count - reuseCount;
+  if (newCount == 0) return;
+
+  if ((u64)entityHighWaterMark + newCount > MAX_ENTITY_COUNT)
   {
-    LOG_FATAL("No more available entities!");
+    LOG_FATAL("No more available entities! Max entity count (%u) hit!", MAX_ENTITY_COUNT);
     ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
   }
 
-  Entity entity = availableEntities[0];
+  while (entityHighWaterMark + newCount > entityCapacity) { GrowEntityStorage(); }
+
+  for (u32 i = 0; i < newCount; ++i)
+  {
+    const u32 entityIndex = entityHighWaterMark + i;
+    aliveEntities.Set(entityIndex);
+    outEntities[reuseCount + i] = entities[entityIndex];
+  }
+
+  entityHighWaterMark += newCount;
+}
 
-  availableEntityCount--;
-  availableEntities[0] = availableEntities[availableEntityCount];
-  availableEntities[availableEntityCount] = NULL_ENTITY;
+void Manager::Instantiate(const Prefab& prefab, u32 count, Entity* outEntities)
+{
+  CreateEntities(count, outEntities);
 
-  return entity;
+  for (u32 i = 0; i < prefab.GetComponentCount(); ++i)
+  {
+    prefab.AddComponentsTo(i, *this, outEntities, count);
+  }
 }
 
 void Manager::DestroyEntity(Entity entity)
 {
-  // TODO(WSWhitehouse): Should remove all components from the entity that is being destroyed.
-  
-  availableEntities[availableEntityCount] = entity;
-  availableEntityCount++;
+  if (!IsAlive(entity))
+  {
+    LOG_ERROR("Trying to destroy an entity which isn't alive!");
+    return;
+  }
+
+  // NOTE(WSWhitehouse): Removing a component clears its bit in the signature, so
+  // take a copy rather than iterating the signature as it changes...
+  u64 signature = componentSignatures[EntityIndex(entity)];
+  while (signature != 0)
+  {
+    const u32 componentIndex = Bits::CountTrailingZeros64(signature);
+    signature &= signature - 1; // Clear lowest set bit...
+
+    componentInitData[componentIndex].removeComponent(*this, entity);
+  }
+
+  ReleaseEntity(entity);
+}
+
+void Manager::DestroyEntities(const Entity* entitiesToDestroy, u32 count)
+{
+  if (count == 0) return;
+
+  DBitSet destroyMask = {};
+  destroyMask.Create(entityCapacity);
+
+  u64 destroySignature = 0;
+  u32 firstDenseIndices[COMPONENT_COUNT];
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i) { firstDenseIndices[i] = U32_MAX; }
+
+  u32 groupRemovedCounts[ECS_MAX_GROUP_COUNT] = {};
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    const Entity entity = entitiesToDestroy[i];
+    if (!IsAlive(entity))
+    {
+      LOG_ERROR("Trying to destroy an entity which isn't alive!");
+      continue;
+    }
+
+    const u32 entityIndex = EntityIndex(entity);
+    if (destroyMask.Test(entityIndex)) continue;
+    destroyMask.Set(entityIndex);
+
+    // NOTE(WSWhitehouse): Only the sets before the first destroyed component
+    // are untouched by the compaction, so track the lowest dense index per set...
+    u64 signature = componentSignatures[entityIndex];
+    destroySignature |= signature;
+    while (signature != 0)
+    {
+      const u32 componentIndex = Bits::CountTrailingZeros64(signature);
+      signature &= signature - 1; // Clear lowest set bit...
+
+      const u32 denseIndex = components[componentIndex].entitySparseArray[entityIndex];
+      firstDenseIndices[componentIndex] = MIN(firstDenseIndices[componentIndex], denseIndex);
+    }
+
+    for (u32 groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+    {
+      const GroupData& group = groups[groupIndex];
+      const ComponentSparseSet& firstSet = components[group.ownedIndices[0]];
+      if (!firstSet.HasEntityIndex(entityIndex) || firstSet.entitySparseArray[entityIndex] >= group.size) continue;
+
+      groupRemovedCounts[groupIndex]++;
+      RecordGroupRemoval(groupIndex, entity);
+    }
+  }
+
+  // NOTE(WSWhitehouse): The compaction keeps the order of the remaining components and
+  // a group's entities are removed from every owned set, so each group stays packed at
+  // the front of its sets and only its size needs updating...
+  for (u64 signature = destroySignature; signature != 0; signature &= signature - 1)
+  {
+    const u32 componentIndex = Bits::CountTrailingZeros64(signature);
+    componentInitData[componentIndex].removeEntities(components[componentIndex], destroyMask, firstDenseIndices[componentIndex]);
+  }
+
+  for (u32 groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+  {
+    groups[groupIndex].size -= groupRemovedCounts[groupIndex];
+  }
+
+  destroyMask.ForEachSetBit([this](u64 entityIndex)
+  {
+    componentSignatures[entityIndex] = 0;
+    ReleaseEntity(entities[entityIndex]);
+  });
+
+  destroyMask.Destroy();
+}
+
+void Manager::ReleaseEntity(Entity entity)
+{
+  const u32 entityIndex = EntityIndex(entity);
+
+  // NOTE(WSWhitehouse): The children become roots, so their matrices are no longer relative to this entity...
+  if (hierarchy.IsMember(entityIndex))
+  {
+    for (Entity child = hierarchy.GetFirstChild(entity); child != NULL_ENTITY; child = hierarchy.GetNextSibling(child))
+    {
+      MarkTransformDirty(child);
+    }
+
+    hierarchy.RemoveEntity(entity);
+  }
+
+  entities[entityIndex] = MakeEntity(entityIndex, EntityGeneration(entity) + 1);
+  aliveEntities.Reset(entityIndex);
+
+  freeEntityIndices[freeEntityCount] = entityIndex;
+  freeEntityCount++;
+}
+
+b8 Manager::SetParent(Entity child, Entity parent)
+{
+  if (!IsAlive(child) || (parent != NULL_ENTITY && !IsAlive(parent)))
+  {
+    LOG_ERROR("Trying to set the parent of an entity which isn't alive!");
+    return false;
+  }
+
+  if (!hierarchy.SetParent(child, parent)) return false;
+
+  // NOTE(WSWhitehouse): The child's matrix has changed space, rebuild it and its subtree...
+  MarkTransformDirty(child);
+  return true;
+}
+
+void Manager::MarkTransformDirty(Entity entity)
+{
+  if (HasComponent<Transform>(entity))
+  {
+    GetComponent<Transform>(entity)->MarkDirty();
+  }
+}
+
+b8 Manager::IsAlive(Entity entity) const
+{
+  // NOTE(WSWhitehouse): A destroyed index has had its generation bumped, so a stale
+  // handle won't match the current handle for the index...
+  const u32 entityIndex = EntityIndex(entity);
+  if (entity == NULL_ENTITY || entityIndex >= entityHighWaterMark) return false;
+
+  return entities[entityIndex] == entity && aliveEntities.Test(entityIndex);
+}
+
+u32 Manager::FindOrCreateGroup(const u32* componentIndices, u32 componentCount)
+{
+  // NOTE(WSWhitehouse): A set can only be owned by one group, so if the first set
+  // is already owned, the group must match exactly or the declaration is invalid...
+  const u32 existingGroupIndex = components[componentIndices[0]].groupIndex;
+  if (existingGroupIndex != NO_GROUP_INDEX)
+  {
+    b8 isSameGroup = groups[existingGroupIndex].ownedCount == componentCount;
+    for (u32 i = 0; i < componentCount && isSameGroup; ++i)
+    {
+      isSameGroup = components[componentIndices[i]].groupIndex == existingGroupIndex;
+    }
+
+    if (isSameGroup) return existingGroupIndex;
+
+    LOG_FATAL("Trying to create an ECS group with components already owned by another group!");
+    ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
+  }
+
+  if (groupCount >= ECS_MAX_GROUP_COUNT)
+  {
+    LOG_FATAL("Max ECS group count hit!");
+    ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
+  }
+
+  for (u32 i = 0; i < componentCount; ++i)
+  {
+    if (components[componentIndices[i]].groupIndex != NO_GROUP_INDEX)
+    {
+      LOG_FATAL("Trying to create an ECS group with components already owned by another group!");
+      ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
+    }
+  }
+
+  const u32 groupIndex = groupCount;
+  groupCount++;
+
+  GroupData& group = groups[groupIndex];
+  group.ownedCount = componentCount;
+  group.size       = 0;
+
+  for (u32 i = 0; i < componentCount; ++i)
+  {
+    group.ownedIndices[i] = componentIndices[i];
+    components[componentIndices[i]].groupIndex = groupIndex;
+  }
+
+  PackGroup(groupIndex);
+  return groupIndex;
+}
+
+void Manager::PackGroup(u32 groupIndex)
+{
+  GroupData& group = groups[groupIndex];
+  group.size       = 0;
+
+  u32 leadComponentIndex = group.ownedIndices[0];
+  for (u32 i = 1; i < group.ownedCount; ++i)
+  {
+    if (components[group.ownedIndices[i]].componentCount < components[leadComponentIndex].componentCount)
+    {
+      leadComponentIndex = group.ownedIndices[i];
+    }
+  }
+
+  // NOTE(WSWhitehouse): Pack the entities that already have every component to the
+  // front of each set. Only slots at or below the current index are swapped, so
+  // walking the smallest set in order visits every entity exactly once.
+  const ComponentSparseSet& leadSet = components[leadComponentIndex];
+  for (u32 i = 0; i < leadSet.componentCount; ++i)
+  {
+    const Entity entity = *(const Entity*)((const byte*)leadSet.componentArray + ((u64)i * leadSet.componentStride));
+    OnGroupComponentAdded(groupIndex, entity);
+  }
+}
+
+void Manager::OnGroupComponentAdded(u32 groupIndex, Entity entity)
+{
+  GroupData& group = groups[groupIndex];
+  const u32 entityIndex = EntityIndex(entity);
+
+  for (u32 i = 0; i < group.ownedCount; ++i)
+  {
+    if (!components[group.ownedIndices[i]].HasEntityIndex(entityIndex)) return;
+  }
+
+  // Already in the group...
+  if (components[group.ownedIndices[0]].entitySparseArray[entityIndex] < group.size) return;
+
+  for (u32 i = 0; i < group.ownedCount; ++i)
+  {
+    ComponentSparseSet& sparseSet = components[group.ownedIndices[i]];
+    sparseSet.SwapDense(sparseSet.entitySparseArray[entityIndex], group.size);
+  }
+
+  group.size++;
+}
+
+void Manager::OnGroupComponentRemoved(u32 groupIndex, Entity entity)
+{
+  GroupData& group = groups[groupIndex];
+
+  // NOTE(WSWhitehouse): If the entity is within the group in one set it's in the
+  // group in every set, so only the first set needs checking...
+  const u32 entityIndex = EntityIndex(entity);
+  const ComponentSparseSet& firstSet = components[group.ownedIndices[0]];
+  if (!firstSet.HasEntityIndex(entityIndex) || firstSet.entitySparseArray[entityIndex] >= group.size) return;
+
+  group.size--;
+  RecordGroupRemoval(groupIndex, entity);
+
+  // Move the entity just past the end of the group, the component is then
+  // removed with the usual swap with the last element in the dense array.
+  for (u32 i = 0; i < group.ownedCount; ++i)
+  {
+    ComponentSparseSet& sparseSet = components[group.ownedIndices[i]];
+    sparseSet.SwapDense(sparseSet.entitySparseArray[entityIndex], group.size);
+  }
+}
+
+void Manager::RecordGroupRemoval(u32 groupIndex, Entity entity)
+{
+  DArray<Entity>& removedEntities = groups[groupIndex].removedEntities;
+  if (!removedEntities.IsValid()) return;
+
+  removedEntities.Add(entity);
+}
+
+CommandBuffer& Manager::GetCommandBuffer()
+{
+  const u64 threadIndex = JobSystem::GetThreadIndex();
+  ASSERT_MSG(threadIndex < commandBufferCount, "Thread index is out of range of the ECS command buffers!");
+
+  return commandBuffers[threadIndex];
+}
+
+void Manager::PlaybackCommandBuffers()
+{
+  u64 totalCommandCount = 0;
+  u32 totalPendingCount = 0;
+  for (u32 i = 0; i < commandBufferCount; ++i)
+  {
+    totalCommandCount += commandBuffers[i].GetCommandCount();
+    totalPendingCount += commandBuffers[i].GetPendingEntityCount();
+  }
+
+  if (totalCommandCount == 0 && totalPendingCount == 0) return;
+
+  ASSERT_MSG(totalCommandCount < U32_MAX, "Too many ECS commands recorded in a single frame!");
+
+  // NOTE(WSWhitehouse): Create every pending entity in one go, each buffer's pending
+  // entities are a contiguous range in the array starting at its offset...
+  Entity* pendingEntities = (Entity*)mem_alloc(sizeof(Entity) * MAX(totalPendingCount, 1U));
+  CreateEntities(totalPendingCount, pendingEntities);
+
+  // Flatten the commands from every buffer, resolving the target entity...
+  struct PlaybackCommand
+  {
+    const CommandBuffer::Command* command;
+    void* data;
+    Entity entity;
+  };
+
+  PlaybackCommand* playbackCommands = (PlaybackCommand*)mem_alloc(sizeof(PlaybackCommand) * totalCommandCount);
+  u32* keys   = (u32*)mem_alloc(sizeof(u32) * totalCommandCount);
+  u32* values = (u32*)mem_alloc(sizeof(u32) * totalCommandCount);
+
+  Entity* destroyEntities = (Entity*)mem_alloc(sizeof(Entity) * totalCommandCount);
+  u32 destroyCount        = 0;
+
+  u32 commandIndex  = 0;
+  u32 pendingOffset = 0;
+  for (u32 i = 0; i < commandBufferCount; ++i)
+  {
+    const CommandBuffer& buffer = commandBuffers[i];
+    for (u64 j = 0; j < buffer.GetCommandCount(); ++j)
+    {
+      const CommandBuffer::Command& command = buffer.GetCommand(j);
+
+      PlaybackCommand& playback = playbackCommands[commandIndex];
+      playback.command = &command;
+      playback.data    = buffer.GetCommandData(command);
+      playback.entity  = command.isPending ? pendingEntities[pendingOffset + command.target] : (Entity)command.target;
+
+      // NOTE(WSWhitehouse): Destroy commands use U32_MAX as the key, so they're sorted after every component command...
+      keys[commandIndex]   = command.componentIndex;
+      values[commandIndex] = commandIndex;
+      commandIndex++;
+    }
+
+    pendingOffset += buffer.GetPendingEntityCount();
+  }
+
+  // NOTE(WSWhitehouse): The radix sort is stable, so commands for the same component
+  // type are still applied in the order they were recorded (per buffer)...
+  RadixSort::Sort(keys, values, totalCommandCount);
+
+  for (u64 i = 0; i < totalCommandCount; ++i)
+  {
+    const PlaybackCommand& playback = playbackCommands[values[i]];
+
+    if (!IsAlive(playback.entity))
+    {
+      LOG_WARN("ECS command buffer is trying to modify an entity which isn't alive!");
+      continue;
+    }
+
+    switch (playback.command->type)
+    {
+      case CommandBuffer::CommandType::ADD_COMPONENT:
+      case CommandBuffer::CommandType::REMOVE_COMPONENT:
+      {
+        playback.command->apply(*this, playback.entity, playback.data);
+        break;
+      }
+      case CommandBuffer::CommandType::DESTROY_ENTITY:
+      {
+        // NOTE(WSWhitehouse): Destroy commands are sorted last, so the entities are
+        // collected and destroyed in one batch after every component command...
+        destroyEntities[destroyCount] = playback.entity;
+        destroyCount++;
+        break;
+      }
+    }
+  }
+
+  DestroyEntities(destroyEntities, destroyCount);
+
+  mem_free(destroyEntities);
+  mem_free(values);
+  mem_free(keys);
+  mem_free(playbackCommands);
+  mem_free(pendingEntities);
+
+  for (u32 i = 0; i < commandBufferCount; ++i)
+  {
+    commandBuffers[i].Clear();
+  }
+}
+
+u32 Manager::AdvanceChangeVersion()
+{
+  const u32 previousVersion = changeVersion;
+  changeVersion++;
+
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    components[i].changeVersion = changeVersion;
+  }
+
+  return previousVersion;
+}
+
+static INLINE u64 AlignSnapshotOffset(u64 offset)
+{
+  return (offset + (SNAPSHOT_ALIGNMENT - 1)) & ~(SNAPSHOT_ALIGNMENT - 1);
+}
+
+static INLINE b8 IsSectionInSnapshot(u64 offset, u64 size, u64 snapshotSize)
+{
+  // NOTE(WSWhitehouse): The offsets come from the file, written so neither side can overflow...
+  return offset <= snapshotSize && size <= snapshotSize - offset;
+}
+
+SnapshotHeader Manager::GetSnapshotHeader() const
+{
+  SnapshotHeader header        = {};
+  header.magic                 = SNAPSHOT_MAGIC;
+  header.version               = SNAPSHOT_VERSION;
+  header.entityHighWaterMark   = entityHighWaterMark;
+  header.freeEntityCount       = freeEntityCount;
+  header.componentCount        = 0;
+
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    if (componentInitData[i].snapshotVersion != 0) { header.componentCount++; }
+  }
+
+  u64 offset = AlignSnapshotOffset(sizeof(SnapshotHeader));
+  header.entitiesOffset       = offset;
+  offset = AlignSnapshotOffset(offset + (sizeof(Entity) * entityHighWaterMark));
+  header.signaturesOffset     = offset;
+  offset = AlignSnapshotOffset(offset + (sizeof(u64) * entityHighWaterMark));
+  header.parentsOffset        = offset;
+  offset = AlignSnapshotOffset(offset + (sizeof(Entity) * entityHighWaterMark));
+  header.freeEntitiesOffset   = offset;
+  offset = AlignSnapshotOffset(offset + (sizeof(u32) * freeEntityCount));
+  header.componentTableOffset = offset;
+  offset = AlignSnapshotOffset(offset + (sizeof(SnapshotComponent) * header.componentCount));
+
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    if (componentInitData[i].snapshotVersion == 0) continue;
+    offset = AlignSnapshotOffset(offset + ((u64)components[i].componentStride * components[i].componentCount));
+  }
+
+  header.size = offset;
+  return header;
+}
+
+u64 Manager::GetSnapshotSize() const
+{
+  return GetSnapshotHeader().size;
+}
+
+void Manager::WriteSnapshot(byte* outData) const
+{
+  const SnapshotHeader header = GetSnapshotHeader();
+  mem_zero(outData, header.size);
+  mem_copy(outData, &header, sizeof(SnapshotHeader));
+
+  mem_copy(outData + header.entitiesOffset,   entities,            sizeof(Entity) * entityHighWaterMark);
+  mem_copy(outData + header.signaturesOffset, componentSignatures, sizeof(u64)    * entityHighWaterMark);
+  mem_copy(outData + header.freeEntitiesOffset, freeEntityIndices, sizeof(u32)    * freeEntityCount);
+
+  for (u32 i = 0; i < entityHighWaterMark; ++i)
+  {
+    const Entity parent = aliveEntities.Test(i) ? hierarchy.GetParent(entities[i]) : NULL_ENTITY;
+    mem_copy(outData + header.parentsOffset + (sizeof(Entity) * i), &parent, sizeof(Entity));
+  }
+
+  u64 offset = AlignSnapshotOffset(header.componentTableOffset + (sizeof(SnapshotComponent) * header.componentCount));
+
+  u32 tableIndex = 0;
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    const InitComponentData& initData = componentInitData[i];
+    if (initData.snapshotVersion == 0) continue;
+
+    const ComponentSparseSet& sparseSet = components[i];
+    const u64 blobSize = (u64)sparseSet.componentStride * sparseSet.componentCount;
+
+    SnapshotComponent entry;
+    entry.uuid          = initData.uuid;
+    entry.index         = i;
+    entry.schemaVersion = initData.snapshotVersion;
+    entry.stride        = (u32)sparseSet.componentStride;
+    entry.count         = sparseSet.componentCount;
+    entry.offset        = offset;
+
+    mem_copy(outData + header.componentTableOffset + (sizeof(SnapshotComponent) * tableIndex), &entry, sizeof(SnapshotComponent));
+    tableIndex++;
+
+    mem_copy(outData + offset, sparseSet.componentArray, blobSize);
+    offset = AlignSnapshotOffset(offset + blobSize);
+  }
+}
+
+b8 Manager::ReadSnapshot(const byte* data, u64 size)
+{
+  // NOTE(WSWhitehouse): The data may come straight from a mapped file, so it's validated
+  // completely before any state is touched. Nothing in it is assumed to be aligned,
+  // the header and table are copied out before they are read...
+  if (size < sizeof(SnapshotHeader))
+  {
+    LOG_ERROR("ECS snapshot is too small!");
+    return false;
+  }
+
+  // NOTE(WSWhitehouse): Loading resets the ECS, which would drop components that own
+  // resources (i.e. GPU buffers) without destroying them. They aren't saved in snapshots
+  // so can't be restored either, the caller must destroy them before loading...
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    if (componentInitData[i].snapshotVersion != 0 || components[i].componentCount == 0) continue;
+
+    LOG_ERROR("Can't load an ECS snapshot while there are '%s' components, they aren't saved in snapshots!",
+              GetComponentName(i));
+    return false;
+  }
+
+  SnapshotHeader header;
+  mem_copy(&header, data, sizeof(SnapshotHeader));
+
+  if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+  {
+    LOG_ERROR("ECS snapshot has an unknown format! (version: %u, expected: %u)", header.version, SNAPSHOT_VERSION);
+    return false;
+  }
+
+  const u64 highWaterMark = header.entityHighWaterMark;
+  const b8 validSections =
+    header.size <= size && highWaterMark <= MAX_ENTITY_COUNT && header.freeEntityCount <= highWaterMark &&
+    IsSectionInSnapshot(header.entitiesOffset,       sizeof(Entity) * highWaterMark,                            header.size) &&
+    IsSectionInSnapshot(header.signaturesOffset,     sizeof(u64)    * highWaterMark,                            header.size) &&
+    IsSectionInSnapshot(header.parentsOffset,        sizeof(Entity) * highWaterMark,                            header.size) &&
+    IsSectionInSnapshot(header.freeEntitiesOffset,   sizeof(u32)    * (u64)header.freeEntityCount,              header.size) &&
+    IsSectionInSnapshot(header.componentTableOffset, sizeof(SnapshotComponent) * (u64)header.componentCount, header.size);
+
+  if (!validSections)
+  {
+    LOG_ERROR("ECS snapshot is corrupt, a section is out of bounds!");
+    return false;
+  }
+
+  // NOTE(WSWhitehouse): A free index that appears twice would be handed out twice by
+  // CreateEntity, and one with components would leave them on a dead entity...
+  DBitSet freeEntities = {};
+  freeEntities.Create(MAX(highWaterMark, 1));
+
+  for (u32 i = 0; i < header.freeEntityCount; ++i)
+  {
+    u32 freeIndex;
+    mem_copy(&freeIndex, data + header.freeEntitiesOffset + (sizeof(u32) * i), sizeof(u32));
+
+    b8 valid = freeIndex < highWaterMark && !freeEntities.Test(freeIndex);
+    if (valid)
+    {
+      u64 savedSignature;
+      mem_copy(&savedSignature, data + header.signaturesOffset + (sizeof(u64) * freeIndex), sizeof(u64));
+      valid = savedSignature == 0;
+    }
+
+    if (!valid)
+    {
+      LOG_ERROR("ECS snapshot is corrupt, free entity index %u is invalid!", freeIndex);
+      freeEntities.Destroy();
+      return false;
+    }
+
+    freeEntities.Set(freeIndex);
+  }
+
+  // Match the saved component types to the current ones...
+  SnapshotComponent loadEntries[COMPONENT_COUNT];
+  b8 loadComponent[COMPONENT_COUNT] = {};
+
+  for (u32 i = 0; i < header.componentCount; ++i)
+  {
+    SnapshotComponent entry;
+    mem_copy(&entry, data + header.componentTableOffset + (sizeof(SnapshotComponent) * i), sizeof(SnapshotComponent));
+
+    u32 componentIndex = COMPONENT_COUNT;
+    for (u32 j = 0; j < COMPONENT_COUNT; ++j)
+    {
+      if (componentInitData[j].uuid == entry.uuid) { componentIndex = j; break; }
+    }
+
+    if (componentIndex == COMPONENT_COUNT)
+    {
+      LOG_WARN("ECS snapshot contains an unknown component type, skipping it! (uuid: %llu)", entry.uuid);
+      continue;
+    }
+
+    const InitComponentData& initData = componentInitData[componentIndex];
+    if (entry.schemaVersion != initData.snapshotVersion || entry.stride != initData.size)
+    {
+      LOG_WARN("ECS snapshot component '%s' doesn't match the current schema, skipping it! (version: %u, expected: %u)",
+               GetComponentName(componentIndex), entry.schemaVersion, initData.snapshotVersion);
+      continue;
+    }
+
+    if (entry.count > initData.count || !IsSectionInSnapshot(entry.offset, (u64)entry.stride * entry.count, header.size) ||
+        entry.index >= 64 || loadComponent[componentIndex])
+    {
+      LOG_ERROR("ECS snapshot is corrupt, component '%s' is invalid!", GetComponentName(componentIndex));
+      freeEntities.Destroy();
+      return false;
+    }
+
+    loadEntries[componentIndex]   = entry;
+    loadComponent[componentIndex] = true;
+  }
+
+  // NOTE(WSWhitehouse): Every component must belong to a saved entity that isn't free and had
+  // it in its signature, and no entity can appear twice, otherwise the sets would be corrupt...
+  DBitSet seenEntities = {};
+  seenEntities.Create(MAX(highWaterMark, 1));
+
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    if (!loadComponent[i]) continue;
+
+    const SnapshotComponent& entry = loadEntries[i];
+    seenEntities.ClearAll();
+
+    for (u32 j = 0; j < entry.count; ++j)
+    {
+      // NOTE(WSWhitehouse): ComponentData<T> always starts with the entity...
+      Entity entity;
+      mem_copy(&entity, data + entry.offset + ((u64)entry.stride * j), sizeof(Entity));
+
+      const u64 entityIndex = EntityIndex(entity);
+      b8 valid = entity != NULL_ENTITY && entityIndex < highWaterMark &&
+                 !seenEntities.Test(entityIndex) && !freeEntities.Test(entityIndex);
+
+      if (valid)
+      {
+        Entity savedEntity;
+        u64 savedSignature;
+        mem_copy(&savedEntity,    data + header.entitiesOffset   + (sizeof(Entity) * entityIndex), sizeof(Entity));
+        mem_copy(&savedSignature, data + header.signaturesOffset + (sizeof(u64)    * entityIndex), sizeof(u64));
+        valid = savedEntity == entity && (savedSignature & (1ULL << entry.index)) != 0;
+      }
+
+      if (!valid)
+      {
+        LOG_ERROR("ECS snapshot is corrupt, component '%s' belongs to an invalid entity!", GetComponentName(i));
+        seenEntities.Destroy();
+        freeEntities.Destroy();
+        return false;
+      }
+
+      seenEntities.Set(entityIndex);
+    }
+  }
+
+  seenEntities.Destroy();
+  freeEntities.Destroy();
+
+  // The snapshot is valid, replace the current state...
+  ResetECS();
+  while (entityCapacity < highWaterMark) { GrowEntityStorage(); }
+
+  mem_copy(entities,          data + header.entitiesOffset,     sizeof(Entity) * highWaterMark);
+  mem_copy(freeEntityIndices, data + header.freeEntitiesOffset, sizeof(u32)    * header.freeEntityCount);
+  entityHighWaterMark = (u32)highWaterMark;
+  freeEntityCount     = header.freeEntityCount;
+
+  for (u32 i = 0; i < entityHighWaterMark; ++i) { aliveEntities.Set(i); }
+  for (u32 i = 0; i < freeEntityCount;     ++i) { aliveEntities.Reset(freeEntityIndices[i]); }
+
+  // NOTE(WSWhitehouse): The signatures are rebuilt from the components that were loaded,
+  // the saved component indices may not match the current ones and skipped types must
+  // not be left in them...
+  for (u32 i = 0; i < COMPONENT_COUNT; ++i)
+  {
+    if (!loadComponent[i]) continue;
+
+    const SnapshotComponent& entry = loadEntries[i];
+    ComponentSparseSet& sparseSet  = components[i];
+    componentInitData[i].loadSnapshot(sparseSet, data + entry.offset, entry.count);
+
+    for (u32 j = 0; j < sparseSet.componentCount; ++j)
+    {
+      const Entity entity = *(const Entity*)((const byte*)sparseSet.componentArray + ((u64)j * sparseSet.componentStride));
+      componentSignatures[EntityIndex(entity)] |= 1ULL << i;
+    }
+  }
+
+  for (u32 i = 0; i < entityHighWaterMark; ++i)
+  {
+    Entity parent;
+    mem_copy(&parent, data + header.parentsOffset + (sizeof(Entity) * i), sizeof(Entity));
+
+    if (parent == NULL_ENTITY || !aliveEntities.Test(i) || !IsAlive(parent)) continue;
+    hierarchy.SetParent(entities[i], parent);
+  }
+
+  for (u32 i = 0; i < groupCount; ++i)
+  {
+    PackGroup(i);
+  }
+
+  return true;
+}
+
+b8 Manager::SaveSnapshot(const char* filePath) const
+{
+  const u64 snapshotSize = GetSnapshotSize();
+  byte* snapshot = (byte*)mem_alloc(snapshotSize);
+
+  WriteSnapshot(snapshot);
+  const b8 result = FileSystem::WriteAllFileContent(filePath, snapshot, snapshotSize);
+
+  mem_free(snapshot);
+  return result;
+}
+
+b8 Manager::LoadSnapshot(const char* filePath)
+{
+  FileSystem::MappedFile mappedFile;
+  if (!FileSystem::MapFile(filePath, &mappedFile)) return false;
+
+  const b8 result = ReadSnapshot(mappedFile.data, mappedFile.size);
+
+  FileSystem::UnmapFile(&mappedFile);
+  return result;
 }
 
 void Manager::SystemsUpdate()
 {
-  // Player Systems
-  FlyCamSystem::Update(*this);
-  CameraSystem::Update(*this);
+  systemManager.Update(*this);
 
-  // Transform
-  TransformSystem::Update(*this);
-  SpriteSystem::Update(*this);
+  // Sync point, apply the structural changes recorded by the systems...
+  PlaybackCommandBuffers();
 }
@@ -29,10 +29,18 @@
 #include "ecs/Entity.hpp"
 #include "ecs/managers/Component.hpp"
 #include "ecs/managers/SystemManager.hpp"
+#include "ecs/View.hpp"
+#include "ecs/Group.hpp"
+#include "ecs/Hierarchy.hpp"
 
 namespace ECS
 {
 
+  // Forward Declarations
+  struct Prefab;
+  struct CommandBuffer;
+  struct SnapshotHeader;
+
   struct Manager
   {
     // --- ECS SYSTEM MANAGEMENT --- //
@@ -43,12 +51,87 @@ namespace ECS
 
     // --- ENTITY MANAGEMENT --- //
     Entity CreateEntity();
+
+    /**
+    * @brief Destroy the entity and remove every component it owns. Uses the entity's
+    * component signature, so only the sets the entity is in are touched.
+    */
     void DestroyEntity(Entity entity);
 
+    /**
+    * @brief Destroy many entities at once, removing every component they own. Each
+    * component set the entities are in is compacted in a single pass, rather than a
+    * swap and group fix up per component. Entities that aren't alive are skipped.
+    * @param entitiesToDestroy Entities to destroy, duplicates are ignored.
+    * @param count Number of entities.
+    */
+    void DestroyEntities(const Entity* entitiesToDestroy, u32 count);
+
+    /**
+    * @brief Create many entities at once. Grows the entity storage at most once.
+    * @param count Number of entities to create.
+    * @param outEntities Array of at least `count` entities to write the new entities to.
+    */
+    void CreateEntities(u32 count, Entity* outEntities);
+
+    /**
+    * @brief Create many entities at once and clone every component in the prefab into
+    * them. Each component type is added to all the entities as a single batch, see
+    * AddComponents. See ECS::Prefab for more info.
+    * @param prefab Prefab to clone.
+    * @param count Number of entities to create.
+    * @param outEntities Array of at least `count` entities to write the new entities to.
+    */
+    void Instantiate(const Prefab& prefab, u32 count, Entity* outEntities);
+
+    /** @brief Returns true if the entity handle refers to a living entity, false for stale handles. */
+    [[nodiscard]] b8 IsAlive(Entity entity) const;
+
+    /** @brief Get the number of living entities. */
+    [[nodiscard]] INLINE u32 GetEntityCount() const noexcept { return entityHighWaterMark - freeEntityCount; }
+
+    /** @brief Get the number of entities that can be created before the entity storage grows. */
+    [[nodiscard]] INLINE u32 GetEntityCapacity() const noexcept { return entityCapacity; }
+
+    /**
+    * @brief Get the component signature of the entity, one bit per component index that
+    * the entity has. Doesn't check the entity is alive.
+    */
+    [[nodiscard]] INLINE u64 GetComponentSignature(Entity entity) const { return componentSignatures[EntityIndex(entity)]; }
+
+    // --- HIERARCHY --- //
+    /**
+    * @brief Set the parent of the child entity, passing NULL_ENTITY removes the parent.
+    * The Transform matrix of an entity with a parent is its world matrix, the parent's
+    * world matrix multiplied by its own TRS matrix, see TransformSystem. Must not be
+    * called while the systems are updating.
+    * @return True on success; false if either entity isn't alive or the parent is the
+    * child or one of its descendants.
+    */
+    b8 SetParent(Entity child, Entity parent);
+
+    /** @brief Get the parent of the entity, NULL_ENTITY if it doesn't have one. */
+    [[nodiscard]] INLINE Entity GetParent(Entity entity) const { return hierarchy.GetParent(entity); }
+
+    /** @brief Get the entity hierarchy, see ECS::Hierarchy. */
+    [[nodiscard]] INLINE Hierarchy& GetHierarchy() noexcept { return hierarchy; }
+    [[nodiscard]] INLINE const Hierarchy& GetHierarchy() const noexcept { return hierarchy; }
+
     // --- COMPONENT MANAGEMENT --- //
     template<typename T>
     T* AddComponent(Entity entity);
 
+    /**
+    * @brief Add the component to many entities at once, every new component is a copy
+    * of the initial value. See ComponentSparseSet::AddComponents for more info.
+    * @param entities Entities to add the component too, fails if it contains duplicates.
+    * @param count Number of entities.
+    * @param init The initial value of every new component.
+    * @return True on success; false otherwise, in which case no components are added.
+    */
+    template<typename T>
+    b8 AddComponents(const Entity* entities, u32 count, const T& init = {});
+
     template<typename T>
     void RemoveComponent(Entity entity);
 
@@ -58,19 +141,236 @@ namespace ECS
     template<typename T> [[nodiscard]]
     T* GetComponent(Entity entity) const;
 
+    /**
+    * @brief Get the component and mark it as changed, use this rather than GetComponent
+    * when modifying a component that is read by anything tracking changes (i.e. the
+    * renderer). Doesn't check the entity has the component, see GetComponent.
+    */
+    template<typename T> [[nodiscard]]
+    T* GetComponentForWrite(Entity entity);
+
+    /**
+    * @brief Mark the entity's component as changed, for components that were modified
+    * through GetComponent or a view. Does nothing if the entity doesn't have the component.
+    */
+    template<typename T>
+    void MarkChanged(Entity entity);
+
     template<typename T> [[nodiscard]]
     ComponentSparseSet* GetComponentSparseSet();
 
     template<typename T> [[nodiscard]]
     const ComponentSparseSet* GetComponentSparseSet() const;
 
+    // --- ENTITY QUERIES --- //
+    /**
+    * @brief Create a view over every entity that has *all* the component types,
+    * iterate it with `Each` or `ParallelEach`. See ECS::View for more info.
+    */
+    template<typename... Ts> [[nodiscard]]
+    ECS::View<Ts...> View() const;
+
+    /**
+    * @brief Get the owning group for the component types, declaring the group the
+    * first time it is called. Declaring a group reorders the owned sets so only do
+    * this outside of any iteration, groups used during iteration (i.e. rendering) are
+    * declared up front in CreateECS. See ECS::Group for more info.
+    */
+    template<typename... Ts> [[nodiscard]]
+    ECS::Group<Ts...> Group();
+
+    /**
+    * @brief Call the function for every entity that has left the group since the last
+    * call, because it was destroyed, lost one of the owned components or the ECS was
+    * reset. The removals are only recorded after the first call, and each call consumes
+    * them, so a group should only have one caller. An entity that has left and rejoined
+    * the group is still visited. See ECS::Group for more info.
+    * @param func Function with the signature `void(Entity entity)`, the entity may no longer be alive.
+    */
+    template<typename... Ts, typename Func>
+    void ForEachRemovedFromGroup(Func&& func);
+
+    /**
+    * @brief Call the function for every entity that has *all* the component types, in
+    * ascending entity order. Works on the per-component entity masks, so the query is a
+    * word-wise AND plus a bit scan rather than a HasComponent probe per entity. Components
+    * must not be added or removed for these types inside the function.
+    * @param func Function with the signature `void(Entity entity)`.
+    */
+    template<typename... Ts, typename Func>
+    void ForEachEntityWith(Func&& func) const;
+
+    /**
+    * @brief Write the set of entities that have *all* the component types into the bit set,
+    * one bit per entity index (see EntityIndex()).
+    * @param outMask Bit set to write to, (re)created to fit the entity capacity if required.
+    */
+    template<typename... Ts>
+    void GetEntitiesWith(DBitSet& outMask) const;
+
+    /** @brief Count the entities that have *all* the component types. */
+    template<typename... Ts> [[nodiscard]]
+    u64 CountEntitiesWith() const;
+
+    // --- CHANGE TRACKING --- //
+    /**
+    * @brief Get the current change version. Every component that is added, moved in its
+    * dense array, fetched with GetComponentForWrite or marked with MarkChanged is stamped
+    * with the current version.
+    */
+    [[nodiscard]] INLINE u32 GetChangeVersion() const noexcept { return changeVersion; }
+
+    /**
+    * @brief Start a new change version. Returns the previous version, which is newer than
+    * or equal to every stamp so far, use it as the version to pass to ForEachChangedSince
+    * next time. Anything consuming changes (i.e. uploading to the GPU) should do this
+    * after consuming them:
+    * `ecs.ForEachChangedSince<T>(lastVersion, Upload); lastVersion = ecs.AdvanceChangeVersion();`
+    * Must not be called while the systems are updating.
+    */
+    u32 AdvanceChangeVersion();
+
+    /**
+    * @brief Call the function for every component of the type that has changed since the
+    * version, in dense array order. A new ECS starts at version 1 so passing 0 visits
+    * every component. The function may write to the component but won't stamp it.
+    * @param version Version to compare against, see AdvanceChangeVersion().
+    * @param func Function with the signature `void(Entity entity, T& component, u32 denseIndex)`.
+    */
+    template<typename T, typename Func>
+    void ForEachChangedSince(u32 version, Func&& func);
+
+    /** @brief Count the components of the type that have changed since the version. */
+    template<typename T> [[nodiscard]]
+    u32 CountChangedSince(u32 version) const;
+
+    // --- COMMAND BUFFERS --- //
+    /**
+    * @brief Get the command buffer for the calling thread, used to record structural
+    * changes while iterating in parallel. See ECS::CommandBuffer for more info.
+    */
+    [[nodiscard]] CommandBuffer& GetCommandBuffer();
+
+    /**
+    * @brief Apply every command recorded in the command buffers then clear them. Pending
+    * entities are created first, then the add/remove commands are sorted by component type
+    * so each sparse set is written in a single run, then entities are destroyed. Commands
+    * for the same component type keep the order they were recorded in. Called at the end
+    * of SystemsUpdate, must not be called while any thread is recording commands.
+    */
+    void PlaybackCommandBuffers();
+
+    // --- SNAPSHOTS --- //
+    /**
+    * @brief Save a binary snapshot of the ECS to a file, see WriteSnapshot.
+    * @return True on success; false if the file couldn't be written.
+    */
+    b8 SaveSnapshot(const char* filePath) const;
+
+    /**
+    * @brief Replace the state of the ECS with a snapshot file. The file is memory mapped
+    * and read directly, see ReadSnapshot. Only plain data is restored: entities, the
+    * hierarchy and the components that opt into snapshots. Components that own resources
+    * (i.e. MeshRenderer, SdfVoxelGrid) aren't saved, they must be destroyed before loading
+    * and added again afterwards before the world can be rendered.
+    * @return True on success; false if the file couldn't be mapped or isn't a valid snapshot.
+    */
+    b8 LoadSnapshot(const char* filePath);
+
+    /** @brief Get the size in bytes of a snapshot of the current state, see WriteSnapshot. */
+    [[nodiscard]] u64 GetSnapshotSize() const;
+
+    /**
+    * @brief Write a binary snapshot of the ECS (see Snapshot.hpp for the format). The entity
+    * handles, free list, component signatures and parents are saved along with the dense
+    * array of every component type that has opted in with ComponentSnapshot, as a raw blob
+    * with its schema version. Other component types aren't saved.
+    * @param outData Buffer of at least GetSnapshotSize() bytes, doesn't need to be aligned.
+    */
+    void WriteSnapshot(byte* outData) const;
+
+    /**
+    * @brief Replace the state of the ECS with the snapshot, every existing entity and
+    * component is removed first (see ResetECS). Fails if any component that hasn't opted
+    * into snapshots exists, as the reset would drop it without releasing its resources
+    * (i.e. GPU buffers). The saved dense arrays are copied into
+    * the component sets as a single block each, then the sparse arrays, entity masks,
+    * hierarchy and groups are rebuilt from them. Components whose schema version
+    * or size doesn't match the current build are skipped, as are types that no longer
+    * exist. Entities keep the handles they had when the snapshot was written, so handles
+    * from before loading must not be used. Must not be called while the systems are updating.
+    * @param data Snapshot data, doesn't need to be aligned.
+    * @param size Size of the snapshot data in bytes.
+    * @return True on success; false if the snapshot is invalid, in which case the ECS is unchanged.
+    */
+    b8 ReadSnapshot(const byte* data, u64 size);
+
     // --- SYSTEMS MANAGEMENT --- //
+    /**
+    * @brief Run every registered system using the SystemManager schedule, then play
+    * back the command buffers. See ECS::SystemManager for more info.
+    */
     void SystemsUpdate();
 
+    [[nodiscard]] INLINE SystemManager& GetSystemManager() noexcept { return systemManager; }
+    [[nodiscard]] INLINE const SystemManager& GetSystemManager() const noexcept { return systemManager; }
+
+    /** @brief Get the name of the component type at the index, used by debug views. */
+    [[nodiscard]] static const char* GetComponentName(u64 componentIndex);
+
   private:
     ComponentSparseSet* components = nullptr;
-    Entity* availableEntities      = nullptr;
-    u32 availableEntityCount       = 0;
+    SystemManager systemManager    = {};
+
+    // NOTE(WSWhitehouse): One command buffer per thread, indexed by JobSystem::GetThreadIndex()...
+    CommandBuffer* commandBuffers = nullptr;
+    u32 commandBufferCount        = 0;
+
+    // NOTE(WSWhitehouse): The current handle (index + generation) for every entity index
+    // that has been used. Destroyed indices are pushed onto the free list and reused
+    // first, new indices are only taken from the high water mark when the list is empty.
+    Entity* entities        = nullptr;
+    u32* freeEntityIndices  = nullptr;
+    u32 freeEntityCount     = 0;
+    u32 entityHighWaterMark = 0;
+    u32 entityCapacity      = 0;
+    DBitSet aliveEntities   = {};
+
+    // NOTE(WSWhitehouse): The component signature of every entity index, one bit per
+    // component index. Destroying an entity only visits the sets in its signature...
+    u64* componentSignatures = nullptr;
+
+    Hierarchy hierarchy = {};
+
+    static inline constexpr const u32 FIRST_CHANGE_VERSION = 1;
+    u32 changeVersion = FIRST_CHANGE_VERSION;
+
+    void GrowEntityStorage();
+    void MarkTransformDirty(Entity entity);
+
+    /** @brief Return the entity index to the free list, its components must already be removed. */
+    void ReleaseEntity(Entity entity);
+
+    /** @brief Work out the layout of a snapshot of the current state, see WriteSnapshot. */
+    [[nodiscard]] SnapshotHeader GetSnapshotHeader() const;
+
+    /** @brief The number of mask words to process for a query, the smallest of the component masks. */
+    template<typename... Ts> [[nodiscard]]
+    INLINE u64 GetQueryWordCount() const
+    {
+      u64 wordCount = U64_MAX;
+      ((wordCount = MIN(wordCount, components[Component<Ts>::INDEX].entityMask.WordCount())), ...);
+      return wordCount;
+    }
+
+    GroupData groups[ECS_MAX_GROUP_COUNT] = {};
+    u32 groupCount                        = 0;
+
+    u32 FindOrCreateGroup(const u32* componentIndices, u32 componentCount);
+    void PackGroup(u32 groupIndex);
+    void OnGroupComponentAdded(u32 groupIndex, Entity entity);
+    void OnGroupComponentRemoved(u32 groupIndex, Entity entity);
+    void RecordGroupRemoval(u32 groupIndex, Entity entity);
   };
 
 } // namespace ECS
@@ -81,14 +381,58 @@ template<typename T>
 T* ECS::Manager::AddComponent(ECS::Entity entity)
 {
   ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
-  return sparseSet.AddComponent<T>(entity);
+  T* component = sparseSet.AddComponent<T>(entity);
+  if (component == nullptr) return nullptr;
+
+  componentSignatures[EntityIndex(entity)] |= 1ULL << Component<T>::INDEX;
+
+  // NOTE(WSWhitehouse): Joining a group moves the component, so get it again...
+  if (sparseSet.groupIndex != NO_GROUP_INDEX)
+  {
+    OnGroupComponentAdded(sparseSet.groupIndex, entity);
+    component = sparseSet.GetComponent<T>(entity);
+  }
+
+  return component;
+}
+
+template<typename T>
+b8 ECS::Manager::AddComponents(const ECS::Entity* entities, u32 count, const T& init)
+{
+  if (count == 0) return true;
+
+  ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
+  if (sparseSet.AddComponents<T>(entities, count, init) == nullptr) return false;
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    componentSignatures[EntityIndex(entities[i])] |= 1ULL << Component<T>::INDEX;
+  }
+
+  if (sparseSet.groupIndex != NO_GROUP_INDEX)
+  {
+    for (u32 i = 0; i < count; ++i)
+    {
+      OnGroupComponentAdded(sparseSet.groupIndex, entities[i]);
+    }
+  }
+
+  return true;
 }
 
 template<typename T>
 void ECS::Manager::RemoveComponent(ECS::Entity entity)
 {
   ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
-  return sparseSet.RemoveComponent<T>(entity);
+  if (!sparseSet.HasComponent<T>(entity)) return;
+
+  if (sparseSet.groupIndex != NO_GROUP_INDEX)
+  {
+    OnGroupComponentRemoved(sparseSet.groupIndex, entity);
+  }
+
+  sparseSet.RemoveComponent<T>(entity);
+  componentSignatures[EntityIndex(entity)] &= ~(1ULL << Component<T>::INDEX);
 }
 
 template<typename T>
@@ -105,6 +449,22 @@ T* ECS::Manager::GetComponent(ECS::Entity entity) const
   return sparseSet.GetComponent<T>(entity);
 }
 
+template<typename T>
+T* ECS::Manager::GetComponentForWrite(ECS::Entity entity)
+{
+  ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
+  return sparseSet.GetComponentForWrite<T>(entity);
+}
+
+template<typename T>
+void ECS::Manager::MarkChanged(ECS::Entity entity)
+{
+  ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
+  if (!sparseSet.HasComponent<T>(entity)) return;
+
+  sparseSet.MarkChanged(sparseSet.entitySparseArray[EntityIndex(entity)]);
+}
+
 template<typename T>
 ECS::ComponentSparseSet* ECS::Manager::GetComponentSparseSet()
 {
@@ -117,4 +477,125 @@ const ECS::ComponentSparseSet* ECS::Manager::GetComponentSparseSet() const
   return &components[Component<T>::INDEX];
 }
 
+template<typename... Ts>
+ECS::View<Ts...> ECS::Manager::View() const
+{
+  ComponentSparseSet* const sets[] = { &components[Component<Ts>::INDEX]... };
+  return ECS::View<Ts...>(sets);
+}
+
+template<typename... Ts>
+ECS::Group<Ts...> ECS::Manager::Group()
+{
+  const u32 componentIndices[] = { (u32)Component<Ts>::INDEX... };
+  const u32 groupIndex = FindOrCreateGroup(componentIndices, sizeof...(Ts));
+
+  ComponentSparseSet* const sets[] = { &components[Component<Ts>::INDEX]... };
+  return ECS::Group<Ts...>(sets, groups[groupIndex].size);
+}
+
+template<typename... Ts, typename Func>
+void ECS::Manager::ForEachRemovedFromGroup(Func&& func)
+{
+  const u32 componentIndices[] = { (u32)Component<Ts>::INDEX... };
+  const u32 groupIndex = FindOrCreateGroup(componentIndices, sizeof...(Ts));
+
+  DArray<Entity>& removedEntities = groups[groupIndex].removedEntities;
+  if (!removedEntities.IsValid())
+  {
+    removedEntities.Create();
+    return;
+  }
+
+  for (u64 i = 0; i < removedEntities.Size(); ++i)
+  {
+    func(removedEntities[i]);
+  }
+
+  removedEntities.Clear();
+}
+
+template<typename... Ts, typename Func>
+void ECS::Manager::ForEachEntityWith(Func&& func) const
+{
+  STATIC_ASSERT(sizeof...(Ts) > 0, "ForEachEntityWith requires at least one component type!");
+
+  const u64* masks[]  = { components[Component<Ts>::INDEX].entityMask.words... };
+  const u64 wordCount = GetQueryWordCount<Ts...>();
+
+  BitSetOps::ForEachSetBitInAll(masks, sizeof...(Ts), wordCount, [this, &func](u64 bitIndex)
+  {
+    func(entities[bitIndex]);
+  });
+}
+
+template<typename... Ts>
+void ECS::Manager::GetEntitiesWith(DBitSet& outMask) const
+{
+  STATIC_ASSERT(sizeof...(Ts) > 0, "GetEntitiesWith requires at least one component type!");
+
+  const u64* masks[]  = { components[Component<Ts>::INDEX].entityMask.words... };
+  const u64 wordCount = GetQueryWordCount<Ts...>();
+
+  const u64 requiredBitCount = MAX((u64)entityCapacity, wordCount * BITSET_BITS_PER_WORD);
+  if (outMask.Size() < requiredBitCount) { outMask.Create(requiredBitCount); }
+
+  // NOTE(WSWhitehouse): The masks only grow to fit the entities that have the component,
+  // so every bit past the smallest mask is clear in the intersection...
+  outMask.ClearAll();
+  mem_copy(outMask.words, masks[0], sizeof(u64) * wordCount);
+  for (u64 i = 1; i < sizeof...(Ts); ++i)
+  {
+    BitSetOps::And(outMask.words, outMask.words, masks[i], wordCount);
+  }
+}
+
+template<typename... Ts>
+u64 ECS::Manager::CountEntitiesWith() const
+{
+  STATIC_ASSERT(sizeof...(Ts) > 0, "CountEntitiesWith requires at least one component type!");
+
+  const u64* masks[]  = { components[Component<Ts>::INDEX].entityMask.words... };
+  const u64 wordCount = GetQueryWordCount<Ts...>();
+
+  u64 count = 0;
+  for (u64 i = 0; i < wordCount; ++i)
+  {
+    u64 word = masks[0][i];
+    for (u64 mask = 1; mask < sizeof...(Ts); ++mask) { word &= masks[mask][i]; }
+    count += Bits::PopCount64(word);
+  }
+
+  return count;
+}
+
+template<typename T, typename Func>
+void ECS::Manager::ForEachChangedSince(u32 version, Func&& func)
+{
+  ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
+  ComponentData<T>* compArray   = (ComponentData<T>*)sparseSet.componentArray;
+
+  // NOTE(WSWhitehouse): A linear scan over the versions, which are tightly packed so
+  // even a large set with nothing changed is cheap to check...
+  for (u32 i = 0; i < sparseSet.componentCount; ++i)
+  {
+    if (sparseSet.changeVersions[i] <= version) continue;
+    func(compArray[i].entity, compArray[i].component, i);
+  }
+}
+
+template<typename T>
+u32 ECS::Manager::CountChangedSince(u32 version) const
+{
+  const ComponentSparseSet& sparseSet = components[Component<T>::INDEX];
+
+  u32 count = 0;
+  for (u32 i = 0; i < sparseSet.componentCount; ++i)
+  {
+    count += sparseSet.changeVersions[i] > version ? 1 : 0;
+  }
+
+  return count;
+}
+
 #endif //SNOWFLAKE_ECS_HPP
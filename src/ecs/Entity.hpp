@@ -6,14 +6,45 @@
 
 namespace ECS
 {
+  /**
+  * @brief An entity handle. The low ENTITY_INDEX_BITS are the index of the entity,
+  * which is used to look up its components. The high ENTITY_GENERATION_BITS are
+  * the generation of the entity, which is incremented every time the index is
+  * destroyed. This allows a recycled index to be told apart from a stale handle.
+  */
   typedef u32 Entity;
 
   // --- CONST DEFINITIONS --- //
+  static inline constexpr const u32 ENTITY_INDEX_BITS      = 22;
+  static inline constexpr const u32 ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS;
+  static inline constexpr const u32 ENTITY_INDEX_MASK      = (1U << ENTITY_INDEX_BITS) - 1U;
+  static inline constexpr const u32 ENTITY_GENERATION_MASK = (1U << ENTITY_GENERATION_BITS) - 1U;
+
   static inline constexpr const Entity NULL_ENTITY      = U32_MAX;
-  static inline constexpr const u32 MAX_ENTITY_COUNT    = 5000;
+
+  // NOTE(WSWhitehouse): The final index is reserved for the NULL_ENTITY.
+  static inline constexpr const u32 MAX_ENTITY_COUNT    = ENTITY_INDEX_MASK;
+
+  // NOTE(WSWhitehouse): The entity storage and sparse arrays grow in multiples of this
+  // many entities, so CreateEntity only allocates when every entity in storage is in use.
+  static inline constexpr const u32 ENTITY_CHUNK_SIZE   = 4096;
 
   // --- STATIC ASSERTS --- //
   STATIC_ASSERT(MAX_ENTITY_COUNT < U32_MAX, "Cannot support more than U32_MAX entities!");
+  STATIC_ASSERT(ENTITY_CHUNK_SIZE <= MAX_ENTITY_COUNT, "Entity chunk size is larger than the max entity count!");
+
+  // --- ENTITY HELPERS --- //
+  /** @brief Get the index of the entity, used to index into the sparse arrays. */
+  [[nodiscard]] INLINE constexpr u32 EntityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
+
+  /** @brief Get the generation of the entity. */
+  [[nodiscard]] INLINE constexpr u32 EntityGeneration(Entity entity) { return entity >> ENTITY_INDEX_BITS; }
+
+  /** @brief Create an entity handle from an index and generation. */
+  [[nodiscard]] INLINE constexpr Entity MakeEntity(u32 index, u32 generation)
+  {
+    return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+  }
 
 } // namespace ECS
 
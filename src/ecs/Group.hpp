@@ -0,0 +1,139 @@
+#ifndef SNOWFLAKE_ECS_GROUP_HPP
+#define SNOWFLAKE_ECS_GROUP_HPP
+
+#include "pch.hpp"
+
+#include <type_traits>
+
+// containers
+#include "containers/DArray.hpp"
+
+// ECS includes
+#include "ecs/Entity.hpp"
+#include "ecs/View.hpp"
+#include "ecs/managers/Component.hpp"
+
+#define ECS_MAX_GROUP_COUNT       8
+#define ECS_MAX_GROUP_OWNED_COUNT 4
+
+namespace ECS
+{
+
+  /**
+  * @brief The internal data for an owning group, stored in the ECS::Manager.
+  * The entities in the group are packed into [0, size) of every owned set.
+  */
+  struct GroupData
+  {
+    u32 ownedIndices[ECS_MAX_GROUP_OWNED_COUNT];
+    u32 ownedCount;
+    u32 size;
+
+    // NOTE(WSWhitehouse): Entities that have left the group since it was last consumed, see
+    // Manager::ForEachRemovedFromGroup. Only recorded once the array has been created...
+    DArray<Entity> removedEntities;
+  };
+
+  /**
+  * @brief An owning group over the component types. The group owns the component
+  * sets, every entity that has *all* the components is kept packed at the front of
+  * each owned dense array in the same order. So the `i`th component in one set
+  * belongs to the same entity as the `i`th component in every other set, and
+  * iterating the group is a linear walk over parallel arrays.
+  * The ordering is maintained by the ECS::Manager when components are added or
+  * removed. A component type can only be owned by a single group. Create groups with
+  * `ecs.Group<A, B>()`, which declares the group the first time it is called.
+  *
+  * Components of the grouped types *must not* be added or removed while iterating
+  * the group, doing so reorders the dense arrays.
+  * @tparam Ts Component types owned by the group.
+  */
+  template<typename... Ts>
+  struct Group
+  {
+    STATIC_ASSERT(sizeof...(Ts) > 0, "An ECS Group requires at least one component type!");
+    STATIC_ASSERT(sizeof...(Ts) <= ECS_MAX_GROUP_OWNED_COUNT, "ECS Group owns too many component types!");
+
+    static constexpr const u64 SET_COUNT = sizeof...(Ts);
+
+    Group(ComponentSparseSet* const (&_sets)[SET_COUNT], u32 _size)
+      : size(_size)
+    {
+      for (u64 i = 0; i < SET_COUNT; ++i) { sets[i] = _sets[i]; }
+    }
+
+    /** @brief Get the number of entities in the group. */
+    [[nodiscard]] INLINE u32 Size() const noexcept { return size; }
+
+    /**
+    * @brief Get the dense component array of an owned type, the first Size()
+    * elements are the group in the same order as every other owned set.
+    */
+    template<typename T> [[nodiscard]]
+    INLINE ComponentData<T>* Data() const
+    {
+      return (ComponentData<T>*)sets[IndexOf<T, Ts...>()]->componentArray;
+    }
+
+    /** @brief Get the entity at the index in the group. */
+    [[nodiscard]] INLINE Entity GetEntity(u32 index) const
+    {
+      return *(const Entity*)((const byte*)sets[0]->componentArray + ((u64)index * sets[0]->componentStride));
+    }
+
+    /**
+    * @brief Call the function for every entity in the group on the calling thread.
+    * @param func Function with the signature `void(Entity, Ts&...)` or `void(Ts&...)`.
+    */
+    template<typename Func>
+    INLINE void Each(Func&& func) const
+    {
+      EachInRange(func, 0, size, std::make_index_sequence<SET_COUNT>());
+    }
+
+    /**
+    * @brief Call the function for every entity in the group, splitting the group into
+    * batches across the JobSystem. See View::ParallelEach for the threading rules.
+    * @param func Function with the signature `void(Entity, Ts&...)` or `void(Ts&...)`.
+    * @param minBatchSize The minimum number of entities processed per batch.
+    */
+    template<typename Func>
+    INLINE void ParallelEach(Func&& func, u32 minBatchSize = ECS_VIEW_DEFAULT_MIN_BATCH_SIZE) const
+    {
+      ParallelForBatches(size, minBatchSize, [this, &func](u32 start, u32 end)
+      {
+        EachInRange(func, start, end, std::make_index_sequence<SET_COUNT>());
+      });
+    }
+
+  private:
+    ComponentSparseSet* sets[SET_COUNT];
+    u32 size;
+
+    template<typename T, typename First, typename... Rest>
+    static consteval u64 IndexOf()
+    {
+      if constexpr (std::is_same_v<T, First>) { return 0; }
+      else                                    { return 1 + IndexOf<T, Rest...>(); }
+    }
+
+    template<typename Func, std::size_t... Is>
+    INLINE void EachInRange(Func& func, u32 start, u32 end, std::index_sequence<Is...>) const
+    {
+      for (u32 i = start; i < end; ++i)
+      {
+        if constexpr (std::is_invocable_v<Func&, Entity, Ts&...>)
+        {
+          func(GetEntity(i), ((ComponentData<Ts>*)sets[Is]->componentArray)[i].component...);
+        }
+        else
+        {
+          func(((ComponentData<Ts>*)sets[Is]->componentArray)[i].component...);
+        }
+      }
+    }
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_GROUP_HPP
@@ -0,0 +1,258 @@
+#include "ecs/Hierarchy.hpp"
+
+// core
+#include "core/Logging.hpp"
+
+using namespace ECS;
+
+void Hierarchy::Create(u32 entityCapacity)
+{
+  parents     = nullptr;
+  firstChild  = nullptr;
+  nextSibling = nullptr;
+  prevSibling = nullptr;
+  handles     = nullptr;
+  capacity    = 0;
+  members     = {};
+
+  nodes        = nullptr;
+  rootOffsets  = nullptr;
+  nodeCount    = 0;
+  rootCount    = 0;
+  nodeCapacity = 0;
+  nodesDirty   = false;
+
+  Resize(entityCapacity);
+}
+
+void Hierarchy::Destroy()
+{
+  mem_free(parents);
+  mem_free(firstChild);
+  mem_free(nextSibling);
+  mem_free(prevSibling);
+  mem_free(handles);
+  members.Destroy();
+
+  mem_free(nodes);
+  mem_free(rootOffsets);
+
+  parents      = nullptr;
+  firstChild   = nullptr;
+  nextSibling  = nullptr;
+  prevSibling  = nullptr;
+  handles      = nullptr;
+  capacity     = 0;
+  nodes        = nullptr;
+  rootOffsets  = nullptr;
+  nodeCount    = 0;
+  rootCount    = 0;
+  nodeCapacity = 0;
+}
+
+void Hierarchy::Resize(u32 entityCapacity)
+{
+  if (entityCapacity <= capacity) return;
+
+  parents     = (Entity*)mem_realloc(parents,     sizeof(Entity) * entityCapacity);
+  firstChild  = (u32*)mem_realloc(firstChild,     sizeof(u32)    * entityCapacity);
+  nextSibling = (u32*)mem_realloc(nextSibling,    sizeof(u32)    * entityCapacity);
+  prevSibling = (u32*)mem_realloc(prevSibling,    sizeof(u32)    * entityCapacity);
+  handles     = (Entity*)mem_realloc(handles,     sizeof(Entity) * entityCapacity);
+  members.Resize(entityCapacity);
+
+  for (u32 i = capacity; i < entityCapacity; ++i)
+  {
+    parents[i]     = NULL_ENTITY;
+    firstChild[i]  = NO_LINK;
+    nextSibling[i] = NO_LINK;
+    prevSibling[i] = NO_LINK;
+    handles[i]     = NULL_ENTITY;
+  }
+
+  capacity = entityCapacity;
+}
+
+void Hierarchy::Clear()
+{
+  for (u32 i = 0; i < capacity; ++i)
+  {
+    parents[i]     = NULL_ENTITY;
+    firstChild[i]  = NO_LINK;
+    nextSibling[i] = NO_LINK;
+    prevSibling[i] = NO_LINK;
+    handles[i]     = NULL_ENTITY;
+  }
+
+  members.ClearAll();
+  nodeCount  = 0;
+  rootCount  = 0;
+  nodesDirty = false;
+}
+
+b8 Hierarchy::SetParent(Entity child, Entity parent)
+{
+  const u32 childIndex = EntityIndex(child);
+
+  if (parent != NULL_ENTITY)
+  {
+    // NOTE(WSWhitehouse): Walk up from the new parent, if the child is found the
+    // parent is one of its descendants and the link would create a cycle...
+    for (Entity ancestor = parent; ancestor != NULL_ENTITY; ancestor = parents[EntityIndex(ancestor)])
+    {
+      if (EntityIndex(ancestor) == childIndex)
+      {
+        LOG_ERROR("Trying to parent an entity to itself or one of its descendants!");
+        return false;
+      }
+    }
+  }
+
+  Unlink(childIndex);
+  handles[childIndex] = child;
+
+  if (parent != NULL_ENTITY)
+  {
+    const u32 parentIndex = EntityIndex(parent);
+    handles[parentIndex]  = parent;
+
+    parents[childIndex]     = parent;
+    prevSibling[childIndex] = NO_LINK;
+    nextSibling[childIndex] = firstChild[parentIndex];
+
+    if (firstChild[parentIndex] != NO_LINK) { prevSibling[firstChild[parentIndex]] = childIndex; }
+    firstChild[parentIndex] = childIndex;
+
+    UpdateMembership(parentIndex);
+  }
+
+  UpdateMembership(childIndex);
+  nodesDirty = true;
+  return true;
+}
+
+void Hierarchy::RemoveEntity(Entity entity)
+{
+  const u32 entityIndex = EntityIndex(entity);
+  if (!IsMember(entityIndex)) return;
+
+  Unlink(entityIndex);
+
+  u32 child = firstChild[entityIndex];
+  while (child != NO_LINK)
+  {
+    const u32 next = nextSibling[child];
+
+    parents[child]     = NULL_ENTITY;
+    nextSibling[child] = NO_LINK;
+    prevSibling[child] = NO_LINK;
+    UpdateMembership(child);
+
+    child = next;
+  }
+
+  firstChild[entityIndex] = NO_LINK;
+  UpdateMembership(entityIndex);
+  nodesDirty = true;
+}
+
+void Hierarchy::UpdateNodes()
+{
+  if (!nodesDirty) return;
+  nodesDirty = false;
+
+  nodeCount = (u32)members.Count();
+  rootCount = 0;
+
+  if (nodeCount + 1 > nodeCapacity)
+  {
+    nodeCapacity = nodeCount + 1;
+    nodes        = (HierarchyNode*)mem_realloc(nodes, sizeof(HierarchyNode) * nodeCapacity);
+    rootOffsets  = (u32*)mem_realloc(rootOffsets, sizeof(u32) * nodeCapacity);
+  }
+
+  if (nodeCount == 0)
+  {
+    rootOffsets[0] = 0;
+    return;
+  }
+
+  struct StackEntry
+  {
+    u32 entityIndex;
+    u32 parentNode;
+    u32 depth;
+  };
+
+  StackEntry* stack = (StackEntry*)mem_alloc(sizeof(StackEntry) * nodeCount);
+  u32 stackSize     = 0;
+  u32 nodeIndex     = 0;
+
+  // NOTE(WSWhitehouse): Depth-first from every root, a node's children are pushed after
+  // it's written so they are all written (with their descendants) before the next entry
+  // below them on the stack. This keeps every subtree contiguous...
+  members.ForEachSetBit([&](u64 bit)
+  {
+    const u32 rootIndex = (u32)bit;
+    if (parents[rootIndex] != NULL_ENTITY) return;
+
+    rootOffsets[rootCount] = nodeIndex;
+    rootCount++;
+
+    stack[stackSize] = { rootIndex, NO_HIERARCHY_NODE, 0 };
+    stackSize++;
+
+    while (stackSize > 0)
+    {
+      stackSize--;
+      const StackEntry entry = stack[stackSize];
+
+      nodes[nodeIndex] = { handles[entry.entityIndex], entry.parentNode, entry.depth };
+      const u32 parentNode = nodeIndex;
+      nodeIndex++;
+
+      for (u32 child = firstChild[entry.entityIndex]; child != NO_LINK; child = nextSibling[child])
+      {
+        stack[stackSize] = { child, parentNode, entry.depth + 1 };
+        stackSize++;
+      }
+    }
+  });
+
+  rootOffsets[rootCount] = nodeIndex;
+  ASSERT_MSG(nodeIndex == nodeCount, "Hierarchy contains a cycle or an unreachable node!");
+
+  mem_free(stack);
+}
+
+void Hierarchy::Unlink(u32 childIndex)
+{
+  if (parents[childIndex] == NULL_ENTITY) return;
+
+  const u32 parentIndex = EntityIndex(parents[childIndex]);
+  const u32 prev        = prevSibling[childIndex];
+  const u32 next        = nextSibling[childIndex];
+
+  if (prev != NO_LINK) { nextSibling[prev] = next; }
+  else                 { firstChild[parentIndex] = next; }
+
+  if (next != NO_LINK) { prevSibling[next] = prev; }
+
+  parents[childIndex]     = NULL_ENTITY;
+  prevSibling[childIndex] = NO_LINK;
+  nextSibling[childIndex] = NO_LINK;
+
+  UpdateMembership(parentIndex);
+}
+
+void Hierarchy::UpdateMembership(u32 entityIndex)
+{
+  if (parents[entityIndex] != NULL_ENTITY || firstChild[entityIndex] != NO_LINK)
+  {
+    members.Set(entityIndex);
+  }
+  else
+  {
+    members.Reset(entityIndex);
+  }
+}
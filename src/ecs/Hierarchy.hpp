@@ -0,0 +1,109 @@
+#ifndef SNOWFLAKE_ECS_HIERARCHY_HPP
+#define SNOWFLAKE_ECS_HIERARCHY_HPP
+
+#include "pch.hpp"
+
+// containers
+#include "containers/BitSet.hpp"
+
+// ECS includes
+#include "ecs/Entity.hpp"
+
+namespace ECS
+{
+
+  static inline constexpr const u32 NO_HIERARCHY_NODE = U32_MAX;
+
+  /** @brief An entity in the flattened hierarchy, see Hierarchy::GetNodes(). */
+  struct HierarchyNode
+  {
+    Entity entity;
+    u32 parentNode; // Index of the parent node, NO_HIERARCHY_NODE for roots
+    u32 depth;
+  };
+
+  /**
+  * @brief The parent/child relationships between entities, owned by the ECS::Manager
+  * (see Manager::SetParent). The links are stored per entity index as a parent plus an
+  * intrusive list of children, so changing a parent is O(1). Only entities with a parent
+  * or a child are part of the hierarchy.
+  *
+  * For iterating, the hierarchy is flattened into a single array in depth-first order
+  * (rebuilt lazily after the links change). Every parent comes before its children, so
+  * world matrices can be calculated in a single linear pass. Each root's subtree is a
+  * contiguous range of the array, so disjoint subtrees can be processed in parallel.
+  * Like the DArray it isn't set up during its ctor, call the Create/Destroy functions.
+  */
+  struct Hierarchy
+  {
+    void Create(u32 entityCapacity);
+    void Destroy();
+
+    /** @brief Grow the per entity storage, called when the entity storage grows. */
+    void Resize(u32 entityCapacity);
+
+    /** @brief Remove every relationship. */
+    void Clear();
+
+    /**
+    * @brief Set the parent of the child, passing NULL_ENTITY removes the parent.
+    * @return True on success; false if the parent is the child or one of its descendants.
+    */
+    b8 SetParent(Entity child, Entity parent);
+
+    /** @brief Remove the entity from the hierarchy, its children become roots. */
+    void RemoveEntity(Entity entity);
+
+    /** @brief Get the parent of the entity, NULL_ENTITY if it doesn't have one. */
+    [[nodiscard]] INLINE Entity GetParent(Entity entity) const { return parents[EntityIndex(entity)]; }
+
+    /** @brief Get the first child of the entity, NULL_ENTITY if it doesn't have any. */
+    [[nodiscard]] INLINE Entity GetFirstChild(Entity entity) const { return LinkToEntity(firstChild[EntityIndex(entity)]); }
+
+    /** @brief Get the next sibling of the entity, NULL_ENTITY if it is the last child. */
+    [[nodiscard]] INLINE Entity GetNextSibling(Entity entity) const { return LinkToEntity(nextSibling[EntityIndex(entity)]); }
+
+    /** @brief Returns true if the entity index has a parent or any children. Safe to call from multiple threads. */
+    [[nodiscard]] INLINE b8 IsMember(u32 entityIndex) const { return entityIndex < capacity && members.Test(entityIndex); }
+
+    /** @brief Rebuild the flattened hierarchy if the relationships have changed since it was last built. */
+    void UpdateNodes();
+
+    /** @brief Get the flattened hierarchy, see UpdateNodes(). */
+    [[nodiscard]] INLINE const HierarchyNode* GetNodes() const noexcept { return nodes; }
+    [[nodiscard]] INLINE u32 GetNodeCount() const noexcept { return nodeCount; }
+
+    /** @brief Get the number of root entities, root `i`'s subtree is the node range [GetRootOffset(i), GetRootOffset(i + 1)). */
+    [[nodiscard]] INLINE u32 GetRootCount() const noexcept { return rootCount; }
+    [[nodiscard]] INLINE u32 GetRootOffset(u32 rootIndex) const { return rootOffsets[rootIndex]; }
+
+  private:
+    static inline constexpr const u32 NO_LINK = U32_MAX;
+
+    // NOTE(WSWhitehouse): Indexed by entity index. The sibling lists hold entity indices,
+    // the parent holds the full handle so it can be returned directly...
+    Entity* parents   = nullptr;
+    u32* firstChild   = nullptr;
+    u32* nextSibling  = nullptr;
+    u32* prevSibling  = nullptr;
+    u32 capacity      = 0;
+    DBitSet members   = {};
+    Entity* handles   = nullptr; // The handle of every member, used to return links as entities
+
+    // Flattened hierarchy...
+    HierarchyNode* nodes = nullptr;
+    u32* rootOffsets     = nullptr;
+    u32 nodeCount        = 0;
+    u32 rootCount        = 0;
+    u32 nodeCapacity     = 0;
+    b8 nodesDirty        = false;
+
+    [[nodiscard]] INLINE Entity LinkToEntity(u32 link) const { return link == NO_LINK ? NULL_ENTITY : handles[link]; }
+
+    void Unlink(u32 childIndex);
+    void UpdateMembership(u32 entityIndex);
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_HIERARCHY_HPP
@@ -0,0 +1,148 @@
+#ifndef SNOWFLAKE_ECS_PREFAB_HPP
+#define SNOWFLAKE_ECS_PREFAB_HPP
+
+#include "pch.hpp"
+
+#include <new> // placement new
+
+// core
+#include "core/Logging.hpp"
+
+// ECS includes
+#include "ecs/ECS.hpp"
+
+#define ECS_MAX_PREFAB_COMPONENT_COUNT 16
+
+namespace ECS
+{
+
+  /**
+  * @brief A template set of components that can be cloned into many entities at once
+  * using ECS::Manager::Instantiate. Each component type is added to every new entity
+  * as a single batch (see Manager::AddComponents), so trivially copyable components
+  * are cloned with mem_copy. Components are copied as-is, any component that owns
+  * resources (i.e. GPU buffers) should be initialised after instantiating using the
+  * ComponentFactory, otherwise every entity will share the same resources. Like the
+  * DArray it isn't set up during its ctor, call the Create/Destroy functions.
+  */
+  struct Prefab
+  {
+    /** @brief Create the prefab with no components. */
+    INLINE void Create()
+    {
+      componentCount = 0;
+    }
+
+    /** @brief Destroy the prefab and free every component. */
+    INLINE void Destroy()
+    {
+      for (u32 i = 0; i < componentCount; ++i)
+      {
+        entries[i].destroy(entries[i].component);
+        mem_free(entries[i].component);
+      }
+
+      componentCount = 0;
+    }
+
+    /**
+    * @brief Set the component in the prefab, overwriting it if the prefab already has it.
+    * @param component Value of the component.
+    * @return Pointer to the component stored in the prefab, can be used to modify it.
+    */
+    template<typename T>
+    INLINE T* Set(const T& component = {})
+    {
+      Entry* entry = FindEntry(Component<T>::INDEX);
+      if (entry != nullptr)
+      {
+        *(T*)entry->component = component;
+        return (T*)entry->component;
+      }
+
+      if (componentCount >= ECS_MAX_PREFAB_COMPONENT_COUNT)
+      {
+        LOG_ERROR("Max prefab component count hit, can't add '%s' Component!", Component<T>::NAME);
+        return nullptr;
+      }
+
+      entry = &entries[componentCount];
+      componentCount++;
+
+      entry->componentIndex = Component<T>::INDEX;
+      entry->component      = mem_alloc(sizeof(T));
+      entry->addComponents  = AddComponentsImpl<T>;
+      entry->destroy        = DestroyImpl<T>;
+      new (entry->component) T(component);
+
+      return (T*)entry->component;
+    }
+
+    /** @brief Check if the prefab has the component. */
+    template<typename T> [[nodiscard]]
+    INLINE b8 Has() const
+    {
+      return FindEntry(Component<T>::INDEX) != nullptr;
+    }
+
+    /** @brief Get the component stored in the prefab, returns nullptr if the prefab doesn't have it. */
+    template<typename T> [[nodiscard]]
+    INLINE T* Get() const
+    {
+      const Entry* entry = FindEntry(Component<T>::INDEX);
+      return entry != nullptr ? (T*)entry->component : nullptr;
+    }
+
+    /** @brief Get the number of components in the prefab. */
+    [[nodiscard]] INLINE u32 GetComponentCount() const noexcept { return componentCount; }
+
+    /**
+    * @brief Add the component at the index in the prefab to every entity.
+    * Used by ECS::Manager::Instantiate.
+    */
+    INLINE b8 AddComponentsTo(u32 index, Manager& ecs, const Entity* entities, u32 count) const
+    {
+      return entries[index].addComponents(ecs, entities, count, entries[index].component);
+    }
+
+  private:
+    typedef b8 (*AddComponentsFuncPtr)(Manager& ecs, const Entity* entities, u32 count, const void* component);
+    typedef void (*DestroyFuncPtr)(void* component);
+
+    struct Entry
+    {
+      u64 componentIndex;
+      void* component;
+      AddComponentsFuncPtr addComponents;
+      DestroyFuncPtr destroy;
+    };
+
+    Entry entries[ECS_MAX_PREFAB_COMPONENT_COUNT] = {};
+    u32 componentCount = 0;
+
+    [[nodiscard]] INLINE Entry* FindEntry(u64 componentIndex) const
+    {
+      for (u32 i = 0; i < componentCount; ++i)
+      {
+        if (entries[i].componentIndex == componentIndex) return (Entry*)&entries[i];
+      }
+
+      return nullptr;
+    }
+
+    template<typename T>
+    static b8 AddComponentsImpl(Manager& ecs, const Entity* entities, u32 count, const void* component)
+    {
+      return ecs.AddComponents<T>(entities, count, *(const T*)component);
+    }
+
+    template<typename T>
+    static void DestroyImpl(void* component)
+    {
+      ((T*)component)->~T();
+    }
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_PREFAB_HPP
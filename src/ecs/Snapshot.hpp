@@ -0,0 +1,70 @@
+#ifndef SNOWFLAKE_ECS_SNAPSHOT_HPP
+#define SNOWFLAKE_ECS_SNAPSHOT_HPP
+
+#include "pch.hpp"
+
+// ECS includes
+#include "ecs/Entity.hpp"
+
+/**
+* @file Snapshot.hpp
+* @brief The binary format of an ECS::Manager snapshot, see Manager::SaveSnapshot.
+*
+* LAYOUT:
+*  - SnapshotHeader
+*  - Entity[entityHighWaterMark]            The handle of every used entity index.
+*  - u64[entityHighWaterMark]               The component signature of every entity index.
+*  - Entity[entityHighWaterMark]            The parent of every entity index, NULL_ENTITY for none.
+*  - u32[freeEntityCount]                   The entity free list.
+*  - SnapshotComponent[componentCount]      One entry per saved component type.
+*  - ComponentData<T>[count] per entry      The dense component array, as raw bytes.
+*
+* Every section starts at a multiple of SNAPSHOT_ALIGNMENT from the start of the
+* snapshot. Values are stored in the native byte order, snapshots are only meant to
+* be loaded by the same build of the engine on the same platform.
+*
+* Only plain data components are saved, see ECS::ComponentSnapshot. Components that own
+* GPU resources (MeshRenderer, SdfVoxelGrid, SdfRenderer, etc.) don't keep a reference to
+* the asset they were created from, so they can't be recreated and must be set up again
+* by the world after loading.
+*/
+
+namespace ECS
+{
+
+  static inline constexpr const u32 SNAPSHOT_MAGIC     = 0x50414E53; // "SNAP"
+  static inline constexpr const u32 SNAPSHOT_VERSION   = 1;
+  static inline constexpr const u64 SNAPSHOT_ALIGNMENT = 64;
+
+  struct SnapshotHeader
+  {
+    u32 magic;
+    u32 version;
+    u64 size; // Size of the entire snapshot in bytes
+
+    u32 entityHighWaterMark;
+    u32 freeEntityCount;
+    u32 componentCount;
+    u32 padding;
+
+    // NOTE(WSWhitehouse): Byte offsets from the start of the snapshot...
+    u64 entitiesOffset;
+    u64 signaturesOffset;
+    u64 parentsOffset;
+    u64 freeEntitiesOffset;
+    u64 componentTableOffset;
+  };
+
+  struct SnapshotComponent
+  {
+    u64 uuid;          // Component<T>::UUID, used to find the type when loading
+    u32 index;         // Component<T>::INDEX when saved, used to remap the signatures
+    u32 schemaVersion; // ComponentSnapshot<T>::SCHEMA_VERSION
+    u32 stride;        // sizeof(ComponentData<T>)
+    u32 count;
+    u64 offset;        // Byte offset of the dense array from the start of the snapshot
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_SNAPSHOT_HPP
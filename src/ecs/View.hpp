@@ -0,0 +1,155 @@
+#ifndef SNOWFLAKE_ECS_VIEW_HPP
+#define SNOWFLAKE_ECS_VIEW_HPP
+
+#include "pch.hpp"
+
+#include <type_traits>
+
+// ECS includes
+#include "ecs/Entity.hpp"
+#include "ecs/managers/Component.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+// NOTE(WSWhitehouse): Below this entity count ParallelEach runs on the calling thread,
+// the cost of submitting jobs outweighs the benefit for small views.
+#define ECS_VIEW_DEFAULT_MIN_BATCH_SIZE 256
+
+namespace ECS
+{
+
+  /**
+  * @brief Split the range [0, count) into batches across the JobSystem, see
+  * JobSystem::ParallelForRanges. The calling thread takes the first batch and blocks
+  * until every batch is complete. Runs the whole range on the calling thread when it
+  * is too small to be worth splitting.
+  * @param count Number of elements in the range.
+  * @param minBatchSize The minimum number of elements processed per batch.
+  * @param func Function with the signature `void(u32 start, u32 end)`.
+  */
+  template<typename Func>
+  INLINE void ParallelForBatches(u32 count, u32 minBatchSize, const Func& func)
+  {
+    // NOTE(WSWhitehouse): The calling thread also takes a batch...
+    minBatchSize = MAX(minBatchSize, 1);
+    const u64 maxBatchCount = (count + minBatchSize - 1) / minBatchSize;
+    const u64 batchCount    = MIN(JobSystem::GetWorkerThreadCount() + 1, maxBatchCount);
+
+    JobSystem::ParallelForRanges(count, (u32)batchCount, func);
+  }
+
+  /**
+  * @brief A view over every entity that has *all* the component types. The view
+  * iterates the dense array of the smallest component set and skips entities that
+  * are missing any of the other components (a single bit test against each entity
+  * mask), then hands the function references to every component. Views are cheap
+  * to create and don't own any memory, create them with `ecs.View<A, B>()`.
+  *
+  * Components of the viewed types *must not* be added or removed while iterating
+  * the view, doing so moves components around in the dense arrays.
+  * @tparam Ts Component types in the view.
+  */
+  template<typename... Ts>
+  struct View
+  {
+    STATIC_ASSERT(sizeof...(Ts) > 0, "An ECS View requires at least one component type!");
+
+    static constexpr const u64 SET_COUNT = sizeof...(Ts);
+
+    explicit View(ComponentSparseSet* const (&_sets)[SET_COUNT])
+    {
+      leadSet = _sets[0];
+      for (u64 i = 0; i < SET_COUNT; ++i)
+      {
+        sets[i] = _sets[i];
+        if (sets[i]->componentCount < leadSet->componentCount) { leadSet = sets[i]; }
+      }
+    }
+
+    /**
+    * @brief The upper bound of entities in the view, this is the component
+    * count of the smallest set. The actual number of entities may be fewer.
+    */
+    [[nodiscard]] INLINE u32 SizeHint() const noexcept { return leadSet->componentCount; }
+
+    /** @brief Check if the entity has every component in the view. */
+    [[nodiscard]] INLINE b8 Contains(Entity entity) const
+    {
+      const u32 entityIndex = EntityIndex(entity);
+      for (u64 i = 0; i < SET_COUNT; ++i)
+      {
+        if (!sets[i]->HasEntityIndex(entityIndex)) return false;
+      }
+      return true;
+    }
+
+    /**
+    * @brief Call the function for every entity in the view on the calling thread.
+    * @param func Function with the signature `void(Entity, Ts&...)` or `void(Ts&...)`.
+    */
+    template<typename Func>
+    INLINE void Each(Func&& func) const
+    {
+      EachInRange(func, 0, leadSet->componentCount);
+    }
+
+    /**
+    * @brief Call the function for every entity in the view, splitting the view into
+    * batches across the JobSystem. The calling thread takes part and blocks until every
+    * batch is complete. The function is called concurrently so it *must* only write to
+    * the components it is given, or externally synchronise any other data.
+    * @param func Function with the signature `void(Entity, Ts&...)` or `void(Ts&...)`.
+    * @param minBatchSize The minimum number of entities processed per batch.
+    */
+    template<typename Func>
+    INLINE void ParallelEach(Func&& func, u32 minBatchSize = ECS_VIEW_DEFAULT_MIN_BATCH_SIZE) const
+    {
+      ParallelForBatches(leadSet->componentCount, minBatchSize, [this, &func](u32 start, u32 end)
+      {
+        EachInRange(func, start, end);
+      });
+    }
+
+  private:
+    ComponentSparseSet* sets[SET_COUNT];
+    ComponentSparseSet* leadSet;
+
+    /** @brief Get the entity at the dense index of the lead set, works for any component type. */
+    [[nodiscard]] INLINE Entity GetLeadEntity(u32 index) const
+    {
+      // NOTE(WSWhitehouse): The entity is the first member of every ComponentData<T>,
+      // so it can be read using the stride without knowing the lead component type.
+      const byte* componentData = (const byte*)leadSet->componentArray + ((u64)index * leadSet->componentStride);
+      return *(const Entity*)componentData;
+    }
+
+    template<typename Func, std::size_t... Is>
+    INLINE void Invoke(Func& func, Entity entity, std::index_sequence<Is...>) const
+    {
+      if constexpr (std::is_invocable_v<Func&, Entity, Ts&...>)
+      {
+        func(entity, *sets[Is]->template GetComponent<Ts>(entity)...);
+      }
+      else
+      {
+        func(*sets[Is]->template GetComponent<Ts>(entity)...);
+      }
+    }
+
+    template<typename Func>
+    INLINE void EachInRange(Func& func, u32 start, u32 end) const
+    {
+      for (u32 i = start; i < end; ++i)
+      {
+        const Entity entity = GetLeadEntity(i);
+        if (!Contains(entity)) continue;
+
+        Invoke(func, entity, std::make_index_sequence<SET_COUNT>());
+      }
+    }
+  };
+
+} // namespace ECS
+
+#endif //SNOWFLAKE_ECS_VIEW_HPP
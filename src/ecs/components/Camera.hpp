@@ -3,6 +3,9 @@
 
 #include "pch.hpp"
 
+// ecs
+#include "ecs/managers/Component.hpp"
+
 struct Camera
 {
   // Matrices
@@ -18,5 +21,13 @@ struct Camera
   glm::vec3 upAxis  = glm::vec3(0.0f, -1.0f, 0.0f);
 };
 
+template<>
+struct ECS::ComponentSnapshot<Camera>
+{
+  static constexpr const u32 SCHEMA_VERSION = 1;
+
+  // NOTE(WSWhitehouse): The matrices are rebuilt by the CameraSystem every update...
+  static INLINE void FixUp(Camera&) { }
+};
 
 #endif //SNOWFLAKE_CAMERA_HPP
@@ -3,6 +3,9 @@
 
 #include "pch.hpp"
 
+// ecs
+#include "ecs/managers/Component.hpp"
+
 struct FlyCam
 {
   f32 moveSpeed       = 10.0f;
@@ -11,4 +14,12 @@ struct FlyCam
   glm::vec2 prevMousePos;
 };
 
+template<>
+struct ECS::ComponentSnapshot<FlyCam>
+{
+  static constexpr const u32 SCHEMA_VERSION = 1;
+
+  static INLINE void FixUp(FlyCam&) { }
+};
+
 #endif //SNOWFLAKE_FLY_CAM_HPP
@@ -13,10 +13,15 @@
 #include "renderer/GraphicsPipeline.hpp"
 #include "renderer/Material.hpp"
 
+// containers
+#include "containers/AABBTree.hpp"
+#include "containers/DArray.hpp"
+
 // geometry
 #include "geometry/MeshGeometry.hpp"
 #include "geometry/Mesh.hpp"
 #include "geometry/Vertex.hpp"
+#include "geometry/Frustum.hpp"
 
 // ecs
 #include "ecs/ECS.hpp"
@@ -36,6 +41,18 @@ vk::Buffer CreateIndexBuffer(const void* indexArray, u64 indexCount, u64 sizeOfI
 static PipelineHandle pipelineHandle             = INVALID_PIPELINE_HANDLE;
 static VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
 
+// NOTE(WSWhitehouse): The ECS change version and camera the model data UBOs of each
+// frame in flight were last written with, see Render...
+static FArray<u32, MAX_FRAMES_IN_FLIGHT> modelDataVersions          = {0};
+static FArray<glm::mat4, MAX_FRAMES_IN_FLIGHT> modelDataViewProjMat = {glm::mat4(0.0f)};
+
+// NOTE(WSWhitehouse): World space bounds of every mesh renderer, used to cull them against
+// the camera frustum before recording. Updated from the entities that have changed or left
+// the group since the tree was last updated...
+static AABBTree cullingTree                = {};
+static u32 cullingTreeVersion              = 0;
+static DArray<ECS::Entity> visibleEntities = {};
+
 struct UBOModelData
 {
   alignas(16) glm::mat4 WVP;
@@ -62,6 +79,9 @@ void ComponentFactory::MeshRendererCreate(MeshRenderer* meshRenderer, const Mesh
     const MeshNode& node         = mesh->nodeArray[i];
     const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
 
+    const BoundingBox3D nodeBounds = geometry.CalculateBoundingBox(node.transformMatrix);
+    meshRenderer->localBounds = i == 0 ? nodeBounds : BoundingBox3D::Combine(meshRenderer->localBounds, nodeBounds);
+
     // REVIEW(WSWhitehouse): Is there a better way to create this temp array that isn't each loop iteration?
     const u64 vertexArraySize = sizeof(Vertex) * geometry.vertexCount;
     Vertex* vertexArray = (Vertex*)(mem_alloc(vertexArraySize));
@@ -121,6 +141,7 @@ void ComponentFactory::MeshRendererCreate(MeshRenderer* meshRenderer, const Mesh
   // Allocate renderer data array
   meshRenderer->bufferDataCount = 1;
   meshRenderer->bufferDataArray = (MeshBufferData*)(mem_alloc(sizeof(MeshBufferData)));
+  meshRenderer->localBounds     = mesh.CalculateBoundingBox();
 
   // Create buffers and initialise renderer data...
   {
@@ -187,20 +208,62 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
 {
   const GraphicsPipeline& pipeline = Renderer::GetGraphicsPipeline(pipelineHandle);
 
-  ComponentSparseSet* meshRendererSparseSet = ecs.GetComponentSparseSet<MeshRenderer>();
-  for (u32 meshIndex = 0; meshIndex < meshRendererSparseSet->componentCount; ++meshIndex)
+  // NOTE(WSWhitehouse): The model data UBOs are persistently mapped, so they only need
+  // writing when the entity has changed since this frame's UBOs were last written. Every
+  // WVP matrix depends on the camera, so all of them are written when it has moved...
+  const glm::mat4 viewProjMat = camera.projMatrix * camera.viewMatrix;
+  const b8 cameraChanged      = viewProjMat != modelDataViewProjMat[currentFrame];
+  const u32 sinceVersion      = cameraChanged ? 0 : modelDataVersions[currentFrame];
+
+  const ComponentSparseSet* transformSet    = ecs.GetComponentSparseSet<Transform>();
+  const ComponentSparseSet* meshRendererSet = ecs.GetComponentSparseSet<MeshRenderer>();
+
+  // NOTE(WSWhitehouse): Removed before the tree is updated, an entity that has rejoined the
+  // group (or a new entity reusing the index) has new components so is inserted again below...
+  ecs.ForEachRemovedFromGroup<Transform, MeshRenderer>([](Entity entity)
+  {
+    cullingTree.Remove(entity);
+  });
+
+  // NOTE(WSWhitehouse): The group keeps the Transform and MeshRenderer sets in the same
+  // order, so rendering walks both dense arrays linearly rather than gathering transforms.
+  // It's declared when the ECS is created, so this never reorders the Transform set while
+  // the renderer is iterating the cameras.
+  const ECS::Group<Transform, MeshRenderer> group = ecs.Group<Transform, MeshRenderer>();
+  const ComponentData<Transform>* transforms      = group.Data<Transform>();
+  ComponentData<MeshRenderer>* meshRenderers      = group.Data<MeshRenderer>();
+
+  for (u32 groupIndex = 0; groupIndex < group.Size(); ++groupIndex)
   {
-    ComponentData<MeshRenderer>& componentData = ((ComponentData<MeshRenderer>*)meshRendererSparseSet->componentArray)[meshIndex];
-    MeshRenderer& meshRenderer = componentData.component;
+    const Entity entity        = transforms[groupIndex].entity;
+    const Transform& transform = transforms[groupIndex].component;
+    MeshRenderer& meshRenderer = meshRenderers[groupIndex].component;
 
-    if (!meshRenderer.renderMesh) continue;
+    // NOTE(WSWhitehouse): Written even when the mesh isn't visible, renderMesh can be
+    // toggled and the camera moved without the component being marked as changed...
+    if (transformSet->ChangedSince(groupIndex, sinceVersion) || meshRendererSet->ChangedSince(groupIndex, sinceVersion))
+    {
+      UBOModelData modelData = {};
+      modelData.WVP      = transform.GetWVPMatrix(camera);
+      modelData.worldMat = transform.matrix;
+      mem_copy(meshRenderer.modelDataUBOMapped[currentFrame], &modelData, sizeof(modelData));
+    }
 
-    Transform* transform = ecs.GetComponent<Transform>(componentData.entity);
+    if (transformSet->ChangedSince(groupIndex, cullingTreeVersion) || meshRendererSet->ChangedSince(groupIndex, cullingTreeVersion))
+    {
+      cullingTree.Update(entity, meshRenderer.localBounds.GetTransformed(transform.matrix));
+    }
+  }
+
+  visibleEntities.Clear();
+  cullingTree.QueryFrustum(Frustum::FromMatrix(viewProjMat), visibleEntities);
+
+  for (u32 i = 0; i < visibleEntities.Size(); ++i)
+  {
+    const Entity entity = visibleEntities[i];
 
-    UBOModelData modelData = {};
-    modelData.WVP      = transform->GetWVPMatrix(camera);
-    modelData.worldMat = transform->matrix;
-    mem_copy(meshRenderer.modelDataUBOMapped[currentFrame], &modelData, sizeof(modelData));
+    const MeshRenderer& meshRenderer = *ecs.GetComponent<MeshRenderer>(entity);
+    if (!meshRenderer.renderMesh) continue;
 
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout,
                             1, 1, &meshRenderer.descriptorSets[currentFrame], 0, nullptr);
@@ -221,9 +284,9 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
                        0, sizeof(Material::PushConstants), &pushConstant);
 
     // Draw mesh buffers...
-    for (u32 i = 0; i < meshRenderer.bufferDataCount; i++)
+    for (u32 bufferIndex = 0; bufferIndex < meshRenderer.bufferDataCount; bufferIndex++)
     {
-      const MeshBufferData& rendererData = meshRenderer.bufferDataArray[i];
+      const MeshBufferData& rendererData = meshRenderer.bufferDataArray[bufferIndex];
 
       const VkDeviceSize offsets[] = { 0 };
       vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &rendererData.vertexBuffer.buffer, offsets);
@@ -231,18 +294,30 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
       vkCmdDrawIndexed(cmdBuffer, rendererData.indexCount, 1, 0, 0, 0);
     }
   }
+
+  const u32 version = ecs.AdvanceChangeVersion();
+  modelDataViewProjMat[currentFrame] = viewProjMat;
+  modelDataVersions[currentFrame]    = version;
+  cullingTreeVersion                 = version;
 }
 
 static void CleanUp()
 {
   const vk::Device& device = Renderer::GetDevice();
   vkDestroyDescriptorSetLayout(device.logicalDevice, descriptorSetLayout, nullptr);
+
+  cullingTree.Destroy();
+  visibleEntities.Destroy();
 }
 
 static void CreatePipeline()
 {
   const vk::Device& device = Renderer::GetDevice();
 
+  cullingTree.Create();
+  cullingTreeVersion = 0;
+  visibleEntities.Create();
+
   // Create Mesh Descriptor Set Layout
   {
     LOG_INFO("\tCreating mesh descriptor set layout...");
@@ -6,6 +6,9 @@
 // containers
 #include "containers/FArray.hpp"
 
+// geometry
+#include "geometry/BoundingBox3D.hpp"
+
 // renderer
 #include "renderer/vk/Vulkan.hpp"
 
@@ -33,6 +36,9 @@ struct MeshRenderer
   glm::vec3 colour;
   glm::vec2 texTiling;
 
+  // NOTE(WSWhitehouse): Bounds of every mesh buffer in local space, used for culling...
+  BoundingBox3D localBounds = {};
+
   // --- UNIFORM BUFFERS & DESCRIPTOR SETS --- //
   FArray<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets     = {VK_NULL_HANDLE};
   FArray<vk::Buffer,      MAX_FRAMES_IN_FLIGHT> modelDataUBO       = {{}};
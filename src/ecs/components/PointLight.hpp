@@ -3,6 +3,9 @@
 
 #include "pch.hpp"
 
+// ecs
+#include "ecs/managers/Component.hpp"
+
 #define MAX_POINT_LIGHT_COUNT 1
 
 struct PointLight
@@ -11,6 +14,14 @@ struct PointLight
   f32 range        = 1.0f;
 };
 
+template<>
+struct ECS::ComponentSnapshot<PointLight>
+{
+  static constexpr const u32 SCHEMA_VERSION = 1;
+
+  static INLINE void FixUp(PointLight&) { }
+};
+
 // NOTE(WSWhitehouse): This component is used directly in the UBO (see
 // UniformBufferObjects.hpp). Variables are aligned ready for the GPU.
 struct RawPointLight
@@ -17,41 +17,32 @@
 #include "geometry/MeshGeometry.hpp"
 #include "geometry/Mesh.hpp"
 #include "geometry/Vertex.hpp"
+#include "geometry/Triangle.hpp"
 
 // ecs
 #include "ecs/ECS.hpp"
 #include "ecs/components/Transform.hpp"
 #include "ecs/ComponentFactory.hpp"
 
-#include "containers/BSPTree.hpp"
+// containers
+#include "containers/BVH.hpp"
 
 using namespace ECS;
 
 static PipelineHandle pipelineHandle             = INVALID_PIPELINE_HANDLE;
 static VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
 
+// NOTE(WSWhitehouse): Must match STACK_MAX_SIZE in "containers/stack.glsl". The shader pushes at
+// most one node per level of the BVH, any push past the max size is dropped by the shader...
+static inline constexpr const u32 SHADER_STACK_MAX_SIZE = 50;
+
 struct SdfDataUBO
 {
   alignas(16) glm::mat4x4 WVP;
   alignas(16) glm::mat4x4 worldMat;
   alignas(16) glm::mat4x4 invWorldMat;
 
-  alignas(16) glm::vec3 boundingBoxExtents;
-  alignas(04) u32 indexCount;
-};
-
-struct BSPNodeUBO
-{
-  alignas(16) Plane plane = {};
-
-  alignas(4) u32 isLeaf = 0;
-
-  // NOTE(WSWhitehouse): Should only link to other nodes if this is not a leaf
-  alignas(4) u32 nodePositive = U32_MAX;
-  alignas(4) u32 nodeNegative = U32_MAX;
-
-  alignas(4) u32 indexStart;
-  alignas(4) u32 indexCount;
+  alignas(04) u32 triangleCount;
 };
 
 // Forward Declarations
@@ -65,49 +56,37 @@ void ComponentFactory::SdfRendererCreate(ECS::Manager& ecs, SdfRenderer* sdfRend
 
   if (pipelineHandle == INVALID_PIPELINE_HANDLE) CreatePipeline();
 
-  BSPTree tree = {};
-  tree.BuildTree(mesh);
-
-  BSPNodeUBO* nodes = (BSPNodeUBO*)mem_alloc(sizeof(BSPNodeUBO) * tree.nodes.Size());
-  u32 indexCount = 0;
+  // NOTE(WSWhitehouse): The BVH nodes are uploaded as they are (see BVH::Node), the
+  // triangles are converted to the GPU layout with their normals precalculated...
+  BVH bvh = {};
+  bvh.Create(mesh);
 
-  for (u32 i = 0; i < tree.nodes.Size(); ++i)
+  if (bvh.nodeCount == 0)
   {
-    nodes[i] =
-      {
-        .plane        = tree.nodes[i].plane,
-        .isLeaf       = tree.nodes[i].isLeaf ? 1U : 0U,
-        .nodePositive = tree.nodes[i].nodePositive,
-        .nodeNegative = tree.nodes[i].nodeNegative,
-        .indexStart   = indexCount,
-        .indexCount   = tree.nodes[i].indexCount
-      };
-
-    indexCount += tree.nodes[i].indexCount;
+    LOG_FATAL("SdfRenderer: Mesh has no triangles!");
+    bvh.Destroy();
+    return;
   }
 
-  LOG_DEBUG("Index Count: %u", indexCount);
-  u32* indices = (u32*)mem_alloc(sizeof(u32) * indexCount);
-  u32 currentIndex = 0;
-  for (u32 i = 0; i < tree.nodes.Size(); ++i)
+  if (bvh.depth - 1 > SHADER_STACK_MAX_SIZE)
   {
-    mem_copy(&indices[currentIndex], tree.nodes[i].indices, sizeof(u32) * tree.nodes[i].indexCount);
-    currentIndex += tree.nodes[i].indexCount;
+    LOG_ERROR("SdfRenderer: BVH depth (%u) is larger than the shader stack (%u), nodes will be skipped when raymarching!",
+              bvh.depth, SHADER_STACK_MAX_SIZE);
   }
 
-//  const MeshGeometry testGeom = {
-//    .vertexArray = mesh->geometryArray[0].vertexArray,
-//    .indexArray  = indices,
-//    .vertexCount = mesh->geometryArray[0].vertexCount,
-//    .indexCount  = indexCount,
-//    .indexType   = IndexType::U32_TYPE,
-//  };
+  GPUTriangle* triangles = (GPUTriangle*)mem_alloc(sizeof(GPUTriangle) * bvh.triangleCount);
+  for (u32 i = 0; i < bvh.triangleCount; ++i)
+  {
+    const Triangle& triangle = bvh.triangles[i];
 
-//  Entity entity = ecs.CreateEntity();
-//  Transform* testTransform   = ecs.AddComponent<Transform>(entity);
-//  testTransform->position    = {0.0f, 4.0f, 0.0f};
-//  MeshRenderer* testRenderer = ecs.AddComponent<MeshRenderer>(entity);
-//  ComponentFactory::MeshRendererCreate(testRenderer, testGeom);
+    triangles[i] =
+      {
+        .a      = triangle.vertices[0],
+        .b      = triangle.vertices[1],
+        .c      = triangle.vertices[2],
+        .normal = triangle.CalculateNormal()
+      };
+  }
 
   const vk::Device& device = Renderer::GetDevice();
 
@@ -133,10 +112,10 @@ void ComponentFactory::SdfRendererCreate(ECS::Manager& ecs, SdfRenderer* sdfRend
     }
   }
 
-  // BSP Nodes
+  // BVH Nodes
   {
-    FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT>& dataUBO = sdfRenderer->bspNodesUBO;
-    const VkDeviceSize bufferSize = sizeof(BSPNodeUBO) * tree.nodes.Size();
+    FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT>& dataUBO = sdfRenderer->bvhNodesUBO;
+    const VkDeviceSize bufferSize = sizeof(BVH::Node) * bvh.nodeCount;
 
     for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
@@ -147,21 +126,21 @@ void ComponentFactory::SdfRendererCreate(ECS::Manager& ecs, SdfRenderer* sdfRend
 
       if (!success)
       {
-        LOG_FATAL("UBO BSP Nodes Buffer %i Creation Failed!", i);
+        LOG_FATAL("UBO BVH Nodes Buffer %i Creation Failed!", i);
         return;
       }
 
       void* mappedData;
       dataUBO[i].MapMemory(device, &mappedData);
-      mem_copy(mappedData, nodes, bufferSize);
+      mem_copy(mappedData, bvh.nodes, bufferSize);
       dataUBO[i].UnmapMemory(device);
     }
   }
 
-  // Indices Array
+  // Triangle Array
   {
-    FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT>& dataUBO = sdfRenderer->indicesUBO;
-    const VkDeviceSize bufferSize = sizeof(u32) * indexCount;
+    FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT>& dataUBO = sdfRenderer->trianglesUBO;
+    const VkDeviceSize bufferSize = sizeof(GPUTriangle) * bvh.triangleCount;
 
     for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
@@ -172,38 +151,13 @@ void ComponentFactory::SdfRendererCreate(ECS::Manager& ecs, SdfRenderer* sdfRend
 
       if (!success)
       {
-        LOG_FATAL("UBO Vertex Array Buffer %i Creation Failed!", i);
+        LOG_FATAL("UBO Triangle Array Buffer %i Creation Failed!", i);
         return;
       }
 
       void* mappedData;
       dataUBO[i].MapMemory(device, &mappedData);
-      mem_copy(mappedData, indices, bufferSize);
-      dataUBO[i].UnmapMemory(device);
-    }
-  }
-
-  // Vertices Array
-  {
-    FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT>& dataUBO = sdfRenderer->verticesUBO;
-    const VkDeviceSize bufferSize = sizeof(Vertex) * mesh->geometryArray[0].vertexCount;
-
-    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-      b8 success = dataUBO[i].Create(device, bufferSize,
-                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-      if (!success)
-      {
-        LOG_FATAL("UBO Vertex Array Buffer %i Creation Failed!", i);
-        return;
-      }
-
-      void* mappedData;
-      dataUBO[i].MapMemory(device, &mappedData);
-      mem_copy(mappedData, mesh->geometryArray[0].vertexArray, bufferSize);
+      mem_copy(mappedData, triangles, bufferSize);
       dataUBO[i].UnmapMemory(device);
     }
   }
@@ -245,71 +199,54 @@ void ComponentFactory::SdfRendererCreate(ECS::Manager& ecs, SdfRenderer* sdfRend
       dataDescriptorWrite.pImageInfo       = nullptr;
       dataDescriptorWrite.pTexelBufferView = nullptr;
 
-      // BSP Nodes UBO
-      VkDescriptorBufferInfo bspNodesBufferInfo = {};
-      bspNodesBufferInfo.buffer = sdfRenderer->bspNodesUBO[i].buffer;
-      bspNodesBufferInfo.offset = 0;
-      bspNodesBufferInfo.range  = sdfRenderer->bspNodesUBO[i].size;
-
-      VkWriteDescriptorSet bspNodesDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-      bspNodesDescriptorWrite.dstSet           = descriptorSets[i];
-      bspNodesDescriptorWrite.dstBinding       = 1;
-      bspNodesDescriptorWrite.dstArrayElement  = 0;
-      bspNodesDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-      bspNodesDescriptorWrite.descriptorCount  = 1;
-      bspNodesDescriptorWrite.pBufferInfo      = &bspNodesBufferInfo;
-      bspNodesDescriptorWrite.pImageInfo       = nullptr;
-      bspNodesDescriptorWrite.pTexelBufferView = nullptr;
-
-      // Index Array UBO
-      VkDescriptorBufferInfo indexBufferInfo = {};
-      indexBufferInfo.buffer = sdfRenderer->indicesUBO[i].buffer;
-      indexBufferInfo.offset = 0;
-      indexBufferInfo.range  = sdfRenderer->indicesUBO[i].size;
-
-      VkWriteDescriptorSet indexDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-      indexDescriptorWrite.dstSet           = descriptorSets[i];
-      indexDescriptorWrite.dstBinding       = 2;
-      indexDescriptorWrite.dstArrayElement  = 0;
-      indexDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-      indexDescriptorWrite.descriptorCount  = 1;
-      indexDescriptorWrite.pBufferInfo      = &indexBufferInfo;
-      indexDescriptorWrite.pImageInfo       = nullptr;
-      indexDescriptorWrite.pTexelBufferView = nullptr;
-
-      // Vertex Array UBO
-      VkDescriptorBufferInfo vertexBufferInfo = {};
-      vertexBufferInfo.buffer = sdfRenderer->verticesUBO[i].buffer;
-      vertexBufferInfo.offset = 0;
-      vertexBufferInfo.range  = sdfRenderer->verticesUBO[i].size;
-
-      VkWriteDescriptorSet vertexDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-      vertexDescriptorWrite.dstSet           = descriptorSets[i];
-      vertexDescriptorWrite.dstBinding       = 3;
-      vertexDescriptorWrite.dstArrayElement  = 0;
-      vertexDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-      vertexDescriptorWrite.descriptorCount  = 1;
-      vertexDescriptorWrite.pBufferInfo      = &vertexBufferInfo;
-      vertexDescriptorWrite.pImageInfo       = nullptr;
-      vertexDescriptorWrite.pTexelBufferView = nullptr;
+      // BVH Nodes UBO
+      VkDescriptorBufferInfo bvhNodesBufferInfo = {};
+      bvhNodesBufferInfo.buffer = sdfRenderer->bvhNodesUBO[i].buffer;
+      bvhNodesBufferInfo.offset = 0;
+      bvhNodesBufferInfo.range  = sdfRenderer->bvhNodesUBO[i].size;
+
+      VkWriteDescriptorSet bvhNodesDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      bvhNodesDescriptorWrite.dstSet           = descriptorSets[i];
+      bvhNodesDescriptorWrite.dstBinding       = 1;
+      bvhNodesDescriptorWrite.dstArrayElement  = 0;
+      bvhNodesDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      bvhNodesDescriptorWrite.descriptorCount  = 1;
+      bvhNodesDescriptorWrite.pBufferInfo      = &bvhNodesBufferInfo;
+      bvhNodesDescriptorWrite.pImageInfo       = nullptr;
+      bvhNodesDescriptorWrite.pTexelBufferView = nullptr;
+
+      // Triangle Array UBO
+      VkDescriptorBufferInfo triangleBufferInfo = {};
+      triangleBufferInfo.buffer = sdfRenderer->trianglesUBO[i].buffer;
+      triangleBufferInfo.offset = 0;
+      triangleBufferInfo.range  = sdfRenderer->trianglesUBO[i].size;
+
+      VkWriteDescriptorSet triangleDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      triangleDescriptorWrite.dstSet           = descriptorSets[i];
+      triangleDescriptorWrite.dstBinding       = 2;
+      triangleDescriptorWrite.dstArrayElement  = 0;
+      triangleDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      triangleDescriptorWrite.descriptorCount  = 1;
+      triangleDescriptorWrite.pBufferInfo      = &triangleBufferInfo;
+      triangleDescriptorWrite.pImageInfo       = nullptr;
+      triangleDescriptorWrite.pTexelBufferView = nullptr;
 
       const VkWriteDescriptorSet descriptorWrites[] =
         {
           dataDescriptorWrite,
-          bspNodesDescriptorWrite,
-          indexDescriptorWrite,
-          vertexDescriptorWrite
+          bvhNodesDescriptorWrite,
+          triangleDescriptorWrite
         };
 
       vkUpdateDescriptorSets(device.logicalDevice, ARRAY_SIZE(descriptorWrites), descriptorWrites, 0, nullptr);
     }
   }
 
-  mem_free(nodes);
-  mem_free(indices);
+  sdfRenderer->boundingBox   = bvh.GetBounds();
+  sdfRenderer->triangleCount = bvh.triangleCount;
 
-  sdfRenderer->boundingBox = mesh->geometryArray[0].CalculateBoundingBox();
-  sdfRenderer->indexCount  = indexCount;
+  mem_free(triangles);
+  bvh.Destroy();
 }
 
 void ComponentFactory::SdfRendererDestroy(SdfRenderer* sdfRenderer)
@@ -321,14 +258,11 @@ void ComponentFactory::SdfRendererDestroy(SdfRenderer* sdfRenderer)
     sdfRenderer->dataUBO[i].UnmapMemory(device);
     sdfRenderer->dataUBO[i].Destroy(device);
 
-    sdfRenderer->bspNodesUBO[i].UnmapMemory(device);
-    sdfRenderer->bspNodesUBO[i].Destroy(device);
+    sdfRenderer->bvhNodesUBO[i].UnmapMemory(device);
+    sdfRenderer->bvhNodesUBO[i].Destroy(device);
 
-    sdfRenderer->verticesUBO[i].UnmapMemory(device);
-    sdfRenderer->verticesUBO[i].Destroy(device);
-
-    sdfRenderer->indicesUBO[i].UnmapMemory(device);
-    sdfRenderer->indicesUBO[i].Destroy(device);
+    sdfRenderer->trianglesUBO[i].UnmapMemory(device);
+    sdfRenderer->trianglesUBO[i].Destroy(device);
   }
 
   vkFreeDescriptorSets(device.logicalDevice, Renderer::GetDescriptorPool(),
@@ -348,33 +282,25 @@ static void CreatePipeline()
     sdfDataLayoutBinding.pImmutableSamplers = nullptr;
     sdfDataLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    VkDescriptorSetLayoutBinding bspNodeLayoutBinding = {};
-    bspNodeLayoutBinding.binding            = 1;
-    bspNodeLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bspNodeLayoutBinding.descriptorCount    = 1;
-    bspNodeLayoutBinding.pImmutableSamplers = nullptr;
-    bspNodeLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    VkDescriptorSetLayoutBinding indexArrayLayoutBinding = {};
-    indexArrayLayoutBinding.binding            = 2;
-    indexArrayLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    indexArrayLayoutBinding.descriptorCount    = 1;
-    indexArrayLayoutBinding.pImmutableSamplers = nullptr;
-    indexArrayLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    VkDescriptorSetLayoutBinding vertexArrayLayoutBinding = {};
-    vertexArrayLayoutBinding.binding            = 3;
-    vertexArrayLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    vertexArrayLayoutBinding.descriptorCount    = 1;
-    vertexArrayLayoutBinding.pImmutableSamplers = nullptr;
-    vertexArrayLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutBinding bvhNodeLayoutBinding = {};
+    bvhNodeLayoutBinding.binding            = 1;
+    bvhNodeLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bvhNodeLayoutBinding.descriptorCount    = 1;
+    bvhNodeLayoutBinding.pImmutableSamplers = nullptr;
+    bvhNodeLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutBinding triangleArrayLayoutBinding = {};
+    triangleArrayLayoutBinding.binding            = 2;
+    triangleArrayLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    triangleArrayLayoutBinding.descriptorCount    = 1;
+    triangleArrayLayoutBinding.pImmutableSamplers = nullptr;
+    triangleArrayLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
 
     const VkDescriptorSetLayoutBinding bindings[] =
       {
         sdfDataLayoutBinding,
-        bspNodeLayoutBinding,
-        indexArrayLayoutBinding,
-        vertexArrayLayoutBinding
+        bvhNodeLayoutBinding,
+        triangleArrayLayoutBinding
       };
 
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
@@ -537,8 +463,7 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
     dataUbo->worldMat    = transform->matrix;
     dataUbo->invWorldMat = glm::inverse(transform->matrix);
 
-    dataUbo->boundingBoxExtents = renderer.boundingBox.GetExtents();
-    dataUbo->indexCount         = renderer.indexCount;
+    dataUbo->triangleCount = renderer.triangleCount;
 
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout,
                             1, 1, &renderer.descriptorSets[currentFrame], 0, nullptr);
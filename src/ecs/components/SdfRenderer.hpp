@@ -15,16 +15,15 @@
 struct SdfRenderer
 {
   BoundingBox3D boundingBox = {};
-  u32 indexCount = 0;
+  u32 triangleCount = 0;
 
   FArray<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets = {VK_NULL_HANDLE};
 
   FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> dataUBO       = {{}};
   FArray<void*,      MAX_FRAMES_IN_FLIGHT> dataUBOMapped = {nullptr};
 
-  FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> bspNodesUBO = {{}};
-  FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> indicesUBO  = {{}};
-  FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> verticesUBO = {{}};
+  FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> bvhNodesUBO  = {{}};
+  FArray<vk::Buffer, MAX_FRAMES_IN_FLIGHT> trianglesUBO = {{}};
 };
 
 #endif //SNOWFLAKE_SDF_RENDERER_HPP
@@ -19,6 +19,8 @@
 #include "geometry/Vertex.hpp"
 #include "geometry/BoundingBox3D.hpp"
 #include "geometry/Triangle.hpp"
+#include "geometry/SdfVolume.hpp"
+#include "geometry/SdfBakeCache.hpp"
 
 // ecs
 #include "ecs/components/Transform.hpp"
@@ -41,13 +43,19 @@ struct UBOCompTriDistInput
   alignas(04) u32 indexFormat;
 };
 
-struct UBOCompJumpFloodInput
+// NOTE(WSWhitehouse): Must match the JUMP_FLOOD_PASS defines in computeShared.glsl...
+enum class JumpFloodPass : u32
+{
+  INIT    = 0, // Every cell in the narrow band becomes a seed
+  JUMP    = 1, // Each cell keeps the closest seed of its neighbours at the jump offset
+  RESOLVE = 2, // The closest seed is converted into a signed distance
+};
+
+struct JumpFloodPushConstant
 {
   alignas(16) glm::uvec4 cellCount;
-  alignas(16) glm::vec3 cellSize;
-  alignas(04) u32 iteration;
+  alignas(04) JumpFloodPass passType;
   alignas(04) u32 jumpOffset;
-  alignas(04) f32 maxDist;
 };
 
 struct UBOActiveCells
@@ -69,9 +77,36 @@ struct UBOSdfVoxelData
   alignas(04) f32 voxelGridScale;
   alignas(04) f32 blend;
   alignas(04) b8 showBounds;
+
+  alignas(16) glm::uvec3 brickCount;
+  alignas(16) glm::uvec3 brickAtlasCount;
+  alignas(04) f32 distanceScale;
+  alignas(04) f32 distanceBias;
 };
 
 STATIC_ASSERT(sizeof(UBOSdfVoxelData) % 16 == 0);
+STATIC_ASSERT(sizeof(JumpFloodPushConstant) % 16 == 0);
+
+// NOTE(WSWhitehouse): Jump flooding seeds are packed with 10 bits per axis (see computeShared.glsl)...
+static inline constexpr const u32 JUMP_FLOOD_MAX_CELL_COUNT = 1024;
+
+// NOTE(WSWhitehouse): Extra passes with a jump offset of 1 after the power of two
+// passes (JFA+1), they fix most of the cells that were given the wrong seed...
+static inline constexpr const u32 JUMP_FLOOD_REFINE_PASSES = 1;
+
+// NOTE(WSWhitehouse): Every parameter that changes the baked volume, it is hashed with the mesh
+// to find the bake in the SdfBakeCache. It's zeroed before being set so the padding is always the same...
+struct SdfBakeCacheParams
+{
+  glm::uvec3 cellCount;
+  f32 narrowBand;
+  f32 unorm8NarrowBand;
+  f32 sweepFixedBand;
+  u32 sweepIterations;
+  SdfBakeMethod bakeMethod;
+  SdfStorage storage;
+  SdfFormat format;
+};
 
 // Compute Pipeline
 struct ComputePipeline
@@ -87,6 +122,10 @@ static ComputePipeline compNaiveDistPipeline    = {};
 static ComputePipeline compTriDistPipeline      = {};
 static ComputePipeline compJumpFloodingPipeline = {};
 
+// NOTE(WSWhitehouse): The jump flooding passes ping-pong between two seed
+// images, set i reads seed image i and writes the other...
+static VkDescriptorSet jumpFloodingDescriptorSets[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+
 // Graphics Pipeline
 static PipelineHandle pipelineHandle             = INVALID_PIPELINE_HANDLE;
 static VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
@@ -96,15 +135,31 @@ static b8 CreateNaiveDistComputePipeline();
 static b8 CreateTriDistComputePipeline();
 static b8 CreateJumpFloodingComputePipeline();
 
-static b8 Create3DImage(SdfVoxelGrid* voxelGrid);
+static b8 Create3DImage(SdfVoxelGrid* voxelGrid, VkExtent3D extent);
+static b8 CreateBrickGridBuffer(SdfVoxelGrid* voxelGrid, const void* data, u64 size);
+static void DestroyVolumeResources(SdfVoxelGrid* voxelGrid);
+static VkFormat GetImageFormat(SdfFormat format);
+static void LogEncodingError(const SdfEncoding& encoding, const f32* distances, const void* data, u64 count);
 
 static void DispatchNaiveMethod(SdfVoxelGrid* voxelGrid, const Mesh* mesh);
 static void DispatchJumpFloodingMethod(SdfVoxelGrid* voxelGrid, const Mesh* mesh);
+static void DispatchFastSweepingMethod(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout);
+static void CreateActiveCellsBuffer(SdfVoxelGrid* voxelGrid, Buffer* out_activeCells);
+static void BakeOnCPU(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout, b8 useWindingNumbers);
+static b8 BakeBricksOnCPU(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout, b8 useWindingNumbers);
+static void UploadImage(SdfVoxelGrid* voxelGrid, const void* data, u64 size, VkExtent3D extent);
+static void CopyBufferToImage(SdfVoxelGrid* voxelGrid, const vk::Buffer& stagingBuffer, VkExtent3D extent);
+static b8 CreateReadbackBuffer(vk::Buffer* out_readbackBuffer, u64 size);
+static b8 ReadbackComputeImage(SdfVoxelGrid* voxelGrid, void* out_data, u64 size);
+
+static b8 BakeVolume(SdfVoxelGrid* voxelGrid, SdfBakeMethod bakeMethod, const Mesh* mesh, const SdfGridLayout& layout);
+static b8 LoadFromBakeCache(SdfVoxelGrid* voxelGrid, u64 cacheKey, const SdfBakeCache::VolumeLayout& volumeLayout);
+static void SaveToBakeCache(SdfVoxelGrid* voxelGrid, u64 cacheKey);
 
 static void DispatchNaiveDistComputeShader(SdfVoxelGrid* voxelGrid, const MeshGeometry& geometry, const glm::mat4x4& transform);
 static void DispatchTriDistComputeShader(SdfVoxelGrid* voxelGrid, const MeshGeometry& geometry,
                                          const glm::mat4x4& transform, Buffer& activeCells);
-static void DispatchJumpFloodingPipeline(SdfVoxelGrid* voxelGrid, Buffer& activeCells);
+static void DispatchJumpFloodingPipeline(SdfVoxelGrid* voxelGrid);
 
 static void CreatePipeline();
 static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdBuffer, u32 currentFrame);
@@ -139,12 +194,12 @@ void SdfVoxelGrid::CleanUpComputePipeline()
   // Jump Flooding Compute Pipeline
   vkDestroyPipeline(device.logicalDevice, compJumpFloodingPipeline.pipeline, nullptr);
   vkDestroyPipelineLayout(device.logicalDevice, compJumpFloodingPipeline.pipelineLayout, nullptr);
-  vkFreeDescriptorSets(device.logicalDevice, Renderer::GetDescriptorPool(), 1, &compJumpFloodingPipeline.descriptorSet);
+  vkFreeDescriptorSets(device.logicalDevice, Renderer::GetDescriptorPool(), ARRAY_SIZE(jumpFloodingDescriptorSets), jumpFloodingDescriptorSets);
   vkDestroyDescriptorSetLayout(device.logicalDevice, compJumpFloodingPipeline.descriptorSetLayout, nullptr);
-  compJumpFloodingPipeline.inputBufferUBO.Destroy(device);
 }
 
-void SdfVoxelGrid::Create(SdfVoxelGrid* voxelGrid, b8 useJumpFlooding, const Mesh* mesh, glm::uvec3 uCellCount)
+void SdfVoxelGrid::Create(SdfVoxelGrid* voxelGrid, SdfBakeMethod bakeMethod, SdfStorage storage,
+                          SdfFormat format, const Mesh* mesh, glm::uvec3 uCellCount)
 {
   LOG_INFO("SdfVoxelGrid: Creating Voxel Grid from Mesh...");
 
@@ -153,60 +208,58 @@ void SdfVoxelGrid::Create(SdfVoxelGrid* voxelGrid, b8 useJumpFlooding, const Mes
   const vk::Device& device = Renderer::GetDevice();
 
   // Calculate Voxel Grid Values
+  const SdfGridLayout layout = SdfGridLayout::Calculate(mesh, uCellCount);
+  voxelGrid->cellCount        = layout.cellCount;
+  voxelGrid->gridExtent       = layout.gridExtent;
+  voxelGrid->gridCenterOffset = layout.gridCenterOffset;
+  voxelGrid->cellSize         = layout.cellSize;
+  voxelGrid->scalingFactor    = layout.scalingFactor;
+  voxelGrid->storage          = storage;
+  voxelGrid->brickCount       = { 0, 0, 0 };
+  voxelGrid->brickAtlasCount  = { 0, 0, 0 };
+  voxelGrid->encoding         = {};
+  voxelGrid->encoding.format  = format;
+
+  // NOTE(WSWhitehouse): The compute shaders write f32 distances straight into a dense image...
+  const b8 isGPUBakeMethod = bakeMethod == SdfBakeMethod::GPU_NAIVE         ||
+                             bakeMethod == SdfBakeMethod::GPU_JUMP_FLOODING ||
+                             bakeMethod == SdfBakeMethod::GPU_FAST_SWEEPING;
+  if (isGPUBakeMethod && (storage != SdfStorage::DENSE || format != SdfFormat::F32))
   {
-    // Calculate the bounding box for the entire mesh
-    BoundingBox3D boundingBox
-      {
-        .minimum = {F32_MAX, F32_MAX, F32_MAX},
-        .maximum = {F32_MIN, F32_MIN, F32_MIN}
-      };
-
-    for (u32 i = 0; i < mesh->nodeCount; ++i)
-    {
-      const MeshNode& node         = mesh->nodeArray[i];
-      const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
-
-      const BoundingBox3D geometryBoundingBox = geometry.CalculateBoundingBox(node.transformMatrix);
-      boundingBox = BoundingBox3D::Combine(boundingBox, geometryBoundingBox);
-    }
-
-    // Grid Extent
-    const glm::vec3 meshExtent  = boundingBox.GetSize();
-    const f32 maxExtentValue    = MAX(meshExtent.x, MAX(meshExtent.y, meshExtent.z));
-    const glm::vec3 gridExtent  = glm::vec3(maxExtentValue, maxExtentValue, maxExtentValue);
-    voxelGrid->gridExtent       = gridExtent;
-    voxelGrid->gridCenterOffset = boundingBox.GetCenter();
-
-    // Cell Count
-    const glm::vec3 cellCount = glm::vec3(uCellCount);
-    const u64 totalCellCount  = uCellCount.x * uCellCount.y * uCellCount.z;
-    voxelGrid->cellCount      = glm::uvec4(uCellCount.x, uCellCount.y, uCellCount.z, totalCellCount);
-
-    // Scaling Factor
-    const glm::vec3 cellSize      = gridExtent / cellCount;
-    const glm::vec3 scalingFactor = cellCount / (gridExtent + cellSize * 2.0f);
-    voxelGrid->scalingFactor      = MIN(scalingFactor.x, MIN(scalingFactor.y, scalingFactor.z));
-
-    // Cell Size
-    voxelGrid->cellSize = (gridExtent / cellCount) * scalingFactor;
+    LOG_WARN("SdfVoxelGrid: Only dense F32 grids can be baked on the GPU, using SdfBakeMethod::CPU instead.");
+    bakeMethod = SdfBakeMethod::CPU;
   }
 
-  const u64 memorySize = sizeof(f32) * voxelGrid->cellCount.w;
-  LOG_DEBUG("Grid Memory Size (MiB): %i", memorySize / 1024 / 1024);
-
-  if (!Create3DImage(voxelGrid))
+  if (bakeMethod == SdfBakeMethod::GPU_JUMP_FLOODING && glm::any(glm::greaterThan(uCellCount, glm::uvec3(JUMP_FLOOD_MAX_CELL_COUNT))))
   {
-    mem_free(voxelGrid);
-    return;
+    LOG_WARN("SdfVoxelGrid: Jump flooding supports up to %u cells on each axis, using SdfBakeMethod::CPU instead.", JUMP_FLOOD_MAX_CELL_COUNT);
+    bakeMethod = SdfBakeMethod::CPU;
   }
 
-  if (useJumpFlooding)
+  // NOTE(WSWhitehouse): The bake is skipped entirely when the cache has a volume
+  // for the same mesh and parameters, it is uploaded straight from the file...
+  SdfBakeCacheParams bakeParams;
+  mem_zero(&bakeParams, sizeof(SdfBakeCacheParams));
+  bakeParams.cellCount        = uCellCount;
+  bakeParams.narrowBand       = storage == SdfStorage::SPARSE_BRICKS ? SdfBrickVolume::DEFAULT_NARROW_BAND : 0.0f;
+  bakeParams.unorm8NarrowBand = SdfEncoding::UNORM8_NARROW_BAND;
+  bakeParams.sweepFixedBand   = bakeMethod == SdfBakeMethod::GPU_FAST_SWEEPING ? SdfVolume::DEFAULT_FIXED_BAND : 0.0f;
+  bakeParams.sweepIterations  = bakeMethod == SdfBakeMethod::GPU_FAST_SWEEPING ? SdfVolume::DEFAULT_SWEEP_ITERATIONS : 0;
+  bakeParams.bakeMethod       = bakeMethod;
+  bakeParams.storage          = storage;
+  bakeParams.format           = format;
+
+  const u64 cacheKey = SdfBakeCache::CalculateKey(mesh, &bakeParams, sizeof(SdfBakeCacheParams));
+
+  SdfBakeCache::VolumeLayout volumeLayout = {};
+  volumeLayout.format     = format;
+  volumeLayout.cellCount  = glm::uvec3(layout.cellCount);
+  volumeLayout.brickCount = storage == SdfStorage::SPARSE_BRICKS ? SdfBrickVolume::CalculateTopLevelCount(layout) : glm::uvec3(0);
+
+  if (!LoadFromBakeCache(voxelGrid, cacheKey, volumeLayout))
   {
-    DispatchJumpFloodingMethod(voxelGrid, mesh);
-  }
-  else
-  {
-    DispatchNaiveMethod(voxelGrid, mesh);
+    if (!BakeVolume(voxelGrid, bakeMethod, mesh, layout)) return;
+    SaveToBakeCache(voxelGrid, cacheKey);
   }
 
   // SDF Voxel Data
@@ -281,10 +334,24 @@ void SdfVoxelGrid::Create(SdfVoxelGrid* voxelGrid, b8 useJumpFlooding, const Mes
       voxelGridDescriptorWrite.descriptorCount = 1;
       voxelGridDescriptorWrite.pImageInfo      = &voxelGridInfo;
 
+      VkDescriptorBufferInfo brickGridInfo = {};
+      brickGridInfo.buffer = voxelGrid->brickGrid.buffer;
+      brickGridInfo.offset = 0;
+      brickGridInfo.range  = voxelGrid->brickGrid.size;
+
+      VkWriteDescriptorSet brickGridDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      brickGridDescriptorWrite.dstSet          = descriptorSets[i];
+      brickGridDescriptorWrite.dstBinding      = 2;
+      brickGridDescriptorWrite.dstArrayElement = 0;
+      brickGridDescriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      brickGridDescriptorWrite.descriptorCount = 1;
+      brickGridDescriptorWrite.pBufferInfo     = &brickGridInfo;
+
       VkWriteDescriptorSet descriptorWrites[] =
         {
           dataDescriptorWrite,
-          voxelGridDescriptorWrite
+          voxelGridDescriptorWrite,
+          brickGridDescriptorWrite
         };
 
       vkUpdateDescriptorSets(device.logicalDevice, ARRAY_SIZE(descriptorWrites), descriptorWrites, 0, nullptr);
@@ -298,9 +365,7 @@ void SdfVoxelGrid::Release(SdfVoxelGrid* sdfVolume)
 {
   const Device& device = Renderer::GetDevice();
 
-  vkDestroySampler(device.logicalDevice, sdfVolume->imageSampler, nullptr);
-  vkDestroyImageView(device.logicalDevice, sdfVolume->imageView, nullptr);
-  sdfVolume->image.Destroy(device);
+  DestroyVolumeResources(sdfVolume);
 
   vkFreeDescriptorSets(device.logicalDevice, Renderer::GetDescriptorPool(),
                        MAX_FRAMES_IN_FLIGHT, sdfVolume->descriptorSets.data);
@@ -311,21 +376,206 @@ void SdfVoxelGrid::Release(SdfVoxelGrid* sdfVolume)
   }
 }
 
-static b8 Create3DImage(SdfVoxelGrid* voxelGrid)
+static b8 BakeVolume(SdfVoxelGrid* voxelGrid, SdfBakeMethod bakeMethod, const Mesh* mesh, const SdfGridLayout& layout)
 {
-  LOG_INFO("SdfVoxelGrid: Creating Voxel Image...");
+  if (voxelGrid->storage == SdfStorage::SPARSE_BRICKS)
+  {
+    return BakeBricksOnCPU(voxelGrid, mesh, layout, bakeMethod == SdfBakeMethod::CPU_WINDING_NUMBER);
+  }
+
+  const u64 memorySize = (u64)voxelGrid->encoding.GetDistanceSize() * voxelGrid->cellCount.w;
+  LOG_DEBUG("Grid Memory Size (MiB): %i", memorySize / 1024 / 1024);
+
+  const VkExtent3D extent = { voxelGrid->cellCount.x, voxelGrid->cellCount.y, voxelGrid->cellCount.z };
+  if (!Create3DImage(voxelGrid, extent))
+  {
+    mem_free(voxelGrid);
+    return false;
+  }
+
+  switch (bakeMethod)
+  {
+    case SdfBakeMethod::GPU_NAIVE:          DispatchNaiveMethod(voxelGrid, mesh);                break;
+    case SdfBakeMethod::GPU_JUMP_FLOODING:  DispatchJumpFloodingMethod(voxelGrid, mesh);         break;
+    case SdfBakeMethod::GPU_FAST_SWEEPING:  DispatchFastSweepingMethod(voxelGrid, mesh, layout); break;
+    case SdfBakeMethod::CPU:                BakeOnCPU(voxelGrid, mesh, layout, false);           break;
+    case SdfBakeMethod::CPU_WINDING_NUMBER: BakeOnCPU(voxelGrid, mesh, layout, true);            break;
+
+    default:
+    {
+      LOG_FATAL("Unhandled SdfBakeMethod in switch statement!");
+      return false;
+    }
+  }
+
+  // NOTE(WSWhitehouse): The shader still binds the brick grid, so it is
+  // given a single empty brick even though it is never read...
+  const SdfBrickVolume::TopLevelCell emptyCell = { SdfBrickVolume::EMPTY_BRICK, F32_MAX };
+  return CreateBrickGridBuffer(voxelGrid, &emptyCell, sizeof(emptyCell));
+}
+
+static b8 LoadFromBakeCache(SdfVoxelGrid* voxelGrid, u64 cacheKey, const SdfBakeCache::VolumeLayout& volumeLayout)
+{
+  PROFILE_FUNC
+
+  SdfBakeCache::CacheFile cacheFile = {};
+  if (!SdfBakeCache::Open(cacheKey, volumeLayout, &cacheFile)) return false;
+
+  LOG_INFO("SdfVoxelGrid: Loading Volume from the Bake Cache...");
+
+  const Device& device                 = Renderer::GetDevice();
+  const SdfBakeCache::VolumeInfo& info = cacheFile.header.info;
+  const u64 imageSize                  = info.GetImageSize();
+
+  // NOTE(WSWhitehouse): The image is decompressed straight into the staging buffer, before
+  // any of the voxel grid is created so a corrupt file can still fall back to baking...
+  vk::Buffer stagingBuffer = {};
+  stagingBuffer.Create(device, imageSize,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  void* mapped;
+  stagingBuffer.MapMemory(device, &mapped);
+  const b8 imageRead = SdfBakeCache::ReadImage(cacheFile, mapped);
+  stagingBuffer.UnmapMemory(device);
+
+  if (!imageRead)
+  {
+    stagingBuffer.Destroy(device);
+    SdfBakeCache::Close(&cacheFile);
+    return false;
+  }
+
+  const SdfEncoding bakeEncoding = voxelGrid->encoding;
+
+  voxelGrid->encoding        = info.encoding;
+  voxelGrid->brickCount      = info.brickCount;
+  voxelGrid->brickAtlasCount = info.brickAtlasCount;
+
+  const VkExtent3D extent = { info.imageExtent.x, info.imageExtent.y, info.imageExtent.z };
+  b8 success = Create3DImage(voxelGrid, extent);
+
+  if (success)
+  {
+    CopyBufferToImage(voxelGrid, stagingBuffer, extent);
+    success = CreateBrickGridBuffer(voxelGrid, cacheFile.brickGrid, info.brickGridSize);
+  }
+
+  stagingBuffer.Destroy(device);
+  SdfBakeCache::Close(&cacheFile);
+
+  // NOTE(WSWhitehouse): The bake creates the volume again, so anything created
+  // from the file is destroyed and the voxel grid is put back how it was...
+  if (!success)
+  {
+    DestroyVolumeResources(voxelGrid);
+    voxelGrid->encoding        = bakeEncoding;
+    voxelGrid->brickCount      = { 0, 0, 0 };
+    voxelGrid->brickAtlasCount = { 0, 0, 0 };
+    return false;
+  }
+
+  LOG_INFO("SdfVoxelGrid: Loaded Volume from the Bake Cache!");
+  return true;
+}
+
+static void SaveToBakeCache(SdfVoxelGrid* voxelGrid, u64 cacheKey)
+{
+  PROFILE_FUNC
 
   const Device& device = Renderer::GetDevice();
 
-  // Create image
+  SdfBakeCache::VolumeInfo info = {};
+  info.encoding        = voxelGrid->encoding;
+  info.brickCount      = voxelGrid->brickCount;
+  info.brickAtlasCount = voxelGrid->brickAtlasCount;
+  info.brickGridSize   = voxelGrid->brickGrid.size;
+  info.imageExtent     = voxelGrid->storage == SdfStorage::SPARSE_BRICKS ?
+                         voxelGrid->brickAtlasCount * SdfBrickVolume::BRICK_SIZE :
+                         glm::uvec3(voxelGrid->cellCount);
+
+  const u64 imageSize    = info.GetImageSize();
+  const u64 readbackSize = imageSize + info.brickGridSize;
+
+  // NOTE(WSWhitehouse): The volume is read back from the GPU so every bake method is cached the same way...
+  vk::Buffer readbackBuffer = {};
+  if (!CreateReadbackBuffer(&readbackBuffer, readbackSize)) return;
+
+  // Copy the image and brick grid into the readback buffer
   {
-    const VkExtent3D extent =
+    const VkImageSubresourceRange subresourceRange =
       {
-        .width  = voxelGrid->cellCount.x,
-        .height = voxelGrid->cellCount.y,
-        .depth  = voxelGrid->cellCount.z
+        .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel   = 0,
+        .levelCount     = 1,
+        .baseArrayLayer = 0,
+        .layerCount     = 1
       };
 
+    const vk::CommandPool& cmdPool = Renderer::GetGraphicsCommandPool();
+    VkCommandBuffer cmdBuffer      = cmdPool.SingleTimeCommandBegin(device);
+
+    vk::Image::CmdTransitionBarrier(cmdBuffer, voxelGrid->image.image,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    subresourceRange);
+
+    VkBufferImageCopy imageCopy = {};
+    imageCopy.bufferOffset      = 0;
+    imageCopy.bufferRowLength   = 0;
+    imageCopy.bufferImageHeight = 0;
+    imageCopy.imageSubresource  =
+      {
+        .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevel       = 0,
+        .baseArrayLayer = 0,
+        .layerCount     = 1
+      };
+    imageCopy.imageOffset = { 0, 0, 0 };
+    imageCopy.imageExtent = { info.imageExtent.x, info.imageExtent.y, info.imageExtent.z };
+
+    vkCmdCopyImageToBuffer(cmdBuffer, voxelGrid->image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readbackBuffer.buffer, 1, &imageCopy);
+
+    vk::Image::CmdTransitionBarrier(cmdBuffer, voxelGrid->image.image,
+                                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    subresourceRange);
+
+    VkBufferCopy brickGridCopy = {};
+    brickGridCopy.srcOffset = 0;
+    brickGridCopy.dstOffset = imageSize;
+    brickGridCopy.size      = info.brickGridSize;
+    vkCmdCopyBuffer(cmdBuffer, voxelGrid->brickGrid.buffer, readbackBuffer.buffer, 1, &brickGridCopy);
+
+    // NOTE(WSWhitehouse): Make the copies visible to the CPU...
+    VkMemoryBarrier hostBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+    cmdPool.SingleTimeCommandEnd(device, cmdBuffer);
+  }
+
+  void* mapped;
+  readbackBuffer.MapMemory(device, &mapped);
+  SdfBakeCache::Save(cacheKey, info, mapped, (const byte*)mapped + imageSize);
+  readbackBuffer.UnmapMemory(device);
+
+  readbackBuffer.Destroy(device);
+}
+
+static b8 Create3DImage(SdfVoxelGrid* voxelGrid, VkExtent3D extent)
+{
+  LOG_INFO("SdfVoxelGrid: Creating Voxel Image...");
+
+  const Device& device = Renderer::GetDevice();
+
+  // Create image
+  {
     const u32 queueFamilyIndices[] =
       {
         device.queueFamilyIndices.graphicsFamily,
@@ -337,16 +587,23 @@ static b8 Create3DImage(SdfVoxelGrid* voxelGrid)
     imageCreateInfo.mipLevels             = 1;
     imageCreateInfo.arrayLayers           = 1;
     imageCreateInfo.extent                = extent;
-    imageCreateInfo.format                = VK_FORMAT_R32_SFLOAT;
+    imageCreateInfo.format                = GetImageFormat(voxelGrid->encoding.format);
     imageCreateInfo.tiling                = VK_IMAGE_TILING_OPTIMAL;
     imageCreateInfo.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageCreateInfo.usage                 = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageCreateInfo.usage                 = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     imageCreateInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
     imageCreateInfo.samples               = VK_SAMPLE_COUNT_1_BIT;
     imageCreateInfo.flags                 = 0;
     imageCreateInfo.queueFamilyIndexCount = ARRAY_SIZE(queueFamilyIndices);
     imageCreateInfo.pQueueFamilyIndices   = queueFamilyIndices;
 
+    // NOTE(WSWhitehouse): Only the F32 image is written by the compute shaders,
+    // storage support for the other formats is optional...
+    if (voxelGrid->encoding.format == SdfFormat::F32)
+    {
+      imageCreateInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
     if (!voxelGrid->image.Create(device, &imageCreateInfo))
     {
       LOG_ERROR("Failed to create volume image!");
@@ -369,7 +626,7 @@ static b8 Create3DImage(SdfVoxelGrid* voxelGrid)
     VkImageViewCreateInfo viewCreateInfo = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
     viewCreateInfo.image            = voxelGrid->image.image;
     viewCreateInfo.viewType         = VK_IMAGE_VIEW_TYPE_3D;
-    viewCreateInfo.format           = VK_FORMAT_R32_SFLOAT;
+    viewCreateInfo.format           = GetImageFormat(voxelGrid->encoding.format);
     viewCreateInfo.subresourceRange = subresourceRange;
 
     VK_SUCCESS_CHECK(vkCreateImageView(device.logicalDevice, &viewCreateInfo, nullptr, &voxelGrid->imageView));
@@ -449,51 +706,447 @@ static void DispatchJumpFloodingMethod(SdfVoxelGrid* voxelGrid, const Mesh* mesh
   const Device& device = Renderer::GetDevice();
 
   Buffer activeCells = {};
+  CreateActiveCellsBuffer(voxelGrid, &activeCells);
 
-  // Create Active Cells buffer
+  for (u32 i = 0; i < mesh->nodeCount; ++i)
   {
-    const VkDeviceSize bufferSize = sizeof(u32) + (sizeof(u8) * voxelGrid->cellCount.w);
+    const MeshNode& node         = mesh->nodeArray[i];
+    const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
+    DispatchTriDistComputeShader(voxelGrid, geometry, node.transformMatrix, activeCells);
+  }
 
-    vk::Buffer stagingBuffer = {};
-    stagingBuffer.Create(device, bufferSize,
-                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  DispatchJumpFloodingPipeline(voxelGrid);
 
-    void* data;
-    stagingBuffer.MapMemory(device, &data);
-    mem_zero(data, bufferSize);
-    stagingBuffer.UnmapMemory(device);
+  // NOTE(WSWhitehouse): Must transition the image to a layout optimal for shader reads
+  // TODO(WSWhitehouse): Transition layout needs appropriate queue family indices... this should crash.
+  vk::Image::TransitionLayout(voxelGrid->image.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-    activeCells.Create(device, bufferSize,
-                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
-                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  // Clean Up...
+  {
+    activeCells.Destroy(device);
+  }
+}
+
+static void DispatchFastSweepingMethod(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout)
+{
+  PROFILE_FUNC
+
+  const Device& device = Renderer::GetDevice();
+
+  // NOTE(WSWhitehouse): The tri dist shader writes the exact distance into every cell
+  // within the bounds of a triangle, the rest of the image is left at F32_MAX...
+  {
+    Buffer activeCells = {};
+    CreateActiveCellsBuffer(voxelGrid, &activeCells);
+
+    for (u32 i = 0; i < mesh->nodeCount; ++i)
+    {
+      const MeshNode& node         = mesh->nodeArray[i];
+      const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
+      DispatchTriDistComputeShader(voxelGrid, geometry, node.transformMatrix, activeCells);
+    }
+
+    activeCells.Destroy(device);
+  }
+
+  LOG_INFO("SdfVoxelGrid: Fast Sweeping on the CPU...");
+
+  SdfVolume volume = {};
+  volume.Create(layout);
+
+  if (ReadbackComputeImage(voxelGrid, volume.distances, volume.GetSize()))
+  {
+    volume.FastSweep(SdfVolume::DEFAULT_FIXED_BAND, SdfVolume::DEFAULT_SWEEP_ITERATIONS);
+  }
+
+  // NOTE(WSWhitehouse): A failed readback still uploads the volume (every cell at F32_MAX)
+  // so the image always ends up in the same layout as the other bake methods...
+  const VkExtent3D extent = { layout.cellCount.x, layout.cellCount.y, layout.cellCount.z };
+  UploadImage(voxelGrid, volume.distances, volume.GetSize(), extent);
+
+  volume.Destroy();
+  LOG_INFO("SdfVoxelGrid: Fast Sweeping Finished!");
+}
+
+static void CreateActiveCellsBuffer(SdfVoxelGrid* voxelGrid, Buffer* out_activeCells)
+{
+  const Device& device = Renderer::GetDevice();
+
+  const VkDeviceSize bufferSize = sizeof(u32) + (sizeof(u8) * voxelGrid->cellCount.w);
+
+  vk::Buffer stagingBuffer = {};
+  stagingBuffer.Create(device, bufferSize,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-    vk::Buffer::CopyBufferToBuffer(stagingBuffer, activeCells, bufferSize);
+  void* data;
+  stagingBuffer.MapMemory(device, &data);
+  mem_zero(data, bufferSize);
+  stagingBuffer.UnmapMemory(device);
 
-    stagingBuffer.Destroy(device);
+  out_activeCells->Create(device, bufferSize,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  vk::Buffer::CopyBufferToBuffer(stagingBuffer, *out_activeCells, bufferSize);
+
+  stagingBuffer.Destroy(device);
+}
+
+static void BakeOnCPU(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout, b8 useWindingNumbers)
+{
+  PROFILE_FUNC
+
+  LOG_INFO("SdfVoxelGrid: Baking Volume on the CPU...");
+
+  SdfVolume volume = {};
+  volume.Create(layout);
+  volume.BakeMesh(mesh, useWindingNumbers);
+
+  SdfEncoding& encoding = voxelGrid->encoding;
+  encoding = SdfEncoding::Calculate(encoding.format, volume.distances, layout.cellCount.w);
+
+  const u64 encodedSize = (u64)encoding.GetDistanceSize() * layout.cellCount.w;
+  void* encoded         = mem_alloc(encodedSize);
+  encoding.Encode(volume.distances, layout.cellCount.w, encoded);
+  LogEncodingError(encoding, volume.distances, encoded, layout.cellCount.w);
+
+  // NOTE(WSWhitehouse): The volume is in the same layout as the image (x changes fastest,
+  // then y, then z) so it is copied straight into the image...
+  const VkExtent3D extent = { layout.cellCount.x, layout.cellCount.y, layout.cellCount.z };
+  UploadImage(voxelGrid, encoded, encodedSize, extent);
+
+  mem_free(encoded);
+  volume.Destroy();
+  LOG_INFO("SdfVoxelGrid: CPU Bake Finished!");
+}
+
+static b8 BakeBricksOnCPU(SdfVoxelGrid* voxelGrid, const Mesh* mesh, const SdfGridLayout& layout, b8 useWindingNumbers)
+{
+  PROFILE_FUNC
+
+  LOG_INFO("SdfVoxelGrid: Baking Sparse Bricks on the CPU...");
+
+  const Device& device = Renderer::GetDevice();
+
+  SdfBrickVolume volume = {};
+  volume.Create(layout);
+  volume.BakeMesh(mesh, useWindingNumbers);
+
+  const u64 sampleCount = (u64)volume.brickCount * SdfBrickVolume::BRICK_SAMPLE_COUNT;
+
+  SdfEncoding& encoding = voxelGrid->encoding;
+  encoding = SdfEncoding::Calculate(encoding.format, volume.bricks, sampleCount);
+
+  const u32 distanceSize = encoding.GetDistanceSize();
+  u8* encodedBricks      = (u8*)mem_alloc(MAX(distanceSize * sampleCount, (u64)1));
+  encoding.Encode(volume.bricks, sampleCount, encodedBricks);
+  LogEncodingError(encoding, volume.bricks, encodedBricks, sampleCount);
+
+  // NOTE(WSWhitehouse): The top-level grid is always f32...
+  const u64 sparseSize = (sizeof(SdfBrickVolume::TopLevelCell) * volume.topLevelCount.w) + (distanceSize * sampleCount);
+  const u64 denseSize  = sizeof(f32) * layout.cellCount.w;
+  LOG_DEBUG("Brick Count: %u / %u", volume.brickCount, volume.topLevelCount.w);
+  LOG_DEBUG("Grid Memory Size (MiB): %.2f (%.1fx smaller than dense F32)",
+            (f64)sparseSize / 1024.0 / 1024.0, (f64)denseSize / (f64)sparseSize);
+
+  // NOTE(WSWhitehouse): The bricks are packed into a 3D atlas that is as close to a cube as
+  // possible, as the depth of a 3D image is limited like its width and height. There is
+  // always at least one brick so the image is never empty...
+  const u32 maxAtlasCount = device.properties.limits.maxImageDimension3D / SdfBrickVolume::BRICK_SIZE;
+  const u32 atlasBricks   = MAX(volume.brickCount, 1u);
+
+  glm::uvec3 atlasCount = {};
+  atlasCount.x = MIN(maxAtlasCount, (u32)glm::ceil(glm::pow((f32)atlasBricks, 1.0f / 3.0f)));
+  atlasCount.y = MIN(maxAtlasCount, (u32)glm::ceil(glm::sqrt((f32)((atlasBricks + atlasCount.x - 1) / atlasCount.x))));
+  atlasCount.z = (atlasBricks + (atlasCount.x * atlasCount.y) - 1) / (atlasCount.x * atlasCount.y);
+
+  if (atlasCount.z > maxAtlasCount)
+  {
+    LOG_ERROR("SdfVoxelGrid: %u bricks doesn't fit in the brick atlas!", volume.brickCount);
+    mem_free(encodedBricks);
+    volume.Destroy();
+    return false;
   }
 
-  for (u32 i = 0; i < mesh->nodeCount; ++i)
+  voxelGrid->brickCount      = glm::uvec3(volume.topLevelCount);
+  voxelGrid->brickAtlasCount = atlasCount;
+
+  const glm::uvec3 atlasSize = atlasCount * SdfBrickVolume::BRICK_SIZE;
+  const VkExtent3D extent    = { atlasSize.x, atlasSize.y, atlasSize.z };
+  if (!Create3DImage(voxelGrid, extent))
   {
-    const MeshNode& node         = mesh->nodeArray[i];
-    const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
-    DispatchTriDistComputeShader(voxelGrid, geometry, node.transformMatrix, activeCells);
+    mem_free(encodedBricks);
+    volume.Destroy();
+    return false;
   }
 
-  DispatchJumpFloodingPipeline(voxelGrid, activeCells);
+  // Pack the bricks into the atlas
+  {
+    constexpr const u32 BRICK_SIZE = SdfBrickVolume::BRICK_SIZE;
 
-  // NOTE(WSWhitehouse): Must transition the image to a layout optimal for shader reads
-  // TODO(WSWhitehouse): Transition layout needs appropriate queue family indices... this should crash.
-  vk::Image::TransitionLayout(voxelGrid->image.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    const u64 atlasSampleCount = (u64)atlasSize.x * atlasSize.y * atlasSize.z;
+    u8* atlas = (u8*)mem_alloc(distanceSize * atlasSampleCount);
 
-  // Clean Up...
+    for (u32 brick = 0; brick < volume.brickCount; ++brick)
+    {
+      const glm::uvec3 atlasBrick =
+        {
+          brick % atlasCount.x,
+          (brick / atlasCount.x) % atlasCount.y,
+          brick / (atlasCount.x * atlasCount.y)
+        };
+
+      const glm::uvec3 firstSample = atlasBrick * BRICK_SIZE;
+      const u8* samples            = &encodedBricks[(u64)brick * distanceSize * SdfBrickVolume::BRICK_SAMPLE_COUNT];
+
+      // NOTE(WSWhitehouse): Each row of the brick is contiguous in the atlas...
+      for (u32 z = 0; z < BRICK_SIZE; ++z)
+      {
+        for (u32 y = 0; y < BRICK_SIZE; ++y)
+        {
+          const u64 atlasIndex = (u64)firstSample.x +
+                                 ((u64)(firstSample.y + y) * atlasSize.x) +
+                                 ((u64)(firstSample.z + z) * atlasSize.x * atlasSize.y);
+
+          const u64 sampleIndex = (z * BRICK_SIZE * BRICK_SIZE) + (y * BRICK_SIZE);
+          mem_copy(&atlas[atlasIndex * distanceSize], &samples[sampleIndex * distanceSize], distanceSize * BRICK_SIZE);
+        }
+      }
+    }
+
+    UploadImage(voxelGrid, atlas, distanceSize * atlasSampleCount, extent);
+    mem_free(atlas);
+  }
+
+  mem_free(encodedBricks);
+
+  const b8 success = CreateBrickGridBuffer(voxelGrid, volume.topLevel, sizeof(SdfBrickVolume::TopLevelCell) * volume.topLevelCount.w);
+
+  volume.Destroy();
+  LOG_INFO("SdfVoxelGrid: CPU Brick Bake Finished!");
+  return success;
+}
+
+static VkFormat GetImageFormat(SdfFormat format)
+{
+  switch (format)
   {
-    activeCells.Destroy(device);
+    case SdfFormat::F32:     return VK_FORMAT_R32_SFLOAT;
+    case SdfFormat::F16:     return VK_FORMAT_R16_SFLOAT;
+    case SdfFormat::UNORM16: return VK_FORMAT_R16_UNORM;
+    case SdfFormat::UNORM8:  return VK_FORMAT_R8_UNORM;
+
+    default:
+    {
+      LOG_FATAL("Unhandled SdfFormat in switch statement!");
+      return VK_FORMAT_UNDEFINED;
+    }
+  }
+}
+
+static void LogEncodingError(const SdfEncoding& encoding, const f32* distances, const void* data, u64 count)
+{
+  // NOTE(WSWhitehouse): The error is in cells, compared to the f32 distances...
+  const SdfEncoding::Error error = encoding.MeasureError(distances, data, count);
+  LOG_DEBUG("SdfVoxelGrid: %s Encoding Error (cells) - Max: %f, Mean: %f, Clamped: %llu / %llu (scale: %f, bias: %f)",
+            SdfFormatToString(encoding.format), error.maxError, error.meanError,
+            error.clampedCount, count, encoding.scale, encoding.bias);
+}
+
+static b8 CreateBrickGridBuffer(SdfVoxelGrid* voxelGrid, const void* data, u64 size)
+{
+  const Device& device = Renderer::GetDevice();
+
+  vk::Buffer stagingBuffer = {};
+  stagingBuffer.Create(device, size,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  void* mapped;
+  stagingBuffer.MapMemory(device, &mapped);
+  mem_copy(mapped, data, size);
+  stagingBuffer.UnmapMemory(device);
+
+  const b8 success = voxelGrid->brickGrid.Create(device, size,
+                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+                                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  if (!success)
+  {
+    LOG_ERROR("SdfVoxelGrid: Failed to create brick grid buffer!");
+    stagingBuffer.Destroy(device);
+    return false;
   }
+
+  vk::Buffer::CopyBufferToBuffer(stagingBuffer, voxelGrid->brickGrid, size);
+  stagingBuffer.Destroy(device);
+  return true;
+}
+
+static void DestroyVolumeResources(SdfVoxelGrid* voxelGrid)
+{
+  const Device& device = Renderer::GetDevice();
+
+  vkDestroySampler(device.logicalDevice, voxelGrid->imageSampler, nullptr);
+  vkDestroyImageView(device.logicalDevice, voxelGrid->imageView, nullptr);
+  voxelGrid->image.Destroy(device);
+  voxelGrid->brickGrid.Destroy(device);
+
+  voxelGrid->imageSampler = VK_NULL_HANDLE;
+  voxelGrid->imageView    = VK_NULL_HANDLE;
+}
+
+static void UploadImage(SdfVoxelGrid* voxelGrid, const void* data, u64 size, VkExtent3D extent)
+{
+  const Device& device = Renderer::GetDevice();
+
+  vk::Buffer stagingBuffer = {};
+  stagingBuffer.Create(device, size,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  void* mapped;
+  stagingBuffer.MapMemory(device, &mapped);
+  mem_copy(mapped, data, size);
+  stagingBuffer.UnmapMemory(device);
+
+  CopyBufferToImage(voxelGrid, stagingBuffer, extent);
+  stagingBuffer.Destroy(device);
+}
+
+static void CopyBufferToImage(SdfVoxelGrid* voxelGrid, const vk::Buffer& stagingBuffer, VkExtent3D extent)
+{
+  const Device& device = Renderer::GetDevice();
+
+  const VkImageSubresourceRange subresourceRange =
+    {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0,
+      .levelCount     = 1,
+      .baseArrayLayer = 0,
+      .layerCount     = 1
+    };
+
+  const vk::CommandPool& cmdPool = Renderer::GetGraphicsCommandPool();
+  VkCommandBuffer cmdBuffer      = cmdPool.SingleTimeCommandBegin(device);
+
+  // NOTE(WSWhitehouse): Create3DImage leaves the image ready for the compute shaders...
+  vk::Image::CmdTransitionBarrier(cmdBuffer, voxelGrid->image.image,
+                                  VK_IMAGE_LAYOUT_GENERAL,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  subresourceRange);
+
+  VkBufferImageCopy copy = {};
+  copy.bufferOffset      = 0;
+  copy.bufferRowLength   = 0;
+  copy.bufferImageHeight = 0;
+  copy.imageSubresource  =
+    {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .mipLevel       = 0,
+      .baseArrayLayer = 0,
+      .layerCount     = 1
+    };
+  copy.imageOffset = { 0, 0, 0 };
+  copy.imageExtent = extent;
+
+  vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer.buffer, voxelGrid->image.image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+  vk::Image::CmdTransitionBarrier(cmdBuffer, voxelGrid->image.image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  subresourceRange);
+
+  cmdPool.SingleTimeCommandEnd(device, cmdBuffer);
+}
+
+static b8 CreateReadbackBuffer(vk::Buffer* out_readbackBuffer, u64 size)
+{
+  const Device& device = Renderer::GetDevice();
+
+  // NOTE(WSWhitehouse): Cached memory is much faster for the CPU to read, but isn't always available...
+  const VkMemoryPropertyFlags hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+  if (out_readbackBuffer->Create(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostMemory | VK_MEMORY_PROPERTY_HOST_CACHED_BIT))
+  {
+    return true;
+  }
+
+  out_readbackBuffer->Destroy(device);
+  if (out_readbackBuffer->Create(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostMemory))
+  {
+    return true;
+  }
+
+  LOG_ERROR("SdfVoxelGrid: Failed to create the readback buffer!");
+  out_readbackBuffer->Destroy(device);
+  return false;
+}
+
+static b8 ReadbackComputeImage(SdfVoxelGrid* voxelGrid, void* out_data, u64 size)
+{
+  PROFILE_FUNC
+
+  const Device& device = Renderer::GetDevice();
+
+  vk::Buffer readbackBuffer = {};
+  if (!CreateReadbackBuffer(&readbackBuffer, size)) return false;
+
+  const vk::CommandPool& cmdPool = Renderer::GetGraphicsCommandPool();
+  VkCommandBuffer cmdBuffer      = cmdPool.SingleTimeCommandBegin(device);
+
+  // NOTE(WSWhitehouse): The image is still in the general layout the compute shaders wrote
+  // it in, it can be copied from directly once their writes are visible to the transfer...
+  VkMemoryBarrier computeBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  computeBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  computeBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+  vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       0, 1, &computeBarrier, 0, nullptr, 0, nullptr);
+
+  VkBufferImageCopy copy = {};
+  copy.bufferOffset      = 0;
+  copy.bufferRowLength   = 0;
+  copy.bufferImageHeight = 0;
+  copy.imageSubresource  =
+    {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .mipLevel       = 0,
+      .baseArrayLayer = 0,
+      .layerCount     = 1
+    };
+  copy.imageOffset = { 0, 0, 0 };
+  copy.imageExtent = { voxelGrid->cellCount.x, voxelGrid->cellCount.y, voxelGrid->cellCount.z };
+
+  vkCmdCopyImageToBuffer(cmdBuffer, voxelGrid->image.image, VK_IMAGE_LAYOUT_GENERAL,
+                         readbackBuffer.buffer, 1, &copy);
+
+  VkMemoryBarrier hostBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+  vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                       0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+  cmdPool.SingleTimeCommandEnd(device, cmdBuffer);
+
+  void* mapped;
+  readbackBuffer.MapMemory(device, &mapped);
+  mem_copy(out_data, mapped, size);
+  readbackBuffer.UnmapMemory(device);
+
+  readbackBuffer.Destroy(device);
+  return true;
 }
 
 static void DispatchNaiveDistComputeShader(SdfVoxelGrid* voxelGrid, const MeshGeometry& geometry, const glm::mat4x4& transform)
@@ -851,140 +1504,202 @@ static void DispatchTriDistComputeShader(SdfVoxelGrid* voxelGrid, const MeshGeom
   }
 }
 
-static void DispatchJumpFloodingPipeline(SdfVoxelGrid* voxelGrid, Buffer& activeCells)
+static void DispatchJumpFloodingPipeline(SdfVoxelGrid* voxelGrid)
 {
   LOG_INFO("SdfVoxelGrid: Starting Jump Flooding...");
 
   const vk::Device& device = Renderer::GetDevice();
 
-  Buffer updatedCells = {};
-
-  // Create Updated Cells Buffer...
-  {
-    updatedCells.Create(device, activeCells.size,
-                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
-                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  const VkImageSubresourceRange subresourceRange =
+    {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0,
+      .levelCount     = 1,
+      .baseArrayLayer = 0,
+      .layerCount     = 1
+    };
 
-    Buffer::CopyBufferToBuffer(activeCells, updatedCells, activeCells.size);
-  }
+  // NOTE(WSWhitehouse): The passes ping-pong between the seed images, every pass reads
+  // the seeds from one image and writes them to the other so no atomics are needed...
+  vk::Image seedImages[2]       = {};
+  VkImageView seedImageViews[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+  b8 seedImagesCreated          = true;
 
-  // Update descriptor sets
+  // Create Seed Images...
   {
-    // Active Cells Buffer
-    VkDescriptorBufferInfo activeCellsBufferInfo = {};
-    activeCellsBufferInfo.buffer = activeCells.buffer;
-    activeCellsBufferInfo.offset = 0;
-    activeCellsBufferInfo.range  = activeCells.size;
+    VkImageCreateInfo imageCreateInfo = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    imageCreateInfo.imageType     = VK_IMAGE_TYPE_3D;
+    imageCreateInfo.mipLevels     = 1;
+    imageCreateInfo.arrayLayers   = 1;
+    imageCreateInfo.extent        = { voxelGrid->cellCount.x, voxelGrid->cellCount.y, voxelGrid->cellCount.z };
+    imageCreateInfo.format        = VK_FORMAT_R32_UINT;
+    imageCreateInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.usage         = VK_IMAGE_USAGE_STORAGE_BIT;
+    imageCreateInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.flags         = 0;
+
+    for (u32 i = 0; i < ARRAY_SIZE(seedImages); ++i)
+    {
+      if (!seedImages[i].Create(device, &imageCreateInfo))
+      {
+        LOG_ERROR("SdfVoxelGrid: Failed to create jump flooding seed image!");
+        seedImagesCreated = false;
+        break;
+      }
 
-    VkWriteDescriptorSet activeCellsDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    activeCellsDescriptorWrite.dstSet           = compJumpFloodingPipeline.descriptorSet;
-    activeCellsDescriptorWrite.dstBinding       = 1;
-    activeCellsDescriptorWrite.dstArrayElement  = 0;
-    activeCellsDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    activeCellsDescriptorWrite.descriptorCount  = 1;
-    activeCellsDescriptorWrite.pBufferInfo      = &activeCellsBufferInfo;
-    activeCellsDescriptorWrite.pImageInfo       = nullptr;
-    activeCellsDescriptorWrite.pTexelBufferView = nullptr;
+      VkImageViewCreateInfo viewCreateInfo = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+      viewCreateInfo.image            = seedImages[i].image;
+      viewCreateInfo.viewType         = VK_IMAGE_VIEW_TYPE_3D;
+      viewCreateInfo.format           = VK_FORMAT_R32_UINT;
+      viewCreateInfo.subresourceRange = subresourceRange;
 
-    // Updated Cells Buffer
-    VkDescriptorBufferInfo updatedCellsBufferInfo = {};
-    updatedCellsBufferInfo.buffer = updatedCells.buffer;
-    updatedCellsBufferInfo.offset = 0;
-    updatedCellsBufferInfo.range  = updatedCells.size;
-
-    VkWriteDescriptorSet updatedCellsDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    updatedCellsDescriptorWrite.dstSet           = compJumpFloodingPipeline.descriptorSet;
-    updatedCellsDescriptorWrite.dstBinding       = 2;
-    updatedCellsDescriptorWrite.dstArrayElement  = 0;
-    updatedCellsDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    updatedCellsDescriptorWrite.descriptorCount  = 1;
-    updatedCellsDescriptorWrite.pBufferInfo      = &updatedCellsBufferInfo;
-    updatedCellsDescriptorWrite.pImageInfo       = nullptr;
-    updatedCellsDescriptorWrite.pTexelBufferView = nullptr;
+      VK_SUCCESS_CHECK(vkCreateImageView(device.logicalDevice, &viewCreateInfo, nullptr, &seedImageViews[i]));
+    }
+  }
 
-    // Voxel Volume Image
-    VkDescriptorImageInfo voxelImageInfo = {};
-    voxelImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    voxelImageInfo.imageView   = voxelGrid->imageView;
-    voxelImageInfo.sampler     = nullptr;
+  if (seedImagesCreated)
+  {
+    // Update descriptor sets, set i reads seed image i and writes the other...
+    for (u32 i = 0; i < ARRAY_SIZE(jumpFloodingDescriptorSets); ++i)
+    {
+      // Voxel Volume Image
+      VkDescriptorImageInfo voxelImageInfo = {};
+      voxelImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+      voxelImageInfo.imageView   = voxelGrid->imageView;
+      voxelImageInfo.sampler     = nullptr;
+
+      VkWriteDescriptorSet voxelDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      voxelDescriptorWrite.dstSet           = jumpFloodingDescriptorSets[i];
+      voxelDescriptorWrite.dstBinding       = 0;
+      voxelDescriptorWrite.dstArrayElement  = 0;
+      voxelDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+      voxelDescriptorWrite.descriptorCount  = 1;
+      voxelDescriptorWrite.pBufferInfo      = nullptr;
+      voxelDescriptorWrite.pImageInfo       = &voxelImageInfo;
+      voxelDescriptorWrite.pTexelBufferView = nullptr;
+
+      // Seeds In Image
+      VkDescriptorImageInfo seedsInImageInfo = {};
+      seedsInImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+      seedsInImageInfo.imageView   = seedImageViews[i];
+      seedsInImageInfo.sampler     = nullptr;
+
+      VkWriteDescriptorSet seedsInDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      seedsInDescriptorWrite.dstSet           = jumpFloodingDescriptorSets[i];
+      seedsInDescriptorWrite.dstBinding       = 1;
+      seedsInDescriptorWrite.dstArrayElement  = 0;
+      seedsInDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+      seedsInDescriptorWrite.descriptorCount  = 1;
+      seedsInDescriptorWrite.pBufferInfo      = nullptr;
+      seedsInDescriptorWrite.pImageInfo       = &seedsInImageInfo;
+      seedsInDescriptorWrite.pTexelBufferView = nullptr;
+
+      // Seeds Out Image
+      VkDescriptorImageInfo seedsOutImageInfo = {};
+      seedsOutImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+      seedsOutImageInfo.imageView   = seedImageViews[1 - i];
+      seedsOutImageInfo.sampler     = nullptr;
+
+      VkWriteDescriptorSet seedsOutDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      seedsOutDescriptorWrite.dstSet           = jumpFloodingDescriptorSets[i];
+      seedsOutDescriptorWrite.dstBinding       = 2;
+      seedsOutDescriptorWrite.dstArrayElement  = 0;
+      seedsOutDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+      seedsOutDescriptorWrite.descriptorCount  = 1;
+      seedsOutDescriptorWrite.pBufferInfo      = nullptr;
+      seedsOutDescriptorWrite.pImageInfo       = &seedsOutImageInfo;
+      seedsOutDescriptorWrite.pTexelBufferView = nullptr;
+
+      const VkWriteDescriptorSet descriptorWrites[] =
+        {
+          voxelDescriptorWrite,
+          seedsInDescriptorWrite,
+          seedsOutDescriptorWrite,
+        };
 
-    VkWriteDescriptorSet voxelDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    voxelDescriptorWrite.dstSet           = compJumpFloodingPipeline.descriptorSet;
-    voxelDescriptorWrite.dstBinding       = 3;
-    voxelDescriptorWrite.dstArrayElement  = 0;
-    voxelDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    voxelDescriptorWrite.descriptorCount  = 1;
-    voxelDescriptorWrite.pBufferInfo      = nullptr;
-    voxelDescriptorWrite.pImageInfo       = &voxelImageInfo;
-    voxelDescriptorWrite.pTexelBufferView = nullptr;
+      vkUpdateDescriptorSets(device.logicalDevice, ARRAY_SIZE(descriptorWrites), descriptorWrites, 0, nullptr);
+    }
 
-    const VkWriteDescriptorSet descriptorWrites[] =
-      {
-        activeCellsDescriptorWrite,
-        updatedCellsDescriptorWrite,
-        voxelDescriptorWrite,
-      };
+    // Group Count
+    constexpr const glm::uvec3 localSize = {8, 8, 8};
+    const glm::uvec3 cellCount  = glm::uvec3(voxelGrid->cellCount);
+    const glm::uvec3 groupCount = (cellCount + (localSize - 1u)) / localSize;
 
-    vkUpdateDescriptorSets(device.logicalDevice, ARRAY_SIZE(descriptorWrites), descriptorWrites, 0, nullptr);
-  }
+    // NOTE(WSWhitehouse): The jump offsets are N/2, N/4, ..., 1 where N is the
+    // largest axis rounded up to a power of two, so there are log2(N) passes...
+    const u32 maxCellCount = glm::max(cellCount.x, glm::max(cellCount.y, cellCount.z));
+    u32 firstJumpOffset    = 1;
+    while (firstJumpOffset * 2 < maxCellCount) firstJumpOffset *= 2;
 
-  const CommandPool& cmdPool = Renderer::GetComputeCommandPool();
+    // NOTE(WSWhitehouse): Every pass is recorded into a single command buffer, the barrier makes
+    // the previous pass (or the tri dist shader before the first pass) visible to the next one...
+    VkMemoryBarrier passBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    passBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    passBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-  // Iterations
-  const glm::vec3& cellCount = glm::vec3(voxelGrid->cellCount.x, voxelGrid->cellCount.y, voxelGrid->cellCount.z);
-  const u32 numIterations    = (u32)glm::ceil(glm::log2(glm::max(cellCount.x, glm::max(cellCount.y, cellCount.z)))) + 1;
+    const CommandPool& cmdPool = Renderer::GetComputeCommandPool();
+    VkCommandBuffer cmdBuffer  = cmdPool.SingleTimeCommandBegin(device);
 
-  // Group Count
-//  constexpr const glm::uvec3 localSize = {64, 1, 1};
-//  const u32 groupCountX = cellCount.w / localSize.x;
-  constexpr const glm::uvec3 localSize = {8, 8, 8};
-  const glm::uvec3 groupCount = glm::uvec3(cellCount) / localSize;
+    for (u32 i = 0; i < ARRAY_SIZE(seedImages); ++i)
+    {
+      vk::Image::CmdTransitionBarrier(cmdBuffer, seedImages[i].image,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      subresourceRange);
+    }
 
-  for (u32 i = 0; i < numIterations; ++i)
-  {
-    const u32 jumpOffset = numIterations - i;// (u32)(glm::pow(2, numIterations - i));
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compJumpFloodingPipeline.pipeline);
 
-    // Update input buffer
+    const auto CmdDispatchPass = [&](JumpFloodPass passType, u32 jumpOffset, u32 seedsInIndex)
     {
-      const UBOCompJumpFloodInput voxelGridInput =
+      const JumpFloodPushConstant pushConstant =
         {
           .cellCount  = voxelGrid->cellCount,
-          .cellSize   = voxelGrid->cellSize,
-          .iteration  = numIterations - i,
-          .jumpOffset = jumpOffset,
-          .maxDist    = F32_MAX
+          .passType   = passType,
+          .jumpOffset = jumpOffset
         };
 
-      void* data;
-      compJumpFloodingPipeline.inputBufferUBO.MapMemory(device, &data);
-      mem_copy(data, &voxelGridInput, compJumpFloodingPipeline.inputBufferUBO.size);
-      compJumpFloodingPipeline.inputBufferUBO.UnmapMemory(device);
-    }
+      vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           0, 1, &passBarrier, 0, nullptr, 0, nullptr);
 
-    // Dispatch Compute Shader...
-    {
-      VkCommandBuffer cmdBuffer = cmdPool.SingleTimeCommandBegin(device);
-
-      // Bind resources and pipeline
       vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compJumpFloodingPipeline.pipelineLayout,
-                              0, 1, &compJumpFloodingPipeline.descriptorSet, 0, nullptr);
-      vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compJumpFloodingPipeline.pipeline);
+                              0, 1, &jumpFloodingDescriptorSets[seedsInIndex], 0, nullptr);
+      vkCmdPushConstants(cmdBuffer, compJumpFloodingPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                         0, sizeof(JumpFloodPushConstant), &pushConstant);
 
-      // Dispatch
       vkCmdDispatch(cmdBuffer, groupCount.x, groupCount.y, groupCount.z);
+    };
+
+    // The init pass writes the narrow band seeds into seed image 0...
+    CmdDispatchPass(JumpFloodPass::INIT, 0, 1);
+    u32 seedsIndex = 0;
+
+    for (u32 jumpOffset = firstJumpOffset; jumpOffset >= 1; jumpOffset /= 2)
+    {
+      CmdDispatchPass(JumpFloodPass::JUMP, jumpOffset, seedsIndex);
+      seedsIndex = 1 - seedsIndex;
+    }
 
-      cmdPool.SingleTimeCommandEnd(device, cmdBuffer);
+    for (u32 i = 0; i < JUMP_FLOOD_REFINE_PASSES; ++i)
+    {
+      CmdDispatchPass(JumpFloodPass::JUMP, 1, seedsIndex);
+      seedsIndex = 1 - seedsIndex;
     }
 
-    // Update active cells
-    Buffer::CopyBufferToBuffer(updatedCells, activeCells, activeCells.size);
+    CmdDispatchPass(JumpFloodPass::RESOLVE, 0, seedsIndex);
+
+    cmdPool.SingleTimeCommandEnd(device, cmdBuffer);
   }
 
   // Clean Up...
   {
-    updatedCells.Destroy(device);
+    for (u32 i = 0; i < ARRAY_SIZE(seedImages); ++i)
+    {
+      vkDestroyImageView(device.logicalDevice, seedImageViews[i], nullptr);
+      seedImages[i].Destroy(device);
+    }
   }
 
   LOG_INFO("SdfVoxelGrid: Jump Flooding Complete!");
@@ -1010,10 +1725,18 @@ static void CreatePipeline()
     voxelGridLayoutBinding.pImmutableSamplers = nullptr;
     voxelGridLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
 
+    VkDescriptorSetLayoutBinding brickGridLayoutBinding = {};
+    brickGridLayoutBinding.binding            = 2;
+    brickGridLayoutBinding.descriptorCount    = 1;
+    brickGridLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    brickGridLayoutBinding.pImmutableSamplers = nullptr;
+    brickGridLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+
     VkDescriptorSetLayoutBinding bindings[] =
       {
         sdfVoxelDataLayoutBinding,
-        voxelGridLayoutBinding
+        voxelGridLayoutBinding,
+        brickGridLayoutBinding
       };
 
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
@@ -1166,9 +1889,9 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
     Transform* transform = ecs.GetComponent<Transform>(componentData.entity);
 
     ImGui::Begin("SDF Voxel Grid");
-    ImGui::InputFloat3("Position", glm::value_ptr(transform->position));
-    ImGui::InputFloat3("Rotation", glm::value_ptr(transform->rotation));
-    ImGui::InputFloat3("Scale", glm::value_ptr(transform->scale));
+    if (ImGui::InputFloat3("Position", glm::value_ptr(transform->position))) transform->MarkDirty();
+    if (ImGui::InputFloat3("Rotation", glm::value_ptr(transform->rotation))) transform->MarkDirty();
+    if (ImGui::InputFloat3("Scale", glm::value_ptr(transform->scale)))       transform->MarkDirty();
     ImGui::InputFloat3("Twist", glm::value_ptr(voxelGrid.twist));
     ImGui::InputFloat3("Sphere Pos", glm::value_ptr(voxelGrid.sphere));
     ImGui::InputFloat("Sphere Radius", &voxelGrid.sphere.w);
@@ -1177,16 +1900,20 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
     ImGui::End();
 
     UBOSdfVoxelData* data = (UBOSdfVoxelData*)voxelGrid.dataUniformBuffersMapped[currentFrame];
-    data->WVP            = transform->GetWVPMatrix(camera);
-    data->worldMat       = transform->matrix;
-    data->invWorldMat    = glm::inverse(transform->matrix);
-    data->cellCount      = voxelGrid.cellCount;
-    data->gridExtents    = voxelGrid.gridExtent;
-    data->twist          = voxelGrid.twist;
-    data->sphere         = voxelGrid.sphere;
-    data->voxelGridScale = voxelGrid.scalingFactor;
-    data->blend          = voxelGrid.sphereBlend;
-    data->showBounds     = voxelGrid.showBounds;
+    data->WVP             = transform->GetWVPMatrix(camera);
+    data->worldMat        = transform->matrix;
+    data->invWorldMat     = glm::inverse(transform->matrix);
+    data->cellCount       = voxelGrid.cellCount;
+    data->gridExtents     = voxelGrid.gridExtent;
+    data->twist           = voxelGrid.twist;
+    data->sphere          = voxelGrid.sphere;
+    data->voxelGridScale  = voxelGrid.scalingFactor;
+    data->blend           = voxelGrid.sphereBlend;
+    data->showBounds      = voxelGrid.showBounds;
+    data->brickCount      = voxelGrid.brickCount;
+    data->brickAtlasCount = voxelGrid.brickAtlasCount;
+    data->distanceScale   = voxelGrid.encoding.scale;
+    data->distanceBias    = voxelGrid.encoding.bias;
 
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout,
                             1, 1, &voxelGrid.descriptorSets[currentFrame], 0, nullptr);
@@ -1477,40 +2204,32 @@ static b8 CreateJumpFloodingComputePipeline()
 
   // Create descriptor set layout
   {
-    VkDescriptorSetLayoutBinding inputBufferLayoutBinding = {};
-    inputBufferLayoutBinding.binding            = 0;
-    inputBufferLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    inputBufferLayoutBinding.descriptorCount    = 1;
-    inputBufferLayoutBinding.pImmutableSamplers = nullptr;
-    inputBufferLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
-
-    VkDescriptorSetLayoutBinding activeCellsBufferLayoutBinding = {};
-    activeCellsBufferLayoutBinding.binding            = 1;
-    activeCellsBufferLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    activeCellsBufferLayoutBinding.descriptorCount    = 1;
-    activeCellsBufferLayoutBinding.pImmutableSamplers = nullptr;
-    activeCellsBufferLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
-
-    VkDescriptorSetLayoutBinding updatedCellsBufferLayoutBinding = {};
-    updatedCellsBufferLayoutBinding.binding            = 2;
-    updatedCellsBufferLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    updatedCellsBufferLayoutBinding.descriptorCount    = 1;
-    updatedCellsBufferLayoutBinding.pImmutableSamplers = nullptr;
-    updatedCellsBufferLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
-
     VkDescriptorSetLayoutBinding voxelGridLayoutBinding = {};
-    voxelGridLayoutBinding.binding            = 3;
+    voxelGridLayoutBinding.binding            = 0;
     voxelGridLayoutBinding.descriptorCount    = 1;
     voxelGridLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     voxelGridLayoutBinding.pImmutableSamplers = nullptr;
     voxelGridLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
 
+    VkDescriptorSetLayoutBinding seedsInLayoutBinding = {};
+    seedsInLayoutBinding.binding            = 1;
+    seedsInLayoutBinding.descriptorCount    = 1;
+    seedsInLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    seedsInLayoutBinding.pImmutableSamplers = nullptr;
+    seedsInLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutBinding seedsOutLayoutBinding = {};
+    seedsOutLayoutBinding.binding            = 2;
+    seedsOutLayoutBinding.descriptorCount    = 1;
+    seedsOutLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    seedsOutLayoutBinding.pImmutableSamplers = nullptr;
+    seedsOutLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+
     VkDescriptorSetLayoutBinding bindings[] =
       {
-        inputBufferLayoutBinding,
-        activeCellsBufferLayoutBinding,
-        updatedCellsBufferLayoutBinding,
-        voxelGridLayoutBinding
+        voxelGridLayoutBinding,
+        seedsInLayoutBinding,
+        seedsOutLayoutBinding
       };
 
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
@@ -1522,21 +2241,34 @@ static b8 CreateJumpFloodingComputePipeline()
 
   // Create Descriptor Sets
   {
+    const VkDescriptorSetLayout layouts[] =
+      {
+        compJumpFloodingPipeline.descriptorSetLayout,
+        compJumpFloodingPipeline.descriptorSetLayout
+      };
+
     VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
     descriptorSetAllocateInfo.descriptorPool     = Renderer::GetDescriptorPool();
-    descriptorSetAllocateInfo.descriptorSetCount = 1;
-    descriptorSetAllocateInfo.pSetLayouts        = &compJumpFloodingPipeline.descriptorSetLayout;
+    descriptorSetAllocateInfo.descriptorSetCount = ARRAY_SIZE(jumpFloodingDescriptorSets);
+    descriptorSetAllocateInfo.pSetLayouts        = layouts;
 
-    VK_SUCCESS_CHECK(vkAllocateDescriptorSets(device.logicalDevice, &descriptorSetAllocateInfo, &compJumpFloodingPipeline.descriptorSet));
+    VK_SUCCESS_CHECK(vkAllocateDescriptorSets(device.logicalDevice, &descriptorSetAllocateInfo, jumpFloodingDescriptorSets));
   }
 
   // Create pipeline layout
   {
+    const VkPushConstantRange pushConstant =
+      {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset     = 0,
+        .size       = sizeof(JumpFloodPushConstant)
+      };
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
     pipelineLayoutInfo.setLayoutCount         = 1;
     pipelineLayoutInfo.pSetLayouts            = &compJumpFloodingPipeline.descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges    = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges    = &pushConstant;
 
     VK_SUCCESS_CHECK(vkCreatePipelineLayout(device.logicalDevice, &pipelineLayoutInfo, nullptr, &compJumpFloodingPipeline.pipelineLayout));
   }
@@ -1568,32 +2300,5 @@ static b8 CreateJumpFloodingComputePipeline()
     vkDestroyShaderModule(device.logicalDevice, computeShaderModule, nullptr);
   }
 
-  // Create UBO voxel grid input buffer
-  {
-    VkDeviceSize bufferSize = sizeof(UBOCompJumpFloodInput);
-    compJumpFloodingPipeline.inputBufferUBO.Create(device, bufferSize,
-                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT );
-
-    // Update descriptor sets
-    VkDescriptorBufferInfo inputBufferInfo = {};
-    inputBufferInfo.buffer = compJumpFloodingPipeline.inputBufferUBO.buffer;
-    inputBufferInfo.offset = 0;
-    inputBufferInfo.range  = compJumpFloodingPipeline.inputBufferUBO.size;
-
-    VkWriteDescriptorSet inputDescriptorWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    inputDescriptorWrite.dstSet           = compJumpFloodingPipeline.descriptorSet;
-    inputDescriptorWrite.dstBinding       = 0;
-    inputDescriptorWrite.dstArrayElement  = 0;
-    inputDescriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    inputDescriptorWrite.descriptorCount  = 1;
-    inputDescriptorWrite.pBufferInfo      = &inputBufferInfo;
-    inputDescriptorWrite.pImageInfo       = nullptr;
-    inputDescriptorWrite.pTexelBufferView = nullptr;
-
-    vkUpdateDescriptorSets(device.logicalDevice, 1, &inputDescriptorWrite, 0, nullptr);
-  }
-
   return true;
 }
\ No newline at end of file
@@ -7,15 +7,48 @@
 // containers
 #include "containers/FArray.hpp"
 
+// geometry
+#include "geometry/SdfEncoding.hpp"
+
 // Forward Declarations
 struct Mesh;
+struct SdfVolume;
+
+enum class SdfBakeMethod : u8
+{
+  GPU_NAIVE,          // Every cell tests every triangle in a compute shader
+  GPU_JUMP_FLOODING,  // Cells near the surface test the triangles, then the distances are flooded out
+  GPU_FAST_SWEEPING,  // Cells near the surface test the triangles, then SdfVolume::FastSweep fills in the rest on the CPU
+  CPU,                // SdfVolume::BakeMesh, the sign comes from the closest triangle
+  CPU_WINDING_NUMBER, // SdfVolume::BakeMesh, the sign comes from the winding number
+};
+
+enum class SdfStorage : u8
+{
+  DENSE,         // Every cell is stored in a single 3D image
+  SPARSE_BRICKS, // Only the bricks near the surface are stored, see SdfBrickVolume. Always baked on the CPU
+};
 
 struct SdfVoxelGrid
 {
   static b8 CreateComputePipeline();
   static void CleanUpComputePipeline();
 
-  static void Create(SdfVoxelGrid* voxelGrid, b8 useJumpFlooding, const Mesh* mesh, glm::uvec3 uCellCount);
+  /**
+  * @brief Bake the mesh into a new voxel grid. The compute pipelines must have been
+  * created when using one of the GPU bake methods. When the same mesh has been baked
+  * with the same parameters before it is loaded from the SdfBakeCache instead, otherwise
+  * the new bake is saved to the cache.
+  * @param voxelGrid Voxel grid to create.
+  * @param bakeMethod How the signed distances are calculated.
+  * @param storage How the signed distances are stored on the GPU.
+  * @param format Format of the signed distances on the GPU, every format other than
+  * F32 is baked on the CPU.
+  * @param mesh Mesh to bake.
+  * @param uCellCount Number of cells on each axis.
+  */
+  static void Create(SdfVoxelGrid* voxelGrid, SdfBakeMethod bakeMethod, SdfStorage storage,
+                     SdfFormat format, const Mesh* mesh, glm::uvec3 uCellCount);
   static void Release(SdfVoxelGrid* sdfVolume);
 
   // --- Member Data --- //
@@ -55,9 +88,24 @@ struct SdfVoxelGrid
   glm::vec4 sphere = {0.0f, 0.5f, 5.0f, 0.1f};
   float sphereBlend = 0.1f;
 
+  SdfStorage storage = SdfStorage::DENSE;
+
+  /** @brief How the distances in the image are encoded, the brick grid is always F32. */
+  SdfEncoding encoding = {};
+
+  /**
+  * @brief The number of bricks on each axis of the top-level grid
+  * and the brick atlas. Both are 0 when the storage is dense.
+  */
+  glm::uvec3 brickCount      = { 0, 0, 0 };
+  glm::uvec3 brickAtlasCount = { 0, 0, 0 };
+
+  // NOTE(WSWhitehouse): When using sparse bricks the image is the brick
+  // atlas and the top-level grid is stored in the brick grid buffer...
   vk::Image image        = {};
   VkImageView imageView  = VK_NULL_HANDLE;
   VkSampler imageSampler = VK_NULL_HANDLE;
+  vk::Buffer brickGrid   = {};
 
   FArray<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets           = {VK_NULL_HANDLE};
   FArray<vk::Buffer,      MAX_FRAMES_IN_FLIGHT> dataUniformBuffer        = {{}};
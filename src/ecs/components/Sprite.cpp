@@ -336,16 +336,11 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
 
   if (spriteSparseSet->componentCount <= 0) return;
 
-  for (u32 spriteIndex = 0; spriteIndex < spriteSparseSet->componentCount; ++spriteIndex)
+  ecs.View<Sprite, Transform>().Each([&](Sprite& sprite, const Transform& transform)
   {
-    ComponentData<Sprite>& componentData = ((ComponentData<Sprite>*)spriteSparseSet->componentArray)[spriteIndex];
-    Sprite& sprite = componentData.component;
+    if (!sprite.render) return;
 
-    if (!sprite.render) continue;
-
-    Transform* transform = ecs.GetComponent<Transform>(componentData.entity);
-
-    glm::mat4 wvMat = camera.viewMatrix * transform->matrix;
+    glm::mat4 wvMat = camera.viewMatrix * transform.matrix;
     // https://www.geeks3d.com/20140807/billboarding-vertex-shader-glsl/
     if (sprite.billboard != Sprite::BillboardType::DISABLED)
     {
@@ -368,7 +363,7 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
     UBOSpriteData* spriteData = (UBOSpriteData*)sprite.spriteDataUBOMapped[currentFrame];
     mem_zero(spriteData, sizeof(UBOSpriteData));
     spriteData->WVP         = camera.projMatrix * wvMat;
-    spriteData->worldMat    = transform->matrix;
+    spriteData->worldMat    = transform.matrix;
     spriteData->textureSize = sprite.textureSize;
     spriteData->size        = sprite.size;
 
@@ -387,7 +382,7 @@ static void Render(ECS::Manager& ecs, const Camera& camera, VkCommandBuffer cmdB
 
     // Render quad...
     vkCmdDraw(cmdBuffer, 6, 1, 0, 0);
-  }
+  });
 }
 
 static void CleanUp()
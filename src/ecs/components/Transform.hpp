@@ -6,14 +6,40 @@
 #include "imgui.h"
 #include "math/Math.hpp"
 
+// ecs
+#include "ecs/managers/Component.hpp"
+
 struct Transform
 {
   glm::vec3 position = { 0.0f, 0.0f, 0.0f };
   glm::vec3 rotation = { 0.0f, 0.0f, 0.0f }; // euler angles
   glm::vec3 scale    = { 1.0f, 1.0f, 1.0f };
 
+  // NOTE(WSWhitehouse): The world matrix, built by the TransformSystem. For entities with a
+  // parent (see ECS::Manager::SetParent) the position, rotation and scale are relative to
+  // the parent, and the matrix is the parent's matrix multiplied by the TRS matrix.
   glm::mat4x4 matrix = glm::mat4x4(1.0f);
 
+  // NOTE(WSWhitehouse): The TRS matrix, only built for entities in the hierarchy. The
+  // TransformSystem multiplies it by the parent's matrix to build the world matrix.
+  glm::mat4x4 localMatrix = glm::mat4x4(1.0f);
+
+  // NOTE(WSWhitehouse): The TransformSystem only rebuilds the matrix of dirty transforms,
+  // so the position, rotation and scale must be changed through the mutation helpers
+  // below, or call MarkDirty() after writing to them directly. Cleared by the TransformSystem.
+  b8 dirty = true;
+
+  // --- MUTATION FUNCTIONS --- //
+
+  INLINE void MarkDirty() { dirty = true; }
+
+  INLINE void SetPosition(const glm::vec3& _position) { position = _position; dirty = true; }
+  INLINE void SetRotation(const glm::vec3& _rotation) { rotation = _rotation; dirty = true; }
+  INLINE void SetScale(const glm::vec3& _scale)       { scale    = _scale;    dirty = true; }
+
+  INLINE void Translate(const glm::vec3& translation) { position += translation; dirty = true; }
+  INLINE void Rotate(const glm::vec3& eulerAngles)    { rotation += eulerAngles; dirty = true; }
+
   // --- UTILITY FUNCTIONS --- //
 
   [[nodiscard]]
@@ -37,11 +63,21 @@ struct Transform
   INLINE void DrawGUI(const char* title)
   {
     ImGui::Begin(title);
-    ImGui::InputFloat3("position",  glm::value_ptr(position));
-    ImGui::SliderFloat3("rotation", glm::value_ptr(rotation), 0.0f, 360.0f);
-    ImGui::InputFloat3("scale",     glm::value_ptr(scale));
+    if (ImGui::InputFloat3("position",  glm::value_ptr(position)))               MarkDirty();
+    if (ImGui::SliderFloat3("rotation", glm::value_ptr(rotation), 0.0f, 360.0f)) MarkDirty();
+    if (ImGui::InputFloat3("scale",     glm::value_ptr(scale)))                  MarkDirty();
     ImGui::End();
   }
 };
 
+template<>
+struct ECS::ComponentSnapshot<Transform>
+{
+  static constexpr const u32 SCHEMA_VERSION = 2;
+
+  // NOTE(WSWhitehouse): The hierarchy is restored after the components, so the
+  // matrices are rebuilt by the TransformSystem rather than trusting the saved ones...
+  static INLINE void FixUp(Transform& transform) { transform.MarkDirty(); }
+};
+
 #endif //SNOWFLAKE_TRANSFORM_HPP
@@ -4,10 +4,15 @@
 #include "pch.hpp"
 
 #include <new> // placement new
+#include <type_traits>
 
 // core
+#include "core/Assert.hpp"
 #include "core/Logging.hpp"
 
+// containers
+#include "containers/BitSet.hpp"
+
 // ECS includes
 #include "ecs/Entity.hpp"
 
@@ -47,6 +52,31 @@ namespace ECS
     T component   = {};
   };
 
+  /**
+  * @brief Components can opt into being saved in ECS snapshots (see Manager::SaveSnapshot)
+  * by specialising this struct. The dense component arrays are saved as raw bytes, so a
+  * component must be trivially copyable and only hold data that is still valid when
+  * loaded in another run (no pointers, GPU resources, etc.). Bump the schema version
+  * whenever the layout of the component changes, saved components with a different
+  * version are skipped when loading.
+  * Specialisations must provide:
+  *   - `static constexpr const u32 SCHEMA_VERSION = n;` (non-zero)
+  *   - `static void FixUp(T& component);` called on every component after it's loaded.
+  * @tparam T Component Type.
+  */
+  template<typename T>
+  struct ComponentSnapshot
+  {
+    static constexpr const u32 SCHEMA_VERSION = 0;
+  };
+
+  /** @brief True when the component has opted into snapshots. See ComponentSnapshot. */
+  template<typename T>
+  inline constexpr b8 HAS_SNAPSHOT_SUPPORT = ComponentSnapshot<T>::SCHEMA_VERSION != 0;
+
+  /** @brief The group index of a component set that isn't owned by a group. See ECS::Group. */
+  static constexpr const u32 NO_GROUP_INDEX = U32_MAX;
+
   /**
   * @brief The sparse set used to manage components and entity
   * relationships. This is used in the ECS::Manager to hold
@@ -54,11 +84,34 @@ namespace ECS
   */
   struct ComponentSparseSet
   {
+    // NOTE(WSWhitehouse): The sparse array (and entity mask) is indexed by the entity
+    // index, see EntityIndex(). It only grows to fit the largest entity index that has
+    // been given this component, so rarely used components stay small.
     u32* entitySparseArray = nullptr;
+    u32 sparseCapacity     = 0;
+
+    // NOTE(WSWhitehouse): The dense array grows as components are added, up to the
+    // max count the component was registered with.
     void* componentArray   = nullptr;
     u32 componentCount     = 0;
+    u32 componentCapacity  = 0;
     u32 componentStride    = 0;
 
+    // NOTE(WSWhitehouse): The owning group this set belongs to, a set can only be owned
+    // by a single group. The groups entities are packed at the front of the dense array.
+    u32 groupIndex         = NO_GROUP_INDEX;
+
+    // NOTE(WSWhitehouse): One bit per entity, set when the entity has this component.
+    // Multi-component queries AND these masks together rather than probing each set.
+    DBitSet entityMask     = {};
+
+    // NOTE(WSWhitehouse): The change version of every component, parallel to the dense
+    // array. A component is stamped with the current version of the ECS::Manager when it
+    // is added, moved to another dense index, fetched for writing or marked as changed.
+    // See Manager::AdvanceChangeVersion().
+    u32* changeVersions    = nullptr;
+    u32 changeVersion      = 0;
+
     /**
     * @brief Add component to entity
     * @param entity Entity to add component too.
@@ -79,6 +132,10 @@ namespace ECS
         return nullptr;
       }
 
+      const u32 entityIndex = EntityIndex(entity);
+      EnsureSparseCapacity(entityIndex);
+      EnsureComponentCapacity(componentCount + 1, Component<T>::MAX_COUNT);
+
       ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
 
       compArray[componentCount].entity = entity;
@@ -89,13 +146,96 @@ namespace ECS
       // allows values to be set to their default, etc.
       new (&compArray[componentCount].component) T();
 
-      entitySparseArray[entity] = componentCount;
+      entitySparseArray[entityIndex] = componentCount;
+      entityMask.Set(entityIndex);
+      changeVersions[componentCount] = changeVersion;
 
       componentCount++;
 
       return GetComponent<T>(entity);
     }
 
+    /**
+    * @brief Add the component to many entities at once. The sparse and dense arrays are
+    * grown once for the whole batch and the new components are written as one contiguous
+    * block of the dense array. Trivially copyable components are cloned from the prototype
+    * with mem_copy. Either every entity gets the component or none do.
+    * @param entities Entities to add the component too, fails if it contains duplicates.
+    * @param count Number of entities.
+    * @param prototype The initial value of every new component.
+    * @return Pointer to the first new component, the rest follow it in the dense array
+    * (see ComponentData<T> for the stride). Returns nullptr on failure.
+    */
+    template<typename T>
+    INLINE T* AddComponents(const Entity* entities, u32 count, const T& prototype)
+    {
+      if (count == 0) return nullptr;
+
+      if ((u64)componentCount + count > Component<T>::MAX_COUNT)
+      {
+        LOG_ERROR("Max component count hit on '%s' Component!", Component<T>::NAME);
+        return nullptr;
+      }
+
+      u32 maxEntityIndex = 0;
+      for (u32 i = 0; i < count; ++i)
+      {
+        if (HasComponent<T>(entities[i]))
+        {
+          LOG_ERROR("Trying to add %s component to entity which already has this component!", Component<T>::NAME);
+          return nullptr;
+        }
+
+        maxEntityIndex = MAX(maxEntityIndex, EntityIndex(entities[i]));
+      }
+
+      EnsureSparseCapacity(maxEntityIndex);
+
+      // NOTE(WSWhitehouse): The entity mask doubles as the scratch set to find duplicate
+      // entities, the new entities are marked up front and unmarked again on failure...
+      for (u32 i = 0; i < count; ++i)
+      {
+        const u32 entityIndex = EntityIndex(entities[i]);
+        if (entityMask.Test(entityIndex))
+        {
+          for (u32 j = 0; j < i; ++j) { entityMask.Reset(EntityIndex(entities[j])); }
+
+          LOG_ERROR("Trying to add %s component to the same entity more than once!", Component<T>::NAME);
+          return nullptr;
+        }
+
+        entityMask.Set(entityIndex);
+      }
+
+      EnsureComponentCapacity(componentCount + count, Component<T>::MAX_COUNT);
+
+      ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
+      const u32 firstIndex = componentCount;
+
+      for (u32 i = 0; i < count; ++i)
+      {
+        ComponentData<T>& componentData = compArray[firstIndex + i];
+        const u32 entityIndex = EntityIndex(entities[i]);
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+          mem_copy(&componentData.component, &prototype, sizeof(T));
+        }
+        else
+        {
+          new (&componentData.component) T(prototype);
+        }
+
+        componentData.entity           = entities[i];
+        entitySparseArray[entityIndex] = firstIndex + i;
+        changeVersions[firstIndex + i] = changeVersion;
+      }
+
+      componentCount += count;
+
+      return &compArray[firstIndex].component;
+    }
+
     /**
     * @brief Remove a component from the entity.
     * @param entity Entity to remove component from.
@@ -110,12 +250,14 @@ namespace ECS
       T* component = GetComponent<T>(entity);
       component->~T();
 
+      entityMask.Reset(EntityIndex(entity));
+
       componentCount--;
 
       // Move the last item in the dense component array into the empty
       // slot where the item we want to remove is...
       const u32 lastComponentIndex = componentCount;
-      const u32 componentIndex     = entitySparseArray[entity];
+      const u32 componentIndex     = entitySparseArray[EntityIndex(entity)];
 
       // Copy the data to the new index, using mem_copy to avoid copy ctors, etc.
       ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
@@ -123,7 +265,56 @@ namespace ECS
                &compArray[lastComponentIndex],
                sizeof(ComponentData<T>));
 
-      entitySparseArray[compArray[componentIndex].entity] = componentIndex;
+      // NOTE(WSWhitehouse): The last component has moved, anything indexed by the
+      // dense index (i.e. GPU buffers) must see it as changed...
+      changeVersions[componentIndex] = changeVersion;
+
+      entitySparseArray[EntityIndex(compArray[componentIndex].entity)] = componentIndex;
+    }
+
+    /**
+    * @brief Remove the component from every entity index set in the bit set, in a single
+    * pass over the dense array. Unlike RemoveComponent the remaining components are
+    * compacted in order rather than swapped with the last, so an owning group's entities
+    * stay packed at the front (see ECS::Group) and no per entity fix ups are needed.
+    * @param entityIndices One bit per entity index (see EntityIndex()) to remove, must be
+    * large enough for every entity index in the set.
+    * @param firstIndex Dense index of the first component to remove, nothing before it is touched.
+    * @return Number of components removed.
+    */
+    template<typename T>
+    INLINE u32 RemoveEntities(const DBitSet& entityIndices, u32 firstIndex)
+    {
+      ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
+
+      u32 writeIndex = firstIndex;
+      for (u32 readIndex = firstIndex; readIndex < componentCount; ++readIndex)
+      {
+        const u32 entityIndex = EntityIndex(compArray[readIndex].entity);
+
+        if (entityIndices.Test(entityIndex))
+        {
+          compArray[readIndex].component.~T();
+          entityMask.Reset(entityIndex);
+          continue;
+        }
+
+        if (writeIndex != readIndex)
+        {
+          mem_copy(&compArray[writeIndex], &compArray[readIndex], sizeof(ComponentData<T>));
+
+          // NOTE(WSWhitehouse): The component has moved, see RemoveComponent...
+          entitySparseArray[entityIndex] = writeIndex;
+          changeVersions[writeIndex]     = changeVersion;
+        }
+
+        writeIndex++;
+      }
+
+      const u32 removedCount = componentCount - writeIndex;
+
+      componentCount = writeIndex;
+      return removedCount;
     }
 
     /**
@@ -134,11 +325,24 @@ namespace ECS
     template<typename T>
     [[nodiscard]] INLINE b8 HasComponent(Entity entity) const
     {
-      const u32& componentIndex = entitySparseArray[entity];
-      if (componentIndex >= componentCount) return false;
+      const u32 entityIndex = EntityIndex(entity);
+      if (!HasEntityIndex(entityIndex)) return false;
 
-      ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
-      return compArray[componentIndex].entity == entity;
+      // NOTE(WSWhitehouse): The index matches, make sure the generation does too.
+      // Otherwise this is a stale handle to an entity which has been destroyed...
+      const ComponentData<T>* compArray = (const ComponentData<T>*)componentArray;
+      return compArray[entitySparseArray[entityIndex]].entity == entity;
+    }
+
+    /**
+    * @brief Check if an entity index has this component. Doesn't check the entity
+    * generation, used when the entity has come from a dense array and must be alive.
+    * @param entityIndex Entity index to check, see EntityIndex().
+    * @return True if the entity index has this component; false otherwise.
+    */
+    [[nodiscard]] INLINE b8 HasEntityIndex(u32 entityIndex) const
+    {
+      return entityIndex < sparseCapacity && entityMask.Test(entityIndex);
     }
 
     /**
@@ -152,11 +356,115 @@ namespace ECS
     template<typename T>
     [[nodiscard]] INLINE T* GetComponent(Entity entity) const
     {
-      const u32& componentIndex = entitySparseArray[entity];
+      const u32& componentIndex = entitySparseArray[EntityIndex(entity)];
       ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
       return &compArray[componentIndex].component;
     }
 
+    /**
+    * @brief Gets the component associated with the entity and marks it as changed, use
+    * this rather than GetComponent when the component is going to be modified. Does not
+    * perform any safety checks on entity, see GetComponent.
+    * @param entity Entity to get the component from.
+    * @return Pointer to component.
+    */
+    template<typename T>
+    [[nodiscard]] INLINE T* GetComponentForWrite(Entity entity)
+    {
+      const u32 componentIndex = entitySparseArray[EntityIndex(entity)];
+      changeVersions[componentIndex] = changeVersion;
+
+      ComponentData<T>* compArray = (ComponentData<T>*)componentArray;
+      return &compArray[componentIndex].component;
+    }
+
+    /**
+    * @brief Stamp the component at the dense index with the current change version.
+    * Different indices can be marked from multiple threads at once.
+    * @param denseIndex Index of the component in the dense array.
+    */
+    INLINE void MarkChanged(u32 denseIndex)
+    {
+      changeVersions[denseIndex] = changeVersion;
+    }
+
+    /**
+    * @brief Check if the component at the dense index has changed since the version.
+    * @param denseIndex Index of the component in the dense array.
+    * @param version Version to compare against, see Manager::AdvanceChangeVersion().
+    * @return True if the component was stamped after the version; false otherwise.
+    */
+    [[nodiscard]] INLINE b8 ChangedSince(u32 denseIndex, u32 version) const
+    {
+      return changeVersions[denseIndex] > version;
+    }
+
+    /**
+    * @brief Grow the sparse array and entity mask so the entity index can be stored.
+    * Grows in multiples of ENTITY_CHUNK_SIZE and at least doubles the capacity.
+    * @param entityIndex Entity index that must fit in the sparse array.
+    */
+    INLINE void EnsureSparseCapacity(u32 entityIndex)
+    {
+      if (entityIndex < sparseCapacity) return;
+
+      const u32 requiredCapacity = ((entityIndex / ENTITY_CHUNK_SIZE) + 1) * ENTITY_CHUNK_SIZE;
+      const u32 newCapacity      = (u32)MIN(MAX((u64)requiredCapacity, (u64)sparseCapacity * 2), (u64)MAX_ENTITY_COUNT);
+
+      entitySparseArray = (u32*)mem_realloc(entitySparseArray, sizeof(u32) * newCapacity);
+      entityMask.Resize(newCapacity);
+      sparseCapacity = newCapacity;
+    }
+
+    /**
+    * @brief Grow the dense component array to fit the required number of components.
+    * Doubles the capacity, up to the max count the component was registered with.
+    * @param requiredCapacity Number of components that must fit in the dense array.
+    * @param maxCount Max number of components of this type.
+    */
+    INLINE void EnsureComponentCapacity(u32 requiredCapacity, u32 maxCount)
+    {
+      if (requiredCapacity <= componentCapacity) return;
+
+      const u32 newCapacity = (u32)MIN(MAX((u64)requiredCapacity, (u64)componentCapacity * 2), (u64)maxCount);
+
+      componentArray    = mem_realloc(componentArray, (u64)componentStride * newCapacity);
+      changeVersions    = (u32*)mem_realloc(changeVersions, sizeof(u32) * newCapacity);
+      componentCapacity = newCapacity;
+    }
+
+    /**
+    * @brief Swap two components in the dense array, updating the sparse array. This is type-erased so groups can reorder sets of any component type.
+    * @param lhs Dense index of the first component.
+    * @param rhs Dense index of the second component.
+    */
+    INLINE void SwapDense(u32 lhs, u32 rhs)
+    {
+      if (lhs == rhs) return;
+
+      byte* lhsData = (byte*)componentArray + ((u64)lhs * componentStride);
+      byte* rhsData = (byte*)componentArray + ((u64)rhs * componentStride);
+
+      // NOTE(WSWhitehouse): Swap through a small stack buffer in chunks, components are
+      // already moved around using mem_copy (see RemoveComponent) so this is safe.
+      byte temp[128];
+      for (u64 offset = 0; offset < componentStride; offset += sizeof(temp))
+      {
+        const u64 size = MIN(sizeof(temp), componentStride - offset);
+        mem_copy(temp, lhsData + offset, size);
+        mem_copy(lhsData + offset, rhsData + offset, size);
+        mem_copy(rhsData + offset, temp, size);
+      }
+
+      // The entity is the first member of every ComponentData<T>...
+      entitySparseArray[EntityIndex(*(Entity*)lhsData)] = lhs;
+      entitySparseArray[EntityIndex(*(Entity*)rhsData)] = rhs;
+
+      // NOTE(WSWhitehouse): Both components have moved, see RemoveComponent...
+      changeVersions[lhs] = changeVersion;
+      changeVersions[rhs] = changeVersion;
+    }
+
   };
 
 } // namespace ECS
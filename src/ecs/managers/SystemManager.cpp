@@ -1,3 +1,230 @@
 #include "SystemManager.hpp"
 
-using namespace ECS;
\ No newline at end of file
+// core
+#include "core/Abort.hpp"
+#include "core/Logging.hpp"
+#include "core/Platform.hpp"
+
+// ECS includes
+#include "ecs/ECS.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+#include "imgui.h"
+
+using namespace ECS;
+
+void SystemManager::Create()
+{
+  systemCount = 0;
+  stageCount  = 0;
+}
+
+void SystemManager::Destroy()
+{
+  systemCount = 0;
+  stageCount  = 0;
+}
+
+SystemDesc& SystemManager::RegisterSystem(const char* name, SystemUpdateFuncPtr update)
+{
+  if (systemCount >= ECS_MAX_SYSTEM_COUNT)
+  {
+    LOG_FATAL("Max ECS system count hit, can't register '%s' System!", name);
+    ABORT(AbortCode::ABORT_CODE_ECS_FAILURE);
+  }
+
+  SystemDesc& system    = systems[systemCount];
+  system.name           = name;
+  system.update         = update;
+  system.readMask       = 0;
+  system.writeMask      = 0;
+  system.mainThreadOnly = false;
+  system.lastUpdateTime = 0.0;
+
+  systemCount++;
+  return system;
+}
+
+void SystemManager::BuildSchedule()
+{
+  // NOTE(WSWhitehouse): Edges only go from a system to one registered before it, so the
+  // registration order is already a topological order and the DAG can't have a cycle.
+  // A system's stage is one past the latest stage of anything it depends on...
+  stageCount = 0;
+  for (u32 i = 0; i < systemCount; ++i)
+  {
+    dependencies[i] = 0;
+    stages[i]       = 0;
+
+    for (u32 j = 0; j < i; ++j)
+    {
+      if (!systems[i].ConflictsWith(systems[j])) continue;
+
+      dependencies[i] |= 1U << j;
+      stages[i]        = MAX(stages[i], stages[j] + 1);
+    }
+
+    stageCount = MAX(stageCount, stages[i] + 1);
+  }
+
+  // Counting sort the systems by stage, keeping the registration order within a stage...
+  for (u32 i = 0; i <= stageCount; ++i) { stageOffsets[i] = 0; }
+  for (u32 i = 0; i < systemCount; ++i) { stageOffsets[stages[i] + 1]++; }
+  for (u32 i = 0; i < stageCount;  ++i) { stageOffsets[i + 1] += stageOffsets[i]; }
+
+  u32 stageCursor[ECS_MAX_SYSTEM_COUNT];
+  for (u32 i = 0; i < stageCount; ++i) { stageCursor[i] = stageOffsets[i]; }
+  for (u32 i = 0; i < systemCount; ++i)
+  {
+    order[stageCursor[stages[i]]] = i;
+    stageCursor[stages[i]]++;
+  }
+}
+
+static INLINE void RunSystem(SystemDesc& system, Manager& ecs)
+{
+  const f64 startTime = Platform::GetTime();
+  system.update(ecs);
+  system.lastUpdateTime = Platform::GetTime() - startTime;
+}
+
+void SystemManager::Update(Manager& ecs)
+{
+  BuildSchedule();
+
+  // NOTE(WSWhitehouse): Systems use ParallelEach internally, which blocks the thread it's
+  // called on until its batches are complete. Leave at least one worker free of system
+  // jobs so the nested batches can always make progress, any extra systems in the stage
+  // are run on the calling thread instead.
+  const u64 workerCount = JobSystem::GetWorkerThreadCount();
+  const u64 maxJobCount = workerCount > 0 ? workerCount - 1 : 0;
+
+  JobSystem::JobHandle jobs[ECS_MAX_SYSTEM_COUNT];
+  u32 callerSystems[ECS_MAX_SYSTEM_COUNT];
+
+  for (u32 stage = 0; stage < stageCount; ++stage)
+  {
+    const u32 stageStart = stageOffsets[stage];
+    const u32 stageEnd   = stageOffsets[stage + 1];
+
+    u32 jobCount    = 0;
+    u32 callerCount = 0;
+
+    for (u32 i = stageStart; i < stageEnd; ++i)
+    {
+      SystemDesc& system = systems[order[i]];
+
+      // NOTE(WSWhitehouse): Always keep one system for the calling thread rather than
+      // leaving it idle while it waits...
+      const b8 isLastSystem = i == stageEnd - 1 && callerCount == 0;
+      if (system.mainThreadOnly || isLastSystem || jobCount >= maxJobCount)
+      {
+        callerSystems[callerCount] = order[i];
+        callerCount++;
+        continue;
+      }
+
+      jobs[jobCount] = JobSystem::SubmitJob([&system, &ecs] { RunSystem(system, ecs); });
+      jobCount++;
+    }
+
+    for (u32 i = 0; i < callerCount; ++i)
+    {
+      RunSystem(systems[callerSystems[i]], ecs);
+    }
+
+    for (u32 i = 0; i < jobCount; ++i)
+    {
+      jobs[i].WaitUntilComplete();
+    }
+  }
+}
+
+void SystemManager::LogSchedule() const
+{
+  LOG_INFO("ECS System Schedule: %u systems in %u stages", systemCount, stageCount);
+
+  for (u32 stage = 0; stage < stageCount; ++stage)
+  {
+    for (u32 i = stageOffsets[stage]; i < stageOffsets[stage + 1]; ++i)
+    {
+      const SystemDesc& system = systems[order[i]];
+      LOG_INFO("  Stage %u: %s%s", stage, system.name, system.mainThreadOnly ? " (main thread)" : "");
+
+      for (u32 dependency = 0; dependency < systemCount; ++dependency)
+      {
+        if ((dependencies[order[i]] & (1U << dependency)) == 0) continue;
+        LOG_INFO("    after %s", systems[dependency].name);
+      }
+    }
+  }
+}
+
+static void DrawComponentMask(const char* label, u64 mask)
+{
+  ImGui::Text("%s:", label);
+
+  if (mask == 0)
+  {
+    ImGui::SameLine();
+    ImGui::TextDisabled("none");
+    return;
+  }
+
+  for (u64 index = 0; index < ECS_MAX_SYSTEM_COMPONENT_COUNT; ++index)
+  {
+    if ((mask & (1ULL << index)) == 0) continue;
+
+    ImGui::SameLine();
+    ImGui::Text("%s", Manager::GetComponentName(index));
+  }
+}
+
+void SystemManager::DrawDebugGUI(const char* title) const
+{
+  ImGui::Begin(title);
+  ImGui::Text("%u systems in %u stages", systemCount, stageCount);
+
+  for (u32 stage = 0; stage < stageCount; ++stage)
+  {
+    if (!ImGui::TreeNodeEx((void*)(u64)stage, ImGuiTreeNodeFlags_DefaultOpen, "Stage %u", stage)) continue;
+
+    for (u32 i = stageOffsets[stage]; i < stageOffsets[stage + 1]; ++i)
+    {
+      const u32 systemIndex    = order[i];
+      const SystemDesc& system = systems[systemIndex];
+
+      if (!ImGui::TreeNode(system.name, "%s (%.3f ms)%s", system.name, system.lastUpdateTime * 1000.0,
+                           system.mainThreadOnly ? " [main thread]" : ""))
+      {
+        continue;
+      }
+
+      DrawComponentMask("Reads",  system.readMask & ~system.writeMask);
+      DrawComponentMask("Writes", system.writeMask);
+
+      ImGui::Text("After:");
+      if (dependencies[systemIndex] == 0)
+      {
+        ImGui::SameLine();
+        ImGui::TextDisabled("none");
+      }
+
+      for (u32 dependency = 0; dependency < systemCount; ++dependency)
+      {
+        if ((dependencies[systemIndex] & (1U << dependency)) == 0) continue;
+
+        ImGui::SameLine();
+        ImGui::Text("%s", systems[dependency].name);
+      }
+
+      ImGui::TreePop();
+    }
+
+    ImGui::TreePop();
+  }
+
+  ImGui::End();
+}
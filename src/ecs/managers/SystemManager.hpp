@@ -3,27 +3,135 @@
 
 #include "pch.hpp"
 
-// std lib
-#include <functional>
+// ECS includes
+#include "ecs/managers/Component.hpp"
 
-// Forward Declarations
-//struct AppTime;
-//struct StackAllocator;
-//class Renderer;
-//struct VkCommandBuffer;
+#define ECS_MAX_SYSTEM_COUNT           32
+#define ECS_MAX_SYSTEM_COMPONENT_COUNT 64
 
 namespace ECS
 {
 
-  class SystemManager
+  // Forward Declarations
+  struct Manager;
+
+  typedef void (*SystemUpdateFuncPtr)(Manager& ecs);
+
+  /**
+  * @brief A system registered with the SystemManager. The read/write access is
+  * declared with `Reads<Ts...>()` and `Writes<Ts...>()`, the SystemManager uses it to
+  * work out which systems can run at the same time. A system that writes a component
+  * type conflicts with any other system that reads or writes it.
+  */
+  struct SystemDesc
   {
-     // --- FUNCTION PTR TYPEDEFS --- //
-//     typedef std::function<void(const AppTime& appTime, StackAllocator& allocator)> UpdateFuncPtr;
-//     typedef std::function<void(Renderer* renderer, VkCommandBuffer cmdBuffer)>     RenderFuncPtr;
+    const char* name;
+    SystemUpdateFuncPtr update;
+
+    // NOTE(WSWhitehouse): One bit per component index...
+    u64 readMask;
+    u64 writeMask;
+
+    // NOTE(WSWhitehouse): Systems that touch the window, input or any other
+    // main thread only API must set this, they are never run on a worker thread.
+    b8 mainThreadOnly;
+
+    // Debug info, written when the systems are updated...
+    f64 lastUpdateTime;
+
+    /** @brief Declare the component types the system reads. */
+    template<typename... Ts>
+    INLINE SystemDesc& Reads()
+    {
+      ((readMask |= ComponentBit<Ts>()), ...);
+      return *this;
+    }
+
+    /** @brief Declare the component types the system writes, writing implies reading. */
+    template<typename... Ts>
+    INLINE SystemDesc& Writes()
+    {
+      ((writeMask |= ComponentBit<Ts>()), ...);
+      return *this;
+    }
+
+    /** @brief Only ever run the system on the main thread. */
+    INLINE SystemDesc& MainThreadOnly()
+    {
+      mainThreadOnly = true;
+      return *this;
+    }
+
+    /** @brief Returns true if the systems can't run at the same time. */
+    [[nodiscard]] INLINE b8 ConflictsWith(const SystemDesc& other) const noexcept
+    {
+      return (writeMask & (other.readMask | other.writeMask)) != 0 ||
+             (other.writeMask & readMask) != 0;
+    }
+
+  private:
+    template<typename T> [[nodiscard]]
+    static INLINE u64 ComponentBit()
+    {
+      ASSERT_MSG(Component<T>::INDEX < ECS_MAX_SYSTEM_COMPONENT_COUNT, "Component index is too large for the system access masks!");
+      return 1ULL << Component<T>::INDEX;
+    }
+  };
+
+  /**
+  * @brief Owns the ECS systems and schedules their updates. Every frame the systems
+  * are sorted into a dependency DAG using their declared read/write access: a system
+  * depends on every system registered before it that it conflicts with, so the
+  * registration order is kept wherever two systems touch the same data. The DAG is
+  * then split into stages, every system in a stage is independent of the others and
+  * they are run concurrently on the JobSystem. Each stage waits for the previous one.
+  *
+  * Systems run on worker threads so they must only touch the components they declare,
+  * structural changes (adding/removing components, creating/destroying entities)
+  * must be recorded into `ecs.GetCommandBuffer()`.
+  */
+  struct SystemManager
+  {
+    void Create();
+    void Destroy();
+
+    /**
+    * @brief Register a system, the returned desc is used to declare its access:
+    * `systems.RegisterSystem("Name", Func).Reads<A>().Writes<B>();`
+    * @param name Name of the system, used in the debug view. Must outlive the SystemManager.
+    * @param update The update function of the system.
+    */
+    SystemDesc& RegisterSystem(const char* name, SystemUpdateFuncPtr update);
+
+    /** @brief Build the schedule and run every system, blocks until they are all complete. */
+    void Update(Manager& ecs);
+
+    /** @brief Get the number of stages in the schedule of the last update. */
+    [[nodiscard]] INLINE u32 GetStageCount() const noexcept { return stageCount; }
+
+    /** @brief Get the number of registered systems. */
+    [[nodiscard]] INLINE u32 GetSystemCount() const noexcept { return systemCount; }
+
+    /** @brief Print the schedule of the last update to the log. */
+    void LogSchedule() const;
+
+    /** @brief Draw the schedule of the last update, and the time each system took, using ImGui. */
+    void DrawDebugGUI(const char* title) const;
+
+  private:
+    SystemDesc systems[ECS_MAX_SYSTEM_COUNT] = {};
+    u32 systemCount                          = 0;
+
+    // NOTE(WSWhitehouse): The schedule, rebuilt every update. `dependencies` holds a bit per
+    // system index. `order` holds the system indices sorted by stage, stage `i` is the range
+    // [stageOffsets[i], stageOffsets[i + 1]).
+    u32 dependencies[ECS_MAX_SYSTEM_COUNT]     = {};
+    u32 stages[ECS_MAX_SYSTEM_COUNT]           = {};
+    u32 order[ECS_MAX_SYSTEM_COUNT]            = {};
+    u32 stageOffsets[ECS_MAX_SYSTEM_COUNT + 1] = {};
+    u32 stageCount                             = 0;
 
-    // TODO(WSWhitehouse): Create a system that will automatically manage calling system updates and render
-    // functions, passing in the appropriate required parameters. This might not be 100% necessary as this
-    // could just be done manually on a per system basis... but is probably needed for a entire game.
+    void BuildSchedule();
   };
 
 } // namespace ECS
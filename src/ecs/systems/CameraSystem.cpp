@@ -17,17 +17,10 @@ static INLINE glm::mat4 CreateViewMatrixYXZ(glm::vec3 position, glm::vec3 rotati
 
 void CameraSystem::Update(ECS::Manager& ecs)
 {
-  ComponentSparseSet* sparseSet = ecs.GetComponentSparseSet<Camera>();
-  for (u32 i = 0; i < sparseSet->componentCount; ++i)
+  ecs.View<Camera, Transform>().Each([](Camera& camera, const Transform& transform)
   {
-    ComponentData<Camera>& componentData = ((ComponentData<Camera>*)sparseSet->componentArray)[i];
-    Camera& camera = componentData.component;
-
-    if (!ecs.HasComponent<Transform>(componentData.entity)) continue;
-    const Transform* transform = ecs.GetComponent<Transform>(componentData.entity);
-
-    UpdateCamera(camera, *transform);
-  }
+    UpdateCamera(camera, transform);
+  });
 }
 
 static INLINE void UpdateCamera(Camera& camera, const Transform& transform)
@@ -16,18 +16,11 @@ static INLINE void UpdatePosition(FlyCam& flyCam, Transform* transform);
 
 void FlyCamSystem::Update(ECS::Manager& ecs)
 {
-  ComponentSparseSet* sparseSet = ecs.GetComponentSparseSet<FlyCam>();
-  for (u32 i = 0; i < sparseSet->componentCount; ++i)
+  ecs.View<FlyCam, Transform>().Each([](FlyCam& flyCam, Transform& transform)
   {
-    ComponentData<FlyCam>& componentData = ((ComponentData<FlyCam>*)sparseSet->componentArray)[i];
-    FlyCam& flyCam = componentData.component;
-
-    if (!ecs.HasComponent<Transform>(componentData.entity)) continue;
-    Transform* transform = ecs.GetComponent<Transform>(componentData.entity);
-
-    UpdateRotation(flyCam, transform);
-    UpdatePosition(flyCam, transform);
-  }
+    UpdateRotation(flyCam, &transform);
+    UpdatePosition(flyCam, &transform);
+  });
 }
 
 static INLINE void UpdateRotation(FlyCam& flyCam, Transform* transform)
@@ -93,12 +86,11 @@ static INLINE void UpdateRotation(FlyCam& flyCam, Transform* transform)
   if (glm::length(diff) > 0.0001f)
   {
     const glm::vec2 rotation = (diff / screenSize) * glm::vec2(flyCam.lookSpeed.y, flyCam.lookSpeed.x);
-    transform->rotation += glm::vec3(-rotation.x, -rotation.y, 0.0f);
+    transform->Rotate(glm::vec3(-rotation.x, -rotation.y, 0.0f));
   }
 
   // NOTE(WSWhitehouse): limit pitch values between about +/- 85ish degrees
-  transform->rotation.x = CLAMP(transform->rotation.x, -1.5f, 1.5f);
-  transform->rotation.y = MOD(transform->rotation.y, TAU);
+  transform->SetRotation({ CLAMP(transform->rotation.x, -1.5f, 1.5f), MOD(transform->rotation.y, TAU), transform->rotation.z });
 
   flyCam.prevMousePos = mousePos;
 }
@@ -126,6 +118,6 @@ static INLINE void UpdatePosition(FlyCam& flyCam, Transform* transform)
 
   if (glm::dot(moveDir, moveDir) > F32_EPSILON)
   {
-    transform->position += moveSpeed * deltaTime * glm::normalize(moveDir);
+    transform->Translate(moveSpeed * deltaTime * glm::normalize(moveDir));
   }
 }
\ No newline at end of file
@@ -8,21 +8,217 @@
 
 #include "math/Math.hpp"
 
+// NOTE(WSWhitehouse): The dirty flags are scanned in batches of at least this many
+// transforms per worker, and the dirty transforms found in a batch are gathered into
+// groups of this many before building their matrices.
+#define TRANSFORM_SYSTEM_MIN_BATCH_SIZE     4096
+#define TRANSFORM_SYSTEM_GATHER_SIZE        256
+#define TRANSFORM_SYSTEM_MIN_ROOT_BATCH_SIZE 16
+
 namespace TransformSystem
 {
 
+  /**
+  * @brief Build the TRS matrices of the transforms, 8 at a time using Math::F32x8. Matches
+  * Math::CreateTRSMatrix (euler angles in degrees): the half angles go through a single
+  * vectorised sincos, are combined into a quaternion and each scaled matrix column is
+  * built directly from it.
+  * @param transforms The transforms to build, read straight from the dense component array.
+  * @param matrices Where to write the matrix of each transform, may be the transform's own matrix.
+  * @param count Number of transforms.
+  */
+  INLINE void BuildMatrices(const Transform* const* transforms, glm::mat4x4* const* matrices, u32 count)
+  {
+    using namespace Math;
+
+    const F32x8 halfDegToRad = F32x8Set((f32)(PI / 360.0));
+    const F32x8 one          = F32x8Set(1.0f);
+    const F32x8 two          = F32x8Set(2.0f);
+
+    for (u32 base = 0; base < count; base += F32X8_LANE_COUNT)
+    {
+      const u32 laneCount = MIN(F32X8_LANE_COUNT, count - base);
+
+      // NOTE(WSWhitehouse): Gather the lanes, unused lanes of the final group repeat the
+      // first transform so every lane holds valid values...
+      alignas(32) f32 lanes[9][F32X8_LANE_COUNT];
+      for (u32 lane = 0; lane < F32X8_LANE_COUNT; ++lane)
+      {
+        const Transform& transform = *transforms[base + (lane < laneCount ? lane : 0)];
+        lanes[0][lane] = transform.position.x; lanes[1][lane] = transform.position.y; lanes[2][lane] = transform.position.z;
+        lanes[3][lane] = transform.rotation.x; lanes[4][lane] = transform.rotation.y; lanes[5][lane] = transform.rotation.z;
+        lanes[6][lane] = transform.scale.x;    lanes[7][lane] = transform.scale.y;    lanes[8][lane] = transform.scale.z;
+      }
+
+      // Euler angles to quaternion, matches the glm::qua(vec3) ctor...
+      F32x8 sx, cx, sy, cy, sz, cz;
+      F32x8SinCos(F32x8Load(lanes[3]) * halfDegToRad, sx, cx);
+      F32x8SinCos(F32x8Load(lanes[4]) * halfDegToRad, sy, cy);
+      F32x8SinCos(F32x8Load(lanes[5]) * halfDegToRad, sz, cz);
+
+      const F32x8 qw = cx * cy * cz + sx * sy * sz;
+      const F32x8 qx = sx * cy * cz - cx * sy * sz;
+      const F32x8 qy = cx * sy * cz + sx * cy * sz;
+      const F32x8 qz = cx * cy * sz - sx * sy * cz;
+
+      // Quaternion to rotation matrix columns (matches glm::mat3_cast), scaled per column...
+      const F32x8 xx = qx * qx, yy = qy * qy, zz = qz * qz;
+      const F32x8 xy = qx * qy, xz = qx * qz, yz = qy * qz;
+      const F32x8 wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+      const F32x8 scaleX = F32x8Load(lanes[6]);
+      const F32x8 scaleY = F32x8Load(lanes[7]);
+      const F32x8 scaleZ = F32x8Load(lanes[8]);
+
+      alignas(32) f32 columns[9][F32X8_LANE_COUNT];
+      F32x8Store(columns[0], (one - two * (yy + zz)) * scaleX);
+      F32x8Store(columns[1], two * (xy + wz) * scaleX);
+      F32x8Store(columns[2], two * (xz - wy) * scaleX);
+      F32x8Store(columns[3], two * (xy - wz) * scaleY);
+      F32x8Store(columns[4], (one - two * (xx + zz)) * scaleY);
+      F32x8Store(columns[5], two * (yz + wx) * scaleY);
+      F32x8Store(columns[6], two * (xz + wy) * scaleZ);
+      F32x8Store(columns[7], two * (yz - wx) * scaleZ);
+      F32x8Store(columns[8], (one - two * (xx + yy)) * scaleZ);
+
+      for (u32 lane = 0; lane < laneCount; ++lane)
+      {
+        glm::mat4x4& matrix = *matrices[base + lane];
+        matrix[0] = glm::vec4(columns[0][lane], columns[1][lane], columns[2][lane], 0.0f);
+        matrix[1] = glm::vec4(columns[3][lane], columns[4][lane], columns[5][lane], 0.0f);
+        matrix[2] = glm::vec4(columns[6][lane], columns[7][lane], columns[8][lane], 0.0f);
+        matrix[3] = glm::vec4(lanes[0][lane], lanes[1][lane], lanes[2][lane], 1.0f);
+      }
+    }
+  }
+
+  /**
+  * @brief Rebuild the local matrix of every dirty transform in the range of the dense
+  * array, their matrices are built in groups. Transforms outside of the hierarchy get
+  * the matrix written straight into Transform::matrix. Transforms in the hierarchy stay
+  * dirty and get it written to Transform::localMatrix, their world matrices are built
+  * by UpdateHierarchy. Every rebuilt matrix marks the Transform as changed, see
+  * ECS::Manager::ForEachChangedSince.
+  */
+  INLINE void UpdateRange(ECS::ComponentSparseSet& sparseSet, const ECS::Hierarchy& hierarchy, u32 start, u32 end)
+  {
+    ECS::ComponentData<Transform>* compArray = (ECS::ComponentData<Transform>*)sparseSet.componentArray;
+
+    const Transform* dirtyTransforms[TRANSFORM_SYSTEM_GATHER_SIZE];
+    glm::mat4x4* dirtyMatrices[TRANSFORM_SYSTEM_GATHER_SIZE];
+    u32 dirtyCount = 0;
+
+    for (u32 i = start; i < end; ++i)
+    {
+      Transform& transform = compArray[i].component;
+      if (transform.dirty)
+      {
+        if (hierarchy.IsMember(ECS::EntityIndex(compArray[i].entity)))
+        {
+          dirtyMatrices[dirtyCount] = &transform.localMatrix;
+        }
+        else
+        {
+          dirtyMatrices[dirtyCount] = &transform.matrix;
+          transform.dirty = false;
+          sparseSet.MarkChanged(i);
+        }
+
+        dirtyTransforms[dirtyCount] = &transform;
+        dirtyCount++;
+      }
+
+      if (dirtyCount == TRANSFORM_SYSTEM_GATHER_SIZE || (i == end - 1 && dirtyCount > 0))
+      {
+        BuildMatrices(dirtyTransforms, dirtyMatrices, dirtyCount);
+        dirtyCount = 0;
+      }
+    }
+  }
+
+  /**
+  * @brief Build the world matrices of the transforms in the hierarchy, parent first. A
+  * node is rebuilt if it is dirty or its parent was rebuilt, so only dirty subtrees are
+  * propagated. Each root's subtree is contiguous in the flattened hierarchy, the roots
+  * are split into batches across the JobSystem. Entities in the hierarchy without a
+  * Transform are treated as an identity transform.
+  */
+  INLINE void UpdateHierarchy(ECS::Manager& ecs)
+  {
+    using namespace ECS;
+
+    Hierarchy& hierarchy = ecs.GetHierarchy();
+    hierarchy.UpdateNodes();
+
+    const u32 nodeCount = hierarchy.GetNodeCount();
+    if (nodeCount == 0) return;
+
+    const HierarchyNode* nodes = hierarchy.GetNodes();
+    ComponentSparseSet* sparseSet = ecs.GetComponentSparseSet<Transform>();
+
+    // NOTE(WSWhitehouse): Per node scratch, each batch only touches the nodes of its own subtrees...
+    struct NodeState
+    {
+      Transform* transform;
+      b8 changed;
+    };
+
+    NodeState* states = (NodeState*)mem_alloc(sizeof(NodeState) * nodeCount);
+
+    ParallelForBatches(hierarchy.GetRootCount(), TRANSFORM_SYSTEM_MIN_ROOT_BATCH_SIZE,
+                       [&hierarchy, nodes, sparseSet, states](u32 rootStart, u32 rootEnd)
+    {
+      const u32 nodeStart = hierarchy.GetRootOffset(rootStart);
+      const u32 nodeEnd   = hierarchy.GetRootOffset(rootEnd);
+
+      for (u32 node = nodeStart; node < nodeEnd; ++node)
+      {
+        const HierarchyNode& hierarchyNode = nodes[node];
+        const NodeState* parentState = hierarchyNode.parentNode != NO_HIERARCHY_NODE ? &states[hierarchyNode.parentNode] : nullptr;
+        const b8 parentChanged       = parentState != nullptr && parentState->changed;
+
+        NodeState& state = states[node];
+        state.transform  = nullptr;
+        state.changed    = parentChanged;
+
+        const u32 entityIndex = EntityIndex(hierarchyNode.entity);
+        if (!sparseSet->HasEntityIndex(entityIndex)) continue;
+
+        const u32 denseIndex = sparseSet->entitySparseArray[entityIndex];
+        Transform& transform = ((ComponentData<Transform>*)sparseSet->componentArray)[denseIndex].component;
+        state.transform      = &transform;
+
+        if (!transform.dirty && !parentChanged) continue;
+
+        const Transform* parentTransform = parentState != nullptr ? parentState->transform : nullptr;
+        transform.matrix = parentTransform != nullptr ? parentTransform->matrix * transform.localMatrix : transform.localMatrix;
+        transform.dirty  = false;
+        state.changed    = true;
+        sparseSet->MarkChanged(denseIndex);
+      }
+    });
+
+    mem_free(states);
+  }
+
+  /**
+  * @brief Rebuild the matrices of the dirty transforms, see Transform::dirty. The dense
+  * array is split into batches across the JobSystem, a static scene only pays for
+  * scanning the dirty flags. Transforms in the hierarchy are then built parent first.
+  */
   INLINE void Update(ECS::Manager& ecs)
   {
     using namespace ECS;
 
     ComponentSparseSet* sparseSet = ecs.GetComponentSparseSet<Transform>();
-    for (u32 i = 0; i < sparseSet->componentCount; ++i)
+    const Hierarchy& hierarchy    = ecs.GetHierarchy();
+
+    ParallelForBatches(sparseSet->componentCount, TRANSFORM_SYSTEM_MIN_BATCH_SIZE, [sparseSet, &hierarchy](u32 start, u32 end)
     {
-      ComponentData<Transform>& componentData = ((ComponentData<Transform>*)sparseSet->componentArray)[i];
-      Transform& transform = componentData.component;
+      UpdateRange(*sparseSet, hierarchy, start, end);
+    });
 
-      transform.matrix = Math::CreateTRSMatrix(transform.position, transform.rotation, transform.scale);
-    }
+    UpdateHierarchy(ecs);
   }
 
 } // namespace TransformSystem
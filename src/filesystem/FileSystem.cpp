@@ -33,6 +33,28 @@ b8 FileSystem::ReadAllFileContent(const char* filePath, FileContent* out_fileCon
   return true;
 }
 
+b8 FileSystem::WriteAllFileContent(const char* filePath, const void* data, u64 size)
+{
+  FILE* file = fopen(filePath, "wb");
+  if (file == nullptr)
+  {
+    LOG_ERROR("File failed to open! (file path: %s)", filePath);
+    return false;
+  }
+
+  fwrite(data, sizeof(byte), size, file);
+
+  if (ferror(file))
+  {
+    LOG_ERROR("Error writing file! (file path: %s)", filePath);
+    fclose(file);
+    return false;
+  }
+
+  fclose(file);
+  return true;
+}
+
 const char* FileSystem::GetFileExtension(const char* filePath)
 {
   if (filePath == nullptr) return nullptr;
@@ -12,6 +12,17 @@ namespace FileSystem
     u32 size;
   };
 
+  /** @brief A read-only view of a file that has been mapped into memory, see MapFile. */
+  struct MappedFile
+  {
+    const byte* data;
+    u64 size;
+
+    // NOTE(WSWhitehouse): Platform specific handles...
+    void* fileHandle;
+    void* mappingHandle;
+  };
+
   /**
   * @brief Reads an entire file and outputs it to FileContent.
   * @param out_fileContent Output content of file.
@@ -20,6 +31,30 @@ namespace FileSystem
   */
   b8 ReadAllFileContent(const char* filePath, FileContent* out_fileContent);
 
+  /**
+  * @brief Writes the data to a file, replacing the file if it already exists.
+  * @param filePath Path of file to write.
+  * @param data Data to write.
+  * @param size Size of data in bytes.
+  * @return Returns true if the data was successfully written, false if not.
+  */
+  b8 WriteAllFileContent(const char* filePath, const void* data, u64 size);
+
+  /**
+  * @brief Maps an entire file into memory as read-only, the file contents are paged in by
+  * the OS as they are accessed rather than being read up front. Call UnmapFile when done.
+  * @param filePath Path of file to map.
+  * @param out_mappedFile Output mapped file.
+  * @return Returns true if the file was successfully mapped, false if not (or it's empty).
+  */
+  b8 MapFile(const char* filePath, MappedFile* out_mappedFile);
+
+  /**
+  * @brief Unmaps a file mapped with MapFile, the mapped data must not be used after this.
+  * @param mappedFile File to unmap.
+  */
+  void UnmapFile(MappedFile* mappedFile);
+
   /**
   * @brief Gets the extension of the provided file path, returns a pointer
   * to the char in the filepath were the extension begins. Therefore, there
@@ -45,6 +80,13 @@ namespace FileSystem
   */
   b8 DirectoryExists(const char* dirPath);
 
+  /**
+  * @brief Creates the directory at the specified path, the parent directory must exist.
+  * @param dirPath Path of the directory to create.
+  * @return True when the directory was created or already exists; false otherwise.
+  */
+  b8 MakeDirectory(const char* dirPath);
+
 } // namespace FileSystem
 
 #endif //SNOWFLAKE_FILE_SYSTEM_HPP
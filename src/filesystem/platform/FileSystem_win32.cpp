@@ -17,4 +17,66 @@ b8 FileSystem::DirectoryExists(const char* dirPath)
   return (b8)PathFileExistsA(dirPath);
 }
 
+b8 FileSystem::MakeDirectory(const char* dirPath)
+{
+  // NOTE(WSWhitehouse): Not called CreateDirectory as windows.h defines it as a macro...
+  if (CreateDirectoryA(dirPath, nullptr)) return true;
+  return GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+b8 FileSystem::MapFile(const char* filePath, MappedFile* out_mappedFile)
+{
+  mem_zero(out_mappedFile, sizeof(MappedFile));
+
+  HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    LOG_ERROR("File failed to open! (file path: %s)", filePath);
+    return false;
+  }
+
+  // NOTE(WSWhitehouse): Empty files can't be mapped...
+  LARGE_INTEGER fileSize = {};
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+  {
+    LOG_ERROR("File is empty or its size couldn't be read! (file path: %s)", filePath);
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+  {
+    LOG_ERROR("Failed to create file mapping! (file path: %s)", filePath);
+    CloseHandle(file);
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr)
+  {
+    LOG_ERROR("Failed to map view of file! (file path: %s)", filePath);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  out_mappedFile->data          = (const byte*)view;
+  out_mappedFile->size          = (u64)fileSize.QuadPart;
+  out_mappedFile->fileHandle    = file;
+  out_mappedFile->mappingHandle = mapping;
+  return true;
+}
+
+void FileSystem::UnmapFile(MappedFile* mappedFile)
+{
+  if (mappedFile->data          != nullptr) UnmapViewOfFile(mappedFile->data);
+  if (mappedFile->mappingHandle != nullptr) CloseHandle((HANDLE)mappedFile->mappingHandle);
+  if (mappedFile->fileHandle    != nullptr) CloseHandle((HANDLE)mappedFile->fileHandle);
+
+  mem_zero(mappedFile, sizeof(MappedFile));
+}
+
 #endif
\ No newline at end of file
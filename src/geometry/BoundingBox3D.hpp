@@ -20,6 +20,34 @@ struct BoundingBox3D
 
   [[nodiscard]] INLINE glm::vec3 GetExtents() const { return GetSize() * 0.5f; }
 
+  /** @brief Get the surface area of this bounding box. */
+  [[nodiscard]] INLINE f32 GetSurfaceArea() const
+  {
+    const glm::vec3 size = GetSize();
+    return 2.0f * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+  }
+
+  /**
+  * @brief Get the bounding box of this bounding box after it has been transformed
+  * by the matrix. The result is the tightest AABB around the transformed box.
+  * @param matrix Transformation matrix.
+  * @return New transformed bounding box.
+  */
+  [[nodiscard]] INLINE BoundingBox3D GetTransformed(const glm::mat4& matrix) const
+  {
+    // NOTE(WSWhitehouse): Transform the center, then the extents by the absolute
+    // matrix rather than transforming all 8 corners...
+    // https://zeux.io/2010/10/17/aabb-from-obb-with-component-wise-abs/
+    const glm::vec3 center  = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+    const glm::vec3 extents = GetExtents();
+
+    const glm::vec3 newExtents = glm::abs(glm::vec3(matrix[0])) * extents.x +
+                                 glm::abs(glm::vec3(matrix[1])) * extents.y +
+                                 glm::abs(glm::vec3(matrix[2])) * extents.z;
+
+    return { center - newExtents, center + newExtents };
+  }
+
   /**
   * @brief Grows the bounding box to encapsulate the point.
   * @param point Point to encapsulate.
@@ -68,6 +96,21 @@ struct BoundingBox3D
     );
   }
 
+  /**
+  * @brief Check if the requested bounding box is completely inside this bounding box.
+  * @param aabb Bounding box to check.
+  * @return True when inside; false otherwise.
+  */
+  [[nodiscard]] INLINE b8 ContainsAABB(const BoundingBox3D& aabb) const
+  {
+    return
+    (
+      aabb.minimum.x >= minimum.x && aabb.maximum.x <= maximum.x &&
+      aabb.minimum.y >= minimum.y && aabb.maximum.y <= maximum.y &&
+      aabb.minimum.z >= minimum.z && aabb.maximum.z <= maximum.z
+    );
+  }
+
   /**
   * @brief Combines two bounding boxes together.
   * @param lhs First bounding box.
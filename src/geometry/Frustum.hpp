@@ -0,0 +1,86 @@
+#ifndef SNOWFLAKE_FRUSTUM_HPP
+#define SNOWFLAKE_FRUSTUM_HPP
+
+#include "pch.hpp"
+
+// geometry
+#include "geometry/BoundingBox3D.hpp"
+
+/**
+* @brief A view frustum made from 6 planes. Each plane is stored as a normal (xyz)
+* pointing into the frustum and a distance (w), so a point is inside the plane
+* when `dot(normal, point) + w >= 0`.
+*/
+struct Frustum
+{
+  enum PlaneIndex : u32
+  {
+    PLANE_LEFT = 0,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR,
+
+    PLANE_COUNT
+  };
+
+  // --- MEMBER DATA --- //
+  glm::vec4 planes[PLANE_COUNT];
+
+  /**
+  * @brief Extract the frustum planes from a view projection matrix. Expects a
+  * projection with a 0 to 1 depth range (see GLM_FORCE_DEPTH_ZERO_TO_ONE).
+  * @param viewProjMat Projection matrix multiplied by the view matrix.
+  * @return New frustum, in the space the view matrix transforms from (world space).
+  */
+  [[nodiscard]] static INLINE Frustum FromMatrix(const glm::mat4& viewProjMat)
+  {
+    // https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+    // NOTE(WSWhitehouse): glm matrices are column major, so the rows are gathered...
+    const glm::vec4 row0 = glm::vec4(viewProjMat[0][0], viewProjMat[1][0], viewProjMat[2][0], viewProjMat[3][0]);
+    const glm::vec4 row1 = glm::vec4(viewProjMat[0][1], viewProjMat[1][1], viewProjMat[2][1], viewProjMat[3][1]);
+    const glm::vec4 row2 = glm::vec4(viewProjMat[0][2], viewProjMat[1][2], viewProjMat[2][2], viewProjMat[3][2]);
+    const glm::vec4 row3 = glm::vec4(viewProjMat[0][3], viewProjMat[1][3], viewProjMat[2][3], viewProjMat[3][3]);
+
+    Frustum frustum = {};
+    frustum.planes[PLANE_LEFT]   = row3 + row0;
+    frustum.planes[PLANE_RIGHT]  = row3 - row0;
+    frustum.planes[PLANE_BOTTOM] = row3 + row1;
+    frustum.planes[PLANE_TOP]    = row3 - row1;
+    frustum.planes[PLANE_NEAR]   = row2;
+    frustum.planes[PLANE_FAR]    = row3 - row2;
+
+    for (u32 i = 0; i < PLANE_COUNT; ++i)
+    {
+      frustum.planes[i] /= glm::length(glm::vec3(frustum.planes[i]));
+    }
+
+    return frustum;
+  }
+
+  /**
+  * @brief Check if the bounding box is inside or intersecting the frustum. This is
+  * conservative, boxes near the corners of the frustum may be reported as overlapping.
+  * @param aabb Bounding box to check.
+  * @return True when overlapping; false otherwise.
+  */
+  [[nodiscard]] INLINE b8 OverlapAABB(const BoundingBox3D& aabb) const
+  {
+    const glm::vec3 center  = aabb.GetCenter();
+    const glm::vec3 extents = aabb.GetExtents();
+
+    for (u32 i = 0; i < PLANE_COUNT; ++i)
+    {
+      const glm::vec3 normal = glm::vec3(planes[i]);
+      const f32 distance     = glm::dot(normal, center) + planes[i].w;
+      const f32 radius       = glm::dot(glm::abs(normal), extents);
+
+      if (distance + radius < 0.0f) return false;
+    }
+
+    return true;
+  }
+};
+
+#endif //SNOWFLAKE_FRUSTUM_HPP
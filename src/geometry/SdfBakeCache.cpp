@@ -0,0 +1,478 @@
+#include "geometry/SdfBakeCache.hpp"
+
+// core
+#include "core/Hash.hpp"
+#include "core/Logging.hpp"
+#include "core/Profiler.hpp"
+
+// geometry
+#include "geometry/Mesh.hpp"
+#include "geometry/MeshGeometry.hpp"
+#include "geometry/Vertex.hpp"
+#include "geometry/SdfVolume.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+#include <cstdio>
+#include <vector>
+
+// NOTE(WSWhitehouse): The number of chunk ranges each thread (de)compresses, there are more
+// ranges than threads as some chunks (i.e. empty space) are much quicker than others...
+static inline constexpr const u32 RANGES_PER_THREAD = 4;
+
+// NOTE(WSWhitehouse): The run length encoding is PackBits. A control byte below 128 is
+// followed by (control + 1) literal bytes, otherwise the next byte is repeated
+// (control - 128 + MIN_REPEAT_RUN) times...
+static inline constexpr const u64 MAX_LITERAL_RUN = 128;
+static inline constexpr const u64 MIN_REPEAT_RUN  = 3;
+static inline constexpr const u64 MAX_REPEAT_RUN  = 127 + MIN_REPEAT_RUN;
+
+static inline constexpr const u64 MAX_PATH_LENGTH = 64;
+
+// Forward Declarations
+static void GetFilePath(u64 key, char* out_path);
+static b8 IsVolumeInfoValid(const SdfBakeCache::VolumeInfo& info, const SdfBakeCache::VolumeLayout& layout);
+static INLINE b8 IsSectionInFile(u64 offset, u64 size, u64 fileSize);
+static INLINE u64 AlignOffset(u64 offset);
+static INLINE u64 GetMaxCompressedSize(u64 size);
+static u64 CompressChunk(const byte* data, u64 size, u32 elementSize, byte* planes, byte* out_data);
+static b8 DecompressChunk(const byte* data, u64 size, u32 elementSize, u64 decompressedSize, byte* planes, byte* out_data);
+
+template<typename Func>
+static INLINE void RunChunkRanges(u32 chunkCount, const Func& func);
+
+u64 SdfBakeCache::CalculateKey(const Mesh* mesh, const void* bakeParams, u64 bakeParamsSize)
+{
+  PROFILE_FUNC
+
+  u64 key = Hash::FNV1a64(&VERSION, sizeof(VERSION));
+  key     = Hash::FNV1a64(bakeParams, bakeParamsSize, key);
+  key     = Hash::FNV1a64(&mesh->nodeCount, sizeof(mesh->nodeCount), key);
+
+  // NOTE(WSWhitehouse): Geometry is hashed for every node that uses it, the same as the
+  // bake. The counts are included so moving data between the arrays changes the key...
+  for (u32 i = 0; i < mesh->nodeCount; ++i)
+  {
+    const MeshNode& node         = mesh->nodeArray[i];
+    const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
+
+    key = Hash::FNV1a64(&node.transformMatrix, sizeof(node.transformMatrix),                 key);
+    key = Hash::FNV1a64(&geometry.vertexCount, sizeof(geometry.vertexCount),                 key);
+    key = Hash::FNV1a64(&geometry.indexCount,  sizeof(geometry.indexCount),                  key);
+    key = Hash::FNV1a64(&geometry.indexType,   sizeof(geometry.indexType),                   key);
+    key = Hash::FNV1a64(geometry.indexArray,   geometry.SizeOfIndex() * geometry.indexCount, key);
+
+    // NOTE(WSWhitehouse): Only the positions are used by the bake, and the
+    // vertex members are aligned so there is uninitialised padding between them...
+    for (u64 vertex = 0; vertex < geometry.vertexCount; ++vertex)
+    {
+      key = Hash::FNV1a64(&geometry.vertexArray[vertex].position, sizeof(f32) * 3, key);
+    }
+  }
+
+  return key;
+}
+
+b8 SdfBakeCache::Save(u64 key, const VolumeInfo& info, const void* image, const void* brickGrid)
+{
+  PROFILE_FUNC
+
+  if (!FileSystem::DirectoryExists(DIRECTORY) && !FileSystem::MakeDirectory(DIRECTORY))
+  {
+    LOG_ERROR("SdfBakeCache: Failed to create the cache directory! (path: %s)", DIRECTORY);
+    return false;
+  }
+
+  const u64 imageSize   = info.GetImageSize();
+  const u32 elementSize = info.encoding.GetDistanceSize();
+  const u32 chunkCount  = (u32)((imageSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+  // NOTE(WSWhitehouse): Each chunk is compressed into its own worst case sized slot, so
+  // they can be compressed in parallel and then packed together when writing the file...
+  const u64 slotSize = GetMaxCompressedSize(CHUNK_SIZE);
+  byte* slots        = (byte*)mem_alloc(MAX(slotSize * chunkCount, (u64)1));
+  u64* chunkSizes    = (u64*)mem_alloc(MAX(sizeof(u64) * chunkCount, sizeof(u64)));
+
+  RunChunkRanges(chunkCount, [&](u32 start, u32 end)
+  {
+    byte* planes = (byte*)mem_alloc(CHUNK_SIZE);
+
+    for (u32 chunk = start; chunk < end; ++chunk)
+    {
+      const u64 offset = (u64)chunk * CHUNK_SIZE;
+      const u64 size   = MIN(CHUNK_SIZE, imageSize - offset);
+      chunkSizes[chunk] = CompressChunk((const byte*)image + offset, size, elementSize, planes, &slots[chunk * slotSize]);
+    }
+
+    mem_free(planes);
+  });
+
+  CacheHeader header      = {};
+  header.magic            = MAGIC;
+  header.version          = VERSION;
+  header.key              = key;
+  header.info             = info;
+  header.chunkCount       = chunkCount;
+  header.chunkTableOffset = AlignOffset(sizeof(CacheHeader));
+  header.brickGridOffset  = AlignOffset(header.chunkTableOffset + (sizeof(u64) * (chunkCount + 1)));
+
+  const u64 chunkDataOffset = AlignOffset(header.brickGridOffset + info.brickGridSize);
+
+  u64 compressedSize = 0;
+  for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+  {
+    compressedSize += chunkSizes[chunk];
+  }
+
+  header.size = chunkDataOffset + compressedSize;
+
+  byte* file = (byte*)mem_alloc(header.size);
+  mem_copy(file, &header, sizeof(CacheHeader));
+  mem_copy(file + header.brickGridOffset, brickGrid, info.brickGridSize);
+
+  u64* chunkTable = (u64*)(file + header.chunkTableOffset);
+  u64 offset      = chunkDataOffset;
+  for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+  {
+    chunkTable[chunk] = offset;
+    mem_copy(file + offset, &slots[chunk * slotSize], chunkSizes[chunk]);
+    offset += chunkSizes[chunk];
+  }
+  chunkTable[chunkCount] = offset;
+
+  mem_free(chunkSizes);
+  mem_free(slots);
+
+  char path[MAX_PATH_LENGTH];
+  GetFilePath(key, path);
+
+  const b8 success = FileSystem::WriteAllFileContent(path, file, header.size);
+  mem_free(file);
+
+  if (success)
+  {
+    LOG_DEBUG("SdfBakeCache: Saved %s - %.2f MiB (%.1fx smaller than the image)", path,
+              (f64)header.size / 1024.0 / 1024.0, (f64)imageSize / (f64)header.size);
+  }
+
+  return success;
+}
+
+b8 SdfBakeCache::Open(u64 key, const VolumeLayout& layout, CacheFile* out_cacheFile)
+{
+  PROFILE_FUNC
+
+  mem_zero(out_cacheFile, sizeof(CacheFile));
+
+  char path[MAX_PATH_LENGTH];
+  GetFilePath(key, path);
+
+  // NOTE(WSWhitehouse): A missing file is a cache miss rather than an error...
+  if (!FileSystem::FileExists(path)) return false;
+  if (!FileSystem::MapFile(path, &out_cacheFile->file)) return false;
+
+  const FileSystem::MappedFile& file = out_cacheFile->file;
+  CacheHeader& header                = out_cacheFile->header;
+
+  if (file.size < sizeof(CacheHeader))
+  {
+    LOG_WARN("SdfBakeCache: %s is too small, ignoring it.", path);
+    Close(out_cacheFile);
+    return false;
+  }
+
+  mem_copy(&header, file.data, sizeof(CacheHeader));
+
+  if (header.magic != MAGIC || header.version != VERSION || header.key != key)
+  {
+    LOG_WARN("SdfBakeCache: %s has an unknown format, ignoring it. (version: %u, expected: %u)",
+             path, header.version, VERSION);
+    Close(out_cacheFile);
+    return false;
+  }
+
+  // NOTE(WSWhitehouse): The volume info sizes every allocation and copy made from
+  // the file, so it must be checked before anything is calculated from it...
+  if (!IsVolumeInfoValid(header.info, layout))
+  {
+    LOG_WARN("SdfBakeCache: %s doesn't hold the expected volume, ignoring it.", path);
+    Close(out_cacheFile);
+    return false;
+  }
+
+  const u64 imageSize  = header.info.GetImageSize();
+  const u64 chunkCount = (imageSize + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  const b8 validSections =
+    header.size == file.size && header.chunkCount == chunkCount &&
+    header.chunkTableOffset % ALIGNMENT == 0 &&
+    IsSectionInFile(header.chunkTableOffset, sizeof(u64) * (chunkCount + 1), header.size) &&
+    IsSectionInFile(header.brickGridOffset,  header.info.brickGridSize,       header.size);
+
+  if (!validSections)
+  {
+    LOG_WARN("SdfBakeCache: %s is corrupt, a section is out of bounds. Ignoring it.", path);
+    Close(out_cacheFile);
+    return false;
+  }
+
+  out_cacheFile->chunkTable = (const u64*)(file.data + header.chunkTableOffset);
+  out_cacheFile->brickGrid  = file.data + header.brickGridOffset;
+
+  // NOTE(WSWhitehouse): The chunk offsets are validated here so ReadImage only
+  // needs to check the compressed data itself...
+  for (u64 chunk = 0; chunk < chunkCount; ++chunk)
+  {
+    const u64 start = out_cacheFile->chunkTable[chunk];
+    const u64 end   = out_cacheFile->chunkTable[chunk + 1];
+    if (start > end || end > header.size)
+    {
+      LOG_WARN("SdfBakeCache: %s is corrupt, chunk %llu is out of bounds. Ignoring it.", path, chunk);
+      Close(out_cacheFile);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+b8 SdfBakeCache::ReadImage(const CacheFile& cacheFile, void* out_image)
+{
+  PROFILE_FUNC
+
+  const CacheHeader& header = cacheFile.header;
+  const u64 imageSize       = header.info.GetImageSize();
+  const u32 elementSize     = header.info.encoding.GetDistanceSize();
+
+  std::vector<u8> chunkValid(header.chunkCount, 0);
+
+  RunChunkRanges(header.chunkCount, [&](u32 start, u32 end)
+  {
+    byte* planes = (byte*)mem_alloc(CHUNK_SIZE);
+
+    for (u32 chunk = start; chunk < end; ++chunk)
+    {
+      const u64 offset         = (u64)chunk * CHUNK_SIZE;
+      const u64 size           = MIN(CHUNK_SIZE, imageSize - offset);
+      const byte* chunkData    = cacheFile.file.data + cacheFile.chunkTable[chunk];
+      const u64 compressedSize = cacheFile.chunkTable[chunk + 1] - cacheFile.chunkTable[chunk];
+
+      chunkValid[chunk] = DecompressChunk(chunkData, compressedSize, elementSize, size, planes, (byte*)out_image + offset);
+    }
+
+    mem_free(planes);
+  });
+
+  for (u32 chunk = 0; chunk < header.chunkCount; ++chunk)
+  {
+    if (!chunkValid[chunk])
+    {
+      LOG_ERROR("SdfBakeCache: Cache file is corrupt, failed to decompress chunk %u!", chunk);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void SdfBakeCache::Close(CacheFile* cacheFile)
+{
+  if (cacheFile->file.data != nullptr) FileSystem::UnmapFile(&cacheFile->file);
+  mem_zero(cacheFile, sizeof(CacheFile));
+}
+
+static void GetFilePath(u64 key, char* out_path)
+{
+  snprintf(out_path, MAX_PATH_LENGTH, "%ssdf_%016llx.sdfc", SdfBakeCache::DIRECTORY, (unsigned long long)key);
+}
+
+static b8 IsVolumeInfoValid(const SdfBakeCache::VolumeInfo& info, const SdfBakeCache::VolumeLayout& layout)
+{
+  // NOTE(WSWhitehouse): Checked first, an unknown format doesn't have a distance size...
+  if (info.encoding.format != layout.format) return false;
+  if (info.brickCount != layout.brickCount)  return false;
+
+  const b8 isDense = layout.brickCount == glm::uvec3(0);
+  if (isDense)
+  {
+    if (info.imageExtent != layout.cellCount || info.brickAtlasCount != glm::uvec3(0)) return false;
+  }
+  else
+  {
+    // NOTE(WSWhitehouse): Compared in 64 bits so a huge atlas count can't wrap around to match the extent...
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+      if (info.brickAtlasCount[axis] == 0) return false;
+      if ((u64)info.brickAtlasCount[axis] * SdfBrickVolume::BRICK_SIZE != info.imageExtent[axis]) return false;
+    }
+
+    const u64 topLevelCellCount = (u64)layout.brickCount.x * layout.brickCount.y * layout.brickCount.z;
+    if (info.brickGridSize != sizeof(SdfBrickVolume::TopLevelCell) * topLevelCellCount) return false;
+  }
+
+  // NOTE(WSWhitehouse): Two axes can't overflow 64 bits, the third and the distance size can...
+  const u64 texelCount = (u64)info.imageExtent.x * info.imageExtent.y;
+  if (texelCount == 0 || info.imageExtent.z == 0) return false;
+
+  return info.imageExtent.z <= U64_MAX / texelCount / info.encoding.GetDistanceSize();
+}
+
+static INLINE b8 IsSectionInFile(u64 offset, u64 size, u64 fileSize)
+{
+  // NOTE(WSWhitehouse): Written so neither side can overflow...
+  return offset <= fileSize && size <= fileSize - offset;
+}
+
+static INLINE u64 AlignOffset(u64 offset)
+{
+  return (offset + (SdfBakeCache::ALIGNMENT - 1)) & ~(SdfBakeCache::ALIGNMENT - 1);
+}
+
+static INLINE u64 GetMaxCompressedSize(u64 size)
+{
+  // NOTE(WSWhitehouse): Data without any runs is stored as literals, one control byte per run...
+  return size + ((size + MAX_LITERAL_RUN - 1) / MAX_LITERAL_RUN);
+}
+
+template<typename T>
+static void DeltaEncodePlanes(const byte* data, u64 count, byte* out_planes)
+{
+  const T* values = (const T*)data;
+
+  T previous = 0;
+  for (u64 i = 0; i < count; ++i)
+  {
+    const T delta = (T)(values[i] - previous);
+    previous      = values[i];
+
+    for (u64 plane = 0; plane < sizeof(T); ++plane)
+    {
+      out_planes[(plane * count) + i] = (byte)(delta >> (plane * 8));
+    }
+  }
+}
+
+template<typename T>
+static void DeltaDecodePlanes(const byte* planes, u64 count, byte* out_data)
+{
+  T* values = (T*)out_data;
+
+  T value = 0;
+  for (u64 i = 0; i < count; ++i)
+  {
+    T delta = 0;
+    for (u64 plane = 0; plane < sizeof(T); ++plane)
+    {
+      delta |= (T)((T)planes[(plane * count) + i] << (plane * 8));
+    }
+
+    value     = (T)(value + delta);
+    values[i] = value;
+  }
+}
+
+static u64 CompressChunk(const byte* data, u64 size, u32 elementSize, byte* planes, byte* out_data)
+{
+  const u64 count = size / elementSize;
+  switch (elementSize)
+  {
+    case sizeof(u8):  DeltaEncodePlanes<u8>(data, count, planes);  break;
+    case sizeof(u16): DeltaEncodePlanes<u16>(data, count, planes); break;
+    case sizeof(u32): DeltaEncodePlanes<u32>(data, count, planes); break;
+
+    default:
+    {
+      LOG_FATAL("Unhandled element size in switch statement!");
+      return 0;
+    }
+  }
+
+  u64 in  = 0;
+  u64 out = 0;
+  while (in < size)
+  {
+    u64 run = 1;
+    while (in + run < size && run < MAX_REPEAT_RUN && planes[in + run] == planes[in])
+    {
+      run++;
+    }
+
+    if (run >= MIN_REPEAT_RUN)
+    {
+      out_data[out++] = (byte)(run - MIN_REPEAT_RUN + 128);
+      out_data[out++] = planes[in];
+      in += run;
+      continue;
+    }
+
+    // NOTE(WSWhitehouse): Literals continue until the next repeat run starts, this
+    // always takes at least one byte as there isn't a repeat run at the start...
+    const u64 literalStart = in;
+    while (in < size && in - literalStart < MAX_LITERAL_RUN)
+    {
+      if (in + MIN_REPEAT_RUN <= size && planes[in] == planes[in + 1] && planes[in] == planes[in + 2]) break;
+      in++;
+    }
+
+    const u64 literalCount = in - literalStart;
+    out_data[out++] = (byte)(literalCount - 1);
+    mem_copy(&out_data[out], &planes[literalStart], literalCount);
+    out += literalCount;
+  }
+
+  return out;
+}
+
+static b8 DecompressChunk(const byte* data, u64 size, u32 elementSize, u64 decompressedSize, byte* planes, byte* out_data)
+{
+  u64 in  = 0;
+  u64 out = 0;
+  while (out < decompressedSize)
+  {
+    if (in >= size) return false;
+    const u64 control = data[in++];
+
+    if (control < 128)
+    {
+      const u64 count = control + 1;
+      if (in + count > size || out + count > decompressedSize) return false;
+
+      mem_copy(&planes[out], &data[in], count);
+      in  += count;
+      out += count;
+    }
+    else
+    {
+      const u64 count = control - 128 + MIN_REPEAT_RUN;
+      if (in >= size || out + count > decompressedSize) return false;
+
+      mem_set(&planes[out], data[in++], count);
+      out += count;
+    }
+  }
+
+  if (in != size) return false;
+
+  const u64 count = decompressedSize / elementSize;
+  switch (elementSize)
+  {
+    case sizeof(u8):  DeltaDecodePlanes<u8>(planes, count, out_data);  break;
+    case sizeof(u16): DeltaDecodePlanes<u16>(planes, count, out_data); break;
+    case sizeof(u32): DeltaDecodePlanes<u32>(planes, count, out_data); break;
+
+    default:
+    {
+      LOG_FATAL("Unhandled element size in switch statement!");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename Func>
+static INLINE void RunChunkRanges(u32 chunkCount, const Func& func)
+{
+  JobSystem::ParallelForRanges(chunkCount, (u32)(JobSystem::GetWorkerThreadCount() + 1) * RANGES_PER_THREAD, func);
+}
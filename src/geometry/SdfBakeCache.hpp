@@ -0,0 +1,152 @@
+#ifndef SNOWFLAKE_SDF_BAKE_CACHE_HPP
+#define SNOWFLAKE_SDF_BAKE_CACHE_HPP
+
+#include "pch.hpp"
+
+// core
+#include "core/Assert.hpp"
+
+// filesystem
+#include "filesystem/FileSystem.hpp"
+
+// geometry
+#include "geometry/SdfEncoding.hpp"
+
+// Forward Declarations
+struct Mesh;
+
+/**
+* @file SdfBakeCache.hpp
+* @brief A cache of baked signed distance field volumes on disk, so an unchanged mesh
+* doesn't need to be baked again. Each volume is stored in its own file, named after a
+* key made from the mesh contents and the bake parameters (see CalculateKey). A changed
+* mesh or bake produces a new key, old files are never invalidated - just never loaded.
+*
+* LAYOUT:
+*  - CacheHeader
+*  - u64[chunkCount + 1]                    Byte offset of each compressed chunk, the last is the end of the data.
+*  - byte[brickGridSize]                    The brick grid buffer, uncompressed so it can be uploaded from the mapped file.
+*  - byte[]                                 The compressed chunks of the image.
+*
+* The image is split into chunks of CHUNK_SIZE bytes that are compressed on their own,
+* so they can be compressed and decompressed in parallel. Each chunk is delta encoded
+* (the difference to the previous distance), the bytes are split into planes (every
+* low byte, then every high byte...) and the planes are run length encoded. Neighbouring
+* distances are similar so most of the high bytes are the same, and empty space and
+* clamped distances are runs of identical values.
+*
+* Every section starts at a multiple of ALIGNMENT from the start of the file. Values are
+* stored in the native byte order, the cache is only meant to be loaded by the same build
+* of the engine on the same platform.
+*
+* USEFUL LINKS & RESOURCES:
+*  - https://en.wikipedia.org/wiki/PackBits
+*  - https://www.blosc.org/posts/new-bitshuffle-filter/
+*/
+
+namespace SdfBakeCache
+{
+  static inline constexpr const u32 MAGIC      = 0x43464453; // "SDFC"
+  static inline constexpr const u32 VERSION    = 2;
+  static inline constexpr const u64 ALIGNMENT  = 64;
+  static inline constexpr const u64 CHUNK_SIZE = 1024 * 1024;
+
+  /** @brief The directory the cache files are written to, it is created when needed. */
+  static inline constexpr const char* DIRECTORY = "cache/";
+
+  /** @brief The volume stored in a cache file, everything needed to recreate the GPU resources. */
+  struct VolumeInfo
+  {
+    SdfEncoding encoding;
+
+    glm::uvec3 imageExtent;     // Texels on each axis of the 3D image
+    glm::uvec3 brickCount;      // Bricks on each axis of the top-level grid, 0 when dense
+    glm::uvec3 brickAtlasCount; // Bricks on each axis of the atlas, 0 when dense
+
+    u64 brickGridSize; // Size of the brick grid buffer in bytes
+
+    /** @brief Get the size of the image in bytes. */
+    [[nodiscard]] INLINE u64 GetImageSize() const
+    {
+      return (u64)encoding.GetDistanceSize() * imageExtent.x * imageExtent.y * imageExtent.z;
+    }
+  };
+
+  /** @brief The volume the caller expects to load, a cache file holding any other volume is ignored. See Open. */
+  struct VolumeLayout
+  {
+    SdfFormat format;
+    glm::uvec3 cellCount;  // Cells on each axis of the volume
+    glm::uvec3 brickCount; // Bricks on each axis of the top-level grid, 0 when dense
+  };
+
+  struct CacheHeader
+  {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u64 size; // Size of the entire file in bytes
+
+    VolumeInfo info;
+
+    u32 chunkCount;
+    u32 padding;
+
+    // NOTE(WSWhitehouse): Byte offsets from the start of the file...
+    u64 chunkTableOffset;
+    u64 brickGridOffset;
+  };
+
+  /** @brief A cache file mapped into memory, see Open. */
+  struct CacheFile
+  {
+    FileSystem::MappedFile file;
+    CacheHeader header;
+    const u64* chunkTable;
+    const void* brickGrid;
+  };
+
+  /**
+  * @brief Calculate the cache key of a bake. The key is a hash of the vertices, indices and
+  * transform of every node in the mesh, combined with the bake parameters and VERSION.
+  * @param mesh Mesh being baked.
+  * @param bakeParams Every parameter that changes the baked volume, hashed as raw bytes so
+  * any padding must be zeroed.
+  * @param bakeParamsSize Size of the bake parameters in bytes.
+  * @return The cache key.
+  */
+  [[nodiscard]] u64 CalculateKey(const Mesh* mesh, const void* bakeParams, u64 bakeParamsSize);
+
+  /**
+  * @brief Compress the volume and write it to the cache, replacing any existing file.
+  * @param key Cache key of the bake, see CalculateKey.
+  * @param info Volume being written.
+  * @param image The image data, GetImageSize() bytes.
+  * @param brickGrid The brick grid data, brickGridSize bytes.
+  * @return True when the file was written; false otherwise.
+  */
+  b8 Save(u64 key, const VolumeInfo& info, const void* image, const void* brickGrid);
+
+  /**
+  * @brief Map the cache file of the key into memory and validate it. Call Close when done.
+  * @param key Cache key of the bake, see CalculateKey.
+  * @param layout The volume the file must hold, the key alone can't be trusted as the file may be corrupt.
+  * @param out_cacheFile Output cache file.
+  * @return True on a cache hit; false when there isn't a valid file for the key.
+  */
+  b8 Open(u64 key, const VolumeLayout& layout, CacheFile* out_cacheFile);
+
+  /**
+  * @brief Decompress the image in parallel on the JobSystem.
+  * @param cacheFile Cache file opened with Open.
+  * @param out_image Output image data, must be GetImageSize() bytes. Can be mapped GPU memory.
+  * @return True when the image was decompressed; false when the file is corrupt.
+  */
+  b8 ReadImage(const CacheFile& cacheFile, void* out_image);
+
+  /** @brief Unmap a cache file opened with Open. */
+  void Close(CacheFile* cacheFile);
+
+} // namespace SdfBakeCache
+
+#endif //SNOWFLAKE_SDF_BAKE_CACHE_HPP
@@ -0,0 +1,154 @@
+#include "geometry/SdfEncoding.hpp"
+
+// core
+#include "core/Logging.hpp"
+
+#include <gtc/packing.hpp>
+
+SdfEncoding SdfEncoding::Calculate(SdfFormat format, const f32* distances, u64 count)
+{
+  SdfEncoding encoding = {};
+  encoding.format      = format;
+
+  if (format == SdfFormat::F32 || format == SdfFormat::F16) return encoding;
+
+  f32 minDistance = F32_MAX;
+  f32 maxDistance = -F32_MAX;
+
+  for (u64 i = 0; i < count; ++i)
+  {
+    minDistance = MIN(minDistance, distances[i]);
+    maxDistance = MAX(maxDistance, distances[i]);
+  }
+
+  // NOTE(WSWhitehouse): The 8 bit format doesn't have enough precision for the whole
+  // volume, so only the distances close to the surface are stored accurately...
+  if (format == SdfFormat::UNORM8)
+  {
+    minDistance = MAX(minDistance, -UNORM8_NARROW_BAND);
+    maxDistance = MIN(maxDistance,  UNORM8_NARROW_BAND);
+  }
+
+  // NOTE(WSWhitehouse): Every distance is the same (or there are none), the scale
+  // must not be 0 as the stored values are divided by it...
+  if (count == 0 || maxDistance <= minDistance)
+  {
+    encoding.scale = 1.0f;
+    encoding.bias  = count > 0 ? minDistance : 0.0f;
+    return encoding;
+  }
+
+  encoding.scale = maxDistance - minDistance;
+  encoding.bias  = minDistance;
+  return encoding;
+}
+
+u32 SdfEncoding::GetDistanceSize() const
+{
+  switch (format)
+  {
+    case SdfFormat::F32:     return sizeof(f32);
+    case SdfFormat::F16:     return sizeof(u16);
+    case SdfFormat::UNORM16: return sizeof(u16);
+    case SdfFormat::UNORM8:  return sizeof(u8);
+
+    default:
+    {
+      LOG_FATAL("Unhandled SdfFormat in switch statement!");
+      return 0;
+    }
+  }
+}
+
+void SdfEncoding::Encode(const f32* distances, u64 count, void* out_data) const
+{
+  switch (format)
+  {
+    case SdfFormat::F32:
+    {
+      mem_copy(out_data, distances, sizeof(f32) * count);
+      break;
+    }
+    case SdfFormat::F16:
+    {
+      u16* data = (u16*)out_data;
+      for (u64 i = 0; i < count; ++i)
+      {
+        data[i] = glm::packHalf1x16(distances[i]);
+      }
+      break;
+    }
+    case SdfFormat::UNORM16:
+    {
+      u16* data = (u16*)out_data;
+      for (u64 i = 0; i < count; ++i)
+      {
+        data[i] = glm::packUnorm1x16((distances[i] - bias) / scale);
+      }
+      break;
+    }
+    case SdfFormat::UNORM8:
+    {
+      u8* data = (u8*)out_data;
+      for (u64 i = 0; i < count; ++i)
+      {
+        data[i] = glm::packUnorm1x8((distances[i] - bias) / scale);
+      }
+      break;
+    }
+
+    default:
+    {
+      LOG_FATAL("Unhandled SdfFormat in switch statement!");
+      return;
+    }
+  }
+}
+
+f32 SdfEncoding::Decode(const void* data, u64 index) const
+{
+  switch (format)
+  {
+    case SdfFormat::F32:     return ((const f32*)data)[index];
+    case SdfFormat::F16:     return glm::unpackHalf1x16(((const u16*)data)[index]);
+    case SdfFormat::UNORM16: return (glm::unpackUnorm1x16(((const u16*)data)[index]) * scale) + bias;
+    case SdfFormat::UNORM8:  return (glm::unpackUnorm1x8(((const u8*)data)[index]) * scale) + bias;
+
+    default:
+    {
+      LOG_FATAL("Unhandled SdfFormat in switch statement!");
+      return 0.0f;
+    }
+  }
+}
+
+SdfEncoding::Error SdfEncoding::MeasureError(const f32* distances, const void* data, u64 count) const
+{
+  Error error = { 0.0f, 0.0f, 0 };
+
+  const b8 isNormalised = format == SdfFormat::UNORM16 || format == SdfFormat::UNORM8;
+
+  // NOTE(WSWhitehouse): Allows for rounding errors at the edges of the range...
+  constexpr const f32 epsilon = 1e-5f;
+
+  f64 totalError = 0.0;
+  u64 errorCount = 0;
+
+  for (u64 i = 0; i < count; ++i)
+  {
+    const f32 normalised = (distances[i] - bias) / scale;
+    if (isNormalised && (normalised < -epsilon || normalised > 1.0f + epsilon))
+    {
+      error.clampedCount++;
+      continue;
+    }
+
+    const f32 distError = glm::abs(Decode(data, i) - distances[i]);
+    error.maxError      = MAX(error.maxError, distError);
+    totalError         += distError;
+    errorCount++;
+  }
+
+  error.meanError = errorCount > 0 ? (f32)(totalError / (f64)errorCount) : 0.0f;
+  return error;
+}
@@ -0,0 +1,87 @@
+#ifndef SNOWFLAKE_SDF_ENCODING_HPP
+#define SNOWFLAKE_SDF_ENCODING_HPP
+
+#include "pch.hpp"
+
+enum class SdfFormat : u8
+{
+  F32,     // 32 bit float, the reference format
+  F16,     // 16 bit float
+  UNORM16, // 16 bit normalised, covers every distance in the volume
+  UNORM8,  // 8 bit normalised, distances are clamped to a narrow band around the surface
+};
+
+/**
+* @brief Returns the string representation of the SdfFormat.
+*/
+constexpr INLINE const char* SdfFormatToString(SdfFormat format)
+{
+  switch (format)
+  {
+    case SdfFormat::F32:     return "F32";
+    case SdfFormat::F16:     return "F16";
+    case SdfFormat::UNORM16: return "UNORM16";
+    case SdfFormat::UNORM8:  return "UNORM8";
+    default:                 return "UNKNOWN";
+  }
+}
+
+/**
+* @brief How the signed distances of a volume are stored, so the volume can use a
+* smaller format than f32. The normalised formats store (distance - bias) / scale
+* and are decoded as (stored * scale) + bias, this is the same for every format so
+* the shaders decode every format the same way (the float formats have a scale of
+* 1 and a bias of 0).
+*/
+struct SdfEncoding
+{
+  /** @brief The narrow band of the UNORM8 format, in cells. */
+  static inline constexpr const f32 UNORM8_NARROW_BAND = 8.0f;
+
+  /** @brief The error of the decoded distances compared to the f32 distances. */
+  struct Error
+  {
+    f32 maxError;     // Largest error of the distances that aren't clamped
+    f32 meanError;    // Mean error of the distances that aren't clamped
+    u64 clampedCount; // Number of distances outside the range of the format
+  };
+
+  /**
+  * @brief Calculate the encoding that fits the distances into the format.
+  * @param format Format to encode into.
+  * @param distances Array of distances, in grid space.
+  * @param count Number of distances.
+  * @return The encoding.
+  */
+  [[nodiscard]] static SdfEncoding Calculate(SdfFormat format, const f32* distances, u64 count);
+
+  /** @brief Get the size of a single encoded distance in bytes. */
+  [[nodiscard]] u32 GetDistanceSize() const;
+
+  /**
+  * @brief Encode the distances into the format.
+  * @param distances Array of distances to encode.
+  * @param count Number of distances.
+  * @param out_data Encoded distances, must be at least `count * GetDistanceSize()` bytes.
+  */
+  void Encode(const f32* distances, u64 count, void* out_data) const;
+
+  /** @brief Decode a single distance from the encoded data. */
+  [[nodiscard]] f32 Decode(const void* data, u64 index) const;
+
+  /**
+  * @brief Measure the error of the encoded distances.
+  * @param distances The original f32 distances.
+  * @param data The encoded distances.
+  * @param count Number of distances.
+  * @return The error.
+  */
+  [[nodiscard]] Error MeasureError(const f32* distances, const void* data, u64 count) const;
+
+  // --- MEMBER DATA --- //
+  SdfFormat format = SdfFormat::F32;
+  f32 scale        = 1.0f;
+  f32 bias         = 0.0f;
+};
+
+#endif //SNOWFLAKE_SDF_ENCODING_HPP
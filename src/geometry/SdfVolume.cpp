@@ -0,0 +1,761 @@
+#include "geometry/SdfVolume.hpp"
+
+// core
+#include "core/Logging.hpp"
+#include "core/Profiler.hpp"
+
+// containers
+#include "containers/BVH.hpp"
+
+// geometry
+#include "geometry/Mesh.hpp"
+#include "geometry/MeshGeometry.hpp"
+#include "geometry/BoundingBox3D.hpp"
+
+// threading
+#include "threading/JobSystem.hpp"
+
+#include <vector>
+
+// NOTE(WSWhitehouse): The number of ranges each thread bakes when baking in parallel...
+static inline constexpr const u32 RANGES_PER_THREAD = 4;
+
+// NOTE(WSWhitehouse): Nodes further away than this multiple of their radius are treated
+// as a single dipole when calculating the winding number, rather than visiting every
+// triangle. Higher values are more accurate but slower...
+static inline constexpr const f32 WINDING_NUMBER_ACCURACY = 2.0f;
+
+SdfGridLayout SdfGridLayout::Calculate(const Mesh* mesh, glm::uvec3 uCellCount)
+{
+  SdfGridLayout layout = {};
+
+  // Calculate the bounding box for the entire mesh
+  BoundingBox3D boundingBox
+    {
+      .minimum = { F32_MAX,  F32_MAX,  F32_MAX},
+      .maximum = {-F32_MAX, -F32_MAX, -F32_MAX}
+    };
+
+  for (u32 i = 0; i < mesh->nodeCount; ++i)
+  {
+    const MeshNode& node         = mesh->nodeArray[i];
+    const MeshGeometry& geometry = mesh->geometryArray[node.geometryIndex];
+
+    const BoundingBox3D geometryBoundingBox = geometry.CalculateBoundingBox(node.transformMatrix);
+    boundingBox = BoundingBox3D::Combine(boundingBox, geometryBoundingBox);
+  }
+
+  // Grid Extent
+  const glm::vec3 meshExtent = boundingBox.GetSize();
+  const f32 maxExtentValue   = MAX(meshExtent.x, MAX(meshExtent.y, meshExtent.z));
+  const glm::vec3 gridExtent = glm::vec3(maxExtentValue, maxExtentValue, maxExtentValue);
+  layout.gridExtent          = gridExtent;
+  layout.gridCenterOffset    = boundingBox.GetCenter();
+
+  // Cell Count
+  const glm::vec3 cellCount = glm::vec3(uCellCount);
+  const u64 totalCellCount  = uCellCount.x * uCellCount.y * uCellCount.z;
+  layout.cellCount          = glm::uvec4(uCellCount.x, uCellCount.y, uCellCount.z, totalCellCount);
+
+  // Scaling Factor
+  const glm::vec3 cellSize      = gridExtent / cellCount;
+  const glm::vec3 scalingFactor = cellCount / (gridExtent + cellSize * 2.0f);
+  layout.scalingFactor          = MIN(scalingFactor.x, MIN(scalingFactor.y, scalingFactor.z));
+
+  // Cell Size
+  layout.cellSize = (gridExtent / cellCount) * scalingFactor;
+
+  return layout;
+}
+
+void SdfVolume::Create(const SdfGridLayout& gridLayout)
+{
+  layout    = gridLayout;
+  distances = (f32*)mem_alloc(GetSize());
+
+  for (u64 i = 0; i < layout.cellCount.w; ++i)
+  {
+    distances[i] = F32_MAX;
+  }
+}
+
+void SdfVolume::Destroy()
+{
+  mem_free(distances);
+
+  layout    = {};
+  distances = nullptr;
+}
+
+/**
+* @brief The far field approximation of the triangles in a BVH node, used to calculate
+* the winding number. The triangles are treated as a single dipole at their area
+* weighted center, whose strength is the sum of the area weighted normals.
+*/
+struct WindingNumberNode
+{
+  glm::vec3 areaNormal;
+  f32 area;
+  glm::vec3 center;
+  f32 radius; // Distance from the center to the furthest corner of the node bounds
+};
+
+static WindingNumberNode* CreateWindingNumberNodes(const BVH& bvh)
+{
+  WindingNumberNode* windingNodes = (WindingNumberNode*)mem_alloc(sizeof(WindingNumberNode) * bvh.nodeCount);
+
+  // NOTE(WSWhitehouse): Children are always after their parent in the node array,
+  // so walking the array backwards visits the children first...
+  for (u32 i = bvh.nodeCount; i-- > 0;)
+  {
+    const BVH::Node& node          = bvh.nodes[i];
+    WindingNumberNode& windingNode = windingNodes[i];
+
+    glm::vec3 areaNormal = glm::vec3(0.0f);
+    glm::vec3 center     = glm::vec3(0.0f);
+    f32 area             = 0.0f;
+
+    if (node.IsLeaf())
+    {
+      for (u32 tri = node.offset; tri < node.offset + node.triangleCount; ++tri)
+      {
+        const Triangle& triangle = bvh.triangles[tri];
+        const glm::vec3 normal   = glm::cross(triangle.vertices[1] - triangle.vertices[0],
+                                              triangle.vertices[2] - triangle.vertices[0]) * 0.5f;
+        const f32 triangleArea   = glm::length(normal);
+
+        areaNormal += normal;
+        center     += triangle.CalculateCentroid() * triangleArea;
+        area       += triangleArea;
+      }
+    }
+    else
+    {
+      const WindingNumberNode& left  = windingNodes[i + 1];
+      const WindingNumberNode& right = windingNodes[node.offset];
+
+      areaNormal = left.areaNormal + right.areaNormal;
+      center     = (left.center * left.area) + (right.center * right.area);
+      area       = left.area + right.area;
+    }
+
+    windingNode.areaNormal = areaNormal;
+    windingNode.area       = area;
+    windingNode.center     = area > 0.0f ? center / area : node.GetBounds().GetCenter();
+
+    const glm::vec3 furthestCorner = glm::max(glm::abs(windingNode.center - node.minimum),
+                                              glm::abs(node.maximum - windingNode.center));
+    windingNode.radius = glm::length(furthestCorner);
+  }
+
+  return windingNodes;
+}
+
+/**
+* @brief Calculate the solid angle of the triangle as seen from the point, positive
+* when the point is behind the triangle (Van Oosterom & Strackee).
+*/
+static INLINE f32 TriangleSolidAngle(const Triangle& triangle, const glm::vec3& point)
+{
+  const glm::vec3 a = triangle.vertices[0] - point;
+  const glm::vec3 b = triangle.vertices[1] - point;
+  const glm::vec3 c = triangle.vertices[2] - point;
+
+  const f32 lengthA = glm::length(a);
+  const f32 lengthB = glm::length(b);
+  const f32 lengthC = glm::length(c);
+
+  const f32 determinant = glm::dot(a, glm::cross(b, c));
+  const f32 divisor     = (lengthA * lengthB * lengthC) + (glm::dot(a, b) * lengthC) +
+                          (glm::dot(b, c) * lengthA) + (glm::dot(c, a) * lengthB);
+
+  return 2.0f * glm::atan(determinant, divisor);
+}
+
+/**
+* @brief Calculate the generalised winding number of the mesh at the point, it is 1
+* inside a closed mesh and 0 outside.
+* @param stack Scratch space for the traversal, at least `bvh.depth + 1` entries.
+*/
+static f32 CalculateWindingNumber(const BVH& bvh, const WindingNumberNode* windingNodes,
+                                  const glm::vec3& point, u32* stack)
+{
+  f32 solidAngle = 0.0f;
+
+  u32 stackSize = 0;
+  stack[stackSize++] = 0;
+
+  while (stackSize > 0)
+  {
+    const u32 nodeIndex                  = stack[--stackSize];
+    const BVH::Node& node                = bvh.nodes[nodeIndex];
+    const WindingNumberNode& windingNode = windingNodes[nodeIndex];
+
+    const glm::vec3 toCenter = windingNode.center - point;
+    const f32 distSq         = glm::dot(toCenter, toCenter);
+    const f32 farDistance    = windingNode.radius * WINDING_NUMBER_ACCURACY;
+
+    if (distSq > farDistance * farDistance)
+    {
+      solidAngle += glm::dot(windingNode.areaNormal, toCenter) / (distSq * glm::sqrt(distSq));
+      continue;
+    }
+
+    if (node.IsLeaf())
+    {
+      for (u32 tri = node.offset; tri < node.offset + node.triangleCount; ++tri)
+      {
+        solidAngle += TriangleSolidAngle(bvh.triangles[tri], point);
+      }
+      continue;
+    }
+
+    stack[stackSize++] = node.offset;
+    stack[stackSize++] = nodeIndex + 1;
+  }
+
+  return solidAngle / (4.0f * (f32)PI);
+}
+
+/** @brief The acceleration structures used to find the signed distance to a mesh. */
+struct MeshDistanceQuery
+{
+  BVH bvh = {};
+  WindingNumberNode* windingNodes = nullptr; // nullptr when the sign comes from the closest triangle
+};
+
+static b8 CreateMeshDistanceQuery(MeshDistanceQuery* query, const Mesh* mesh, b8 useWindingNumbers)
+{
+  query->bvh.Create(mesh);
+
+  if (query->bvh.triangleCount == 0)
+  {
+    LOG_WARN("SdfVolume: Baking a mesh with no triangles!");
+    query->bvh.Destroy();
+    return false;
+  }
+
+  query->windingNodes = useWindingNumbers ? CreateWindingNumberNodes(query->bvh) : nullptr;
+  return true;
+}
+
+static void DestroyMeshDistanceQuery(MeshDistanceQuery* query)
+{
+  mem_free(query->windingNodes);
+  query->bvh.Destroy();
+  *query = {};
+}
+
+/** @brief Allocate the scratch space used to calculate the winding number, nullptr when it isn't used. */
+static INLINE u32* AllocateWindingNumberStack(const MeshDistanceQuery& query)
+{
+  if (query.windingNodes == nullptr) return nullptr;
+  return (u32*)mem_alloc(sizeof(u32) * (query.bvh.depth + 1));
+}
+
+/**
+* @brief Find which side of the surface the point is on.
+* @param triangle The triangle closest to the point.
+* @return 1 outside the mesh; -1 inside.
+*/
+static INLINE f32 CalculateSign(const MeshDistanceQuery& query, const glm::vec3& point, u32 triangle, u32* stack)
+{
+  if (query.windingNodes != nullptr)
+  {
+    return CalculateWindingNumber(query.bvh, query.windingNodes, point, stack) > 0.5f ? -1.0f : 1.0f;
+  }
+
+  const Triangle& closest = query.bvh.triangles[triangle];
+  const glm::vec3 normal  = glm::cross(closest.vertices[1] - closest.vertices[0],
+                                       closest.vertices[2] - closest.vertices[0]);
+
+  return glm::dot(normal, point - closest.vertices[0]) >= 0.0f ? 1.0f : -1.0f;
+}
+
+/**
+* @brief Bake a row of cells along the x axis.
+* @param start The first cell in the row.
+* @param count Number of cells in the row.
+* @param stack Winding number scratch space, see AllocateWindingNumberStack.
+* @param out_distances Array of count distances, in grid space.
+*/
+static void BakeRow(const MeshDistanceQuery& query, const SdfGridLayout& layout,
+                    glm::uvec3 start, u32 count, u32* stack, f32* out_distances)
+{
+  // NOTE(WSWhitehouse): The distance between neighbouring cells in mesh space...
+  const f32 cellStep = 1.0f / layout.scalingFactor;
+
+  f32 prevDistance = F32_MAX;
+  f32 prevSign     = 1.0f;
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    const glm::vec3 point = layout.CellToMesh({ start.x + i, start.y, start.z });
+
+    // NOTE(WSWhitehouse): The distance can change by at most the distance between the cells,
+    // so the previous cell bounds the search. This culls most of the BVH straight away...
+    u32 triangle             = U32_MAX;
+    const f32 searchDistance = prevDistance < F32_MAX ? prevDistance + (cellStep * 1.01f) : F32_MAX;
+    f32 distance             = query.bvh.ClosestTriangle(point, searchDistance, &triangle);
+
+    if (triangle == U32_MAX)
+    {
+      distance = query.bvh.ClosestTriangle(point, F32_MAX, &triangle);
+    }
+
+    // NOTE(WSWhitehouse): There is no surface within the previous distance of the previous cell,
+    // so if this cell is inside that sphere they are on the same side of the surface. This is
+    // only worth it for the winding number, the closest triangle is already known...
+    f32 sign;
+    if (query.windingNodes != nullptr && prevDistance < F32_MAX && prevDistance > cellStep)
+    {
+      sign = prevSign;
+    }
+    else
+    {
+      sign = CalculateSign(query, point, triangle, stack);
+    }
+
+    out_distances[i] = sign * distance * layout.scalingFactor;
+
+    prevDistance = distance;
+    prevSign     = sign;
+  }
+}
+
+/**
+* @brief Run the function on ranges of [0, count) in parallel, see JobSystem::ParallelForRanges.
+* The range count depends on the thread count so the function must not depend on the ranges.
+* @param func Called as func(u32 start, u32 end).
+*/
+template<typename Func>
+static INLINE void ParallelForRanges(u32 count, const Func& func)
+{
+  JobSystem::ParallelForRanges(count, (u32)(JobSystem::GetWorkerThreadCount() + 1) * RANGES_PER_THREAD, func);
+}
+
+void SdfVolume::BakeMesh(const Mesh* mesh, b8 useWindingNumbers)
+{
+  PROFILE_FUNC
+
+  if (layout.cellCount.w == 0) return;
+
+  MeshDistanceQuery query = {};
+  if (!CreateMeshDistanceQuery(&query, mesh, useWindingNumbers)) return;
+
+  // NOTE(WSWhitehouse): Every cell is independent (the previous cell is only used inside a row),
+  // so the slabs can be baked at the same time and the result doesn't depend on the thread count...
+  ParallelForRanges(layout.cellCount.z, [this, &query](u32 zStart, u32 zEnd)
+  {
+    u32* stack = AllocateWindingNumberStack(query);
+
+    for (u32 z = zStart; z < zEnd; ++z)
+    {
+      for (u32 y = 0; y < layout.cellCount.y; ++y)
+      {
+        BakeRow(query, layout, { 0, y, z }, layout.cellCount.x, stack, &distances[layout.GetCellIndex(0, y, z)]);
+      }
+    }
+
+    mem_free(stack);
+  });
+
+  DestroyMeshDistanceQuery(&query);
+}
+
+/**
+* @brief Solve the eikonal equation at a cell using the first order upwind (Godunov)
+* scheme, with a grid spacing of 1.
+* @param a, b, c The smallest distance of the neighbours on each axis.
+* @return The distance of the cell.
+*/
+static INLINE f32 SolveEikonal(f32 a, f32 b, f32 c)
+{
+  // NOTE(WSWhitehouse): Sort so a <= b <= c, then add the axes one at a time until
+  // the solution is smaller than the next neighbour...
+  if (a > b) std::swap(a, b);
+  if (b > c) std::swap(b, c);
+  if (a > b) std::swap(a, b);
+
+  const f32 solution1D = a + 1.0f;
+  if (solution1D <= b) return solution1D;
+
+  const f32 solution2D = (a + b + glm::sqrt(2.0f - ((a - b) * (a - b)))) * 0.5f;
+  if (solution2D <= c) return solution2D;
+
+  const f32 sum = a + b + c;
+  return (sum + glm::sqrt((sum * sum) - (3.0f * ((a * a) + (b * b) + (c * c) - 1.0f)))) / 3.0f;
+}
+
+/**
+* @brief Sweep the cells in the block in a single direction, see SdfVolume::FastSweep.
+* @param reverse The axes that are swept from the end of the block to the start.
+*/
+static void SweepBlock(f32* distances, const u8* fixedCells, glm::uvec3 cellCount,
+                       glm::uvec3 blockStart, glm::uvec3 blockEnd, glm::bvec3 reverse)
+{
+  const u64 strideY = cellCount.x;
+  const u64 strideZ = (u64)cellCount.x * cellCount.y;
+
+  const glm::uvec3 size  = blockEnd - blockStart;
+  const glm::ivec3 step  = { reverse.x ? -1 : 1, reverse.y ? -1 : 1, reverse.z ? -1 : 1 };
+  const glm::ivec3 first =
+    {
+      reverse.x ? blockEnd.x - 1 : blockStart.x,
+      reverse.y ? blockEnd.y - 1 : blockStart.y,
+      reverse.z ? blockEnd.z - 1 : blockStart.z
+    };
+
+  for (u32 iz = 0; iz < size.z; ++iz)
+  {
+    const u32 z = (u32)(first.z + ((i32)iz * step.z));
+
+    for (u32 iy = 0; iy < size.y; ++iy)
+    {
+      const u32 y = (u32)(first.y + ((i32)iy * step.y));
+
+      for (u32 ix = 0; ix < size.x; ++ix)
+      {
+        const u32 x     = (u32)(first.x + ((i32)ix * step.x));
+        const u64 index = (u64)x + (y * strideY) + (z * strideZ);
+
+        if (fixedCells[index]) continue;
+
+        const f32 neighbours[6] =
+          {
+            x > 0               ? distances[index - 1]       : F32_MAX,
+            x + 1 < cellCount.x ? distances[index + 1]       : F32_MAX,
+            y > 0               ? distances[index - strideY] : F32_MAX,
+            y + 1 < cellCount.y ? distances[index + strideY] : F32_MAX,
+            z > 0               ? distances[index - strideZ] : F32_MAX,
+            z + 1 < cellCount.z ? distances[index + strideZ] : F32_MAX,
+          };
+
+        // NOTE(WSWhitehouse): The cell takes the sign of its closest neighbour, the fixed
+        // band separates the inside from the outside so they are never mixed...
+        f32 closest = neighbours[0];
+        for (u32 i = 1; i < 6; ++i)
+        {
+          if (glm::abs(neighbours[i]) < glm::abs(closest)) closest = neighbours[i];
+        }
+
+        if (glm::abs(closest) >= F32_MAX) continue;
+
+        const f32 distance = SolveEikonal(MIN(glm::abs(neighbours[0]), glm::abs(neighbours[1])),
+                                          MIN(glm::abs(neighbours[2]), glm::abs(neighbours[3])),
+                                          MIN(glm::abs(neighbours[4]), glm::abs(neighbours[5])));
+
+        if (distance < glm::abs(distances[index]))
+        {
+          distances[index] = closest < 0.0f ? -distance : distance;
+        }
+      }
+    }
+  }
+}
+
+void SdfVolume::FastSweep(f32 fixedBand, u32 iterations)
+{
+  PROFILE_FUNC
+
+  if (layout.cellCount.w == 0) return;
+
+  const glm::uvec3 cellCount = glm::uvec3(layout.cellCount);
+
+  u8* fixedCells = (u8*)mem_alloc(layout.cellCount.w);
+  ParallelForRanges(cellCount.z, [this, fixedCells, fixedBand, &cellCount](u32 zStart, u32 zEnd)
+  {
+    const u64 start = layout.GetCellIndex(0, 0, zStart);
+    const u64 end   = layout.GetCellIndex(0, 0, zEnd);
+    for (u64 i = start; i < end; ++i)
+    {
+      fixedCells[i] = glm::abs(distances[i]) <= fixedBand;
+    }
+  });
+
+  // NOTE(WSWhitehouse): A block only depends on the blocks before it on each axis, so every
+  // block on the same diagonal plane (x + y + z) can be swept at the same time. The blocks
+  // are grouped by their plane, reversed axes are mirrored when the block is swept...
+  const glm::uvec3 blockCount = (cellCount + (SWEEP_BLOCK_SIZE - 1)) / SWEEP_BLOCK_SIZE;
+  const u32 planeCount        = blockCount.x + blockCount.y + blockCount.z - 2;
+
+  std::vector<glm::uvec3> blocks = {};
+  std::vector<u32> planeOffsets  = {};
+  blocks.reserve((u64)blockCount.x * blockCount.y * blockCount.z);
+  planeOffsets.reserve(planeCount + 1);
+
+  for (u32 plane = 0; plane < planeCount; ++plane)
+  {
+    planeOffsets.push_back((u32)blocks.size());
+
+    for (u32 z = 0; z < blockCount.z && z <= plane; ++z)
+    {
+      for (u32 y = 0; y < blockCount.y && y + z <= plane; ++y)
+      {
+        const u32 x = plane - y - z;
+        if (x < blockCount.x) blocks.push_back({ x, y, z });
+      }
+    }
+  }
+  planeOffsets.push_back((u32)blocks.size());
+
+  for (u32 iteration = 0; iteration < iterations; ++iteration)
+  {
+    for (u32 sweep = 0; sweep < 8; ++sweep)
+    {
+      const glm::bvec3 reverse = { (sweep & 1) != 0, (sweep & 2) != 0, (sweep & 4) != 0 };
+
+      for (u32 plane = 0; plane < planeCount; ++plane)
+      {
+        const u32 firstBlock = planeOffsets[plane];
+        const u32 blockTotal = planeOffsets[plane + 1] - firstBlock;
+
+        ParallelForRanges(blockTotal, [&](u32 start, u32 end)
+        {
+          for (u32 i = start; i < end; ++i)
+          {
+            glm::uvec3 block = blocks[firstBlock + i];
+            if (reverse.x) block.x = blockCount.x - 1 - block.x;
+            if (reverse.y) block.y = blockCount.y - 1 - block.y;
+            if (reverse.z) block.z = blockCount.z - 1 - block.z;
+
+            const glm::uvec3 blockStart = block * SWEEP_BLOCK_SIZE;
+            const glm::uvec3 blockEnd   = glm::min(blockStart + SWEEP_BLOCK_SIZE, cellCount);
+            SweepBlock(distances, fixedCells, cellCount, blockStart, blockEnd, reverse);
+          }
+        });
+      }
+    }
+  }
+
+  mem_free(fixedCells);
+}
+
+glm::uvec3 SdfBrickVolume::CalculateTopLevelCount(const SdfGridLayout& gridLayout)
+{
+  // NOTE(WSWhitehouse): Neighbouring bricks share their samples, so n bricks cover
+  // (n * BRICK_STRIDE) + 1 cells. There is always at least one brick...
+  const glm::uvec3 cellCount = glm::uvec3(gridLayout.cellCount);
+  return glm::max((cellCount + (BRICK_STRIDE - 2)) / BRICK_STRIDE, glm::uvec3(1));
+}
+
+void SdfBrickVolume::Create(const SdfGridLayout& gridLayout)
+{
+  layout = gridLayout;
+
+  const glm::uvec3 count = CalculateTopLevelCount(layout);
+  topLevelCount          = glm::uvec4(count.x, count.y, count.z, count.x * count.y * count.z);
+
+  topLevel = (TopLevelCell*)mem_alloc(sizeof(TopLevelCell) * topLevelCount.w);
+  for (u32 i = 0; i < topLevelCount.w; ++i)
+  {
+    topLevel[i] = { EMPTY_BRICK, F32_MAX };
+  }
+
+  bricks     = nullptr;
+  brickCount = 0;
+}
+
+void SdfBrickVolume::Destroy()
+{
+  mem_free(topLevel);
+  mem_free(bricks);
+
+  layout        = {};
+  topLevelCount = { 0, 0, 0, 0 };
+  topLevel      = nullptr;
+  bricks        = nullptr;
+  brickCount    = 0;
+}
+
+void SdfBrickVolume::BakeMesh(const Mesh* mesh, b8 useWindingNumbers, f32 narrowBand)
+{
+  PROFILE_FUNC
+
+  if (layout.cellCount.w == 0) return;
+
+  MeshDistanceQuery query = {};
+  if (!CreateMeshDistanceQuery(&query, mesh, useWindingNumbers)) return;
+
+  // NOTE(WSWhitehouse): Every point in a cell is within half a cell diagonal of a sample, so
+  // if no sample is within this distance of the surface the surface doesn't pass through the
+  // brick. Smaller narrow bands would skip bricks the surface passes through...
+  const f32 halfCellDiagonal = glm::sqrt(3.0f) * 0.5f;
+  narrowBand = MAX(narrowBand, halfCellDiagonal);
+
+  // NOTE(WSWhitehouse): Distance from the center of a brick to its corners, in cells...
+  const f32 brickRadius = glm::sqrt(3.0f) * (f32)BRICK_STRIDE * 0.5f;
+
+  // Find the bricks that might be in the narrow band
+  ParallelForRanges(topLevelCount.z, [this, &query, narrowBand, brickRadius](u32 zStart, u32 zEnd)
+  {
+    u32* stack = AllocateWindingNumberStack(query);
+
+    for (u32 z = zStart; z < zEnd; ++z)
+    {
+      for (u32 y = 0; y < topLevelCount.y; ++y)
+      {
+        for (u32 x = 0; x < topLevelCount.x; ++x)
+        {
+          const glm::vec3 center = (glm::vec3(x, y, z) + 0.5f) * (f32)BRICK_STRIDE;
+          const glm::vec3 point  = layout.GridToMesh(center);
+
+          u32 triangle       = U32_MAX;
+          const f32 distance = query.bvh.ClosestTriangle(point, F32_MAX, &triangle) * layout.scalingFactor;
+
+          TopLevelCell& cell = topLevel[GetTopLevelIndex(x, y, z)];
+          if (distance - brickRadius > narrowBand)
+          {
+            cell.brickIndex = EMPTY_BRICK;
+            cell.distance   = CalculateSign(query, point, triangle, stack) * (distance - brickRadius);
+          }
+          else
+          {
+            // NOTE(WSWhitehouse): Marked as a candidate, the index is set below...
+            cell.brickIndex = 0;
+            cell.distance   = 0.0f;
+          }
+        }
+      }
+    }
+
+    mem_free(stack);
+  });
+
+  // NOTE(WSWhitehouse): The candidates are given their index in top-level order,
+  // so the bricks are always in the same order regardless of the thread count...
+  u32 candidateCount = 0;
+  for (u32 i = 0; i < topLevelCount.w; ++i)
+  {
+    if (topLevel[i].brickIndex != EMPTY_BRICK) candidateCount++;
+  }
+
+  u32* candidates = (u32*)mem_alloc(sizeof(u32) * MAX(candidateCount, 1u));
+  bricks          = (f32*)mem_alloc(sizeof(f32) * BRICK_SAMPLE_COUNT * MAX(candidateCount, 1u));
+
+  for (u32 i = 0, candidate = 0; i < topLevelCount.w; ++i)
+  {
+    if (topLevel[i].brickIndex == EMPTY_BRICK) continue;
+
+    topLevel[i].brickIndex  = candidate;
+    candidates[candidate++] = i;
+  }
+
+  // Bake the candidates
+  ParallelForRanges(candidateCount, [this, &query, candidates, narrowBand, halfCellDiagonal](u32 start, u32 end)
+  {
+    u32* stack = AllocateWindingNumberStack(query);
+
+    const glm::uvec3 maxCell = glm::uvec3(layout.cellCount) - 1u;
+
+    for (u32 candidate = start; candidate < end; ++candidate)
+    {
+      const u32 topLevelIndex = candidates[candidate];
+      const glm::uvec3 brick  =
+        {
+          topLevelIndex % topLevelCount.x,
+          (topLevelIndex / topLevelCount.x) % topLevelCount.y,
+          topLevelIndex / (topLevelCount.x * topLevelCount.y)
+        };
+
+      const glm::uvec3 firstCell = brick * BRICK_STRIDE;
+      const u32 rowCount         = MIN(BRICK_SIZE, layout.cellCount.x - firstCell.x);
+      f32* samples               = &bricks[(u64)candidate * BRICK_SAMPLE_COUNT];
+
+      for (u32 z = 0; z < BRICK_SIZE; ++z)
+      {
+        for (u32 y = 0; y < BRICK_SIZE; ++y)
+        {
+          const glm::uvec3 rowStart = { firstCell.x, MIN(firstCell.y + y, maxCell.y), MIN(firstCell.z + z, maxCell.z) };
+          f32* row                  = &samples[(z * BRICK_SIZE * BRICK_SIZE) + (y * BRICK_SIZE)];
+
+          BakeRow(query, layout, rowStart, rowCount, stack, row);
+
+          // NOTE(WSWhitehouse): Samples past the edge of the grid are clamped to the edge...
+          for (u32 x = rowCount; x < BRICK_SIZE; ++x)
+          {
+            row[x] = row[rowCount - 1];
+          }
+        }
+      }
+
+      f32 minDistance = F32_MAX;
+      for (u32 i = 0; i < BRICK_SAMPLE_COUNT; ++i)
+      {
+        minDistance = MIN(minDistance, glm::abs(samples[i]));
+      }
+
+      // NOTE(WSWhitehouse): The brick center was close to the surface, but none of the samples
+      // are. The surface doesn't pass through the brick so every sample has the same sign...
+      if (minDistance > narrowBand)
+      {
+        TopLevelCell& cell = topLevel[topLevelIndex];
+        cell.brickIndex    = EMPTY_BRICK;
+        cell.distance      = glm::sign(samples[0]) * (minDistance - halfCellDiagonal);
+      }
+    }
+
+    mem_free(stack);
+  });
+
+  // NOTE(WSWhitehouse): Remove the candidates that weren't in the narrow band, the
+  // bricks only ever move towards the start of the array so nothing is overwritten...
+  brickCount = 0;
+  for (u32 candidate = 0; candidate < candidateCount; ++candidate)
+  {
+    TopLevelCell& cell = topLevel[candidates[candidate]];
+    if (cell.brickIndex == EMPTY_BRICK) continue;
+
+    if (brickCount != candidate)
+    {
+      mem_copy(&bricks[(u64)brickCount * BRICK_SAMPLE_COUNT],
+               &bricks[(u64)candidate  * BRICK_SAMPLE_COUNT],
+               sizeof(f32) * BRICK_SAMPLE_COUNT);
+    }
+
+    cell.brickIndex = brickCount++;
+  }
+
+  if (brickCount > 0)
+  {
+    bricks = (f32*)mem_realloc(bricks, sizeof(f32) * BRICK_SAMPLE_COUNT * brickCount);
+  }
+  else
+  {
+    mem_free(bricks);
+    bricks = nullptr;
+  }
+
+  mem_free(candidates);
+  DestroyMeshDistanceQuery(&query);
+}
+
+f32 SdfBrickVolume::Sample(const glm::vec3& position) const
+{
+  const glm::vec3 maxCell = glm::vec3(layout.cellCount) - 1.0f;
+  const glm::vec3 cell    = glm::clamp(position, glm::vec3(0.0f), maxCell);
+
+  const glm::uvec3 brick = glm::min(glm::uvec3(cell / (f32)BRICK_STRIDE), glm::uvec3(topLevelCount) - 1u);
+  const TopLevelCell& topLevelCell = topLevel[GetTopLevelIndex(brick.x, brick.y, brick.z)];
+
+  if (topLevelCell.brickIndex == EMPTY_BRICK) return topLevelCell.distance;
+
+  // NOTE(WSWhitehouse): The position can be on the last sample of the brick,
+  // the interpolation then starts from the sample before it...
+  const glm::vec3 local  = cell - glm::vec3(brick * BRICK_STRIDE);
+  const glm::uvec3 base  = glm::min(glm::uvec3(local), glm::uvec3(BRICK_SIZE - 2));
+  const glm::vec3 t      = local - glm::vec3(base);
+  const f32* samples     = GetBrick(topLevelCell.brickIndex);
+
+  const auto sample = [samples, base](u32 x, u32 y, u32 z)
+  {
+    return samples[((base.z + z) * BRICK_SIZE * BRICK_SIZE) + ((base.y + y) * BRICK_SIZE) + (base.x + x)];
+  };
+
+  const f32 x00 = glm::mix(sample(0, 0, 0), sample(1, 0, 0), t.x);
+  const f32 x10 = glm::mix(sample(0, 1, 0), sample(1, 1, 0), t.x);
+  const f32 x01 = glm::mix(sample(0, 0, 1), sample(1, 0, 1), t.x);
+  const f32 x11 = glm::mix(sample(0, 1, 1), sample(1, 1, 1), t.x);
+
+  return glm::mix(glm::mix(x00, x10, t.y), glm::mix(x01, x11, t.y), t.z);
+}
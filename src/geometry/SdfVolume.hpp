@@ -0,0 +1,221 @@
+#ifndef SNOWFLAKE_SDF_VOLUME_HPP
+#define SNOWFLAKE_SDF_VOLUME_HPP
+
+#include "pch.hpp"
+
+// core
+#include "core/Assert.hpp"
+
+// Forward Declarations
+struct Mesh;
+
+/**
+* @brief The layout of a signed distance field voxel grid, matching the layout used by
+* the SdfVoxelGrid compute shaders. Distances are stored in grid space, where the
+* distance between neighbouring cells is 1 and cell (x, y, z) is at position (x, y, z).
+*/
+struct SdfGridLayout
+{
+  /**
+  * @brief The cell count for the 3D Image.
+  * w = x * y * z
+  */
+  glm::uvec4 cellCount = { 0, 0, 0, 0 };
+
+  /** @brief The extents of the voxel grid. */
+  glm::vec3 gridExtent = { 0.0f, 0.0f, 0.0f };
+
+  /** @brief The center of the mesh bounding box, the grid is centered on it. */
+  glm::vec3 gridCenterOffset = { 0.0f, 0.0f, 0.0f };
+
+  /** @brief The size of one cell in the grid. */
+  glm::vec3 cellSize = { 0.0f, 0.0f, 0.0f };
+
+  /** @brief The scaling factor used to scale the mesh to the voxel grid. */
+  f32 scalingFactor = 0.0f;
+
+  /**
+  * @brief Calculate the layout of a voxel grid that fits the mesh.
+  * @param mesh Mesh the grid is created for, every node is included.
+  * @param cellCount Number of cells on each axis.
+  * @return The grid layout.
+  */
+  [[nodiscard]] static SdfGridLayout Calculate(const Mesh* mesh, glm::uvec3 cellCount);
+
+  /** @brief Convert a position in grid space to mesh space. */
+  [[nodiscard]] INLINE glm::vec3 GridToMesh(const glm::vec3& position) const
+  {
+    const glm::vec3 gridCenter = glm::vec3(cellCount) * 0.5f;
+    return ((position - gridCenter) / scalingFactor) + gridCenterOffset;
+  }
+
+  /** @brief Get the position of the cell in mesh space. */
+  [[nodiscard]] INLINE glm::vec3 CellToMesh(glm::uvec3 cell) const { return GridToMesh(glm::vec3(cell)); }
+
+  /** @brief Get the index of the cell, x is the fastest changing axis then y then z. */
+  [[nodiscard]] INLINE u64 GetCellIndex(u32 x, u32 y, u32 z) const
+  {
+    return (u64)x + ((u64)y * cellCount.x) + ((u64)z * cellCount.x * cellCount.y);
+  }
+};
+
+/**
+* @brief A signed distance field volume baked on the CPU, so a mesh can be baked without
+* a GPU. The distances are in the same layout and units as the SdfVoxelGrid 3D image
+* (see SdfGridLayout) so they can be copied directly into the image.
+*
+* Like the DArray it isn't set up during its ctor, call the Create/Destroy functions.
+*/
+struct SdfVolume
+{
+  /** @brief The default band of cells kept by FastSweep, in cells. */
+  static inline constexpr const f32 DEFAULT_FIXED_BAND = 1.0f;
+
+  /** @brief The default number of FastSweep iterations. */
+  static inline constexpr const u32 DEFAULT_SWEEP_ITERATIONS = 1;
+
+  /** @brief The number of cells on each axis of the blocks swept in parallel by FastSweep. */
+  static inline constexpr const u32 SWEEP_BLOCK_SIZE = 16;
+
+  /** @brief Allocate the distances, every cell is set to F32_MAX. */
+  void Create(const SdfGridLayout& gridLayout);
+  void Destroy();
+
+  /**
+  * @brief Bake the signed distance to the mesh into every cell. Each cell finds the
+  * closest triangle using a BVH, the z slabs of the grid are baked in parallel on the
+  * JobSystem. Distances are positive outside the mesh.
+  * @param mesh Mesh to bake, must be the mesh the layout was calculated for.
+  * @param useWindingNumbers When true the sign is found using the generalised winding
+  * number, which works for meshes with holes and self intersections. Otherwise the sign
+  * is found using the normal of the closest triangle, like the compute shaders.
+  */
+  void BakeMesh(const Mesh* mesh, b8 useWindingNumbers);
+
+  /**
+  * @brief Fill in the distances away from the surface by solving the eikonal equation
+  * (|grad d| = 1) with the fast sweeping method, starting from a narrow band of known
+  * distances. Cells within the fixed band are kept as they are, every other cell is set
+  * to the smaller of its distance and the solution (F32_MAX for unknown cells), taking
+  * the sign of its closest neighbour.
+  *
+  * Each sweep visits the cells in one of the 8 diagonal orders. The grid is split into
+  * blocks that are swept in parallel along diagonal wavefronts (x + y + z = n), so the
+  * result is the same as a sequential sweep and doesn't depend on the thread count.
+  * @param fixedBand Cells closer to the surface than this are kept, in cells.
+  * @param iterations Number of times the grid is swept in all 8 directions.
+  *
+  * USEFUL LINKS & RESOURCES:
+  *  - Zhao, H. (2005). A fast sweeping method for Eikonal equations.
+  *  - Detrixhe, M., Gibou, F., Min, C. (2013). A parallel fast sweeping method for the Eikonal equation.
+  */
+  void FastSweep(f32 fixedBand = DEFAULT_FIXED_BAND, u32 iterations = DEFAULT_SWEEP_ITERATIONS);
+
+  /** @brief Get the size of the distances in bytes. */
+  [[nodiscard]] INLINE u64 GetSize() const { return sizeof(f32) * layout.cellCount.w; }
+
+  // --- MEMBER DATA --- //
+  SdfGridLayout layout = {};
+  f32* distances       = nullptr;
+};
+
+/**
+* @brief A sparse signed distance field volume, only the cells within a narrow band of
+* the surface are stored. The grid is split into bricks of BRICK_SIZE^3 samples and a
+* coarse top-level grid holds the index of each brick. Bricks without a sample in the
+* narrow band aren't stored, their top-level cell holds the minimum distance to the
+* surface instead (a lower bound, so it is always safe to sphere trace with).
+*
+* Neighbouring bricks share a face of samples, so brick (x, y, z) holds the cells from
+* (x, y, z) * BRICK_STRIDE to (x, y, z) * BRICK_STRIDE + BRICK_STRIDE inclusive. This
+* means a position can be interpolated using a single brick (and the hardware filtering
+* on the GPU). Cells past the edge of the grid are clamped to the edge.
+*
+* Like the DArray it isn't set up during its ctor, call the Create/Destroy functions.
+*
+* USEFUL LINKS & RESOURCES:
+*  - https://docs.unrealengine.com/5.0/en-US/mesh-distance-fields-in-unreal-engine/
+*  - Museth, K. (2013). VDB: High-Resolution Sparse Volumes with Dynamic Topology.
+*/
+struct SdfBrickVolume
+{
+  /** @brief The number of samples on each axis of a brick. */
+  static inline constexpr const u32 BRICK_SIZE = 8;
+
+  /** @brief The number of cells between the first sample of neighbouring bricks. */
+  static inline constexpr const u32 BRICK_STRIDE = BRICK_SIZE - 1;
+
+  static inline constexpr const u32 BRICK_SAMPLE_COUNT = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+  /** @brief The brick index of top-level cells that don't have a brick. */
+  static inline constexpr const u32 EMPTY_BRICK = U32_MAX;
+
+  /** @brief The default narrow band, in cells. */
+  static inline constexpr const f32 DEFAULT_NARROW_BAND = 2.0f;
+
+  /**
+  * @brief A cell of the top-level grid, the layout matches the `TopLevelCell` std430
+  * struct used by the shaders so the grid can be uploaded directly.
+  */
+  struct TopLevelCell
+  {
+    u32 brickIndex; // EMPTY_BRICK when the brick isn't stored
+    f32 distance;   // Minimum signed distance in the brick, in grid space. Only valid without a brick
+  };
+
+  /** @brief Calculate the number of bricks on each axis of the top-level grid of the layout. */
+  [[nodiscard]] static glm::uvec3 CalculateTopLevelCount(const SdfGridLayout& gridLayout);
+
+  /** @brief Allocate the top-level grid, every brick is empty. */
+  void Create(const SdfGridLayout& gridLayout);
+  void Destroy();
+
+  /**
+  * @brief Bake the signed distance to the mesh into the bricks within the narrow band.
+  * Uses the same distances as SdfVolume::BakeMesh.
+  * @param mesh Mesh to bake, must be the mesh the layout was calculated for.
+  * @param useWindingNumbers Find the sign using the generalised winding number, see SdfVolume::BakeMesh.
+  * @param narrowBand Bricks are stored when any of their samples are closer to the surface than
+  * this, in cells. Values smaller than a cell are clamped, as the surface could pass between samples.
+  */
+  void BakeMesh(const Mesh* mesh, b8 useWindingNumbers, f32 narrowBand = DEFAULT_NARROW_BAND);
+
+  /**
+  * @brief Sample the signed distance using trilinear interpolation, matching the shaders.
+  * @param position Position in grid space, clamped to the grid.
+  * @return The signed distance in grid space.
+  */
+  [[nodiscard]] f32 Sample(const glm::vec3& position) const;
+
+  /** @brief Get the index of the top-level cell, x is the fastest changing axis then y then z. */
+  [[nodiscard]] INLINE u64 GetTopLevelIndex(u32 x, u32 y, u32 z) const
+  {
+    return (u64)x + ((u64)y * topLevelCount.x) + ((u64)z * topLevelCount.x * topLevelCount.y);
+  }
+
+  /** @brief Get the samples of the brick, x is the fastest changing axis then y then z. */
+  [[nodiscard]] INLINE const f32* GetBrick(u32 brickIndex) const { return &bricks[(u64)brickIndex * BRICK_SAMPLE_COUNT]; }
+
+  /** @brief Get the size of the top-level grid and the bricks in bytes. */
+  [[nodiscard]] INLINE u64 GetSize() const
+  {
+    return (sizeof(TopLevelCell) * topLevelCount.w) + (sizeof(f32) * BRICK_SAMPLE_COUNT * brickCount);
+  }
+
+  // --- MEMBER DATA --- //
+  SdfGridLayout layout = {};
+
+  /**
+  * @brief The number of bricks on each axis.
+  * w = x * y * z
+  */
+  glm::uvec4 topLevelCount = { 0, 0, 0, 0 };
+  TopLevelCell* topLevel   = nullptr;
+
+  f32* bricks    = nullptr;
+  u32 brickCount = 0;
+};
+
+STATIC_ASSERT(sizeof(SdfBrickVolume::TopLevelCell) == 8);
+
+#endif //SNOWFLAKE_SDF_VOLUME_HPP
@@ -0,0 +1,207 @@
+#ifndef SNOWFLAKE_TRIANGLE_X8_HPP
+#define SNOWFLAKE_TRIANGLE_X8_HPP
+
+#include "pch.hpp"
+
+// core
+#include "core/Assert.hpp"
+
+// geometry
+#include "geometry/Triangle.hpp"
+
+// math
+#include "math/Math.hpp"
+
+/**
+* @brief 8 triangles stored as structure of arrays, so the distance from a point to all
+* of them is calculated at once using Math::F32x8. Everything that only depends on the
+* triangle (edges, inverse edge lengths and normals) is calculated when the triangles are
+* set, rather than for every point like Triangle::SignedDistanceFromPoint.
+*
+* The same triangle can also be broadcast to every lane, to find the distance from 8
+* different points to a single triangle. Unused lanes are filled with a triangle that
+* is infinitely far away, so they can be included in a minimum without being masked.
+*
+* USEFUL LINKS & RESOURCES:
+*  - https://iquilezles.org/articles/triangledistance/
+*/
+struct TriangleX8
+{
+  static inline constexpr const u32 LANE_COUNT = Math::F32X8_LANE_COUNT;
+
+  /** @brief The number of F32x8 members, they are set in the order they are declared. */
+  static inline constexpr const u32 MEMBER_COUNT = 27;
+
+  /** @brief Position of the unused lanes, far enough away that the squared distance is infinite. */
+  static inline constexpr const f32 UNUSED_LANE_POSITION = 1e30f;
+
+  // NOTE(WSWhitehouse): Only the first vertex is stored, the others are found
+  // by walking along the edges (b = a + ba, c = b + cb)...
+  Math::F32x8 ax, ay, az;
+
+  // Edges
+  Math::F32x8 baX, baY, baZ;
+  Math::F32x8 cbX, cbY, cbZ;
+  Math::F32x8 acX, acY, acZ;
+
+  // 1 / squared edge length, 0 for edges with no length
+  Math::F32x8 invLengthSqBA, invLengthSqCB, invLengthSqAC;
+
+  // NOTE(WSWhitehouse): Point inwards, perpendicular to the edge and the triangle normal.
+  // A point is above the triangle when it is in front of all three. They are 0 for
+  // triangles with no area, so these are always treated as a set of edges...
+  Math::F32x8 edgeNormalBAX, edgeNormalBAY, edgeNormalBAZ;
+  Math::F32x8 edgeNormalCBX, edgeNormalCBY, edgeNormalCBZ;
+  Math::F32x8 edgeNormalACX, edgeNormalACY, edgeNormalACZ;
+
+  // Unit length triangle normal
+  Math::F32x8 normalX, normalY, normalZ;
+
+  /**
+  * @brief Set the lanes to the triangles, lanes past the count are unused.
+  * @param triangles Array of triangles.
+  * @param count Number of triangles, at most LANE_COUNT.
+  */
+  INLINE void Set(const Triangle* triangles, u32 count)
+  {
+    f32 lanes[MEMBER_COUNT][LANE_COUNT];
+
+    for (u32 lane = 0; lane < LANE_COUNT; ++lane)
+    {
+      // NOTE(WSWhitehouse): Unused lanes are a single point, every edge has no length
+      // so the distance overflows to infinity without producing any NaNs...
+      const glm::vec3 unusedPos = glm::vec3(UNUSED_LANE_POSITION);
+      const Triangle unused     = { unusedPos, unusedPos, unusedPos };
+      const Triangle& triangle  = lane < count ? triangles[lane] : unused;
+
+      const glm::vec3& a = triangle.vertices[0];
+      const glm::vec3& b = triangle.vertices[1];
+      const glm::vec3& c = triangle.vertices[2];
+
+      const glm::vec3 ba = b - a;
+      const glm::vec3 cb = c - b;
+      const glm::vec3 ac = a - c;
+
+      // NOTE(WSWhitehouse): Points the same way as Triangle::CalculateNormal...
+      const glm::vec3 normal     = glm::cross(ba, ac);
+      const f32 normalLengthSq   = glm::dot(normal, normal);
+      const glm::vec3 unitNormal = normalLengthSq > 0.0f ? normal / glm::sqrt(normalLengthSq) : glm::vec3(0.0f);
+
+      const glm::vec3 edgeNormalBA = glm::cross(ba, normal);
+      const glm::vec3 edgeNormalCB = glm::cross(cb, normal);
+      const glm::vec3 edgeNormalAC = glm::cross(ac, normal);
+
+      const f32 lengthSqBA = glm::dot(ba, ba);
+      const f32 lengthSqCB = glm::dot(cb, cb);
+      const f32 lengthSqAC = glm::dot(ac, ac);
+
+      const f32 values[MEMBER_COUNT] =
+        {
+          a.x, a.y, a.z,
+          ba.x, ba.y, ba.z,
+          cb.x, cb.y, cb.z,
+          ac.x, ac.y, ac.z,
+          lengthSqBA > 0.0f ? 1.0f / lengthSqBA : 0.0f,
+          lengthSqCB > 0.0f ? 1.0f / lengthSqCB : 0.0f,
+          lengthSqAC > 0.0f ? 1.0f / lengthSqAC : 0.0f,
+          edgeNormalBA.x, edgeNormalBA.y, edgeNormalBA.z,
+          edgeNormalCB.x, edgeNormalCB.y, edgeNormalCB.z,
+          edgeNormalAC.x, edgeNormalAC.y, edgeNormalAC.z,
+          unitNormal.x, unitNormal.y, unitNormal.z
+        };
+
+      for (u32 i = 0; i < MEMBER_COUNT; ++i)
+      {
+        lanes[i][lane] = values[i];
+      }
+    }
+
+    Math::F32x8* members = &ax;
+    for (u32 i = 0; i < MEMBER_COUNT; ++i)
+    {
+      members[i] = Math::F32x8Load(lanes[i]);
+    }
+  }
+
+  /** @brief Set every lane to the same triangle. */
+  INLINE void Broadcast(const Triangle& triangle)
+  {
+    Set(&triangle, 1);
+
+    Math::F32x8* members = &ax;
+    for (u32 i = 0; i < MEMBER_COUNT; ++i)
+    {
+      f32 lanes[LANE_COUNT];
+      Math::F32x8Store(lanes, members[i]);
+      members[i] = Math::F32x8Set(lanes[0]);
+    }
+  }
+
+  /**
+  * @brief Get the squared distance from each point to the closest point on the
+  * triangle in the same lane. Unused lanes return infinity.
+  */
+  [[nodiscard]] INLINE Math::F32x8 DistanceSq(Math::F32x8 px, Math::F32x8 py, Math::F32x8 pz) const
+  {
+    using namespace Math;
+
+    const F32x8 zero = F32x8Set(0.0f);
+    const F32x8 one  = F32x8Set(1.0f);
+
+    // Vectors from each vertex to the point...
+    const F32x8 paX = px - ax;
+    const F32x8 paY = py - ay;
+    const F32x8 paZ = pz - az;
+    const F32x8 pbX = paX - baX;
+    const F32x8 pbY = paY - baY;
+    const F32x8 pbZ = paZ - baZ;
+    const F32x8 pcX = pbX - cbX;
+    const F32x8 pcY = pbY - cbY;
+    const F32x8 pcZ = pbZ - cbZ;
+
+    // Distance to the plane of the triangle...
+    const F32x8 planeDist = (normalX * paX) + (normalY * paY) + (normalZ * paZ);
+    const F32x8 faceDistSq = planeDist * planeDist;
+
+    // Distance to each edge...
+    const F32x8 tBA = F32x8Min(F32x8Max(((baX * paX) + (baY * paY) + (baZ * paZ)) * invLengthSqBA, zero), one);
+    const F32x8 tCB = F32x8Min(F32x8Max(((cbX * pbX) + (cbY * pbY) + (cbZ * pbZ)) * invLengthSqCB, zero), one);
+    const F32x8 tAC = F32x8Min(F32x8Max(((acX * pcX) + (acY * pcY) + (acZ * pcZ)) * invLengthSqAC, zero), one);
+
+    const F32x8 deltaBAX = (baX * tBA) - paX;
+    const F32x8 deltaBAY = (baY * tBA) - paY;
+    const F32x8 deltaBAZ = (baZ * tBA) - paZ;
+    const F32x8 deltaCBX = (cbX * tCB) - pbX;
+    const F32x8 deltaCBY = (cbY * tCB) - pbY;
+    const F32x8 deltaCBZ = (cbZ * tCB) - pbZ;
+    const F32x8 deltaACX = (acX * tAC) - pcX;
+    const F32x8 deltaACY = (acY * tAC) - pcY;
+    const F32x8 deltaACZ = (acZ * tAC) - pcZ;
+
+    const F32x8 edgeDistSq = F32x8Min(F32x8Min(
+      (deltaBAX * deltaBAX) + (deltaBAY * deltaBAY) + (deltaBAZ * deltaBAZ),
+      (deltaCBX * deltaCBX) + (deltaCBY * deltaCBY) + (deltaCBZ * deltaCBZ)),
+      (deltaACX * deltaACX) + (deltaACY * deltaACY) + (deltaACZ * deltaACZ));
+
+    // NOTE(WSWhitehouse): The point is above the triangle when it is in front of every
+    // edge, then the closest point is on the face. Otherwise it is on one of the edges.
+    // Points exactly on an edge use the edges, which gives the same distance...
+    const F32x8 sideBA = (edgeNormalBAX * paX) + (edgeNormalBAY * paY) + (edgeNormalBAZ * paZ);
+    const F32x8 sideCB = (edgeNormalCBX * pbX) + (edgeNormalCBY * pbY) + (edgeNormalCBZ * pbZ);
+    const F32x8 sideAC = (edgeNormalACX * pcX) + (edgeNormalACY * pcY) + (edgeNormalACZ * pcZ);
+    const F32x8 side   = F32x8Min(F32x8Min(sideBA, sideCB), sideAC);
+
+    return F32x8SelectLessThan(zero, side, faceDistSq, edgeDistSq);
+  }
+
+  /** @brief Get the squared distance from the point to each triangle. */
+  [[nodiscard]] INLINE Math::F32x8 DistanceSq(const glm::vec3& point) const
+  {
+    return DistanceSq(Math::F32x8Set(point.x), Math::F32x8Set(point.y), Math::F32x8Set(point.z));
+  }
+};
+
+// NOTE(WSWhitehouse): The members are accessed as an array when setting the lanes...
+STATIC_ASSERT(sizeof(TriangleX8) == sizeof(Math::F32x8) * TriangleX8::MEMBER_COUNT);
+
+#endif //SNOWFLAKE_TRIANGLE_X8_HPP
@@ -1,8 +1,16 @@
 #include "geometry/Triangulation.hpp"
 
+// containers
+#include "containers/SmallVector.hpp"
+
 // geometry
 #include "geometry/Vertex.hpp"
 
+// NOTE(WSWhitehouse): Most polygons being triangulated are small, so the working
+// index list is kept inline and only spills to the heap for large polygons.
+#define EAR_CLIPPING_INLINE_INDEX_COUNT 64
+typedef SmallVector<u32, EAR_CLIPPING_INLINE_INDEX_COUNT> EarClippingIndices;
+
 static INLINE glm::vec3 ComputeTriangleNormal(const Triangle& triangle)
 {
   return glm::normalize(glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]));
@@ -115,20 +123,21 @@ std::vector<Triangle> Triangulation::EarClipping3D(const glm::vec3* points, u32
   std::vector<Triangle> result;
   result.reserve(pointCount - 2);
 
-  std::vector<u32> indices(pointCount);
+  EarClippingIndices indices = {};
+  indices.Create(pointCount);
   for (u32 i = 0; i < pointCount; ++i)
   {
-    indices[i] = i;
+    indices.Add(i);
   }
 
-  while (indices.size() > 3)
+  while (indices.Size() > 3)
   {
     b8 foundEar = false;
 
-    for (u32 i = 0; i < indices.size(); ++i)
+    for (u32 i = 0; i < indices.Size(); ++i)
     {
-      u32 prev = (i == 0) ? indices.size() - 1 : i - 1;
-      u32 next = (i == indices.size() - 1) ? 0 : i + 1;
+      u32 prev = (i == 0) ? indices.Size() - 1 : i - 1;
+      u32 next = (i == indices.Size() - 1) ? 0 : i + 1;
 
       const glm::vec3& a = points[indices[prev]];
       const glm::vec3& b = points[indices[i]];
@@ -139,7 +148,7 @@ std::vector<Triangle> Triangulation::EarClipping3D(const glm::vec3* points, u32
         Triangle triangle = { a, b, c };
         result.push_back(triangle);
 
-        indices.erase(indices.begin() + i);
+        indices.RemoveOrdered(i);
 
         foundEar = true;
         break;
@@ -152,7 +161,7 @@ std::vector<Triangle> Triangulation::EarClipping3D(const glm::vec3* points, u32
     }
   }
 
-  if (indices.size() == 3)
+  if (indices.Size() == 3)
   {
     Triangle triangle =
       {
@@ -163,6 +172,7 @@ std::vector<Triangle> Triangulation::EarClipping3D(const glm::vec3* points, u32
     result.push_back(triangle);
   }
 
+  indices.Destroy();
   return result;
 }
 
@@ -171,20 +181,21 @@ std::vector<Vertex> Triangulation::EarClipping3D(const Vertex* vertices, u32 ver
   std::vector<Vertex> result;
   result.reserve(vertexCount - 2);
 
-  std::vector<u32> indices(vertexCount);
+  EarClippingIndices indices = {};
+  indices.Create(vertexCount);
   for (u32 i = 0; i < vertexCount; ++i)
   {
-    indices[i] = i;
+    indices.Add(i);
   }
 
-  while (indices.size() > 3)
+  while (indices.Size() > 3)
   {
     b8 foundEar = false;
 
-    for (u32 i = 0; i < indices.size(); ++i)
+    for (u32 i = 0; i < indices.Size(); ++i)
     {
-      const u32 prev = (i == 0) ? indices.size() - 1 : i - 1;
-      const u32 next = (i == indices.size() - 1) ? 0 : i + 1;
+      const u32 prev = (i == 0) ? indices.Size() - 1 : i - 1;
+      const u32 next = (i == indices.Size() - 1) ? 0 : i + 1;
 
       const u32 prevIndex = indices[prev];
       const u32 currIndex = indices[i];
@@ -204,7 +215,7 @@ std::vector<Vertex> Triangulation::EarClipping3D(const Vertex* vertices, u32 ver
         result.push_back(vertB);
         result.push_back(vertC);
 
-        indices.erase(indices.begin() + i);
+        indices.RemoveOrdered(i);
 
         foundEar = true;
         break;
@@ -214,12 +225,13 @@ std::vector<Vertex> Triangulation::EarClipping3D(const Vertex* vertices, u32 ver
     if (!foundEar) break;
   }
 
-  if (indices.size() == 3)
+  if (indices.Size() == 3)
   {
     result.push_back(vertices[indices[0]]);
     result.push_back(vertices[indices[1]]);
     result.push_back(vertices[indices[2]]);
   }
 
+  indices.Destroy();
   return result;
 }
\ No newline at end of file
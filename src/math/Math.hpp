@@ -9,5 +9,6 @@
 #include "math/internal/Common.hpp"
 #include "math/internal/Quaternion.hpp"
 #include "math/internal/Matrix.hpp"
+#include "math/internal/Simd.hpp"
 
 #endif //SNOWFLAKE_MATH_HPP
@@ -0,0 +1,238 @@
+#ifndef SNOWFLAKE_SIMD_HPP
+#define SNOWFLAKE_SIMD_HPP
+
+#include "pch.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+  #include <immintrin.h>
+#endif
+
+namespace Math
+{
+
+  /**
+  * @brief 8 f32 lanes that are processed together. Uses a single AVX register when
+  * compiled with AVX2 (see the USE_AVX2 CMake option), a pair of SSE2 registers on
+  * other x86 targets, and falls back to scalar lanes everywhere else. Only the
+  * operations needed by the math kernels are provided.
+  */
+  struct alignas(32) F32x8
+  {
+#if defined(__AVX2__)
+    __m256 v;
+#elif defined(__SSE2__)
+    __m128 lo;
+    __m128 hi;
+#else
+    f32 lanes[8];
+#endif
+  };
+
+  static inline constexpr const u32 F32X8_LANE_COUNT = 8;
+
+#if defined(__AVX2__)
+
+  [[nodiscard]] INLINE F32x8 F32x8Set(f32 value)           { return { _mm256_set1_ps(value) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Load(const f32* values)  { return { _mm256_loadu_ps(values) }; }
+  INLINE void F32x8Store(f32* out, F32x8 a)                { _mm256_storeu_ps(out, a.v); }
+
+  [[nodiscard]] INLINE F32x8 operator+(F32x8 a, F32x8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+  [[nodiscard]] INLINE F32x8 operator-(F32x8 a, F32x8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+  [[nodiscard]] INLINE F32x8 operator*(F32x8 a, F32x8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+  [[nodiscard]] INLINE F32x8 operator/(F32x8 a, F32x8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+
+  [[nodiscard]] INLINE F32x8 F32x8Floor(F32x8 a) { return { _mm256_floor_ps(a.v) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Sqrt(F32x8 a)  { return { _mm256_sqrt_ps(a.v) }; }
+
+  [[nodiscard]] INLINE F32x8 F32x8Min(F32x8 a, F32x8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Max(F32x8 a, F32x8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+
+  /** @brief Returns a bit per lane, set where `a < b`. */
+  [[nodiscard]] INLINE u32 F32x8LessThanMask(F32x8 a, F32x8 b) { return (u32)_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+
+  /** @brief Pick `ifLess` in lanes where `a < b`, otherwise `ifNotLess`. */
+  [[nodiscard]] INLINE F32x8 F32x8SelectLessThan(F32x8 a, F32x8 b, F32x8 ifLess, F32x8 ifNotLess)
+  {
+    return { _mm256_blendv_ps(ifNotLess.v, ifLess.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)) };
+  }
+
+#elif defined(__SSE2__)
+
+  [[nodiscard]] INLINE F32x8 F32x8Set(f32 value)          { return { _mm_set1_ps(value), _mm_set1_ps(value) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Load(const f32* values) { return { _mm_loadu_ps(values), _mm_loadu_ps(values + 4) }; }
+  INLINE void F32x8Store(f32* out, F32x8 a)               { _mm_storeu_ps(out, a.lo); _mm_storeu_ps(out + 4, a.hi); }
+
+  [[nodiscard]] INLINE F32x8 operator+(F32x8 a, F32x8 b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+  [[nodiscard]] INLINE F32x8 operator-(F32x8 a, F32x8 b) { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+  [[nodiscard]] INLINE F32x8 operator*(F32x8 a, F32x8 b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+  [[nodiscard]] INLINE F32x8 operator/(F32x8 a, F32x8 b) { return { _mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi) }; }
+
+  /** @brief SSE2 has no floor, truncate then subtract one where truncating rounded up. Only valid for |a| < 2^31. */
+  [[nodiscard]] INLINE __m128 F32x4Floor(__m128 a)
+  {
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+  }
+
+  [[nodiscard]] INLINE F32x8 F32x8Floor(F32x8 a) { return { F32x4Floor(a.lo), F32x4Floor(a.hi) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Sqrt(F32x8 a)  { return { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) }; }
+
+  [[nodiscard]] INLINE F32x8 F32x8Min(F32x8 a, F32x8 b) { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+  [[nodiscard]] INLINE F32x8 F32x8Max(F32x8 a, F32x8 b) { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+
+  /** @brief Returns a bit per lane, set where `a < b`. */
+  [[nodiscard]] INLINE u32 F32x8LessThanMask(F32x8 a, F32x8 b)
+  {
+    return (u32)_mm_movemask_ps(_mm_cmplt_ps(a.lo, b.lo)) | ((u32)_mm_movemask_ps(_mm_cmplt_ps(a.hi, b.hi)) << 4);
+  }
+
+  /** @brief SSE2 has no blend, the mask is used to combine both sides instead. */
+  [[nodiscard]] INLINE __m128 F32x4Select(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+  {
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+  }
+
+  /** @brief Pick `ifLess` in lanes where `a < b`, otherwise `ifNotLess`. */
+  [[nodiscard]] INLINE F32x8 F32x8SelectLessThan(F32x8 a, F32x8 b, F32x8 ifLess, F32x8 ifNotLess)
+  {
+    return { F32x4Select(_mm_cmplt_ps(a.lo, b.lo), ifLess.lo, ifNotLess.lo),
+             F32x4Select(_mm_cmplt_ps(a.hi, b.hi), ifLess.hi, ifNotLess.hi) };
+  }
+
+#else
+
+  [[nodiscard]] INLINE F32x8 F32x8Set(f32 value)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = value; }
+    return result;
+  }
+
+  [[nodiscard]] INLINE F32x8 F32x8Load(const f32* values)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = values[i]; }
+    return result;
+  }
+
+  INLINE void F32x8Store(f32* out, F32x8 a)
+  {
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { out[i] = a.lanes[i]; }
+  }
+
+  #define SIMD_F32X8_SCALAR_OP(op)                                                     \
+    [[nodiscard]] INLINE F32x8 operator op(F32x8 a, F32x8 b)                           \
+    {                                                                                  \
+      F32x8 result;                                                                    \
+      for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = a.lanes[i] op b.lanes[i]; } \
+      return result;                                                                   \
+    }
+
+  SIMD_F32X8_SCALAR_OP(+)
+  SIMD_F32X8_SCALAR_OP(-)
+  SIMD_F32X8_SCALAR_OP(*)
+  SIMD_F32X8_SCALAR_OP(/)
+
+  #undef SIMD_F32X8_SCALAR_OP
+
+  [[nodiscard]] INLINE F32x8 F32x8Floor(F32x8 a)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = floorf(a.lanes[i]); }
+    return result;
+  }
+
+  [[nodiscard]] INLINE F32x8 F32x8Sqrt(F32x8 a)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = sqrtf(a.lanes[i]); }
+    return result;
+  }
+
+  [[nodiscard]] INLINE F32x8 F32x8Min(F32x8 a, F32x8 b)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = MIN(a.lanes[i], b.lanes[i]); }
+    return result;
+  }
+
+  [[nodiscard]] INLINE F32x8 F32x8Max(F32x8 a, F32x8 b)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = MAX(a.lanes[i], b.lanes[i]); }
+    return result;
+  }
+
+  /** @brief Returns a bit per lane, set where `a < b`. */
+  [[nodiscard]] INLINE u32 F32x8LessThanMask(F32x8 a, F32x8 b)
+  {
+    u32 mask = 0;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { mask |= (a.lanes[i] < b.lanes[i] ? 1U : 0U) << i; }
+    return mask;
+  }
+
+  /** @brief Pick `ifLess` in lanes where `a < b`, otherwise `ifNotLess`. */
+  [[nodiscard]] INLINE F32x8 F32x8SelectLessThan(F32x8 a, F32x8 b, F32x8 ifLess, F32x8 ifNotLess)
+  {
+    F32x8 result;
+    for (u32 i = 0; i < F32X8_LANE_COUNT; ++i) { result.lanes[i] = a.lanes[i] < b.lanes[i] ? ifLess.lanes[i] : ifNotLess.lanes[i]; }
+    return result;
+  }
+
+#endif
+
+  /**
+  * @brief Calculate the sine and cosine of every lane at once (radians). The angle is
+  * reduced to [-PI/4, PI/4] around the nearest multiple of PI/2, then the Cephes minimax
+  * polynomials are evaluated for both and swapped/negated per quadrant. The quadrant
+  * selection is done with arithmetic on the (exact) quadrant index rather than masks,
+  * so it works the same for every lane type. Accurate to a few ULP for |x| < 8192.
+  *
+  * USEFUL LINKS & RESOURCES:
+  *  - http://www.netlib.org/cephes/ (sinf.c)
+  *  - http://gruntthepeon.free.fr/ssemath/
+  */
+  INLINE void F32x8SinCos(F32x8 x, F32x8& outSin, F32x8& outCos)
+  {
+    const F32x8 one  = F32x8Set(1.0f);
+    const F32x8 two  = F32x8Set(2.0f);
+    const F32x8 half = F32x8Set(0.5f);
+
+    // Quadrant index (nearest multiple of PI/2)...
+    const F32x8 quadrant = F32x8Floor(x * F32x8Set(0.636619772367581343f) + half);
+
+    // NOTE(WSWhitehouse): Extended precision modular arithmetic (Cody-Waite), PI/2 is
+    // split into three parts so the subtraction doesn't lose precision...
+    F32x8 r = x - quadrant * F32x8Set(1.5703125f);
+    r = r - quadrant * F32x8Set(4.837512969970703125e-4f);
+    r = r - quadrant * F32x8Set(7.54978995489188216e-8f);
+
+    const F32x8 r2 = r * r;
+
+    F32x8 sinPoly = F32x8Set(-1.9515295891e-4f);
+    sinPoly = sinPoly * r2 + F32x8Set(8.3321608736e-3f);
+    sinPoly = sinPoly * r2 + F32x8Set(-1.6666654611e-1f);
+    sinPoly = sinPoly * r2 * r + r;
+
+    F32x8 cosPoly = F32x8Set(2.443315711809948e-5f);
+    cosPoly = cosPoly * r2 + F32x8Set(-1.388731625493765e-3f);
+    cosPoly = cosPoly * r2 + F32x8Set(4.166664568298827e-2f);
+    cosPoly = cosPoly * r2 * r2 - half * r2 + one;
+
+    // quadrant mod 4, then work out if sin/cos swap and the sign of each...
+    const F32x8 quarter       = F32x8Set(0.25f);
+    const F32x8 four          = F32x8Set(4.0f);
+    const F32x8 quadrantMod   = quadrant - four * F32x8Floor(quadrant * quarter);
+    const F32x8 swap          = quadrantMod - two * F32x8Floor(quadrantMod * half);
+    const F32x8 nextQuadrant  = quadrantMod + one;
+    const F32x8 nextMod       = nextQuadrant - four * F32x8Floor(nextQuadrant * quarter);
+    const F32x8 sinSign       = one - two * F32x8Floor(quadrantMod * half);
+    const F32x8 cosSign       = one - two * F32x8Floor(nextMod * half);
+
+    outSin = sinSign * (sinPoly + swap * (cosPoly - sinPoly));
+    outCos = cosSign * (cosPoly + swap * (sinPoly - cosPoly));
+  }
+
+} // namespace Math
+
+#endif //SNOWFLAKE_SIMD_HPP
@@ -15,6 +15,7 @@
 // containers
 #include "containers/FArray.hpp"
 #include "containers/DArray.hpp"
+#include "containers/RadixSort.hpp"
 #include <unordered_map>
 
 // renderer
@@ -68,6 +69,7 @@ static FArray<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> coreDescriptorSet = {VK_NUL
 
 static FArray<vk::Buffer,     MAX_FRAMES_IN_FLIGHT> frameDataUBO        = {{}};
 static FArray<UBOFrameData*,  MAX_FRAMES_IN_FLIGHT> frameDataUBOMapped  = {nullptr};
+static FArray<u32,            MAX_FRAMES_IN_FLIGHT> frameDataVersions   = {0}; // ECS change version the lights were last written with
 static FArray<vk::Buffer,     MAX_FRAMES_IN_FLIGHT> cameraDataUBO       = {{}};
 static FArray<UBOCameraData*, MAX_FRAMES_IN_FLIGHT> cameraDataUBOMapped = {nullptr};
 
@@ -513,37 +515,46 @@ void Renderer::WaitForFrame(u32 frame)
                                                          PIPELINE_HANDLE_RENDER_SUBPASS_BITS \
                                                          )) & PIPELINE_HANDLE_QUEUE_MASK)
 
-static i32 QSortGraphicsPipelines(const void* lhs, const void* rhs)
+/**
+* @brief Creates the sort key for a pipeline handle. Pipelines are sorted by render
+* pass, then render subpass, then render queue - so they make up the key from the
+* most significant digit down.
+*/
+static INLINE u32 GetGraphicsPipelineSortKey(PipelineHandle handle)
 {
-  const PipelineHandle* handleLhs = (PipelineHandle*)lhs;
-  const PipelineHandle* handleRhs = (PipelineHandle*)rhs;
+  const u32 renderPass    = (u32)PIPELINE_HANDLE_GET_RENDER_PASS(handle);
+  const u32 renderSubpass = (u32)PIPELINE_HANDLE_GET_RENDER_SUBPASS(handle);
+  const u32 queue         = (u32)PIPELINE_HANDLE_GET_QUEUE(handle);
 
-  const u32 renderPassLhs = (u32)PIPELINE_HANDLE_GET_RENDER_PASS(*handleLhs);
-  const u32 renderPassRhs = (u32)PIPELINE_HANDLE_GET_RENDER_PASS(*handleRhs);
-
-  if (renderPassLhs < renderPassRhs) return -1;
-  if (renderPassLhs > renderPassRhs) return  1;
-
-  const u32 renderSubpassLhs = (u32)PIPELINE_HANDLE_GET_RENDER_SUBPASS(*handleLhs);
-  const u32 renderSubpassRhs = (u32)PIPELINE_HANDLE_GET_RENDER_SUBPASS(*handleRhs);
-
-  if (renderSubpassLhs < renderSubpassRhs) return -1;
-  if (renderSubpassLhs > renderSubpassRhs) return  1;
-
-  const u32 queueLhs = (u32)PIPELINE_HANDLE_GET_QUEUE((*handleLhs));
-  const u32 queueRhs = (u32)PIPELINE_HANDLE_GET_QUEUE((*handleRhs));
-
-  if (queueLhs < queueRhs) return -1;
-  if (queueLhs > queueRhs) return  1;
-
-  return 0;
+  return (renderPass    << (PIPELINE_HANDLE_RENDER_SUBPASS_BITS + PIPELINE_HANDLE_QUEUE_BITS)) |
+         (renderSubpass << (PIPELINE_HANDLE_QUEUE_BITS)) |
+         (queue);
 }
 
 static INLINE void SortGraphicsPipelines()
 {
   if (pipelineCount == 0) return;
 
-  ::qsort(pipelines.data, pipelineCount, sizeof(GraphicsPipeline), QSortGraphicsPipelines);
+  FArray<u32, MAX_GRAPHICS_PIPELINES> sortKeys    = {};
+  FArray<u32, MAX_GRAPHICS_PIPELINES> sortIndices = {};
+  FArray<u32, MAX_GRAPHICS_PIPELINES> keysScratch    = {};
+  FArray<u32, MAX_GRAPHICS_PIPELINES> indicesScratch = {};
+
+  for (u32 i = 0; i < pipelineCount; ++i)
+  {
+    sortKeys[i]    = GetGraphicsPipelineSortKey(pipelines[i].handle);
+    sortIndices[i] = i;
+  }
+
+  RadixSort::Sort(sortKeys.data, sortIndices.data, pipelineCount, keysScratch.data, indicesScratch.data);
+
+  // NOTE(WSWhitehouse): Reorder the pipelines using the sorted indices...
+  FArray<GraphicsPipeline, MAX_GRAPHICS_PIPELINES> sortedPipelines;
+  for (u32 i = 0; i < pipelineCount; ++i)
+  {
+    mem_copy(&sortedPipelines[i], &pipelines[sortIndices[i]], sizeof(GraphicsPipeline));
+  }
+  mem_copy(pipelines.data, sortedPipelines.data, sizeof(GraphicsPipeline) * pipelineCount);
 
   // NOTE(WSWhitehouse): After sorting ensure the sparse array values point to the correct index...
   for (u32 i = 0; i < pipelineCount; ++i)
@@ -705,20 +716,29 @@ static void RecordRenderData(ECS::Manager& ecs, VkCommandBuffer cmdBuffer)
 
   // Update frame data
   UBOFrameData* frameData = frameDataUBOMapped[currentFrame];
-  mem_zero(frameData, sizeof(UBOFrameData));
 
-  ComponentSparseSet* lightSparseSet = ecs.GetComponentSparseSet<PointLight>();
+  // NOTE(WSWhitehouse): The frame data is persistently mapped, only the lights that have
+  // changed since this frame's UBO was last written are rewritten. A light's position
+  // comes from its Transform, so a changed Transform rewrites the light too...
+  const u32 sinceVersion = frameDataVersions[currentFrame];
+
+  const ComponentSparseSet* lightSparseSet     = ecs.GetComponentSparseSet<PointLight>();
+  const ComponentSparseSet* transformSparseSet = ecs.GetComponentSparseSet<Transform>();
   for (u32 i = 0; i < lightSparseSet->componentCount; ++i)
   {
     const ComponentData<PointLight>& data = ((ComponentData<PointLight>*)lightSparseSet->componentArray)[i];
+    b8 lightChanged = lightSparseSet->ChangedSince(i, sinceVersion);
 
     glm::vec3 position = {};
-    if (ecs.HasComponent<Transform>(data.entity))
+    if (transformSparseSet->HasComponent<Transform>(data.entity))
     {
-      Transform* transform = ecs.GetComponent<Transform>(data.entity);
-      position = transform->position;
+      const u32 transformIndex = transformSparseSet->entitySparseArray[EntityIndex(data.entity)];
+      lightChanged = lightChanged || transformSparseSet->ChangedSince(transformIndex, sinceVersion);
+      position     = transformSparseSet->GetComponent<Transform>(data.entity)->position;
     }
 
+    if (!lightChanged) continue;
+
     frameData->pointLights[i].position = position;
     frameData->pointLights[i].colour   = data.component.colour;
     frameData->pointLights[i].range    = data.component.range;
@@ -728,22 +748,15 @@ static void RecordRenderData(ECS::Manager& ecs, VkCommandBuffer cmdBuffer)
   frameData->ambientColour   = { 0.25f, 0.25f, 0.25f };
   frameData->time            = (f32)AppTime::AppTotalTime();
   frameData->sinTime         = glm::sin(frameData->time);
+  frameDataVersions[currentFrame] = ecs.AdvanceChangeVersion();
 
-  ComponentSparseSet* cameraSparseSet = ecs.GetComponentSparseSet<Camera>();
-  for (u32 camIndex = 0; camIndex < cameraSparseSet->componentCount; ++camIndex)
+  ecs.View<Camera, Transform>().Each([&](const Camera& camera, const Transform& cameraTransform)
   {
-    const ComponentData<Camera>& camComponentData = ((ComponentData<Camera>*)cameraSparseSet->componentArray)[camIndex];
-    const Camera& camera = camComponentData.component;
-
-    if (!ecs.HasComponent<Transform>(camComponentData.entity)) continue;
-
-    Transform* cameraTransform = ecs.GetComponent<Transform>(camComponentData.entity);
-
     // Update camera data
     UBOCameraData* cameraData = cameraDataUBOMapped[currentFrame];
     mem_zero(cameraData, sizeof(UBOCameraData));
 
-    cameraData->position   = cameraTransform->position;
+    cameraData->position   = cameraTransform.position;
     cameraData->viewMat    = camera.viewMatrix;
     cameraData->projMat    = camera.projMatrix;
     cameraData->invViewMat = camera.inverseViewMatrix;
@@ -758,7 +771,7 @@ static void RecordRenderData(ECS::Manager& ecs, VkCommandBuffer cmdBuffer)
 
       pipeline.renderFuncPtr(ecs, camera, cmdBuffer, currentFrame);
     }
-  }
+  });
 
 //    // Render all sdf voxel grids...
 //    ComponentSparseSet* voxelGridSparseSet = ecs.GetComponentSparseSet<SdfVoxelGrid>();
@@ -1722,6 +1735,8 @@ static void CreateCoreDescriptorsAndBuffers()
       if (!success) ABORT(ABORT_CODE_VK_FAILURE);
 
       frameDataUBO[i].MapMemory(device, (void**)&frameDataUBOMapped[i]);
+      mem_zero(frameDataUBOMapped[i], sizeof(UBOFrameData));
+      frameDataVersions[i] = 0;
     }
 
     // Create Camera Data Buffer
@@ -155,6 +155,7 @@ JobSystem::JobHandle JobSystem::SubmitJob(WorkFuncPtr workFuncPtr)
 
 const u64& JobSystem::GetWorkerThreadCount() { return workerThreadCount; }
 b8 JobSystem::IsWorkerThread() { return workerThreadIndex != U64_MAX; }
+u64 JobSystem::GetThreadIndex() { return IsWorkerThread() ? workerThreadIndex + 1 : 0; }
 
 static void WorkerThreadRun(void* _index)
 {
@@ -5,6 +5,7 @@
 #include "threading/JobHandle.hpp"
 
 #include <functional>
+#include <vector>
 
 namespace JobSystem
 {
@@ -46,6 +47,70 @@ namespace JobSystem
   */
   [[nodiscard]] b8 IsWorkerThread();
 
+  /**
+  * @brief Get the index of the calling thread, useful for indexing per-thread data.
+  * Worker threads return [1, GetWorkerThreadCount()], any other thread returns 0.
+  * @return Index of the calling thread.
+  */
+  [[nodiscard]] u64 GetThreadIndex();
+
+  /**
+  * @brief Call the function for every index in [0, count) in parallel. Indices [1, count)
+  * are submitted as jobs and index 0 is run on the calling thread, then blocks until every
+  * job is complete. Runs every index on the calling thread when there are no worker threads.
+  * @param count Number of indices.
+  * @param func Function with the signature `void(u32 index)`.
+  */
+  template<typename Func>
+  INLINE void ParallelFor(u32 count, const Func& func)
+  {
+    if (count == 0) return;
+
+    if (GetWorkerThreadCount() == 0)
+    {
+      for (u32 i = 0; i < count; ++i) { func(i); }
+      return;
+    }
+
+    std::vector<JobHandle> jobs(count - 1);
+    for (u32 i = 1; i < count; ++i)
+    {
+      jobs[i - 1] = SubmitJob([&func, i] { func(i); });
+    }
+
+    func(0);
+
+    for (JobHandle& job : jobs)
+    {
+      job.WaitUntilComplete();
+    }
+  }
+
+  /**
+  * @brief Split [0, count) into ranges of equal size (the last may be smaller) and call the
+  * function on each range in parallel, see ParallelFor. The ranges only depend on the count
+  * and range count, so pick a range count that doesn't depend on the thread count if the
+  * result must be deterministic.
+  * @param count Number of elements.
+  * @param rangeCount The number of ranges to split the elements into, clamped to [1, count].
+  * @param func Function with the signature `void(u32 start, u32 end)`.
+  */
+  template<typename Func>
+  INLINE void ParallelForRanges(u32 count, u32 rangeCount, const Func& func)
+  {
+    if (count == 0) return;
+
+    rangeCount = MIN(MAX(rangeCount, 1u), count);
+    const u32 rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    // NOTE(WSWhitehouse): Rounding the range size up can leave fewer ranges than requested...
+    ParallelFor((count + rangeSize - 1) / rangeSize, [&func, count, rangeSize](u32 range)
+    {
+      const u32 start = range * rangeSize;
+      func(start, MIN(start + rangeSize, count));
+    });
+  }
+
 } // namespace JobSystem
 
 
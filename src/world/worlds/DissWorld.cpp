@@ -3,6 +3,7 @@
 // core
 #include "core/Profiler.hpp"
 #include "core/AppTime.hpp"
+#include "core/Platform.hpp"
 
 // containers
 #include "containers/DArray.hpp"
@@ -49,6 +50,12 @@ static Entity camera;
 static Entity pointLight;
 static DArray<TreeNode> meshEntities = {};
 static Entity sdfVoxelGrid;
+
+// NOTE(WSWhitehouse): The BSP tree isn't rendered anymore (the SdfRenderer uses a BVH),
+// it can be rebuilt from the debug GUI to check the tree and how long it takes to build.
+static const Mesh* testMesh = nullptr;
+static BSPTree bspTree      = {};
+static f64 bspBuildTime     = 0.0;
 //static Entity sdfRenderer;
 //static Entity planeEntities = {};
 
@@ -58,7 +65,7 @@ void DissWorld::Init(ECS::Manager& ecs)
   camera = ecs.CreateEntity();
   {
     Transform* transform = ecs.AddComponent<Transform>(camera);
-    transform->position = glm::vec3(0.0f, 0.0f, 0.0f);
+    transform->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
 
     ecs.AddComponent<Camera>(camera);
     ecs.AddComponent<FlyCam>(camera);
@@ -82,7 +89,7 @@ void DissWorld::Init(ECS::Manager& ecs)
 //  const Mesh* testMesh = AssetDatabase::LoadMesh("data/test-obj.glb");
 //  const Mesh* testMesh = AssetDatabase::LoadMesh("data/low-poly-sphere.glb");
 //  const Mesh* testMesh = AssetDatabase::LoadMesh("data/sphere.glb");
-  const Mesh* testMesh = AssetDatabase::LoadMesh("data/stanford-bunny-high-res.glb");
+  testMesh = AssetDatabase::LoadMesh("data/stanford-bunny-high-res.glb");
 //  const Mesh* testMesh = AssetDatabase::LoadMesh("data/sponza/sponza.glb");
 //  const Mesh* testMesh = AssetDatabase::LoadMesh("data/monkey.glb");
   if (testMesh == nullptr) ABORT(ABORT_CODE_ASSET_FAILURE);
@@ -130,7 +137,7 @@ void DissWorld::Init(ECS::Manager& ecs)
   pointLight = ecs.CreateEntity();
   {
     Transform* transform = ecs.AddComponent<Transform>(pointLight);
-    transform->position = { 2.0f, 0.0f, 3.0f };
+    transform->SetPosition({ 2.0f, 0.0f, 3.0f });
 
     PointLight* light = ecs.AddComponent<PointLight>(pointLight);
     light->range  = 5.0f;
@@ -141,8 +148,8 @@ void DissWorld::Init(ECS::Manager& ecs)
   sdfVoxelGrid = ecs.CreateEntity();
   {
     Transform* transform = ecs.AddComponent<Transform>(sdfVoxelGrid);
-    transform->position = { 0.0f, 0.0f, 5.0f };
-    transform->rotation = { 0.0f, 180.0f, 0.0f};
+    transform->SetPosition({ 0.0f, 0.0f, 5.0f });
+    transform->SetRotation({ 0.0f, 180.0f, 0.0f});
 
     SdfVoxelGrid* voxelGrid = ecs.AddComponent<SdfVoxelGrid>(sdfVoxelGrid);
 
@@ -152,7 +159,7 @@ void DissWorld::Init(ECS::Manager& ecs)
 //    glm::vec3 cellCount = glm::vec3{128, 128, 128};
 //    glm::vec3 cellCount = glm::vec3{64, 64, 64};
 //    glm::vec3 cellCount = glm::vec3{32, 32, 32};
-    SdfVoxelGrid::Create(voxelGrid, true, testMesh, cellCount);
+    SdfVoxelGrid::Create(voxelGrid, SdfBakeMethod::GPU_JUMP_FLOODING, SdfStorage::DENSE, SdfFormat::F32, testMesh, cellCount);
   }
   SdfVoxelGrid::CleanUpComputePipeline();
 }
@@ -162,6 +169,8 @@ void DissWorld::Shutdown(ECS::Manager& ecs)
   SdfVoxelGrid* voxelGrid = ecs.GetComponent<SdfVoxelGrid>(sdfVoxelGrid);
   SdfVoxelGrid::Release(voxelGrid);
 
+  bspTree.Destroy();
+
 //  SdfRenderer* renderer = ecs.GetComponent<SdfRenderer>(sdfRenderer);
 //  ComponentFactory::SdfRendererDestroy(renderer);
 
@@ -186,19 +195,45 @@ void DissWorld::Update(ECS::Manager& ecs)
     ImGui::Begin("Camera Settings");
     ImGui::InputFloat("Move Speed", &flyCam->moveSpeed);
     ImGui::InputFloat2("Look Speed", glm::value_ptr(flyCam->lookSpeed));
-    ImGui::InputFloat3("Position", glm::value_ptr(camTransform->position));
-    ImGui::InputFloat3("Rotation", glm::value_ptr(camTransform->rotation));
+    if (ImGui::InputFloat3("Position", glm::value_ptr(camTransform->position))) camTransform->MarkDirty();
+    if (ImGui::InputFloat3("Rotation", glm::value_ptr(camTransform->rotation))) camTransform->MarkDirty();
     ImGui::End();
   }
 
+  // ECS systems schedule GUI...
+  ecs.GetSystemManager().DrawDebugGUI("ECS Systems");
+
   // Point light GUI...
   {
     ImGui::Begin("Point Light");
     Transform* transform = ecs.GetComponent<Transform>(pointLight);
     PointLight* light    = ecs.GetComponent<PointLight>(pointLight);
-    ImGui::InputFloat3("position", glm::value_ptr(transform->position));
-    ImGui::ColorPicker3("colour", glm::value_ptr(light->colour));
-    ImGui::InputFloat("range", &light->range);
+    if (ImGui::InputFloat3("position", glm::value_ptr(transform->position))) transform->MarkDirty();
+    if (ImGui::ColorPicker3("colour", glm::value_ptr(light->colour))) ecs.MarkChanged<PointLight>(pointLight);
+    if (ImGui::InputFloat("range", &light->range))                     ecs.MarkChanged<PointLight>(pointLight);
+    ImGui::End();
+  }
+
+  // BSP tree GUI...
+  {
+    ImGui::Begin("BSP Tree");
+    if (ImGui::Button("Build"))
+    {
+      bspTree.Destroy();
+
+      const f64 startTime = Platform::GetTime();
+      bspTree.BuildTree(testMesh);
+      bspBuildTime = Platform::GetTime() - startTime;
+    }
+
+    u64 leafCount = 0;
+    for (u64 i = 0; i < bspTree.nodes.Size(); ++i)
+    {
+      if (bspTree.nodes[i].isLeaf) leafCount++;
+    }
+
+    ImGui::Text("Nodes: %llu, Leaves: %llu", bspTree.nodes.Size(), leafCount);
+    ImGui::Text("Build Time: %.3f ms", bspBuildTime * 1000.0);
     ImGui::End();
   }
 
@@ -229,9 +264,9 @@ void DissWorld::Update(ECS::Manager& ecs)
 
     ImGui::Begin(name);
     ImGui::Checkbox("Render", &meshRenderer->renderMesh);
-    ImGui::InputFloat3("Position", glm::value_ptr(transform->position));
-    ImGui::SliderFloat3("Rotation", glm::value_ptr(transform->rotation), 0.0f, 360.0f);
-    ImGui::InputFloat3("Scale", glm::value_ptr(transform->scale));
+    if (ImGui::InputFloat3("Position", glm::value_ptr(transform->position)))               transform->MarkDirty();
+    if (ImGui::SliderFloat3("Rotation", glm::value_ptr(transform->rotation), 0.0f, 360.0f)) transform->MarkDirty();
+    if (ImGui::InputFloat3("Scale", glm::value_ptr(transform->scale)))                      transform->MarkDirty();
     ImGui::End();
   }
 }